@@ -9,6 +9,10 @@
 *******************************************************************************/
 #include "CH56x_common.h"
 #include "CH56x_debug_log.h"
+#include "event.h"
+#include "irqprio.h"
+#include "memuse.h"
+#include "trace.h"
 
 #undef FREQ_SYS
 /* System clock / MCU frequency in Hz (lowest possible speed 15MHz) */
@@ -35,6 +39,8 @@ debug_log_buf_t log_buf;
  */
 int main()
 {
+	/* Paint free RAM and stack for stack high-water mark (see memuse.h) */
+	memuse_stack_paint();
 	/* Configure GPIO In/Out default/safe state for the board */
 	bsp_gpio_init();
 	/* Init BSP (MCU Frequency & SysTick) */
@@ -46,6 +52,13 @@ int main()
 	UART1_init(UART1_BAUD, FREQ_SYS);
 #endif
 	log_printf("Start\n");
+	memuse_log();
+	/* Init event dispatcher (main loop sleep with WFI between events) */
+	event_init();
+	/* Init trace points backends (see trace.h) */
+	trace_init();
+	/* Interrupts priority map with preemption (see irqprio.h) */
+	irqprio_init();
 
 	while(1)
 	{
@@ -58,9 +71,9 @@ int main()
 			blink_ms = BLINK_SLOW;
 		}
 		bsp_uled_on();
-		bsp_wait_ms_delay(blink_ms);
+		event_sleep_ms(blink_ms);
 		bsp_uled_off();
-		bsp_wait_ms_delay(blink_ms);
-		log_printf("Blink\n");
+		event_sleep_ms(blink_ms);
+		log_printf("Blink idle=%d%%\n", event_idle_percent());
 	}
 }
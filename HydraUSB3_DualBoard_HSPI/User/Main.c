@@ -9,6 +9,17 @@
 *******************************************************************************/
 #include "CH56x_common.h"
 #include "CH56x_debug_log.h"
+#include "bootprof.h"
+#include "clkgov.h"
+#include "event.h"
+#include "irqprio.h"
+#include "memuse.h"
+#include "trace.h"
+#include "fastmem.h"
+#include "crc32.h"
+#include "hspi_rpc.h"
+#include "soak.h"
+#include "link_hspi.h"
 
 #undef FREQ_SYS
 /* System clock / MCU frequency(HSPI Frequency) in Hz */
@@ -21,37 +32,47 @@
 #define UART1_BAUD (5000000) // Real baud rate is round to 5Mbauds (For Fsys 120MHz) => Requires USB2HS Serial like FTDI C232HM-DDHSL-0
 #endif
 
-//Data size
-#define DataSize_8bit  0
-#define DataSize_16bit 1
-#define DataSize_32bit 2
-/* HSPI Data Size Selection 8, 16 or 32bits bus */
-//#define Data_Size DataSize_8bit
-//#define Data_Size DataSize_16bit
-#define Data_Size DataSize_32bit
+// Run fastmem benchmark (fastmem vs newlib-nano memcpy/memset) at startup
+//#define FASTMEM_BENCHMARK (1)
+//#define CRC32_BENCHMARK (1)
+// Run HSPI request/response round-trip benchmark after HSPI training (both boards)
+//#define HSPI_RPC_BENCHMARK (1)
+// Run long duration soak test (32K transfers in loop, statistics logged each SOAK_LOG_MS) after HSPI training
+//#define SOAK_TEST (1)
+/* Soak test fault injection: TX corrupts one 32K transfer each SOAK_FAULT_EVERY_N (0 = disabled) */
+#define SOAK_FAULT_EVERY_N (0)
+// Run common link benchmark (16K transfers see link.h) after HSPI training
+//#define LINK_BENCHMARK (1)
+#define LINK_BENCHMARK_LOG_MS (1000)
+// TX board: 32K transfers (UBTN) sent from 2x16K fragments stored in reverse order in RAMX (see hspi_link_tx_sg())
+//#define HSPI_SG_TX (1)
+// TX board: CLKGOV_FREQ_LOW between 32K transfers (UBTN) (see clkgov.h, RX board stays at FREQ_SYS)
+//#define CLK_GOVERNOR (1)
+#if(defined CLK_GOVERNOR) && (defined DEBUG)
+#define CLK_GOVERNOR_UART1_BAUD (UART1_BAUD) // Shall be reachable at CLKGOV_FREQ_LOW
+#else
+#define CLK_GOVERNOR_UART1_BAUD (0)
+#endif
 
-//DMA_Len
-#define DMA_Tx_Len   (512)
-#define DMA_Tx_Len0   DMA_Tx_Len
-#define DMA_Tx_Len1   DMA_Tx_Len
+/* HSPI bus width (8, 16 or 32bits) and packet length are negotiated at startup (see hspi_link_train()) */
+hspi_link_cfg_t hspi_cfg;
 
 //DMA_Addr0
 #define TX_DMA_Addr0   0x20020000
 #define RX_DMA_Addr0   0x20020000
 
-//DMA_Addr1
-#define TX_DMA_Addr1   0x20020000 + DMA_Tx_Len0
-#define RX_DMA_Addr1   0x20020000 + DMA_Tx_Len1
-
-/* Shared variables */
-volatile int HSPI_TX_End_Flag; // Send completion flag
-volatile int HSPI_RX_End_Flag; // Receive completion flag
-volatile int HSPI_RX_End_Err; // 0=No Error else >0 Error code
+/* 32K transfer */
+#define HSPI_XFER_SIZE (32768)
 
-/* HSPI_IRQHandler variables */
-uint32_t Tx_Cnt = 0;
-uint32_t Rx_Cnt = 0;
-uint32_t addr_cnt = 0;
+#ifdef HSPI_SG_TX
+#define HSPI_SG_FRAG_SIZE (HSPI_XFER_SIZE / 2)
+/* Second half of the 32K pattern first in RAMX, RX board receives the 32K pattern */
+static const hspi_link_sg_t hspi_sg_tx[2] =
+{
+	{ TX_DMA_Addr0 + HSPI_SG_FRAG_SIZE, HSPI_SG_FRAG_SIZE },
+	{ TX_DMA_Addr0, HSPI_SG_FRAG_SIZE },
+};
+#endif
 
 /* Blink time in ms */
 #define BLINK_ULTRA_FAST  2 // Determine the speed of Packets Sent (It shall be not too fast for the Slave)
@@ -66,6 +87,155 @@ bool_t is_board1; /* Return true or false */
 /* Required for log_init() => log_printf()/cprintf() */
 debug_log_buf_t log_buf;
 
+#ifdef SOAK_TEST
+/*********************************************************************
+ * @fn      hspi_soak_verify
+ *
+ * @brief   Check received 32K transfer
+ *
+ * @return  0 if valid else SOAK_ERR_XXX + 1
+ */
+static int hspi_soak_verify(void)
+{
+	uint32_t i;
+
+	if(hspi_link_rx_err & HSPI_LINK_RX_ERR_CRC)
+		return (SOAK_ERR_CRC + 1);
+	if(hspi_link_rx_err & HSPI_LINK_RX_ERR_NUM_MIS)
+		return (SOAK_ERR_SEQ + 1);
+	for(i = 0; i < (HSPI_XFER_SIZE / 4); i++)
+	{
+		if(((uint32_t*)RX_DMA_Addr0)[i] != (i + 0x55555555))
+			return (SOAK_ERR_DATA + 1);
+	}
+	return 0;
+}
+
+/*********************************************************************
+ * @fn      hspi_soak
+ *
+ * @brief   Soak test, TX sends 32K transfers continuously (one each
+ *          BLINK_ULTRA_FAST ms), RX verifies them and re-init HSPI after
+ *          error (never returns)
+ *
+ * @return  none
+ */
+static void hspi_soak(void)
+{
+	uint32_t events;
+	uint32_t t0;
+	uint32_t log_t0;
+	uint32_t rx_nb; // Transfers received during SOAK_LOG_MS
+	int err;
+
+	soak_init(SOAK_FAULT_EVERY_N);
+	if(is_board1 == false) // TX Mode
+	{
+		log_printf("SOAK HSPI TX width=%d pkt_len=%d fault_every_n=%d\n", hspi_cfg.width, hspi_cfg.pkt_len, SOAK_FAULT_EVERY_N);
+		hspi_link_init(1, &hspi_cfg, TX_DMA_Addr0, HSPI_XFER_SIZE / hspi_cfg.pkt_len);
+		bsp_wait_us_delay(100); /* Wait 100us RX is ready before to TX */
+		log_t0 = bsp_get_SysTickCNT_LSB();
+		while(1)
+		{
+			fastmem_fill_inc32((uint32_t*)TX_DMA_Addr0, 0x55555555, 1, (HSPI_XFER_SIZE / 4));
+			if(soak_fault_inject())
+				((uint32_t*)TX_DMA_Addr0)[HSPI_XFER_SIZE / 8] ^= 0xFFFFFFFF;
+			t0 = bsp_get_SysTickCNT_LSB();
+			hspi_link_tx_start();
+			event_wait(EVENT_HSPI_TX_END);
+			soak_frame(HSPI_XFER_SIZE, (t0 - bsp_get_SysTickCNT_LSB()) / bsp_get_nbtick_1us()); // SysTick count down
+			event_sleep_ms(BLINK_ULTRA_FAST);
+			if(((log_t0 - bsp_get_SysTickCNT_LSB()) / bsp_get_nbtick_1us()) >= (SOAK_LOG_MS * 1000))
+			{
+				log_t0 = bsp_get_SysTickCNT_LSB();
+				soak_log("HSPI TX");
+#if(defined IRQPRIO_STRESS)
+				irqprio_log();
+#endif
+			}
+		}
+	}
+	else // RX mode
+	{
+		log_printf("SOAK HSPI RX width=%d pkt_len=%d\n", hspi_cfg.width, hspi_cfg.pkt_len);
+		fastmem_set32((uint32_t*)RX_DMA_Addr0, 0, (HSPI_XFER_SIZE / 4));
+		hspi_link_init(0, &hspi_cfg, RX_DMA_Addr0, HSPI_XFER_SIZE / hspi_cfg.pkt_len);
+		rx_nb = 0;
+		event_timer_start(SOAK_LOG_MS);
+		while(1)
+		{
+			events = event_wait(EVENT_HSPI_RX_END | EVENT_TIMER);
+			if(events & EVENT_HSPI_RX_END)
+			{
+				err = hspi_soak_verify();
+				if(err == 0)
+				{
+					soak_frame(HSPI_XFER_SIZE, 0);
+				}
+				else
+				{
+					soak_error((e_soak_err)(err - 1));
+					soak_reinit();
+					hspi_link_init(0, &hspi_cfg, RX_DMA_Addr0, HSPI_XFER_SIZE / hspi_cfg.pkt_len);
+				}
+				fastmem_set32((uint32_t*)RX_DMA_Addr0, 0, (HSPI_XFER_SIZE / 4));
+				hspi_link_rx_err = 0;
+				rx_nb++;
+			}
+			if(events & EVENT_TIMER)
+			{
+				/* No transfer received during SOAK_LOG_MS */
+				if(rx_nb == 0)
+					soak_error(SOAK_ERR_TIMEOUT);
+				rx_nb = 0;
+				soak_log("HSPI RX");
+#if(defined IRQPRIO_STRESS)
+				irqprio_log();
+#endif
+				event_timer_start(SOAK_LOG_MS);
+			}
+		}
+	}
+}
+#endif
+
+#ifdef LINK_BENCHMARK
+/*********************************************************************
+ * @fn      link_bench_stream
+ *
+ * @brief   Common link benchmark, send (TX board) or receive and check
+ *          (RX board) 16K transfers and log throughput each
+ *          LINK_BENCHMARK_LOG_MS (never returns)
+ *
+ * @return  None
+ */
+static void link_bench_stream(void)
+{
+	link_bench_t bench;
+
+	log_printf("LINK HSPI width=%d pkt_len=%d\n", hspi_cfg.width, hspi_cfg.pkt_len);
+	link_hspi_open((is_board1 == false), &hspi_cfg);
+	link_bench_init(&bench, &link_hspi, LINK_HSPI_BUF_SIZE);
+	event_timer_start(LINK_BENCHMARK_LOG_MS);
+	while(1)
+	{
+		if(is_board1 == false)
+			link_bench_tx_task(&bench);
+		else
+			link_bench_rx_task(&bench);
+		if(event_poll(EVENT_TIMER))
+		{
+			link_bench_log(&bench);
+#if(defined IRQPRIO_STRESS)
+			irqprio_log();
+#endif
+			trace_log(); // Trace points RAM ring (if any trace point uses TRACE_RING)
+			event_timer_start(LINK_BENCHMARK_LOG_MS);
+		}
+	}
+}
+#endif
+
 /*********************************************************************
  * @fn      main
  *
@@ -77,22 +247,35 @@ int main()
 {
 	uint32_t i;
 
+	/* Paint free RAM and stack for stack high-water mark (see memuse.h) */
+	memuse_stack_paint();
 	/* Configure GPIO In/Out default/safe state for the board */
 	bsp_gpio_init();
 	/* Init BSP (MCU Frequency & SysTick) */
 	bsp_init(FREQ_SYS);
+	/* Boot profile time reference (SysTick started by bsp_init()) */
+	bootprof_init();
 	/* Configure serial debugging for printf()/log_printf()... */
+	bootprof_begin(BOOTPROF_LOG_INIT);
 	log_init(&log_buf);
+	bootprof_end(BOOTPROF_LOG_INIT);
 #if(defined DEBUG)
 	/* Configure serial debugging for printf()/log_printf()... */
 	UART1_init(UART1_BAUD, FREQ_SYS);
 #endif
 	printf("\n");
+	/* Init event dispatcher (main loop sleep with WFI between events) */
+	event_init();
+	/* Init trace points backends (see trace.h) */
+	trace_init();
+	/* Interrupts priority map with preemption (see irqprio.h) */
+	irqprio_init();
 
 	/******************************************/
 	/* Start Synchronization between 2 Boards */
 	/* J3 MOSI(PA14) & J3 SCS(PA12) signals   */
 	/******************************************/
+	bootprof_begin(BOOTPROF_SYNC2BOARDS);
 	if(bsp_switch() == 0)
 	{
 		is_board1 = false;
@@ -103,6 +286,7 @@ int main()
 		is_board1 = true;
 		i = bsp_sync2boards(PA14, PA12, BSP_BOARD1);
 	}
+	bootprof_end(BOOTPROF_SYNC2BOARDS);
 	if(i > 0)
 		log_printf("SYNC %08d\n", i);
 	else
@@ -125,49 +309,96 @@ int main()
 		log_printf("HSPI_Rx(Board1 Top) 2022/12/11 @ChipID=%02X\n", R8_CHIP_ID);
 	}
 	log_printf("FSYS=%d\n", FREQ_SYS);
+	bootprof_log();
+	memuse_log();
+#ifdef FASTMEM_BENCHMARK
+	fastmem_benchmark((uint32_t*)0x20020000, (uint32_t*)(0x20020000 + 16384), 16384);
+#endif
+#ifdef CRC32_BENCHMARK
+	crc32_benchmark((const uint8_t*)0x20020000, 16384);
+#endif
+
+	if(hspi_link_train(is_board1 == false, &hspi_cfg) != 0)
+		log_printf("HSPI train Err (use safest mode)\n");
+#ifdef HSPI_RPC_BENCHMARK
+	hspi_rpc_init(&hspi_cfg);
+	if(is_board1 == false)
+		hspi_rpc_benchmark(); // Master
+	else
+		while(hspi_rpc_serve(hspi_rpc_echo) != 1); // Slave
+	hspi_rpc_deinit();
+#endif
+#if(defined IRQPRIO_STRESS)
+	/* Long USB command like load and latency probe with link traffic (see irqprio.h) */
+	irqprio_stress_start(IRQPRIO_STRESS_LOAD_US, IRQPRIO_STRESS_PERIOD_US);
+#endif
+#ifdef SOAK_TEST
+	hspi_soak();
+#endif
+#ifdef LINK_BENCHMARK
+	link_bench_stream();
+#endif
 
 	if (is_board1 ==  false) // TX Mode
 	{
-		log_printf("HSPI TX Data_Size=%d\n", Data_Size);
-		HSPI_DoubleDMA_Init(HSPI_HOST, RB_HSPI_DAT32_MOD, TX_DMA_Addr0, TX_DMA_Addr1, DMA_Tx_Len);
+		log_printf("HSPI TX width=%d pkt_len=%d\n", hspi_cfg.width, hspi_cfg.pkt_len);
+		hspi_link_init(1, &hspi_cfg, TX_DMA_Addr0, HSPI_XFER_SIZE / hspi_cfg.pkt_len);
 
 		log_printf("Write RAMX 0x20020000 32K\n");
 		// Write RAMX
-		for(i = 0; i < 8192; i++) // 8192*4 = 32K
-		{
-			*(uint32_t*)(0x20020000+i*4) = (i + 0x55555555);
-		}
+		fastmem_fill_inc32((uint32_t*)0x20020000, 0x55555555, 1, 8192); // 8192*4 = 32K
 
 		log_printf("Wait 100us\n"); /* Wait 100us RX is ready before to TX */
 		bsp_wait_us_delay(100);
 
 		log_printf("Start Tx 32K data\n");
 
-		bsp_uled_on();
-		HSPI_DMA_Tx();
-		bsp_uled_off();
+		hspi_link_tx_start();
 
-		while(HSPI_TX_End_Flag == 0);
+		event_wait(EVENT_HSPI_TX_END);
 
 		log_printf("Tx 32K data suc\r\n");
 		log_printf("Wait 20ms before blink loop\n");
-		bsp_wait_ms_delay(20);
+		event_sleep_ms(20);
+#ifdef CLK_GOVERNOR
+		clkgov_init(FREQ_SYS, CLKGOV_FREQ_LOW, CLKGOV_IDLE_MS, CLK_GOVERNOR_UART1_BAUD);
+#endif
 		while(1)
 		{
 			if( bsp_ubtn() )
 			{
+				int ret = 0;
+
 				bsp_uled_on();
+#ifdef CLK_GOVERNOR
+				clkgov_activity(); // HSPI clock is FREQ_SYS
+#endif
 
+#ifdef HSPI_SG_TX
+				// Write RAMX fragments (32K pattern halves swapped)
+				fastmem_fill_inc32((uint32_t*)(TX_DMA_Addr0 + HSPI_SG_FRAG_SIZE), 0x55555555, 1, HSPI_SG_FRAG_SIZE / 4);
+				fastmem_fill_inc32((uint32_t*)TX_DMA_Addr0, 0x55555555 + (HSPI_SG_FRAG_SIZE / 4), 1, HSPI_SG_FRAG_SIZE / 4);
+				log_printf("Start Tx 32K (2 fragments)\n");
+				ret = hspi_link_tx_sg(hspi_sg_tx, 2); // 16K fragments are whole packets for all pkt_len
+#else
 				// Write RAMX
-				for(i=0; i<8192; i++) // 8192*4 = 32K
-				{
-					*(uint32_t*)(0x20020000+i*4) = i + 0x55555555;
-				}
+				fastmem_fill_inc32((uint32_t*)0x20020000, 0x55555555, 1, 8192); // 8192*4 = 32K
 				log_printf("Start Tx 32K\n");
-				HSPI_DMA_Tx();
+				hspi_link_tx_start();
+#endif
 
-				while(HSPI_TX_End_Flag == 0);
-				log_printf("Tx 32K OK\n");
+				if(ret == 0)
+				{
+					event_wait(EVENT_HSPI_TX_END);
+					log_printf("Tx 32K OK idle=%d%%\n", event_idle_percent());
+				}
+				else
+				{
+					log_printf("Tx 32K not started (fragments not whole packets)\n"); // No EVENT_HSPI_TX_END to wait
+				}
+#ifdef CLK_GOVERNOR
+				clkgov_log();
+#endif
 
 				blink_ms = BLINK_ULTRA_FAST;
 			}
@@ -175,39 +406,38 @@ int main()
 			{
 				blink_ms = BLINK_SLOW;
 			}
+#ifdef CLK_GOVERNOR
+			clkgov_task();
+#endif
 			bsp_uled_on();
-			bsp_wait_ms_delay(blink_ms);
+			event_sleep_ms(blink_ms);
 			bsp_uled_off();
-			bsp_wait_ms_delay(blink_ms);
+			event_sleep_ms(blink_ms);
 		}
 	}
 	else // RX mode
 	{
-		log_printf("HSPI RX Data_Size=%d\n", Data_Size);
+		log_printf("HSPI RX width=%d pkt_len=%d\n", hspi_cfg.width, hspi_cfg.pkt_len);
 
 		log_printf("Clear RAMX 32K\n");
-		for(i = 0; i < 8192; i++) // 8192*4 = 32K
-		{
-			*(uint32_t*)(0x20020000+i*4) = 0;
-		}
+		fastmem_set32((uint32_t*)0x20020000, 0, 8192); // 8192*4 = 32K
 		log_printf("DMA_RX_Addr0[0]=0x%08X [8191]=0x%08X\n",
 				   ((uint32_t*)RX_DMA_Addr0)[0], ((uint32_t*)RX_DMA_Addr0)[8191]);
 
-		HSPI_RX_End_Flag = 0;  // Receive completion flag
-		HSPI_RX_End_Err = 0; // 0=No Error else >0 Error code
-		HSPI_DoubleDMA_Init(HSPI_DEVICE, RB_HSPI_DAT32_MOD, RX_DMA_Addr0, RX_DMA_Addr1, 0);
+		hspi_link_init(0, &hspi_cfg, RX_DMA_Addr0, HSPI_XFER_SIZE / hspi_cfg.pkt_len);
 
 		int Rx_Verify_Flag = 0;
+		event_stats_t stats;
 		while(1)
 		{
 			log_printf("Wait Rx\n");
-			while(HSPI_RX_End_Flag == 0)
-			{
-
-			}
-			log_printf("Rx_End\n");
+			event_wait(EVENT_HSPI_RX_END);
+			event_stats_get(&stats);
+			log_printf("Rx_End idle=%d%% wake_lat=%d cycles(min=%d max=%d) crc_err=%d num_mis=%d\n",
+					   event_idle_percent(), stats.wake_lat_last, stats.wake_lat_min, stats.wake_lat_max,
+					   hspi_link_crc_err, hspi_link_num_mis);
 
-			if(HSPI_RX_End_Err == 0)
+			if(hspi_link_rx_err == 0)
 			{
 				//verify
 				for(i = 0; i < 8192; i++) // 8192*4 = 32K
@@ -217,7 +447,7 @@ int main()
 					if(val_u32 != (i + 0x55555555))
 					{
 						Rx_Verify_Flag = 1;
-						log_printf("Verify err Rx_End_Err=%d\n", HSPI_RX_End_Err);
+						log_printf("Verify err Rx_End_Err=%d\n", hspi_link_rx_err);
 						log_printf("Err addr=0x%08X val=0x%08X expected val=0x%08X\n",
 								   (0x20020000+i*4),
 								   val_u32,
@@ -228,7 +458,7 @@ int main()
 			}
 			else
 			{
-				Rx_Verify_Flag = HSPI_RX_End_Err;
+				Rx_Verify_Flag = hspi_link_rx_err;
 			}
 
 			if(Rx_Verify_Flag == 0)
@@ -242,137 +472,16 @@ int main()
 				// Error reset Rx_Verify_Flag
 				Rx_Verify_Flag = 0;
 				log_printf("HSPI_Init\n");
-				HSPI_DoubleDMA_Init(HSPI_DEVICE, RB_HSPI_DAT32_MOD, RX_DMA_Addr0, RX_DMA_Addr1, 0);
+				hspi_link_init(0, &hspi_cfg, RX_DMA_Addr0, HSPI_XFER_SIZE / hspi_cfg.pkt_len);
 			}
 
 			log_printf("Clear RAMX 32K\n");
-			for(i=0; i<8192; i++) // 8192*4 = 32K
-			{
-				*(uint32_t*)(0x20020000+i*4) = 0;
-			}
+			fastmem_set32((uint32_t*)0x20020000, 0, 8192); // 8192*4 = 32K
 			log_printf("DMA_RX_Addr0[0]=0x%08X [8191]=0x%08X\n",
 					   ((uint32_t*)RX_DMA_Addr0)[0], ((uint32_t*)RX_DMA_Addr0)[8191]);
 
-			HSPI_RX_End_Err = 0;
-			HSPI_RX_End_Flag = 0;
+			hspi_link_rx_err = 0;
+			event_poll(EVENT_HSPI_RX_END); // Discard reception ended during verify/clear
 		}
 	}
 }
-
-void HSPI_IRQHandler_ReInitRX(void)
-{
-	R32_HSPI_RX_ADDR0 = RX_DMA_Addr0;
-	R32_HSPI_RX_ADDR1 = RX_DMA_Addr1;
-	addr_cnt = 0;
-	Rx_Cnt = 0;
-}
-
-/*********************************************************************
- * @fn      HSPI_IRQHandler
- *
- * @brief   This function handles HSPI exception.
- *
- * @return  none
- */
-__attribute__((interrupt("WCH-Interrupt-fast"))) void HSPI_IRQHandler(void)
-{
-	/**************/
-	/** Transmit **/
-	/**************/
-	if(R8_HSPI_INT_FLAG & RB_HSPI_IF_T_DONE) // Single packet sending completed
-	{
-		bsp_uled_on();
-		R8_HSPI_INT_FLAG = RB_HSPI_IF_T_DONE;  // Clear Interrupt
-		if (is_board1 ==  false) // TX Mode
-		{
-			Tx_Cnt++;
-			addr_cnt++;
-
-			// log_printf("Tx_Cnt=%d addr_cnt=%d\r\n", Tx_Cnt, addr_cnt);
-			if(Tx_Cnt<64) // Send 32K (64*512 bytes)
-			{
-				if(addr_cnt%2)
-				{
-					R32_HSPI_TX_ADDR0 += DMA_Tx_Len0*2;
-				}
-				else
-				{
-					R32_HSPI_TX_ADDR1 += DMA_Tx_Len0*2;
-				}
-				// bsp_wait_us_delay(1); // Send Data each 1us (to let time to the Device/Receiver to retrieve the packet)
-				R8_HSPI_CTRL |= RB_HSPI_SW_ACT;  // Software, trigger to send
-			}
-			else // Send completed
-			{
-				R32_HSPI_TX_ADDR0 = TX_DMA_Addr0;
-				R32_HSPI_TX_ADDR1 = TX_DMA_Addr1;
-				addr_cnt = 0;
-				Tx_Cnt = 0;
-				HSPI_TX_End_Flag = 1;
-			}
-		}
-	}
-	/*************/
-	/** Receive **/
-	/*************/
-	if(R8_HSPI_INT_FLAG & RB_HSPI_IF_R_DONE) // Single packet reception completed
-	{
-		bsp_uled_on();
-		//log_printf("R8_HSPI_INT_FLAG=0x%02X\n", R8_HSPI_INT_FLAG);
-		R8_HSPI_INT_FLAG = RB_HSPI_IF_R_DONE;  // Clear Interrupt
-
-		// The CRC is correct, the received serial number matches (data is received correctly)
-		if((R8_HSPI_RTX_STATUS & (RB_HSPI_CRC_ERR|RB_HSPI_NUM_MIS)) == 0)
-		{
-			Rx_Cnt++;
-			addr_cnt++;
-			if(Rx_Cnt<64) // Receive 32K (64*512 bytes)
-			{
-				if(addr_cnt%2)
-				{
-					R32_HSPI_RX_ADDR0 += 512*2;
-				}
-				else
-				{
-					R32_HSPI_RX_ADDR1 += 512*2;
-				}
-			}
-			else
-			{
-				// Receive completed
-				HSPI_IRQHandler_ReInitRX();
-				HSPI_RX_End_Flag = 1;
-			}
-		}
-		// Determine whether the CRC is correct
-		if(R8_HSPI_RTX_STATUS & RB_HSPI_CRC_ERR)
-		{
-			// CRC check err
-			// R8_HSPI_CTRL &= ~RB_HSPI_ENABLE;
-			log_printf("CRC err\n");
-			HSPI_IRQHandler_ReInitRX();
-			HSPI_RX_End_Err |= 1;
-			HSPI_RX_End_Flag = 1;
-		}
-		// Whether the received serial number matches, (does not match, modify the packet serial number)
-		if(R8_HSPI_RTX_STATUS & RB_HSPI_NUM_MIS)
-		{
-			// Mismatch
-			log_printf("NUM_MIS err\n");
-			HSPI_IRQHandler_ReInitRX();
-			HSPI_RX_End_Err |= 2;
-			HSPI_RX_End_Flag = 1;
-		}
-	}
-	/*
-	if(R8_HSPI_INT_FLAG & RB_HSPI_IF_FIFO_OV)
-	{ // FIFO OV
-		R8_HSPI_INT_FLAG = RB_HSPI_IF_FIFO_OV; // Clear Interrupt
-		log_printf("FIFO OV\n");
-		HSPI_IRQHandler_ReInitRX();
-		Rx_End_Err |= 4;
-		Rx_End_Flag = 1;
-	}
-	*/
-	bsp_uled_off();
-}
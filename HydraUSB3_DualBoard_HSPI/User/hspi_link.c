@@ -0,0 +1,512 @@
+/********************************** (C) COPYRIGHT *******************************
+* File Name          : hspi_link.c
+* Author             : bvernoux
+* Version            : V1.0
+* Date               : 2026/10/19
+* Description        : HSPI link between 2 boards (TX board is HSPI Host,
+*                      RX board is HSPI Device) with runtime bus width and
+*                      packet length negotiation (training)
+* Copyright (c) 2026 Benjamin VERNOUX
+* SPDX-License-Identifier: Apache-2.0
+*******************************************************************************/
+#include "CH56x_common.h"
+#include "CH56x_debug_log.h"
+#include "fastmem.h"
+#include "hspi_link.h"
+#include "irqprio.h"
+#include "trace.h"
+
+/* Training candidates (first working one is used) */
+static const hspi_link_cfg_t hspi_link_train_cfg[] =
+{
+	{ 32, 2048 }, { 32, 1024 }, { 32, 512 },
+	{ 16, 2048 }, { 16, 1024 }, { 16, 512 },
+	{ 8, 2048 }, { 8, 1024 }, { 8, 512 },
+};
+#define HSPI_LINK_TRAIN_NB_CFG (sizeof(hspi_link_train_cfg) / sizeof(hspi_link_train_cfg[0]))
+
+/* Training pattern increment (all data lines toggle between words) */
+#define HSPI_LINK_TRAIN_INC (0x9E3779B9)
+/* Training buffer (TX board send buffer or RX board receive buffer) */
+#define HSPI_LINK_TRAIN_ADDR (0x20020000)
+
+volatile int hspi_link_rx_err; // 0=No Error else HSPI_LINK_RX_ERR_XXX bits
+volatile uint32_t hspi_link_tx_done;
+volatile uint32_t hspi_link_rx_done;
+volatile uint32_t hspi_link_rx_switch;
+volatile uint32_t hspi_link_crc_err;
+volatile uint32_t hspi_link_num_mis;
+
+/* HSPI_IRQHandler variables */
+static int hspi_link_is_tx;
+static uint8_t hspi_link_mode_data; /* RB_HSPI_DATxx_MOD */
+static uint32_t hspi_link_turnaround_addr; /* Device mode receive address after send (0=disabled) */
+static uint32_t hspi_link_addr; /* First packet address */
+static volatile uint32_t hspi_link_rx_next_addr; /* First packet address of next reception (0=same) */
+static uint32_t hspi_link_pkt_len;
+static uint32_t hspi_link_nb_pkt; /* Number of packets of a transfer */
+static uint32_t hspi_link_tx_nb_pkt; /* Number of packets of actual send */
+static const hspi_link_sg_t* hspi_link_sg; /* Fragments of actual send (NULL = contiguous) */
+static uint32_t hspi_link_sg_idx; /* Fragment of next packet to point DMA on */
+static uint32_t hspi_link_sg_off; /* Offset of next packet in fragment */
+static uint32_t Tx_Cnt = 0;
+static uint32_t Rx_Cnt = 0;
+static uint32_t addr_cnt = 0;
+
+/*******************************************************************************
+ * @fn     hspi_link_init
+ *
+ * @brief  Initialize HSPI (TX: Host, RX: Device armed for reception)
+ *         A transfer is nb_pkt packets of cfg->pkt_len bytes at addr
+ *
+ * @param  is_tx: 1 to send (HSPI Host) else 0 to receive (HSPI Device)
+ * @param  cfg: Bus width and packet length
+ * @param  addr: Address of the first packet in RAMX
+ * @param  nb_pkt: Number of packets of a transfer (shall be even or 1)
+ *
+ * @return None
+ */
+void hspi_link_init(int is_tx, const hspi_link_cfg_t* cfg, uint32_t addr, uint32_t nb_pkt)
+{
+	uint8_t mode_data;
+
+	if(cfg->width == 8)
+		mode_data = RB_HSPI_DAT8_MOD;
+	else if(cfg->width == 16)
+		mode_data = RB_HSPI_DAT16_MOD;
+	else
+		mode_data = RB_HSPI_DAT32_MOD;
+
+	hspi_link_is_tx = is_tx;
+	hspi_link_mode_data = mode_data;
+	hspi_link_addr = addr;
+	hspi_link_pkt_len = cfg->pkt_len;
+	hspi_link_nb_pkt = nb_pkt;
+	hspi_link_tx_nb_pkt = nb_pkt;
+	hspi_link_sg = NULL;
+	Tx_Cnt = 0;
+	Rx_Cnt = 0;
+	addr_cnt = 0;
+	hspi_link_rx_err = 0;
+	hspi_link_rx_next_addr = 0;
+	if(is_tx)
+		HSPI_DoubleDMA_Init(HSPI_HOST, mode_data, addr, addr + cfg->pkt_len, cfg->pkt_len);
+	else
+		HSPI_DoubleDMA_Init(HSPI_DEVICE, mode_data, addr, addr + cfg->pkt_len, 0);
+}
+
+/*******************************************************************************
+ * @fn     hspi_link_tx_start
+ *
+ * @brief  Start a transfer (HSPI Host), EVENT_HSPI_TX_END is posted at the end
+ *
+ * @return None
+ */
+void hspi_link_tx_start(void)
+{
+	hspi_link_tx_nb_pkt = hspi_link_nb_pkt;
+	TRACE(HSPI_TX_START, hspi_link_addr);
+	HSPI_DMA_Tx();
+}
+
+/*******************************************************************************
+ * @fn     hspi_link_tx_xfer
+ *
+ * @brief  Start a transfer of nb_pkt packets of the buffer at addr (HSPI
+ *         Host), EVENT_HSPI_TX_END is posted at the end
+ *
+ * @param  addr: Address of the first packet in RAMX
+ * @param  nb_pkt: Number of packets (shall be even or 1)
+ *
+ * @return None
+ */
+void hspi_link_tx_xfer(uint32_t addr, uint32_t nb_pkt)
+{
+	hspi_link_addr = addr;
+	hspi_link_tx_nb_pkt = nb_pkt;
+	R32_HSPI_TX_ADDR0 = addr;
+	R32_HSPI_TX_ADDR1 = addr + hspi_link_pkt_len;
+	TRACE(HSPI_TX_START, addr);
+	HSPI_DMA_Tx();
+}
+
+/*******************************************************************************
+ * @fn     hspi_link_sg_next
+ *
+ * @brief  Address of next packet of the fragments list (HSPI Host)
+ *
+ * @return Packet address in RAMX
+ */
+static uint32_t hspi_link_sg_next(void)
+{
+	const hspi_link_sg_t* sg = &hspi_link_sg[hspi_link_sg_idx];
+	uint32_t addr = sg->addr + hspi_link_sg_off;
+
+	hspi_link_sg_off += hspi_link_pkt_len;
+	if(hspi_link_sg_off >= sg->len)
+	{
+		hspi_link_sg_off = 0;
+		hspi_link_sg_idx++;
+	}
+	return addr;
+}
+
+/*******************************************************************************
+ * @fn     hspi_link_tx_sg
+ *
+ * @brief  Start a transfer of nb_sg fragments sent one after the other
+ *         (HSPI Host, see hspi_link_sg_t), EVENT_HSPI_TX_END is posted at
+ *         the end, next hspi_link_tx_start() sends again hspi_link_init()
+ *         buffer
+ *
+ * @param  sg: Fragments list (shall stay valid until EVENT_HSPI_TX_END)
+ * @param  nb_sg: Number of fragments
+ *
+ * @return 0 if transfer is started else -1 (fragment not aligned or not whole
+ *         packets, total number of packets shall be even or 1)
+ */
+int hspi_link_tx_sg(const hspi_link_sg_t* sg, uint32_t nb_sg)
+{
+	uint32_t nb_pkt = 0;
+	uint32_t i;
+
+	for(i = 0; i < nb_sg; i++)
+	{
+		if((sg[i].len == 0) || (sg[i].len % hspi_link_pkt_len) ||
+		   (sg[i].addr & (HSPI_LINK_SG_ALIGN - 1)))
+			return -1;
+		nb_pkt += sg[i].len / hspi_link_pkt_len;
+	}
+	if((nb_pkt == 0) || ((nb_pkt > 1) && (nb_pkt & 1)))
+		return -1;
+	hspi_link_sg = sg;
+	hspi_link_sg_idx = 0;
+	hspi_link_sg_off = 0;
+	hspi_link_tx_nb_pkt = nb_pkt;
+	R32_HSPI_TX_ADDR0 = hspi_link_sg_next();
+	if(nb_pkt > 1)
+		R32_HSPI_TX_ADDR1 = hspi_link_sg_next();
+	TRACE(HSPI_TX_START, sg[0].addr);
+	HSPI_DMA_Tx();
+	return 0;
+}
+
+/*******************************************************************************
+ * @fn     hspi_link_set_rx_next
+ *
+ * @brief  Set the address of the next reception (HSPI Device), the
+ *         HSPI_IRQHandler switches to it at end of actual reception
+ *         (hspi_link_rx_switch incremented) else next reception overwrites
+ *         the actual one
+ *
+ * @param  addr: Address of the first packet in RAMX
+ *
+ * @return None
+ */
+void hspi_link_set_rx_next(uint32_t addr)
+{
+	hspi_link_rx_next_addr = addr;
+}
+
+/*******************************************************************************
+ * @fn     hspi_link_set_turnaround
+ *
+ * @brief  Enable/disable role turnaround for half-duplex (TX board and
+ *         RX board both send and receive): at end of each send the
+ *         HSPI_IRQHandler switches to Device mode to receive one packet at
+ *         rx_addr (the peer can reply as soon as it sees the packet)
+ *
+ * @param  rx_addr: Receive address after send (0 to disable turnaround)
+ *
+ * @return None
+ */
+void hspi_link_set_turnaround(uint32_t rx_addr)
+{
+	hspi_link_turnaround_addr = rx_addr;
+}
+
+/*******************************************************************************
+ * @fn     hspi_link_train_wait
+ *
+ * @brief  Busy wait until us microseconds after t0 (SysTick)
+ *
+ * @return None
+ */
+static void hspi_link_train_wait(uint64_t t0, uint32_t us)
+{
+	uint64_t cycles = (uint64_t)us * bsp_get_nbtick_1us();
+
+	while((t0 - bsp_get_SysTickCNT()) < cycles); // SysTick count down
+}
+
+/*******************************************************************************
+ * @fn     hspi_link_train_check
+ *
+ * @brief  Check training pattern received (RX board)
+ *
+ * @return 1 if pattern is correct else 0
+ */
+static int hspi_link_train_check(uint32_t seed, uint32_t nb_words)
+{
+	const uint32_t* buf = (const uint32_t*)HSPI_LINK_TRAIN_ADDR;
+	uint32_t i;
+
+	for(i = 0; i < nb_words; i++)
+	{
+		if(buf[i] != (seed + (i * HSPI_LINK_TRAIN_INC)))
+			return 0;
+	}
+	return 1;
+}
+
+/*******************************************************************************
+ * @fn     hspi_link_train_slot
+ *
+ * @brief  Run one training time slot starting at t0 (SysTick)
+ *
+ * @param  is_tx: 1 for TX board else 0
+ * @param  c: Configuration to test
+ * @param  seed: Pattern first word
+ *
+ * @return 1 if the pattern is received correctly (RX: checked, TX: PA12
+ *         driven high by RX board) else 0
+ */
+static int hspi_link_train_slot(int is_tx, const hspi_link_cfg_t* c, uint32_t seed, uint64_t t0)
+{
+	uint32_t nb_words = (HSPI_LINK_TRAIN_NB_PKT * c->pkt_len) / 4;
+	int ok;
+
+	if(is_tx)
+	{
+		fastmem_fill_inc32((uint32_t*)HSPI_LINK_TRAIN_ADDR, seed, HSPI_LINK_TRAIN_INC, nb_words);
+		hspi_link_init(1, c, HSPI_LINK_TRAIN_ADDR, HSPI_LINK_TRAIN_NB_PKT);
+		event_poll(EVENT_HSPI_TX_END);
+		hspi_link_train_wait(t0, HSPI_LINK_TRAIN_TX_US);
+		hspi_link_tx_start();
+		hspi_link_train_wait(t0, HSPI_LINK_TRAIN_SAMPLE_US);
+		ok = (event_poll(EVENT_HSPI_TX_END) != 0) && (GPIOA_ReadPortPin(GPIO_Pin_12) != 0);
+	}
+	else
+	{
+		fastmem_set32((uint32_t*)HSPI_LINK_TRAIN_ADDR, 0, nb_words);
+		hspi_link_init(0, c, HSPI_LINK_TRAIN_ADDR, HSPI_LINK_TRAIN_NB_PKT);
+		event_poll(EVENT_HSPI_RX_END);
+		hspi_link_train_wait(t0, HSPI_LINK_TRAIN_RESULT_US);
+		ok = (event_poll(EVENT_HSPI_RX_END) != 0) && (hspi_link_rx_err == 0) &&
+			 hspi_link_train_check(seed, nb_words);
+		if(ok)
+			GPIOA_SetBits(GPIO_Pin_12);
+		hspi_link_train_wait(t0, HSPI_LINK_TRAIN_SAMPLE_US + 100);
+		GPIOA_ResetBits(GPIO_Pin_12);
+	}
+	hspi_link_train_wait(t0, HSPI_LINK_TRAIN_SLOT_US);
+	return ok;
+}
+
+/*******************************************************************************
+ * @fn     hspi_link_train
+ *
+ * @brief  Negotiate widest bus width and largest packet length working
+ *         between the 2 boards (shall be called by both boards)
+ *
+ * @param  is_tx: 1 for TX board else 0
+ * @param  cfg: Negotiated configuration (HSPI_LINK_CFG_DEFAULT_XXX if none
+ *              works or if it is not confirmed)
+ *
+ * @return 0 if a working configuration is found and confirmed else -1
+ */
+int hspi_link_train(int is_tx, hspi_link_cfg_t* cfg)
+{
+	uint64_t t_start;
+	uint64_t slot_cycles;
+	uint32_t i;
+	int ok = 0;
+
+	if(is_tx)
+	{
+		bsp_sync2boards(PA14, PA12, BSP_BOARD2);
+		GPIOA_ModeCfg(GPIO_Pin_12, GPIO_ModeIN_PD_SMT); // Result from RX board
+	}
+	else
+	{
+		bsp_sync2boards(PA14, PA12, BSP_BOARD1);
+		GPIOA_ResetBits(GPIO_Pin_12);
+		GPIOA_ModeCfg(GPIO_Pin_12, GPIO_Highspeed_PP_8mA); // Result to TX board
+	}
+	t_start = bsp_get_SysTickCNT();
+	slot_cycles = (uint64_t)HSPI_LINK_TRAIN_SLOT_US * bsp_get_nbtick_1us();
+
+	cfg->width = HSPI_LINK_CFG_DEFAULT_WIDTH;
+	cfg->pkt_len = HSPI_LINK_CFG_DEFAULT_PKT_LEN;
+	for(i = 0; i < HSPI_LINK_TRAIN_NB_CFG; i++)
+	{
+		const hspi_link_cfg_t* c = &hspi_link_train_cfg[i];
+
+		ok = hspi_link_train_slot(is_tx, c, 0x55555555 + i, t_start - (i * slot_cycles)); // SysTick count down
+		log_printf("HSPI train width=%d pkt_len=%d %s\n", c->width, c->pkt_len, ok ? "OK" : "Err");
+		if(ok)
+		{
+			*cfg = *c;
+			break;
+		}
+	}
+	/*
+	 * Confirmation in the chosen mode in the slot after all candidates (same
+	 * time for both boards even if they do not agree on the chosen mode),
+	 * both boards fall back to default configuration if it fails
+	 */
+	if(hspi_link_train_slot(is_tx, cfg, 0xAAAAAAAA, t_start - (HSPI_LINK_TRAIN_NB_CFG * slot_cycles)) == 0)
+		ok = 0;
+	log_printf("HSPI train confirm width=%d pkt_len=%d %s\n", cfg->width, cfg->pkt_len, ok ? "OK" : "Err");
+	if(!is_tx)
+		GPIOA_ModeCfg(GPIO_Pin_12, GPIO_ModeIN_Floating); // Release result line
+	if(!ok)
+	{
+		cfg->width = HSPI_LINK_CFG_DEFAULT_WIDTH;
+		cfg->pkt_len = HSPI_LINK_CFG_DEFAULT_PKT_LEN;
+		return -1;
+	}
+	return 0;
+}
+
+/*******************************************************************************
+ * @fn     hspi_link_reinit_rx
+ *
+ * @brief  Restart reception at first packet address
+ *
+ * @return None
+ */
+static void hspi_link_reinit_rx(void)
+{
+	R32_HSPI_RX_ADDR0 = hspi_link_addr;
+	R32_HSPI_RX_ADDR1 = hspi_link_addr + hspi_link_pkt_len;
+	addr_cnt = 0;
+	Rx_Cnt = 0;
+	TRACE(HSPI_RX_REARM, hspi_link_addr);
+}
+
+/*********************************************************************
+ * @fn      HSPI_IRQHandler
+ *
+ * @brief   This function handles HSPI exception.
+ *
+ * @return  none
+ */
+__attribute__((interrupt("WCH-Interrupt-fast"))) void HSPI_IRQHandler(void)
+{
+	IRQPRIO_ENTER(start);
+	TRACE(HSPI_IRQ_ENTER, R8_HSPI_INT_FLAG);
+	/**************/
+	/** Transmit **/
+	/**************/
+	if(R8_HSPI_INT_FLAG & RB_HSPI_IF_T_DONE) // Single packet sending completed
+	{
+		R8_HSPI_INT_FLAG = RB_HSPI_IF_T_DONE;  // Clear Interrupt
+		if(hspi_link_is_tx)
+		{
+			Tx_Cnt++;
+			addr_cnt++;
+
+			if(Tx_Cnt < hspi_link_tx_nb_pkt)
+			{
+				if(hspi_link_sg)
+				{
+					/* Packet after next one (next one is already in the other DMA address) */
+					if((Tx_Cnt + 1) < hspi_link_tx_nb_pkt)
+					{
+						if(addr_cnt%2)
+							R32_HSPI_TX_ADDR0 = hspi_link_sg_next();
+						else
+							R32_HSPI_TX_ADDR1 = hspi_link_sg_next();
+					}
+				}
+				else if(addr_cnt%2)
+				{
+					R32_HSPI_TX_ADDR0 += hspi_link_pkt_len*2;
+				}
+				else
+				{
+					R32_HSPI_TX_ADDR1 += hspi_link_pkt_len*2;
+				}
+				R8_HSPI_CTRL |= RB_HSPI_SW_ACT;  // Software, trigger to send
+			}
+			else // Send completed
+			{
+				R32_HSPI_TX_ADDR0 = hspi_link_addr;
+				R32_HSPI_TX_ADDR1 = hspi_link_addr + hspi_link_pkt_len;
+				addr_cnt = 0;
+				Tx_Cnt = 0;
+				hspi_link_sg = NULL;
+				hspi_link_tx_done++;
+				if(hspi_link_turnaround_addr)
+				{
+					/* Release the bus and wait the reply */
+					hspi_link_is_tx = 0;
+					hspi_link_addr = hspi_link_turnaround_addr;
+					hspi_link_nb_pkt = 1;
+					HSPI_DoubleDMA_Init(HSPI_DEVICE, hspi_link_mode_data, hspi_link_addr,
+										hspi_link_addr + hspi_link_pkt_len, 0);
+				}
+				event_post(EVENT_HSPI_TX_END);
+			}
+		}
+	}
+	/*************/
+	/** Receive **/
+	/*************/
+	if(R8_HSPI_INT_FLAG & RB_HSPI_IF_R_DONE) // Single packet reception completed
+	{
+		R8_HSPI_INT_FLAG = RB_HSPI_IF_R_DONE;  // Clear Interrupt
+
+		// The CRC is correct, the received serial number matches (data is received correctly)
+		if((R8_HSPI_RTX_STATUS & (RB_HSPI_CRC_ERR|RB_HSPI_NUM_MIS)) == 0)
+		{
+			Rx_Cnt++;
+			addr_cnt++;
+			if(Rx_Cnt < hspi_link_nb_pkt)
+			{
+				if(addr_cnt%2)
+				{
+					R32_HSPI_RX_ADDR0 += hspi_link_pkt_len*2;
+				}
+				else
+				{
+					R32_HSPI_RX_ADDR1 += hspi_link_pkt_len*2;
+				}
+			}
+			else
+			{
+				// Receive completed
+				hspi_link_rx_done++;
+				if(hspi_link_rx_next_addr)
+				{
+					hspi_link_addr = hspi_link_rx_next_addr;
+					hspi_link_rx_next_addr = 0;
+					hspi_link_rx_switch++;
+				}
+				hspi_link_reinit_rx();
+				event_post(EVENT_HSPI_RX_END);
+			}
+		}
+		// Determine whether the CRC is correct
+		if(R8_HSPI_RTX_STATUS & RB_HSPI_CRC_ERR)
+		{
+			// CRC check err (no log_printf() here: it would preempt a main loop log_printf())
+			hspi_link_crc_err++;
+			hspi_link_reinit_rx();
+			hspi_link_rx_err |= HSPI_LINK_RX_ERR_CRC;
+			event_post(EVENT_HSPI_RX_END);
+		}
+		// Whether the received serial number matches, (does not match, modify the packet serial number)
+		if(R8_HSPI_RTX_STATUS & RB_HSPI_NUM_MIS)
+		{
+			// Mismatch
+			hspi_link_num_mis++;
+			hspi_link_reinit_rx();
+			hspi_link_rx_err |= HSPI_LINK_RX_ERR_NUM_MIS;
+			event_post(EVENT_HSPI_RX_END);
+		}
+	}
+	TRACE(HSPI_IRQ_EXIT, 0);
+	IRQPRIO_EXIT(IRQPRIO_ID_HSPI, start);
+}
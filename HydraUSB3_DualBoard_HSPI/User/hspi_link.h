@@ -0,0 +1,101 @@
+/********************************** (C) COPYRIGHT *******************************
+* File Name          : hspi_link.h
+* Author             : bvernoux
+* Version            : V1.0
+* Date               : 2026/10/19
+* Description        : HSPI link between 2 boards (TX board is HSPI Host,
+*                      RX board is HSPI Device) with runtime bus width and
+*                      packet length negotiation (training)
+* Copyright (c) 2026 Benjamin VERNOUX
+* SPDX-License-Identifier: Apache-2.0
+*******************************************************************************/
+#ifndef HSPI_LINK_H_
+#define HSPI_LINK_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include "event.h"
+
+/* Events posted by HSPI_IRQHandler */
+#define EVENT_HSPI_TX_END EVENT_USER(0) // Send completion
+#define EVENT_HSPI_RX_END EVENT_USER(1) // Receive completion (with or without error)
+
+/* hspi_link_rx_err bits */
+#define HSPI_LINK_RX_ERR_CRC     (1) // CRC error
+#define HSPI_LINK_RX_ERR_NUM_MIS (2) // Packet sequence number mismatch
+
+typedef struct
+{
+	uint32_t width; /* Bus width in bits 8, 16 or 32 */
+	uint32_t pkt_len; /* Packet length in bytes */
+} hspi_link_cfg_t;
+
+/*
+ * Scatter-gather send (see hspi_link_tx_sg()): a transfer is a list of
+ * fragments anywhere in RAMX (for example a protocol header and a payload),
+ * HSPI_IRQHandler points the Double DMA on the next packet of the list at
+ * each packet completion so the receiver gets the fragments contiguous
+ * without copy on the sender side.
+ * Each fragment is whole packets (len multiple of hspi_link_cfg_t.pkt_len)
+ * and the list shall stay valid until EVENT_HSPI_TX_END.
+ */
+typedef struct
+{
+	uint32_t addr; /* Fragment address in RAMX (HSPI_LINK_SG_ALIGN aligned) */
+	uint32_t len; /* Fragment length in bytes (multiple of packet length) */
+} hspi_link_sg_t;
+
+#define HSPI_LINK_SG_ALIGN (16)
+
+/* Configuration used when training fails (safest one) */
+#define HSPI_LINK_CFG_DEFAULT_WIDTH   (8)
+#define HSPI_LINK_CFG_DEFAULT_PKT_LEN (512)
+
+/*
+ * Training (see hspi_link_train())
+ * - Both boards are synchronized with bsp_sync2boards() then run one time
+ *   slot of HSPI_LINK_TRAIN_SLOT_US per candidate configuration (widest bus
+ *   and largest packet first)
+ * - TX sends HSPI_LINK_TRAIN_NB_PKT packets of a pattern toggling all data
+ *   lines, RX checks HSPI CRC/sequence status and the data then drives
+ *   J3 SCS(PA12) high if the candidate works (PA12 is read by TX)
+ *   HSPI can answer (role turnaround, see hspi_rpc.h) but the answer would
+ *   use the candidate under test (lost with it if it does not work) or need
+ *   an extra turnaround per slot in a default configuration, PA12 is
+ *   already wired and synchronized by bsp_sync2boards() and works whatever
+ *   the candidate
+ * - First working candidate is chosen then confirmed with an other pattern in
+ *   an extra slot after all candidates (both boards wait it even if they do
+ *   not agree), both boards use HSPI_LINK_CFG_DEFAULT_XXX if it fails
+ */
+#define HSPI_LINK_TRAIN_NB_PKT    (4) // Shall be even
+#define HSPI_LINK_TRAIN_SLOT_US   (2000)
+#define HSPI_LINK_TRAIN_TX_US     (200) // TX start in slot (RX is armed at slot start)
+#define HSPI_LINK_TRAIN_RESULT_US (1500) // RX result driven on PA12
+#define HSPI_LINK_TRAIN_SAMPLE_US (1800) // TX samples PA12
+
+extern volatile int hspi_link_rx_err; // 0=No Error else HSPI_LINK_RX_ERR_XXX bits
+/* Transfers completed (counted by HSPI_IRQHandler) */
+extern volatile uint32_t hspi_link_tx_done; // Sent
+extern volatile uint32_t hspi_link_rx_done; // Received without error
+extern volatile uint32_t hspi_link_rx_switch; // Received then switched to hspi_link_set_rx_next() address
+/* Reception errors (counted by HSPI_IRQHandler, logged by the main loop) */
+extern volatile uint32_t hspi_link_crc_err; // HSPI_LINK_RX_ERR_CRC
+extern volatile uint32_t hspi_link_num_mis; // HSPI_LINK_RX_ERR_NUM_MIS
+
+void hspi_link_init(int is_tx, const hspi_link_cfg_t* cfg, uint32_t addr, uint32_t nb_pkt);
+void hspi_link_tx_start(void);
+void hspi_link_tx_xfer(uint32_t addr, uint32_t nb_pkt);
+int hspi_link_tx_sg(const hspi_link_sg_t* sg, uint32_t nb_sg);
+void hspi_link_set_rx_next(uint32_t addr);
+void hspi_link_set_turnaround(uint32_t rx_addr);
+int hspi_link_train(int is_tx, hspi_link_cfg_t* cfg);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* HSPI_LINK_H_ */
@@ -0,0 +1,437 @@
+/********************************** (C) COPYRIGHT *******************************
+* File Name          : hspi_rpc.c
+* Author             : bvernoux
+* Version            : V1.0
+* Date               : 2026/10/19
+* Description        : HSPI half-duplex request/response messages between
+*                      2 boards (role turnaround on the bus) with round-trip
+*                      latency benchmark
+* Copyright (c) 2026 Benjamin VERNOUX
+* SPDX-License-Identifier: Apache-2.0
+*******************************************************************************/
+#include <string.h>
+
+#include "CH56x_common.h"
+#include "CH56x_debug_log.h"
+#include "event.h"
+#include "fastmem.h"
+#include "irqprio.h"
+#include "hspi_rpc.h"
+
+/* Packet buffers in RAMX after the 32K transfer buffer */
+#define HSPI_RPC_TX_ADDR (0x20028000)
+#define HSPI_RPC_RX_ADDR (HSPI_RPC_TX_ADDR + HSPI_RPC_PKT_MAX_SIZE)
+
+#define HSPI_RPC_TX_HDR ((hspi_rpc_hdr_t*)HSPI_RPC_TX_ADDR)
+#define HSPI_RPC_RX_HDR ((const hspi_rpc_hdr_t*)HSPI_RPC_RX_ADDR)
+#define HSPI_RPC_TX_DATA ((uint8_t*)(HSPI_RPC_TX_ADDR + sizeof(hspi_rpc_hdr_t)))
+#define HSPI_RPC_RX_DATA ((const uint8_t*)(HSPI_RPC_RX_ADDR + sizeof(hspi_rpc_hdr_t)))
+
+static uint32_t hspi_rpc_width;
+static uint32_t hspi_rpc_id;
+
+/* Master: slave has a pending request */
+static uint8_t hspi_rpc_peer_pending;
+
+/* Slave: pending request and its response */
+static uint8_t hspi_rpc_pending;
+static uint8_t hspi_rpc_done;
+static uint32_t hspi_rpc_slave_id;
+static uint32_t hspi_rpc_slave_len;
+static uint32_t hspi_rpc_slave_buf[HSPI_RPC_MAX_DATA / 4]; /* Request then response */
+
+/*******************************************************************************
+ * @fn     hspi_rpc_rx_arm
+ *
+ * @brief  Switch to HSPI Device mode waiting one packet
+ *
+ * @return None
+ */
+static void hspi_rpc_rx_arm(void)
+{
+	hspi_link_cfg_t cfg = { hspi_rpc_width, HSPI_RPC_PKT_MAX_SIZE };
+
+	hspi_link_init(0, &cfg, HSPI_RPC_RX_ADDR, 1);
+}
+
+/*******************************************************************************
+ * @fn     hspi_rpc_init
+ *
+ * @brief  Start request/response mode (both boards in HSPI Device mode)
+ *
+ * @param  cfg: Negotiated bus width (packet length is not used)
+ *
+ * @return None
+ */
+void hspi_rpc_init(const hspi_link_cfg_t* cfg)
+{
+	hspi_rpc_width = cfg->width;
+	hspi_rpc_id = 0;
+	hspi_rpc_peer_pending = 0;
+	hspi_rpc_pending = 0;
+	hspi_rpc_done = 0;
+	hspi_link_set_turnaround(HSPI_RPC_RX_ADDR);
+	event_poll(EVENT_HSPI_TX_END | EVENT_HSPI_RX_END);
+	hspi_rpc_rx_arm();
+}
+
+/*******************************************************************************
+ * @fn     hspi_rpc_deinit
+ *
+ * @brief  Stop request/response mode (disable role turnaround)
+ *
+ * @return None
+ */
+void hspi_rpc_deinit(void)
+{
+	hspi_link_set_turnaround(0);
+}
+
+/*******************************************************************************
+ * @fn     hspi_rpc_send
+ *
+ * @brief  Take the bus (HSPI Host) and send one packet, HSPI_IRQHandler
+ *         switches back to HSPI Device mode at end of send
+ *
+ * @param  data: Data (can be HSPI_RPC_TX_DATA already filled)
+ * @param  len: Data length in bytes (max HSPI_RPC_MAX_DATA)
+ *
+ * @return 0 if success else -1 (len too large, nothing sent)
+ */
+static int hspi_rpc_send(uint32_t type, uint32_t flags, uint32_t id, const uint8_t* data, uint32_t len)
+{
+	hspi_rpc_hdr_t* hdr = HSPI_RPC_TX_HDR;
+	hspi_link_cfg_t cfg;
+
+	if(len > HSPI_RPC_MAX_DATA)
+		return -1;
+	hdr->type = type;
+	hdr->flags = flags;
+	hdr->len = len;
+	hdr->id = id;
+	if(len && (data != HSPI_RPC_TX_DATA))
+		fastmem_cpy(HSPI_RPC_TX_DATA, data, len);
+	cfg.width = hspi_rpc_width;
+	cfg.pkt_len = sizeof(hspi_rpc_hdr_t) + ((len + 3) & ~3UL);
+#if(HSPI_RPC_TURN_US > 0)
+	bsp_wait_us_delay(HSPI_RPC_TURN_US);
+#endif
+	event_poll(EVENT_HSPI_TX_END | EVENT_HSPI_RX_END);
+	hspi_link_init(1, &cfg, HSPI_RPC_TX_ADDR, 1);
+	hspi_link_tx_start();
+	return 0;
+}
+
+/*******************************************************************************
+ * @fn     hspi_rpc_recv
+ *
+ * @brief  Wait one packet (received in HSPI_RPC_RX_ADDR)
+ *
+ * @param  timeout_ms: Timeout in milliseconds (0 for no timeout)
+ *
+ * @return 0 if a valid packet is received else -1
+ */
+static int hspi_rpc_recv(uint32_t timeout_ms)
+{
+	uint32_t events;
+
+	if(timeout_ms)
+	{
+		event_timer_start(timeout_ms);
+		events = event_wait(EVENT_HSPI_RX_END | EVENT_TIMER);
+		event_timer_stop();
+	}
+	else
+	{
+		events = event_wait(EVENT_HSPI_RX_END);
+	}
+	if(((events & EVENT_HSPI_RX_END) == 0) || (hspi_link_rx_err != 0) ||
+			(HSPI_RPC_RX_HDR->len > HSPI_RPC_MAX_DATA))
+	{
+		hspi_rpc_rx_arm(); // Lost or corrupted packet, release the bus
+		return -1;
+	}
+	return 0;
+}
+
+/*******************************************************************************
+ * @fn     hspi_rpc_call
+ *
+ * @brief  Master: send a request and wait its response
+ *
+ * @param  req: Request data
+ * @param  req_len: Request length in bytes (max HSPI_RPC_MAX_DATA)
+ * @param  rsp: Response data (max HSPI_RPC_MAX_DATA)
+ * @param  rsp_len: Response length in bytes
+ *
+ * @return 0 if success else -1 (request too large, timeout or invalid response)
+ */
+int hspi_rpc_call(const uint8_t* req, uint32_t req_len, uint8_t* rsp, uint32_t* rsp_len)
+{
+	const hspi_rpc_hdr_t* hdr = HSPI_RPC_RX_HDR;
+	uint32_t id;
+
+	if(req_len > HSPI_RPC_MAX_DATA)
+		return -1;
+	id = ++hspi_rpc_id;
+	hspi_rpc_send(HSPI_RPC_REQ, 0, id, req, req_len);
+	if(hspi_rpc_recv(HSPI_RPC_TIMEOUT_MS) != 0)
+		return -1;
+	hspi_rpc_peer_pending = (hdr->flags & HSPI_RPC_F_PENDING);
+	if((hdr->type != HSPI_RPC_RSP) || (hdr->id != id))
+		return -1;
+	fastmem_cpy(rsp, HSPI_RPC_RX_DATA, hdr->len);
+	*rsp_len = hdr->len;
+	return 0;
+}
+
+/*******************************************************************************
+ * @fn     hspi_rpc_poll
+ *
+ * @brief  Master: serve slave pending request (if any)
+ *
+ * @param  handler: Request handler
+ *
+ * @return 1 if a request is served, 0 if no request else -1 (also if handler
+ *         response is larger than HSPI_RPC_MAX_DATA, NONE is sent instead)
+ */
+int hspi_rpc_poll(hspi_rpc_handler_t handler)
+{
+	const hspi_rpc_hdr_t* hdr = HSPI_RPC_RX_HDR;
+	uint32_t id;
+	uint32_t len;
+	int ret;
+
+	if(!hspi_rpc_peer_pending)
+		return 0;
+	hspi_rpc_send(HSPI_RPC_POLL, 0, 0, NULL, 0);
+	if(hspi_rpc_recv(HSPI_RPC_TIMEOUT_MS) != 0)
+		return -1;
+	hspi_rpc_peer_pending = (hdr->flags & HSPI_RPC_F_PENDING);
+	if(hdr->type != HSPI_RPC_REQ)
+		return 0;
+	id = hdr->id;
+	len = handler(HSPI_RPC_RX_DATA, hdr->len, HSPI_RPC_TX_DATA);
+	ret = 1;
+	if(hspi_rpc_send(HSPI_RPC_RSP, 0, id, HSPI_RPC_TX_DATA, len) != 0)
+	{
+		hspi_rpc_send(HSPI_RPC_NONE, 0, 0, NULL, 0); // Slave request fails, give the bus back
+		ret = -1;
+	}
+	if(hspi_rpc_recv(HSPI_RPC_TIMEOUT_MS) != 0) // Slave NONE gives the bus back
+		return -1;
+	hspi_rpc_peer_pending = (hdr->flags & HSPI_RPC_F_PENDING);
+	return ret;
+}
+
+/*******************************************************************************
+ * @fn     hspi_rpc_stop
+ *
+ * @brief  Master: end of session (slave hspi_rpc_serve() returns 1)
+ *
+ * @return 0 if success else -1
+ */
+int hspi_rpc_stop(void)
+{
+	hspi_rpc_send(HSPI_RPC_STOP, 0, 0, NULL, 0);
+	return hspi_rpc_recv(HSPI_RPC_TIMEOUT_MS);
+}
+
+/*******************************************************************************
+ * @fn     hspi_rpc_serve
+ *
+ * @brief  Slave: wait next master packet and answer it
+ *
+ * @param  handler: Request handler
+ *
+ * @return 1 if end of session (STOP), 0 if packet served else -1 (also if
+ *         handler response is larger than HSPI_RPC_MAX_DATA, NONE is sent
+ *         instead so master hspi_rpc_call() fails)
+ */
+int hspi_rpc_serve(hspi_rpc_handler_t handler)
+{
+	const hspi_rpc_hdr_t* hdr = HSPI_RPC_RX_HDR;
+	uint32_t flags;
+	uint32_t len;
+
+	if(hspi_rpc_recv(0) != 0)
+		return -1;
+	flags = hspi_rpc_pending ? HSPI_RPC_F_PENDING : 0;
+	switch(hdr->type)
+	{
+		case HSPI_RPC_REQ:
+			len = handler(HSPI_RPC_RX_DATA, hdr->len, HSPI_RPC_TX_DATA);
+			if(hspi_rpc_send(HSPI_RPC_RSP, flags, hdr->id, HSPI_RPC_TX_DATA, len) != 0)
+			{
+				hspi_rpc_send(HSPI_RPC_NONE, flags, 0, NULL, 0);
+				return -1;
+			}
+			break;
+
+		case HSPI_RPC_POLL:
+			if(hspi_rpc_pending)
+			{
+				hspi_rpc_pending = 0;
+				hspi_rpc_send(HSPI_RPC_REQ, 0, hspi_rpc_slave_id,
+							  (const uint8_t*)hspi_rpc_slave_buf, hspi_rpc_slave_len);
+			}
+			else
+			{
+				hspi_rpc_send(HSPI_RPC_NONE, 0, 0, NULL, 0);
+			}
+			break;
+
+		case HSPI_RPC_RSP:
+			if(hdr->id == hspi_rpc_slave_id)
+			{
+				hspi_rpc_slave_len = hdr->len;
+				fastmem_cpy(hspi_rpc_slave_buf, HSPI_RPC_RX_DATA, hdr->len);
+				hspi_rpc_done = 1;
+			}
+			hspi_rpc_send(HSPI_RPC_NONE, flags, 0, NULL, 0);
+			break;
+
+		case HSPI_RPC_STOP:
+			hspi_rpc_send(HSPI_RPC_NONE, flags, 0, NULL, 0);
+			return 1;
+
+		default:
+			hspi_rpc_send(HSPI_RPC_NONE, flags, 0, NULL, 0);
+	}
+	return 0;
+}
+
+/*******************************************************************************
+ * @fn     hspi_rpc_post
+ *
+ * @brief  Slave: queue a request for the master (sent when master polls)
+ *
+ * @param  req: Request data
+ * @param  req_len: Request length in bytes (max HSPI_RPC_MAX_DATA)
+ *
+ * @return 0 if success else -1 (previous request not sent)
+ */
+int hspi_rpc_post(const uint8_t* req, uint32_t req_len)
+{
+	if(hspi_rpc_pending || (req_len > HSPI_RPC_MAX_DATA))
+		return -1;
+	fastmem_cpy(hspi_rpc_slave_buf, req, req_len);
+	hspi_rpc_slave_len = req_len;
+	hspi_rpc_slave_id = ++hspi_rpc_id;
+	hspi_rpc_done = 0;
+	hspi_rpc_pending = 1;
+	return 0;
+}
+
+/*******************************************************************************
+ * @fn     hspi_rpc_result
+ *
+ * @brief  Slave: get response of request queued by hspi_rpc_post()
+ *
+ * @param  rsp: Response data (max HSPI_RPC_MAX_DATA)
+ * @param  rsp_len: Response length in bytes
+ *
+ * @return 1 if response is available else 0
+ */
+int hspi_rpc_result(uint8_t* rsp, uint32_t* rsp_len)
+{
+	if(!hspi_rpc_done)
+		return 0;
+	hspi_rpc_done = 0;
+	fastmem_cpy(rsp, hspi_rpc_slave_buf, hspi_rpc_slave_len);
+	*rsp_len = hspi_rpc_slave_len;
+	return 1;
+}
+
+/*******************************************************************************
+ * @fn     hspi_rpc_echo
+ *
+ * @brief  Request handler returning the request as response (ping-pong)
+ *
+ * @return Response length in bytes
+ */
+uint32_t hspi_rpc_echo(const uint8_t* req, uint32_t req_len, uint8_t* rsp)
+{
+	fastmem_cpy(rsp, req, req_len);
+	return req_len;
+}
+
+/*******************************************************************************
+ * @fn     hspi_rpc_sort
+ *
+ * @brief  Sort values in ascending order (insertion sort)
+ *
+ * @return None
+ */
+static void hspi_rpc_sort(uint32_t* val, uint32_t nb)
+{
+	uint32_t i, j, v;
+
+	for(i = 1; i < nb; i++)
+	{
+		v = val[i];
+		for(j = i; (j > 0) && (val[j - 1] > v); j--)
+			val[j] = val[j - 1];
+		val[j] = v;
+	}
+}
+
+/*******************************************************************************
+ * @fn     hspi_rpc_benchmark
+ *
+ * @brief  Master: ping-pong benchmark with slave running hspi_rpc_serve()
+ *         with hspi_rpc_echo(), log round-trip time percentiles per payload
+ *         size then stop the session
+ *
+ * @return None
+ */
+void hspi_rpc_benchmark(void)
+{
+	static const uint16_t size[] = { 4, 16, 64, HSPI_RPC_MAX_DATA };
+	static uint32_t rtt[HSPI_RPC_BENCH_NB];
+	static uint32_t req[HSPI_RPC_MAX_DATA / 4];
+	static uint32_t rsp[HSPI_RPC_MAX_DATA / 4];
+	irqprio_stats_t irq;
+	uint32_t ns_div = bsp_get_nbtick_1us();
+	uint32_t s, i, nb, nb_err;
+
+	event_sleep_ms(10); // Slave ready
+	for(s = 0; s < (sizeof(size) / sizeof(size[0])); s++)
+	{
+		uint32_t len = size[s];
+		nb = 0;
+		nb_err = 0;
+		fastmem_fill_inc32(req, 0x55555555 + s, 0x9E3779B9, (len + 3) / 4);
+		for(i = 0; i < HSPI_RPC_BENCH_NB; i++)
+		{
+			uint32_t rsp_len = 0;
+			uint32_t start = bsp_get_SysTickCNT_LSB();
+			int ret = hspi_rpc_call((const uint8_t*)req, len, (uint8_t*)rsp, &rsp_len);
+			uint32_t cycles = start - bsp_get_SysTickCNT_LSB(); // SysTick count down
+
+			if((ret != 0) || (rsp_len != len) || (memcmp(req, rsp, len) != 0))
+				nb_err++;
+			else
+				rtt[nb++] = cycles;
+		}
+		if(nb == 0)
+		{
+			log_printf("RPC len=%d all %d calls Err\n", len, HSPI_RPC_BENCH_NB);
+			continue;
+		}
+		hspi_rpc_sort(rtt, nb);
+		log_printf("RPC len=%d n=%d err=%d RTT ns min=%d p50=%d p90=%d p99=%d max=%d\n",
+				   len, nb, nb_err,
+				   (rtt[0] * 1000) / ns_div,
+				   (rtt[(nb * 50) / 100] * 1000) / ns_div,
+				   (rtt[(nb * 90) / 100] * 1000) / ns_div,
+				   (rtt[(nb * 99) / 100] * 1000) / ns_div,
+				   (rtt[nb - 1] * 1000) / ns_div);
+	}
+	if(hspi_rpc_stop() != 0)
+		log_printf("RPC stop Err\n");
+	/* HSPI_RPC_TURN_US shall cover the peer HSPI_IRQHandler() (Host to Device switch) */
+	irqprio_stats_get(&irq);
+	log_printf("RPC turn=%dus HSPI_IRQHandler dur_max=%dns\n",
+			   HSPI_RPC_TURN_US, (irq.irq[IRQPRIO_ID_HSPI].dur_max * 1000) / irq.nbtick_1us);
+}
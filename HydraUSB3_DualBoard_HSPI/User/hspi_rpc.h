@@ -0,0 +1,101 @@
+/********************************** (C) COPYRIGHT *******************************
+* File Name          : hspi_rpc.h
+* Author             : bvernoux
+* Version            : V1.0
+* Date               : 2026/10/19
+* Description        : HSPI half-duplex request/response messages between
+*                      2 boards (role turnaround on the bus) with round-trip
+*                      latency benchmark
+* Copyright (c) 2026 Benjamin VERNOUX
+* SPDX-License-Identifier: Apache-2.0
+*******************************************************************************/
+#ifndef HSPI_RPC_H_
+#define HSPI_RPC_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include "hspi_link.h"
+
+/*
+ * One packet is sent per bus turn, the sender switches to HSPI Device mode
+ * at end of send (HSPI_IRQHandler) and the receiver switches to HSPI Host
+ * mode to send its packet.
+ * The master (TX board) starts each exchange, the slave (RX board) answers
+ * each master packet with exactly one packet so the bus is back to the
+ * master after each exchange:
+ * - REQ  (master) => RSP  (slave)
+ * - POLL (master) => REQ  (slave pending request, see hspi_rpc_post()) or NONE
+ * - RSP  (master) => NONE (slave)
+ * - STOP (master) => NONE (slave), end of session (hspi_rpc_serve() returns 1)
+ * Slave packets have HSPI_RPC_F_PENDING set while a slave request is pending
+ * (master serves it with hspi_rpc_poll()).
+ */
+typedef enum
+{
+	HSPI_RPC_NONE = 0,
+	HSPI_RPC_REQ,
+	HSPI_RPC_RSP,
+	HSPI_RPC_POLL,
+	HSPI_RPC_STOP,
+} e_hspi_rpc_type;
+
+#define HSPI_RPC_F_PENDING (1) // Slave has a pending request
+
+typedef struct
+{
+	uint8_t type; /* see e_hspi_rpc_type */
+	uint8_t flags; /* HSPI_RPC_F_XXX */
+	uint16_t len; /* Data length in bytes */
+	uint32_t id; /* Request id (same id in response) */
+} hspi_rpc_hdr_t;
+
+/* Packet max size (header + data) */
+#define HSPI_RPC_PKT_MAX_SIZE (256)
+#define HSPI_RPC_MAX_DATA (HSPI_RPC_PKT_MAX_SIZE - sizeof(hspi_rpc_hdr_t))
+
+/* Master wait of the slave answer */
+#define HSPI_RPC_TIMEOUT_MS (10)
+
+/*
+ * Guard time before to switch to HSPI Host mode (peer switches to Device mode
+ * in its HSPI_IRQHandler() at end of its send), shall be greater than the
+ * peer HSPI_IRQHandler() entry latency plus duration.
+ * hspi_rpc_benchmark() logs the HSPI_IRQHandler() max duration of this board
+ * (same Host to Device switch, see irqprio_log() for entry latency with
+ * -DIRQPRIO_STRESS=1), set DEFINE_OPTS = -DHSPI_RPC_TURN_US=<us> to tune it
+ * (too short: err of hspi_rpc_benchmark() increases)
+ */
+#ifndef HSPI_RPC_TURN_US
+#define HSPI_RPC_TURN_US (1)
+#endif
+
+/* Number of round trips per payload size for hspi_rpc_benchmark() */
+#define HSPI_RPC_BENCH_NB (256)
+
+/* Request handler, write response in rsp (max HSPI_RPC_MAX_DATA, larger is an error) and return its length */
+typedef uint32_t (*hspi_rpc_handler_t)(const uint8_t* req, uint32_t req_len, uint8_t* rsp);
+
+void hspi_rpc_init(const hspi_link_cfg_t* cfg);
+void hspi_rpc_deinit(void);
+
+/* Master */
+int hspi_rpc_call(const uint8_t* req, uint32_t req_len, uint8_t* rsp, uint32_t* rsp_len);
+int hspi_rpc_poll(hspi_rpc_handler_t handler);
+int hspi_rpc_stop(void);
+void hspi_rpc_benchmark(void);
+
+/* Slave */
+int hspi_rpc_serve(hspi_rpc_handler_t handler);
+int hspi_rpc_post(const uint8_t* req, uint32_t req_len);
+int hspi_rpc_result(uint8_t* rsp, uint32_t* rsp_len);
+
+uint32_t hspi_rpc_echo(const uint8_t* req, uint32_t req_len, uint8_t* rsp);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* HSPI_RPC_H_ */
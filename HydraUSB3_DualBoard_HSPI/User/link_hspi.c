@@ -0,0 +1,283 @@
+/********************************** (C) COPYRIGHT *******************************
+* File Name          : link_hspi.c
+* Author             : bvernoux
+* Version            : V1.0
+* Date               : 2026/10/19
+* Description        : HSPI link as common link (TX board sends, RX board
+*                      receives, see link.h)
+* Copyright (c) 2026 Benjamin VERNOUX
+* SPDX-License-Identifier: Apache-2.0
+*******************************************************************************/
+#include "CH56x_common.h"
+#include "irq_save.h"
+#include "link_hspi.h"
+
+link_t link_hspi;
+
+static int link_hspi_is_tx;
+static uint32_t link_hspi_pkt_len;
+static link_buf_t link_hspi_buf[LINK_HSPI_NB_BUF];
+static uint32_t link_hspi_free; /* Bit mask of free own buffers */
+
+/* TX queue (own buffers or buffers of other links) */
+static link_buf_t* link_hspi_txq[LINK_HSPI_TX_QUEUE];
+static uint32_t link_hspi_txq_head; /* Next submit */
+static uint32_t link_hspi_txq_tail; /* Transfer in progress or next to start */
+static uint32_t link_hspi_tx_busy; /* Transfer in progress */
+static uint32_t link_hspi_tx_seen; /* hspi_link_tx_done processed */
+
+/* RX */
+static uint32_t link_hspi_rx_cur; /* Buffer armed for reception */
+static int32_t link_hspi_rx_next; /* Buffer set with hspi_link_set_rx_next() (-1 = none) */
+static uint32_t link_hspi_rx_ready[LINK_HSPI_NB_BUF]; /* Received buffers in order */
+static uint32_t link_hspi_rx_ready_head;
+static uint32_t link_hspi_rx_ready_tail;
+static uint32_t link_hspi_rx_seen; /* hspi_link_rx_done processed */
+static uint32_t link_hspi_rx_switch_seen; /* hspi_link_rx_switch processed */
+
+#define LINK_HSPI_SLOT(idx, size) ((idx) & ((size) - 1))
+
+/*******************************************************************************
+ * @fn     link_hspi_first_free
+ *
+ * @brief  First free own buffer
+ *
+ * @return Buffer index or -1 if none
+ */
+static int32_t link_hspi_first_free(void)
+{
+	int32_t i;
+
+	for(i = 0; i < LINK_HSPI_NB_BUF; i++)
+	{
+		if(link_hspi_free & (1UL << i))
+			return i;
+	}
+	return -1;
+}
+
+/*******************************************************************************
+ * @fn     link_hspi_buf_idx
+ *
+ * @brief  Own buffer index of buf
+ *
+ * @return Buffer index or -1 if buf is a buffer of an other link
+ */
+static int32_t link_hspi_buf_idx(link_t* link, link_buf_t* buf)
+{
+	if(buf->owner != link)
+		return -1;
+	return (int32_t)(buf - link_hspi_buf);
+}
+
+static link_buf_t* link_hspi_tx_alloc(link_t* link)
+{
+	int32_t i = link_hspi_first_free();
+
+	(void)link;
+	if(i < 0)
+		return NULL;
+	link_hspi_buf[i].len = 0;
+	return &link_hspi_buf[i];
+}
+
+/*******************************************************************************
+ * @fn     link_hspi_nb_pkt
+ *
+ * @brief  Number of packets of a transfer of buf
+ *
+ * @return Number of packets or 0 if buf length is not whole packets (one
+ *         or an even number)
+ */
+static uint32_t link_hspi_nb_pkt(const link_buf_t* buf)
+{
+	uint32_t nb_pkt = buf->len / link_hspi_pkt_len;
+
+	if((buf->len % link_hspi_pkt_len) || ((nb_pkt > 1) && (nb_pkt & 1)))
+		return 0;
+	return nb_pkt;
+}
+
+static int link_hspi_tx_submit(link_t* link, link_buf_t* buf)
+{
+	int32_t i;
+
+	if((link_hspi_nb_pkt(buf) == 0) || (buf->size < buf->len) ||
+	   ((uint32_t)buf->data & (LINK_BUF_ALIGN - 1)))
+		return LINK_ERR_BUF;
+	if((link_hspi_txq_head - link_hspi_txq_tail) >= LINK_HSPI_TX_QUEUE)
+		return LINK_ERR_BUSY;
+	i = link_hspi_buf_idx(link, buf);
+	if(i >= 0)
+		link_hspi_free &= ~(1UL << i);
+	link_hspi_txq[LINK_HSPI_SLOT(link_hspi_txq_head, LINK_HSPI_TX_QUEUE)] = buf;
+	link_hspi_txq_head++;
+	if(link_hspi_tx_busy == 0)
+	{
+		link_hspi_tx_busy = 1;
+		hspi_link_tx_xfer((uint32_t)buf->data, link_hspi_nb_pkt(buf));
+	}
+	return LINK_OK;
+}
+
+/*******************************************************************************
+ * @fn     link_hspi_rx_arm_next
+ *
+ * @brief  Give a free buffer for next reception
+ *
+ * @return None
+ */
+static void link_hspi_rx_arm_next(void)
+{
+	int32_t i;
+
+	if(link_hspi_rx_next >= 0)
+		return;
+	i = link_hspi_first_free();
+	if(i < 0)
+		return;
+	link_hspi_free &= ~(1UL << i);
+	link_hspi_rx_next = i;
+	hspi_link_set_rx_next((uint32_t)link_hspi_buf[i].data);
+}
+
+static link_buf_t* link_hspi_rx_get(link_t* link)
+{
+	link_buf_t* buf;
+
+	(void)link;
+	if(link_hspi_rx_ready_tail == link_hspi_rx_ready_head)
+		return NULL;
+	buf = &link_hspi_buf[link_hspi_rx_ready[LINK_HSPI_SLOT(link_hspi_rx_ready_tail, LINK_HSPI_NB_BUF)]];
+	link_hspi_rx_ready_tail++;
+	buf->len = LINK_HSPI_BUF_SIZE;
+	return buf;
+}
+
+static void link_hspi_release(link_t* link, link_buf_t* buf)
+{
+	int32_t i = link_hspi_buf_idx(link, buf);
+
+	if(i < 0)
+		return;
+	link_hspi_free |= (1UL << i);
+	if(link_hspi_is_tx == 0)
+		link_hspi_rx_arm_next();
+}
+
+/*******************************************************************************
+ * @fn     link_hspi_task
+ *
+ * @brief  Release sent buffers and start next transfer (TX), queue
+ *         received buffers (RX)
+ *
+ * @return None
+ */
+static void link_hspi_task(link_t* link)
+{
+	uint32_t done;
+	uint32_t nb_switch;
+	uint32_t mstatus;
+	link_buf_t* buf;
+
+	event_poll(EVENT_HSPI_TX_END | EVENT_HSPI_RX_END);
+	/* TX */
+	done = hspi_link_tx_done;
+	while(link_hspi_tx_seen != done)
+	{
+		link_hspi_tx_seen++;
+		buf = link_hspi_txq[LINK_HSPI_SLOT(link_hspi_txq_tail, LINK_HSPI_TX_QUEUE)];
+		link_hspi_txq_tail++;
+		link_hspi_tx_busy = 0;
+		link_release(buf);
+	}
+	if((link_hspi_tx_busy == 0) && (link_hspi_txq_tail != link_hspi_txq_head))
+	{
+		buf = link_hspi_txq[LINK_HSPI_SLOT(link_hspi_txq_tail, LINK_HSPI_TX_QUEUE)];
+		link_hspi_tx_busy = 1;
+		hspi_link_tx_xfer((uint32_t)buf->data, link_hspi_nb_pkt(buf));
+	}
+	/* RX */
+	if(hspi_link_rx_err)
+	{
+		link->stats.nb_err++;
+		hspi_link_rx_err = 0;
+	}
+	/* Both counters of the same HSPI_IRQHandler call */
+	mstatus = irq_save();
+	done = hspi_link_rx_done;
+	nb_switch = hspi_link_rx_switch;
+	irq_restore(mstatus);
+	done -= link_hspi_rx_seen;
+	nb_switch -= link_hspi_rx_switch_seen;
+	link_hspi_rx_seen += done;
+	link_hspi_rx_switch_seen += nb_switch;
+	if(nb_switch)
+	{
+		/* Received buffer is given, reception continues in next buffer */
+		link_hspi_rx_ready[LINK_HSPI_SLOT(link_hspi_rx_ready_head, LINK_HSPI_NB_BUF)] = link_hspi_rx_cur;
+		link_hspi_rx_ready_head++;
+		link_hspi_rx_cur = link_hspi_rx_next;
+		link_hspi_rx_next = -1;
+	}
+	link->stats.nb_err += (done - nb_switch); // Received while no buffer was free (overwritten)
+	link_hspi_rx_arm_next();
+}
+
+static const link_ops_t link_hspi_ops =
+{
+	.name = "HSPI",
+	.tx_alloc = link_hspi_tx_alloc,
+	.tx_submit = link_hspi_tx_submit,
+	.rx_get = link_hspi_rx_get,
+	.release = link_hspi_release,
+	.task = link_hspi_task,
+};
+
+/*******************************************************************************
+ * @fn     link_hspi_open
+ *
+ * @brief  Init HSPI link (after hspi_link_train()), RX board is armed for
+ *         reception in first buffer
+ *
+ * @param  is_tx: 1 to send (HSPI Host) else 0 to receive (HSPI Device)
+ * @param  cfg: Bus width and packet length
+ *
+ * @return None
+ */
+void link_hspi_open(int is_tx, const hspi_link_cfg_t* cfg)
+{
+	uint32_t i;
+
+	link_init(&link_hspi, &link_hspi_ops);
+	link_hspi_is_tx = is_tx;
+	link_hspi_pkt_len = cfg->pkt_len;
+	for(i = 0; i < LINK_HSPI_NB_BUF; i++)
+	{
+		link_hspi_buf[i].data = (uint8_t*)(LINK_HSPI_ADDR + (i * LINK_HSPI_BUF_SIZE));
+		link_hspi_buf[i].len = 0;
+		link_hspi_buf[i].size = LINK_HSPI_BUF_SIZE;
+		link_hspi_buf[i].owner = &link_hspi;
+	}
+	link_hspi_free = (1UL << LINK_HSPI_NB_BUF) - 1;
+	link_hspi_txq_head = 0;
+	link_hspi_txq_tail = 0;
+	link_hspi_tx_busy = 0;
+	link_hspi_tx_seen = hspi_link_tx_done;
+	link_hspi_rx_ready_head = 0;
+	link_hspi_rx_ready_tail = 0;
+	link_hspi_rx_next = -1;
+	link_hspi_rx_seen = hspi_link_rx_done;
+	link_hspi_rx_switch_seen = hspi_link_rx_switch;
+	link_hspi_rx_cur = 0;
+	if(is_tx)
+	{
+		hspi_link_init(1, cfg, LINK_HSPI_ADDR, LINK_HSPI_BUF_SIZE / cfg->pkt_len);
+	}
+	else
+	{
+		link_hspi_free &= ~1UL;
+		hspi_link_init(0, cfg, LINK_HSPI_ADDR, LINK_HSPI_BUF_SIZE / cfg->pkt_len);
+		link_hspi_rx_arm_next();
+	}
+}
@@ -0,0 +1,46 @@
+/********************************** (C) COPYRIGHT *******************************
+* File Name          : link_hspi.h
+* Author             : bvernoux
+* Version            : V1.0
+* Date               : 2026/10/19
+* Description        : HSPI link as common link (TX board sends, RX board
+*                      receives, see link.h)
+* Copyright (c) 2026 Benjamin VERNOUX
+* SPDX-License-Identifier: Apache-2.0
+*******************************************************************************/
+#ifndef LINK_HSPI_H_
+#define LINK_HSPI_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include "hspi_link.h"
+#include "link.h"
+
+/*
+ * TX: each buffer is one HSPI transfer of len bytes, len shall be whole
+ * packets (one or an even number of packets, no padding is added) else
+ * link_tx_submit() returns LINK_ERR_BUF (buffers of other links, e.g. 4K,
+ * can be sent)
+ * RX: the packets received fill LINK_HSPI_BUF_SIZE bytes buffers one after
+ * the other (TX transfers are concatenated without padding so the RX
+ * buffers are the TX byte stream), buffers are switched by
+ * HSPI_IRQHandler, when no buffer is free the data received is dropped
+ * (nb_err)
+ */
+#define LINK_HSPI_ADDR     (0x20030000) // RAMX after hspi_rpc buffers
+#define LINK_HSPI_NB_BUF   (2)
+#define LINK_HSPI_BUF_SIZE (16384)
+#define LINK_HSPI_TX_QUEUE (4) // TX buffers queued (power of 2)
+
+extern link_t link_hspi;
+
+void link_hspi_open(int is_tx, const hspi_link_cfg_t* cfg);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* LINK_HSPI_H_ */
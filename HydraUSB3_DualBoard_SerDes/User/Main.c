@@ -9,6 +9,17 @@
 *******************************************************************************/
 #include "CH56x_common.h"
 #include "CH56x_debug_log.h"
+#include "bootprof.h"
+#include "clkgov.h"
+#include "event.h"
+#include "irqprio.h"
+#include "memuse.h"
+#include "trace.h"
+#include "serdes_tv.h"
+#include "serdes_rel.h"
+#include "serdes_sg.h"
+#include "link_serdes.h"
+#include "soak.h"
 
 #undef FREQ_SYS
 /* System clock / MCU frequency in Hz */
@@ -32,13 +43,65 @@
 //#define SERDES_CUSTOM_NUMBER (0x05555555) // Max 28bits
 #define SERDES_CUSTOM_NUMBER (0x0FFFFFFF) // Max 28bits
 
+// Reliable 4K frames stream (acknowledge/retransmit see serdes_rel.h) instead of test vectors
+//#define SERDES_RELIABLE (1)
+// Long duration soak test on reliable stream (statistics logged each SOAK_LOG_MS)
+//#define SOAK_TEST (1)
+/* Soak test fault injection: TX sends one frame with a wrong sequence number each SOAK_FAULT_EVERY_N (0 = disabled) */
+#define SOAK_FAULT_EVERY_N (0)
+#if(defined SOAK_TEST) && !(defined SERDES_RELIABLE)
+#define SERDES_RELIABLE (1)
+#endif
+/* Reliable stream statistics log period */
+#define SERDES_REL_LOG_MS (1000)
+// Common link benchmark (see link.h) on reliable 4K frames instead of test vectors
+//#define LINK_BENCHMARK (1)
+#define LINK_BENCHMARK_LOG_MS (1000)
+// TX board: test vector frames chained by SERDES_IRQHandler (see serdes_sg.h) instead of wait of each frame
+//#define SERDES_SG_TX (1)
+#define SERDES_SG_TX_MAX (4) // Max test vector repeat in one fragments list
+// TX board: CLKGOV_FREQ_LOW between test vectors bursts (see clkgov.h, RX board stays at FREQ_SYS)
+//#define CLK_GOVERNOR (1)
+#if(defined CLK_GOVERNOR) && (defined DEBUG)
+#define CLK_GOVERNOR_UART1_BAUD (UART1_BAUD) // Shall be reachable at CLKGOV_FREQ_LOW
+#else
+#define CLK_GOVERNOR_UART1_BAUD (0)
+#endif
+
 __attribute__((aligned(16))) uint8_t RX_DMA0buff[4096] __attribute__((section(".DMADATA")));
 __attribute__((aligned(16))) uint8_t RX_DMA1buff[4096] __attribute__((section(".DMADATA")));
-__attribute__((aligned(16))) uint8_t TX_DMAbuff[4096] __attribute__((section(".DMADATA")));
+
+/* SerDes TX test vectors precomputed payloads */
+#define TX_TV_POOL_SIZE (24*1024)
+__attribute__((aligned(SERDES_TV_ALIGN))) uint8_t TX_TV_pool[TX_TV_POOL_SIZE] __attribute__((section(".DMADATA")));
 
 uint32_t RX_DMA0_addr = (uint32_t)RX_DMA0buff;
 uint32_t RX_DMA1_addr = (uint32_t)RX_DMA1buff;
-uint32_t TX_DMA_addr = (uint32_t)TX_DMAbuff;
+
+/*
+ * SerDes TX test vectors (sent in loop each 2s)
+ * To add a new test just add an entry (size, kind, repeat, seed, inc)
+ */
+serdes_tv_t serdes_tv_table[] =
+{
+	{ 4, SERDES_TV_CONST, 2, 0x5A5A5A5A, 0 },
+	{ 8, SERDES_TV_CONST, 2, 0xAAAA5555, 0 },
+	{ 16, SERDES_TV_CONST, 2, 0x11111111, 0 },
+	{ 64, SERDES_TV_CONST, 2, 0x22222222, 0 },
+	{ 128, SERDES_TV_CONST, 2, 0x33333333, 0 },
+	{ 512, SERDES_TV_CONST, 2, 0x44444444, 0 },
+	{ 576, SERDES_TV_CONST, 2, 0x55555555, 0 },
+	{ 1024, SERDES_TV_CONST, 2, 0x66666666, 0 },
+	{ 2048, SERDES_TV_CONST, 2, 0x77777777, 0 },
+	{ 2048, SERDES_TV_INC, 2, 0x00000000, 0x01010101 },
+	{ 2048, SERDES_TV_INC, 2, 0x02020200, 0x10101010 },
+	{ 4096, SERDES_TV_INC, 2, 0x22222200, 0x10101010 },
+	{ 4096, SERDES_TV_INC, 2, 0x62626200, 0x10101010 },
+};
+#define SERDES_TV_NB ((int)(sizeof(serdes_tv_table) / sizeof(serdes_tv_table[0])))
+
+/* SerDes TX test vector sent in burst continuously when UBTN is pressed */
+serdes_tv_t serdes_tv_burst = { 4096, SERDES_TV_INC, 2, 0x00000000, 0x10101010 };
 
 volatile uint32_t RX_LEN0=0, RX_LEN1=0;
 volatile uint32_t SDS_RX_LEN0=0, SDS_RX_LEN1=0, SDS_RTX_CTRL=0;
@@ -50,6 +113,9 @@ volatile uint32_t SDS_STATUS[2];
 volatile uint32_t i=0;
 volatile uint32_t k=0;
 
+/* Events posted by SERDES_IRQHandler */
+#define EVENT_SERDES_RX EVENT_USER(0) // 2 frames received (Double DMA RX buffers filled)
+
 #ifdef CNT_64BITS
 uint64_t CNT_S;
 uint64_t CNT_E;
@@ -62,7 +128,155 @@ uint32_t CNT_nb_cycles;
 int is_board1; /* Return true or false */
 
 /* Required for log_init() => log_printf()/cprintf() */
-debug_log_buf_t log_buf;
+/* In RAMX (not initialized, cleared before log_init()) to keep RAM for stack */
+debug_log_buf_t log_buf __attribute__((section(".DMADATA")));
+
+#ifdef SERDES_RELIABLE
+/*********************************************************************
+ * @fn      serdes_rel_stream_log
+ *
+ * @brief   Log reliable stream statistics
+ *
+ * @param   stats - Statistics
+ * @param   prev_bytes - Bytes at previous log
+ * @param   nb_us - Time since previous log in us
+ *
+ * @return  None
+ */
+static void serdes_rel_stream_log(const serdes_rel_stats_t* stats, uint32_t prev_bytes, uint32_t nb_us)
+{
+	uint32_t mbps;
+
+	mbps = (uint32_t)(((uint64_t)(stats->nb_bytes - prev_bytes) * 8) / nb_us);
+	if(is_board1 == false)
+	{
+		log_printf("REL TX %dMbps frames=%d send=%d retx=%d timeout=%d\n",
+				   mbps, stats->nb_frame, stats->nb_send, stats->nb_retx, stats->nb_timeout);
+		if((stats->rtt_max_ns != 0) && (stats->send_us != 0))
+		{
+			/* Frames in flight to cover the acknowledge round trip (see SERDES_REL_WINDOW) */
+			log_printf("REL TX rtt min=%dns max=%dns send=%dus window needed=%d used=%d timeout=%dus\n",
+					   stats->rtt_min_ns, stats->rtt_max_ns, stats->send_us,
+					   1 + ((stats->rtt_max_ns + (stats->send_us * 1000) - 1) / (stats->send_us * 1000)),
+					   SERDES_REL_WINDOW, SERDES_REL_TIMEOUT_US);
+		}
+	}
+	else
+	{
+		log_printf("REL RX %dMbps frames=%d crc_err=%d seq_err=%d data_err=%d rx_err=%d fifo_ov=%d\n",
+				   mbps, stats->nb_frame, stats->nb_crc_err, stats->nb_seq_err,
+				   stats->nb_data_err, stats->nb_rx_err, stats->nb_fifo_ov);
+	}
+}
+
+/*********************************************************************
+ * @fn      serdes_rel_stream
+ *
+ * @brief   Send (TX board) or receive (RX board) 4K frames continuously
+ *          with acknowledge/retransmit and log statistics each
+ *          SERDES_REL_LOG_MS (never returns)
+ *
+ * @return  None
+ */
+static void serdes_rel_stream(void)
+{
+	serdes_rel_stats_t stats;
+	uint32_t prev_bytes = 0;
+	uint32_t t0, t1, nb_us;
+	uint32_t seq;
+	uint32_t* buf;
+#ifdef SOAK_TEST
+	uint32_t soak_nb_log = 0;
+
+	soak_init(SOAK_FAULT_EVERY_N);
+#endif
+
+	if(is_board1 == false)
+	{
+		log_printf("REL TX 4K frames window=%d timeout=%dus\n", SERDES_REL_WINDOW, SERDES_REL_TIMEOUT_US);
+		serdes_rel_tx_init(SERDES_TX_RX_SPEED);
+	}
+	else
+	{
+		log_printf("REL RX 4K frames\n");
+		serdes_rel_rx_init(SERDES_TX_RX_SPEED, RX_DMA0_addr, RX_DMA1_addr, serdes_rel_bench_check);
+	}
+	t0 = bsp_get_SysTickCNT_LSB();
+	while(1)
+	{
+		if(is_board1 == false)
+		{
+			buf = serdes_rel_tx_alloc(&seq);
+			if(buf != NULL)
+			{
+				serdes_rel_bench_fill(seq, buf, SERDES_REL_FRAME_SIZE);
+				serdes_rel_tx_submit(SERDES_REL_FRAME_SIZE);
+			}
+			serdes_rel_tx_task();
+		}
+		else
+		{
+			event_sleep_ms(SERDES_REL_LOG_MS);
+		}
+		t1 = bsp_get_SysTickCNT_LSB();
+		nb_us = (t0 - t1) / bsp_get_nbtick_1us(); // SysTick count down
+		if(nb_us >= (SERDES_REL_LOG_MS * 1000))
+		{
+			serdes_rel_stats_get(&stats);
+			serdes_rel_stream_log(&stats, prev_bytes, nb_us);
+#if(defined IRQPRIO_STRESS)
+			irqprio_log();
+#endif
+			prev_bytes = stats.nb_bytes;
+			t0 = t1;
+#ifdef SOAK_TEST
+			soak_nb_log++;
+			if(soak_nb_log >= (SOAK_LOG_MS / SERDES_REL_LOG_MS))
+			{
+				soak_nb_log = 0;
+				soak_log((is_board1 == false) ? "SerDes TX" : "SerDes RX");
+			}
+#endif
+		}
+	}
+}
+#endif
+
+#ifdef LINK_BENCHMARK
+/*********************************************************************
+ * @fn      link_bench_stream
+ *
+ * @brief   Common link benchmark, send (TX board) or receive and check
+ *          (RX board) 4K frames and log throughput each
+ *          LINK_BENCHMARK_LOG_MS (never returns)
+ *
+ * @return  None
+ */
+static void link_bench_stream(void)
+{
+	link_bench_t bench;
+
+	link_serdes_open((is_board1 == false), SERDES_TX_RX_SPEED);
+	link_bench_init(&bench, &link_serdes, SERDES_REL_FRAME_SIZE);
+	event_timer_start(LINK_BENCHMARK_LOG_MS);
+	while(1)
+	{
+		if(is_board1 == false)
+			link_bench_tx_task(&bench);
+		else
+			link_bench_rx_task(&bench);
+		if(event_poll(EVENT_TIMER))
+		{
+			link_bench_log(&bench);
+#if(defined IRQPRIO_STRESS)
+			irqprio_log();
+#endif
+			trace_log(); // Trace points RAM ring (if any trace point uses TRACE_RING)
+			event_timer_start(LINK_BENCHMARK_LOG_MS);
+		}
+	}
+}
+#endif
 
 /*******************************************************************************
 * Function Name  : main
@@ -72,24 +286,36 @@ debug_log_buf_t log_buf;
 *******************************************************************************/
 int main()
 {
-	uint32_t *p32_txdma = (uint32_t *)TX_DMA_addr;
-
+	/* Paint free RAM and stack for stack high-water mark (see memuse.h) */
+	memuse_stack_paint();
 	/* Configure GPIO In/Out default/safe state for the board */
 	bsp_gpio_init();
 	/* Init BSP (MCU Frequency & SysTick) */
 	bsp_init(FREQ_SYS);
+	/* Boot profile time reference (SysTick started by bsp_init()) */
+	bootprof_init();
 	/* Configure serial debugging for printf()/log_printf()... */
+	bootprof_begin(BOOTPROF_LOG_INIT);
+	memset(&log_buf, 0, sizeof(log_buf));
 	log_init(&log_buf);
+	bootprof_end(BOOTPROF_LOG_INIT);
 #if(defined DEBUG)
 	/* Configure serial debugging for printf()/log_printf()... */
 	UART1_init(UART1_BAUD, FREQ_SYS);
 #endif
 	printf("\n");
+	/* Init event dispatcher (main loop sleep with WFI between events) */
+	event_init();
+	/* Init trace points backends (see trace.h) */
+	trace_init();
+	/* Interrupts priority map with preemption (see irqprio.h) */
+	irqprio_init();
 
 	/******************************************/
 	/* Start Synchronization between 2 Boards */
 	/* J3 MOSI(PA14) & J3 SCS(PA12) signals   */
 	/******************************************/
+	bootprof_begin(BOOTPROF_SYNC2BOARDS);
 	if(bsp_switch() == 0)
 	{
 		is_board1 = false;
@@ -100,6 +326,7 @@ int main()
 		is_board1 = true;
 		i = bsp_sync2boards(PA14, PA12, BSP_BOARD1);
 	}
+	bootprof_end(BOOTPROF_SYNC2BOARDS);
 	if(i > 0)
 		log_printf("SYNC %08d\n", i);
 	else
@@ -122,245 +349,107 @@ int main()
 		log_printf("SerDes_Rx(Board1 Top) 2022/12/11 @ChipID=%02X\n", R8_CHIP_ID);
 	}
 	log_printf("FSYS=%d\n", FREQ_SYS);
+	bootprof_log();
+	memuse_log();
+#if(defined IRQPRIO_STRESS)
+	/* Long USB command like load and latency probe with link traffic (see irqprio.h) */
+	irqprio_stress_start(IRQPRIO_STRESS_LOAD_US, IRQPRIO_STRESS_PERIOD_US);
+#endif
+#ifdef LINK_BENCHMARK
+	link_bench_stream();
+#endif
+#ifdef SERDES_RELIABLE
+	serdes_rel_stream();
+#endif
 
 	if(is_board1 == false) // SerDes TX
 	{
-		uint32_t data=0;
 		int n;
-		log_printf("TX_DMA_addr=0x%08X\n", TX_DMA_addr);
+		int state;
+		int pool_used;
+		uint32_t start;
+#ifdef SERDES_SG_TX
+		serdes_sg_t tv_sg[SERDES_SG_TX_MAX];
+#endif
+
+		start = bsp_get_SysTickCNT_LSB();
+		pool_used = serdes_tv_init(serdes_tv_table, SERDES_TV_NB, TX_TV_pool, sizeof(TX_TV_pool));
+		if(pool_used >= 0)
+			pool_used = serdes_tv_init(&serdes_tv_burst, 1, &TX_TV_pool[pool_used], (sizeof(TX_TV_pool) - pool_used));
+		if(pool_used < 0)
+		{
+			log_printf("serdes_tv_init() Error TX_TV_pool too small\n");
+			while(1);
+		}
+		log_printf("serdes_tv_init() %d test vectors %d cycles\n", SERDES_TV_NB + 1, (start - bsp_get_SysTickCNT_LSB()));
+		log_printf("TX_TV_pool=0x%08X\n", (uint32_t)TX_TV_pool);
 		log_printf("SerDes_Tx_Init(SERDES_TX_RX_SPEED=0x%04X) Before\n", SERDES_TX_RX_SPEED);
 		SerDes_Tx_Init(SERDES_TX_RX_SPEED);
 		log_printf("SerDes_Tx_Init() After\n");
-		n=0;
-		do
-		{
-			*p32_txdma++ = data;
-			data += 0x01010101;
-			n++;
-		}
-		while(n!=(2048/4));
 
 		log_printf("Wait 100us\n"); /* Wait 100us RX is ready before to TX */
 		bsp_wait_us_delay(100);
 
-		int state=0;
+#ifdef CLK_GOVERNOR
+		/* Idle time 0: low frequency during each 2s sleep */
+		clkgov_init(FREQ_SYS, CLKGOV_FREQ_LOW, 0, CLK_GOVERNOR_UART1_BAUD);
+#endif
+		state = 0;
 		while(1)
 		{
-			p32_txdma = (uint32_t *)TX_DMA_addr;
-			n=0;
-			switch(state)
-			{
-				case 0:
-				{
-					data = 0x5A5A5A5A;
-					*p32_txdma = data;
-					SerDes_DMA_Tx_CFG(TX_DMA_addr,4,SERDES_CUSTOM_NUMBER);
-					state = 1;
-				}
-				break;
-				case 1:
-				{
-					data = 0xAAAA5555;
-					do
-					{
-						*p32_txdma++ = data;
-						n++;
-					}
-					while(n!=(8/4));
-					SerDes_DMA_Tx_CFG(TX_DMA_addr,8,SERDES_CUSTOM_NUMBER);
-					state = 2;
-				}
-				break;
-				case 2:
-				{
-					data = 0x11111111;
-					do
-					{
-						*p32_txdma++ = data;
-						n++;
-					}
-					while(n!=(16/4));
-					SerDes_DMA_Tx_CFG(TX_DMA_addr,16,SERDES_CUSTOM_NUMBER);
-					state = 3;
-				}
-				break;
-				case 3:
-				{
-					data = 0x22222222;
-					do
-					{
-						*p32_txdma++ = data;
-						n++;
-					}
-					while(n!=(64/4));
-					SerDes_DMA_Tx_CFG(TX_DMA_addr,64,SERDES_CUSTOM_NUMBER);
-					state = 4;
-				}
-				break;
-				case 4:
-				{
-					data = 0x33333333;
-					do
-					{
-						*p32_txdma++ = data;
-						n++;
-					}
-					while(n!=(128/4));
-					SerDes_DMA_Tx_CFG(TX_DMA_addr,128,SERDES_CUSTOM_NUMBER);
-					state = 5;
-				}
-				break;
-				case 5:
-				{
-					data = 0x44444444;
-					do
-					{
-						*p32_txdma++ = data;
-						n++;
-					}
-					while(n!=(512/4));
-					SerDes_DMA_Tx_CFG(TX_DMA_addr,512,SERDES_CUSTOM_NUMBER);
-					state = 6;
-				}
-				break;
-				case 6:
-				{
-					data = 0x55555555;
-					do
-					{
-						*p32_txdma++ = data;
-						n++;
-					}
-					while(n!=(576/4));
-					SerDes_DMA_Tx_CFG(TX_DMA_addr,576,SERDES_CUSTOM_NUMBER);
-					state = 7;
-				}
-				break;
-				case 7:
-				{
-					data = 0x66666666;
-					do
-					{
-						*p32_txdma++ = data;
-						n++;
-					}
-					while(n!=(1024/4));
-					SerDes_DMA_Tx_CFG(TX_DMA_addr,1024,SERDES_CUSTOM_NUMBER);
-					state = 8;
-				}
-				break;
-				case 8:
-				{
-					data = 0x77777777;
-					do
-					{
-						*p32_txdma++ = data;
-						n++;
-					}
-					while(n!=(2048/4));
-					SerDes_DMA_Tx_CFG(TX_DMA_addr,2048,SERDES_CUSTOM_NUMBER);
-					state = 9;
-				}
-				break;
-				case 9:
-				{
-					data = 0;
-					do
-					{
-						*p32_txdma++ = data;
-						data += 0x01010101;
-						n++;
-					}
-					while(n!=(2048/4));
-					SerDes_DMA_Tx_CFG(TX_DMA_addr,2048,SERDES_CUSTOM_NUMBER);
-					state = 10;
-				}
-				break;
-				case 10:
-				{
-					do
-					{
-						*p32_txdma++ = data;
-						data += 0x10101010;
-						n++;
-					}
-					while(n!=(2048/4));
-					SerDes_DMA_Tx_CFG(TX_DMA_addr,2048,SERDES_CUSTOM_NUMBER);
-					state = 11;
-				}
-				break;
-				case 11:
-				{
-					do
-					{
-						*p32_txdma++ = data;
-						data += 0x10101010;
-						n++;
-					}
-					while(n!=(4096/4));
-					SerDes_DMA_Tx_CFG(TX_DMA_addr,4096,SERDES_CUSTOM_NUMBER);
-					state = 12;
-				}
-				break;
-				case 12:
-				{
-					do
-					{
-						*p32_txdma++ = data;
-						data += 0x10101010;
-						n++;
-					}
-					while(n!=(4096/4));
-					SerDes_DMA_Tx_CFG(TX_DMA_addr,4096,SERDES_CUSTOM_NUMBER);
-					state = 0;
-				}
-				break;
+			const serdes_tv_t* tv = &serdes_tv_table[state];
 
-				default:
-					state = 0;
-					break;
-			}
-			/* Send same data 2 times to test the Double DMA RX mechanism */
-			bsp_uled_on();
-			SerDes_DMA_Tx();
-			SerDes_Wait_Txdone();
-			bsp_uled_off();
+#ifdef CLK_GOVERNOR
+			clkgov_activity();
+#endif
 
-			bsp_uled_on();
-			SerDes_DMA_Tx();
-			SerDes_Wait_Txdone();
-			bsp_uled_off();
+#ifdef SERDES_SG_TX
+			/* Same payload tv->repeat times in one list, sleep until all frames are sent */
+			for(n = 0; (n < tv->repeat) && (n < SERDES_SG_TX_MAX); n++)
+			{
+				tv_sg[n].addr = tv->addr;
+				tv_sg[n].len = tv->size;
+				tv_sg[n].number = SERDES_CUSTOM_NUMBER;
+			}
+			if(serdes_sg_tx(tv_sg, n) == 0)
+				event_wait(EVENT_SERDES_SG_TX_END);
+#else
+			/* Payload is already in RAMX just point DMA on it */
+			SerDes_DMA_Tx_CFG(tv->addr, tv->size, SERDES_CUSTOM_NUMBER);
+			/* Send same data tv->repeat times (2 times to test the Double DMA RX mechanism) */
+			for(n = 0; n < tv->repeat; n++)
+			{
+				TRACE(SERDES_TX_START, tv->size);
+				SerDes_DMA_Tx();
+				SerDes_Wait_Txdone();
+				TRACE(SERDES_TX_END, 0);
+			}
+#endif
+			state++;
+			if(state >= SERDES_TV_NB)
+				state = 0;
 
 			if(bsp_ubtn()) // Send data in burst continuously
 			{
-				p32_txdma = (uint32_t *)TX_DMA_addr;
-				n=0;
-				data = 0;
-				do
-				{
-					*p32_txdma++ = data;
-					data += 0x10101010;
-					n++;
-				}
-				while(n!=(4096/4));
-				SerDes_DMA_Tx_CFG(TX_DMA_addr,4096,SERDES_CUSTOM_NUMBER);
+				SerDes_DMA_Tx_CFG(serdes_tv_burst.addr, serdes_tv_burst.size, SERDES_CUSTOM_NUMBER);
 
 				while(bsp_ubtn())
 				{
-					bsp_uled_on();
-					SerDes_DMA_Tx();
-					SerDes_Wait_Txdone();
-					bsp_uled_off();
-
-					bsp_uled_on();
-					SerDes_DMA_Tx();
-					SerDes_Wait_Txdone();
-					bsp_uled_off();
-
+					for(n = 0; n < serdes_tv_burst.repeat; n++)
+					{
+						TRACE(SERDES_TX_START, serdes_tv_burst.size);
+						SerDes_DMA_Tx();
+						SerDes_Wait_Txdone();
+						TRACE(SERDES_TX_END, 0);
+					}
 					bsp_wait_us_delay(100); /* Wait 100us (about 80us to transmit 2x*4096bytes @1.2Gbps) */
 				}
 			}
-			bsp_wait_ms_delay(2000);
+#ifdef CLK_GOVERNOR
+			clkgov_log();
+			clkgov_task();
+#endif
+			event_sleep_ms(2000);
 		} // loop while(1)
 	}
 	else // SerDes RX
@@ -384,10 +473,13 @@ int main()
 
 		while(1)
 		{
+			event_wait(EVENT_SERDES_RX);
 			if(k==2)
 			{
 				int RX_CRC_OK = 0;
+				event_stats_t stats;
 				k=0;
+				event_stats_get(&stats);
 				CNT_nb_cycles = (CNT_S - CNT_E);
 				SDS_RX_LEN0 = SDS->SDS_RX_LEN0;
 				SDS_RX_LEN1 = SDS->SDS_RX_LEN1;
@@ -399,6 +491,8 @@ int main()
 				log_printf("SDS_RX_LEN0=%d SDS_RX_LEN1=%d CNT_nb_cycles=%d(%dus)\n", SDS_RX_LEN0, SDS_RX_LEN1, CNT_nb_cycles, (CNT_nb_cycles/bsp_get_nbtick_1us()) );
 				log_printf("SDS_STATUS[0]=0x%08X SDS_STATUS[1]=0x%08X SDS_DATA0=0x%08X SDS_DATA1=0x%08X\n", SDS_STATUS[0], SDS_STATUS[1], SDS->SDS_DATA0, SDS->SDS_DATA1);
 				log_printf("SDS_RX_ERR=%d SDS_FIFO_OV=%d RX_CRC_OK=%d\n", SDS_RX_ERR, SDS_FIFO_OV, RX_CRC_OK);
+				log_printf("idle=%d%% wake_lat=%d cycles(min=%d max=%d)\n",
+						   event_idle_percent(), stats.wake_lat_last, stats.wake_lat_min, stats.wake_lat_max);
 
 				uint32_t *d;
 				if (SDS_RX_LEN0 <= 4)
@@ -455,8 +549,17 @@ int main()
 *******************************************************************************/
 __attribute__((interrupt("WCH-Interrupt-fast"))) void SERDES_IRQHandler(void)
 {
+	IRQPRIO_ENTER(start);
 	uint32_t sds_it_status;
 	sds_it_status = SerDes_StatusIT();
+	TRACE(SERDES_IRQ_ENTER, sds_it_status);
+	serdes_sg_tx_irq(sds_it_status);
+#if(defined SERDES_RELIABLE) || (defined LINK_BENCHMARK)
+	serdes_rel_rx_irq(sds_it_status);
+	TRACE(SERDES_IRQ_EXIT, 0);
+	IRQPRIO_EXIT(IRQPRIO_ID_SERDES, start);
+	return;
+#endif
 	if(sds_it_status & SDS_RX_INT_FLG)
 	{
 		if(k == 0)
@@ -477,23 +580,21 @@ __attribute__((interrupt("WCH-Interrupt-fast"))) void SERDES_IRQHandler(void)
 #endif
 			SDS_STATUS[1] = sds_it_status;
 		}
-		bsp_uled_on();
 		k++;
 		SerDes_ClearIT(SDS_RX_INT_FLG|SDS_COMMA_INT_FLG);
-		bsp_uled_off();
+		if(k == 2)
+			event_post(EVENT_SERDES_RX);
 	}
 	if(sds_it_status & SDS_RX_ERR_FLG)
 	{
-		bsp_uled_on();
 		SDS_RX_ERR++;
 		SerDes_ClearIT(SDS_RX_ERR_FLG);
-		bsp_uled_off();
 	}
 	if(sds_it_status & SDS_FIFO_OV_FLG)
 	{
-		bsp_uled_on();
 		SDS_FIFO_OV++;
 		SerDes_ClearIT(SDS_FIFO_OV_FLG);
-		bsp_uled_off();
 	}
+	TRACE(SERDES_IRQ_EXIT, 0);
+	IRQPRIO_EXIT(IRQPRIO_ID_SERDES, start);
 }
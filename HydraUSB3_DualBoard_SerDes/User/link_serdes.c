@@ -0,0 +1,191 @@
+/********************************** (C) COPYRIGHT *******************************
+* File Name          : link_serdes.c
+* Author             : bvernoux
+* Version            : V1.0
+* Date               : 2026/10/19
+* Description        : SerDes reliable frames as common link (TX board sends,
+*                      RX board receives, see link.h and serdes_rel.h)
+* Copyright (c) 2026 Benjamin VERNOUX
+* SPDX-License-Identifier: Apache-2.0
+*******************************************************************************/
+#include "CH56x_common.h"
+#include "link_serdes.h"
+
+link_t link_serdes;
+
+/* TX */
+static link_buf_t link_serdes_tx_own; /* Next serdes_rel frame (serdes_rel_tx_alloc()) */
+static link_buf_t* link_serdes_txq[SERDES_REL_NB_SLOT]; /* Buffers waiting acknowledge */
+static uint32_t link_serdes_tx_head; /* Frames submitted */
+static uint32_t link_serdes_tx_acked; /* serdes_rel_tx_acked() processed */
+
+/* RX (ready queue and free mask updated by SERDES_IRQHandler) */
+__attribute__((aligned(16))) static uint8_t link_serdes_rx_data[LINK_SERDES_RX_NB_BUF][SERDES_REL_FRAME_SIZE] __attribute__((section(".DMADATA")));
+static link_buf_t link_serdes_rx_buf[LINK_SERDES_RX_NB_BUF];
+static volatile uint32_t link_serdes_rx_free; /* Bit mask of buffers not armed and not received */
+static volatile uint32_t link_serdes_rx_ready[LINK_SERDES_RX_NB_BUF];
+static volatile uint32_t link_serdes_rx_ready_head;
+static uint32_t link_serdes_rx_ready_tail;
+
+#define LINK_SERDES_SLOT(idx, size) ((idx) & ((size) - 1))
+
+static link_buf_t* link_serdes_tx_alloc(link_t* link)
+{
+	uint32_t seq;
+	uint32_t* data;
+
+	data = serdes_rel_tx_alloc(&seq);
+	if(data == NULL)
+		return NULL;
+	link_serdes_tx_own.data = (uint8_t*)data;
+	link_serdes_tx_own.len = 0;
+	link_serdes_tx_own.size = SERDES_REL_FRAME_SIZE;
+	link_serdes_tx_own.owner = link;
+	return &link_serdes_tx_own;
+}
+
+static int link_serdes_tx_submit(link_t* link, link_buf_t* buf)
+{
+	uint32_t seq;
+
+	if((buf->len > SERDES_REL_FRAME_SIZE) || (buf->len & 3) ||
+	   ((uint32_t)buf->data & (LINK_BUF_ALIGN - 1)))
+		return LINK_ERR_BUF;
+	if(buf == &link_serdes_tx_own)
+	{
+		/* Shall be the frame returned by serdes_rel_tx_alloc() */
+		if(serdes_rel_tx_alloc(&seq) != (uint32_t*)buf->data)
+			return LINK_ERR_BUSY;
+		serdes_rel_tx_submit(buf->len);
+	}
+	else if(serdes_rel_tx_submit_addr((uint32_t)buf->data, buf->len) < 0)
+	{
+		return LINK_ERR_BUSY;
+	}
+	link_serdes_txq[LINK_SERDES_SLOT(link_serdes_tx_head, SERDES_REL_NB_SLOT)] = buf;
+	link_serdes_tx_head++;
+	return LINK_OK;
+}
+
+/*******************************************************************************
+ * @fn     link_serdes_rx_handler
+ *
+ * @brief  In order frame (serdes_rel_handler_t called in SERDES_IRQHandler),
+ *         the frame is queued and its DMA buffer replaced by a free one
+ *
+ * @return 0 if frame is queued else 1 (no free buffer, sent again by TX)
+ */
+static int link_serdes_rx_handler(uint32_t seq, const uint32_t* buf, uint32_t len)
+{
+	uint32_t idx;
+	uint32_t i;
+
+	(void)seq;
+	if(link_serdes_rx_free == 0)
+		return 1;
+	for(i = 0; (link_serdes_rx_free & (1UL << i)) == 0; i++);
+	link_serdes_rx_free &= ~(1UL << i);
+	serdes_rel_rx_set_next((uint32_t)link_serdes_rx_data[i]);
+	idx = ((const uint8_t*)buf - &link_serdes_rx_data[0][0]) / SERDES_REL_FRAME_SIZE;
+	link_serdes_rx_buf[idx].len = len;
+	link_serdes_rx_ready[LINK_SERDES_SLOT(link_serdes_rx_ready_head, LINK_SERDES_RX_NB_BUF)] = idx;
+	link_serdes_rx_ready_head++;
+	return 0;
+}
+
+static link_buf_t* link_serdes_rx_get(link_t* link)
+{
+	link_buf_t* buf;
+
+	(void)link;
+	if(link_serdes_rx_ready_tail == link_serdes_rx_ready_head)
+		return NULL;
+	buf = &link_serdes_rx_buf[link_serdes_rx_ready[LINK_SERDES_SLOT(link_serdes_rx_ready_tail, LINK_SERDES_RX_NB_BUF)]];
+	link_serdes_rx_ready_tail++;
+	return buf;
+}
+
+static void link_serdes_release(link_t* link, link_buf_t* buf)
+{
+	(void)link;
+	if(buf == &link_serdes_tx_own)
+		return; // serdes_rel frame reused once acknowledged
+	PFIC_DisableIRQ(INT_ID_SERDES);
+	link_serdes_rx_free |= (1UL << (buf - link_serdes_rx_buf));
+	PFIC_EnableIRQ(INT_ID_SERDES);
+}
+
+/*******************************************************************************
+ * @fn     link_serdes_task
+ *
+ * @brief  Send queued frames and release acknowledged buffers (TX), update
+ *         errors (RX)
+ *
+ * @return None
+ */
+static void link_serdes_task(link_t* link)
+{
+	serdes_rel_stats_t stats;
+	uint32_t acked;
+
+	if(link_serdes_tx_head != link_serdes_tx_acked)
+	{
+		serdes_rel_tx_task();
+		acked = serdes_rel_tx_acked();
+		while(link_serdes_tx_acked != acked)
+		{
+			link_release(link_serdes_txq[LINK_SERDES_SLOT(link_serdes_tx_acked, SERDES_REL_NB_SLOT)]);
+			link_serdes_tx_acked++;
+		}
+	}
+	serdes_rel_stats_get(&stats);
+	link->stats.nb_err = stats.nb_crc_err + stats.nb_seq_err + stats.nb_rx_err + stats.nb_fifo_ov;
+}
+
+static const link_ops_t link_serdes_ops =
+{
+	.name = "SerDes",
+	.tx_alloc = link_serdes_tx_alloc,
+	.tx_submit = link_serdes_tx_submit,
+	.rx_get = link_serdes_rx_get,
+	.release = link_serdes_release,
+	.task = link_serdes_task,
+};
+
+/*******************************************************************************
+ * @fn     link_serdes_open
+ *
+ * @brief  Init SerDes link (shall be called after bsp_sync2boards()),
+ *         SERDES_IRQHandler() shall call serdes_rel_rx_irq() on RX board
+ *
+ * @param  is_tx: 1 to send else 0 to receive
+ * @param  speed: SerDes speed (SDS_PLL_FREQ_XXX)
+ *
+ * @return None
+ */
+void link_serdes_open(int is_tx, uint32_t speed)
+{
+	uint32_t i;
+
+	link_init(&link_serdes, &link_serdes_ops);
+	link_serdes_tx_head = 0;
+	link_serdes_tx_acked = 0;
+	if(is_tx)
+	{
+		serdes_rel_tx_init(speed);
+		return;
+	}
+	for(i = 0; i < LINK_SERDES_RX_NB_BUF; i++)
+	{
+		link_serdes_rx_buf[i].data = link_serdes_rx_data[i];
+		link_serdes_rx_buf[i].len = 0;
+		link_serdes_rx_buf[i].size = SERDES_REL_FRAME_SIZE;
+		link_serdes_rx_buf[i].owner = &link_serdes;
+	}
+	link_serdes_rx_ready_head = 0;
+	link_serdes_rx_ready_tail = 0;
+	/* Buffers 0 & 1 armed in Double DMA */
+	link_serdes_rx_free = ((1UL << LINK_SERDES_RX_NB_BUF) - 1) & ~3UL;
+	serdes_rel_rx_init(speed, (uint32_t)link_serdes_rx_data[0], (uint32_t)link_serdes_rx_data[1],
+					   link_serdes_rx_handler);
+}
@@ -0,0 +1,40 @@
+/********************************** (C) COPYRIGHT *******************************
+* File Name          : link_serdes.h
+* Author             : bvernoux
+* Version            : V1.0
+* Date               : 2026/10/19
+* Description        : SerDes reliable frames as common link (TX board sends,
+*                      RX board receives, see link.h and serdes_rel.h)
+* Copyright (c) 2026 Benjamin VERNOUX
+* SPDX-License-Identifier: Apache-2.0
+*******************************************************************************/
+#ifndef LINK_SERDES_H_
+#define LINK_SERDES_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include "link.h"
+#include "serdes_rel.h"
+
+/*
+ * TX: buffers are the serdes_rel frames (released once acknowledged),
+ * buffers of other links (max SERDES_REL_FRAME_SIZE bytes) are sent
+ * without copy
+ * RX: frames are received in LINK_SERDES_RX_NB_BUF buffers rotated in the
+ * SerDes Double DMA, when no buffer is free the frame is not acknowledged
+ * (sent again by TX)
+ */
+#define LINK_SERDES_RX_NB_BUF (4) // Power of 2 (2 always armed in Double DMA)
+
+extern link_t link_serdes;
+
+void link_serdes_open(int is_tx, uint32_t speed);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* LINK_SERDES_H_ */
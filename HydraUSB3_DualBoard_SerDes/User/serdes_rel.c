@@ -0,0 +1,476 @@
+/********************************** (C) COPYRIGHT *******************************
+* File Name          : serdes_rel.c
+* Author             : bvernoux
+* Version            : V1.0
+* Date               : 2026/10/19
+* Description        : SerDes reliable frame delivery (sliding window with
+*                      retransmission, acknowledge back channel on the
+*                      J3 sync GPIOs)
+* Copyright (c) 2026 Benjamin VERNOUX
+* SPDX-License-Identifier: Apache-2.0
+*******************************************************************************/
+#include "CH56x_common.h"
+#include "CH56x_debug_log.h"
+#include "event.h"
+#include "fastmem.h"
+#include "soak.h"
+#include "trace.h"
+#include "serdes_rel.h"
+
+#define SERDES_REL_ACK_PINS (GPIO_Pin_14 | GPIO_Pin_12)
+
+/* Wait of RX acknowledge lines reset at TX start */
+#define SERDES_REL_START_MS (100)
+
+/* TX frames kept until acknowledged */
+__attribute__((aligned(16))) static uint32_t serdes_rel_tx_buf[SERDES_REL_NB_SLOT][SERDES_REL_FRAME_SIZE / 4] __attribute__((section(".DMADATA")));
+static uint32_t serdes_rel_tx_addr[SERDES_REL_NB_SLOT]; // Frame address (own buffer or serdes_rel_tx_submit_addr())
+static uint32_t serdes_rel_tx_len[SERDES_REL_NB_SLOT];
+static uint32_t serdes_rel_tx_ts[SERDES_REL_NB_SLOT]; // SysTick at end of last send
+static uint32_t serdes_rel_tx_us[SERDES_REL_NB_SLOT]; // Duration of last send
+static uint8_t serdes_rel_tx_resent[SERDES_REL_NB_SLOT]; // Sent more than once (no round trip time)
+/* TX sequence numbers (tx_ack <= tx_next <= tx_head and tx_next <= tx_max) */
+static uint32_t serdes_rel_tx_head; // Next frame to submit
+static uint32_t serdes_rel_tx_next; // Next frame to send
+static uint32_t serdes_rel_tx_ack; // Oldest frame not acknowledged
+static uint32_t serdes_rel_tx_max; // Next frame never sent
+
+/* RX */
+static uint32_t serdes_rel_rx_addr[2];
+static uint32_t serdes_rel_rx_idx; // Double DMA buffer of next frame
+static uint32_t serdes_rel_rx_cur; // Double DMA buffer of frame given to handler
+static volatile uint32_t serdes_rel_rx_expected; // Also number of frames acknowledged
+static serdes_rel_handler_t serdes_rel_rx_handler;
+
+static volatile serdes_rel_stats_t serdes_rel_stats;
+
+#define SERDES_REL_SLOT(seq) ((seq) & (SERDES_REL_NB_SLOT - 1))
+
+/*********************************************************************
+ * @fn      serdes_rel_ack_read
+ *
+ * @brief   Read acknowledge lines (2bits Gray counter) driven by RX
+ *
+ * @return  Number of frames acknowledged modulo 4
+ */
+static uint32_t serdes_rel_ack_read(void)
+{
+	uint32_t pins;
+	uint32_t b1, b0;
+
+	pins = GPIOA_ReadPortPin(SERDES_REL_ACK_PINS);
+	b1 = (pins & GPIO_Pin_14) ? 1 : 0;
+	b0 = (pins & GPIO_Pin_12) ? 1 : 0;
+	return ((b1 << 1) | (b1 ^ b0));
+}
+
+/*********************************************************************
+ * @fn      serdes_rel_tx_ack_poll
+ *
+ * @brief   Release frames acknowledged by RX
+ *
+ * @return  None
+ */
+static void serdes_rel_tx_ack_poll(void)
+{
+	uint32_t nb_ack;
+	uint32_t slot;
+	uint32_t rtt_ns;
+
+	nb_ack = (serdes_rel_ack_read() - serdes_rel_tx_ack) & 3;
+	/* RX can only acknowledge frames already sent (SERDES_REL_WINDOW < 4) */
+	if(nb_ack > (serdes_rel_tx_max - serdes_rel_tx_ack))
+		return;
+	while(nb_ack > 0)
+	{
+		slot = SERDES_REL_SLOT(serdes_rel_tx_ack);
+		if(serdes_rel_tx_resent[slot] == 0)
+		{
+			/* SysTick count down */
+			rtt_ns = (uint32_t)(((uint64_t)(serdes_rel_tx_ts[slot] - bsp_get_SysTickCNT_LSB()) * 1000) / bsp_get_nbtick_1us());
+			if(rtt_ns < serdes_rel_stats.rtt_min_ns)
+				serdes_rel_stats.rtt_min_ns = rtt_ns;
+			if(rtt_ns > serdes_rel_stats.rtt_max_ns)
+				serdes_rel_stats.rtt_max_ns = rtt_ns;
+		}
+		serdes_rel_stats.nb_frame++;
+		serdes_rel_stats.nb_bytes += serdes_rel_tx_len[SERDES_REL_SLOT(serdes_rel_tx_ack)];
+		soak_frame(serdes_rel_tx_len[SERDES_REL_SLOT(serdes_rel_tx_ack)], serdes_rel_tx_us[SERDES_REL_SLOT(serdes_rel_tx_ack)]);
+		serdes_rel_tx_ack++;
+		nb_ack--;
+	}
+	/* Frames acknowledged after a timeout (sent before to go back) */
+	if((int32_t)(serdes_rel_tx_next - serdes_rel_tx_ack) < 0)
+		serdes_rel_tx_next = serdes_rel_tx_ack;
+}
+
+/*********************************************************************
+ * @fn      serdes_rel_tx_init
+ *
+ * @brief   Init SerDes TX and acknowledge lines (shall be called after
+ *          bsp_sync2boards())
+ *
+ * @param   speed - SerDes speed (SDS_PLL_FREQ_XXX)
+ *
+ * @return  None
+ */
+void serdes_rel_tx_init(uint32_t speed)
+{
+	int i;
+
+	serdes_rel_tx_head = 0;
+	serdes_rel_tx_next = 0;
+	serdes_rel_tx_ack = 0;
+	serdes_rel_tx_max = 0;
+	fastmem_set((void*)&serdes_rel_stats, 0, sizeof(serdes_rel_stats));
+	serdes_rel_stats.rtt_min_ns = 0xFFFFFFFF;
+
+	GPIOA_ModeCfg(SERDES_REL_ACK_PINS, GPIO_ModeIN_PD_SMT);
+	SerDes_Tx_Init(speed);
+	/* Wait RX is ready (acknowledge lines reset) */
+	for(i = 0; i < SERDES_REL_START_MS; i++)
+	{
+		if(GPIOA_ReadPortPin(SERDES_REL_ACK_PINS) == 0)
+			break;
+		bsp_wait_ms_delay(1);
+	}
+	if(i == SERDES_REL_START_MS)
+		log_printf("serdes_rel_tx_init() Err acknowledge lines not reset\n");
+	bsp_wait_us_delay(100); /* Wait 100us RX is ready before to TX */
+}
+
+/*********************************************************************
+ * @fn      serdes_rel_tx_alloc
+ *
+ * @brief   Get next free TX frame buffer (in RAMX) to be filled then
+ *          submitted with serdes_rel_tx_submit()
+ *
+ * @param   seq - Sequence number of the frame
+ *
+ * @return  Frame buffer (SERDES_REL_FRAME_SIZE bytes) or NULL if all
+ *          frames are waiting acknowledge
+ */
+uint32_t* serdes_rel_tx_alloc(uint32_t* seq)
+{
+	if((serdes_rel_tx_head - serdes_rel_tx_ack) >= SERDES_REL_NB_SLOT)
+		return NULL;
+	*seq = serdes_rel_tx_head;
+	return serdes_rel_tx_buf[SERDES_REL_SLOT(serdes_rel_tx_head)];
+}
+
+/*********************************************************************
+ * @fn      serdes_rel_tx_submit
+ *
+ * @brief   Queue the frame returned by serdes_rel_tx_alloc()
+ *
+ * @param   len - Frame length in bytes (multiple of 4, max SERDES_REL_FRAME_SIZE)
+ *
+ * @return  None
+ */
+void serdes_rel_tx_submit(uint32_t len)
+{
+	serdes_rel_tx_addr[SERDES_REL_SLOT(serdes_rel_tx_head)] = (uint32_t)serdes_rel_tx_buf[SERDES_REL_SLOT(serdes_rel_tx_head)];
+	serdes_rel_tx_len[SERDES_REL_SLOT(serdes_rel_tx_head)] = len;
+	serdes_rel_tx_head++;
+}
+
+/*********************************************************************
+ * @fn      serdes_rel_tx_submit_addr
+ *
+ * @brief   Queue a frame from an other buffer (zero copy), the buffer
+ *          shall be kept until the frame is acknowledged
+ *          (see serdes_rel_tx_acked())
+ *
+ * @param   addr - Frame address in RAMX (16 bytes aligned)
+ * @param   len - Frame length in bytes (multiple of 4, max SERDES_REL_FRAME_SIZE)
+ *
+ * @return  Sequence number of the frame or -1 if all frames are waiting
+ *          acknowledge
+ */
+int32_t serdes_rel_tx_submit_addr(uint32_t addr, uint32_t len)
+{
+	uint32_t seq = serdes_rel_tx_head;
+
+	if((serdes_rel_tx_head - serdes_rel_tx_ack) >= SERDES_REL_NB_SLOT)
+		return -1;
+	serdes_rel_tx_addr[SERDES_REL_SLOT(seq)] = addr;
+	serdes_rel_tx_len[SERDES_REL_SLOT(seq)] = len;
+	serdes_rel_tx_head++;
+	return (int32_t)(seq & SERDES_REL_SEQ_MASK);
+}
+
+/*********************************************************************
+ * @fn      serdes_rel_tx_acked
+ *
+ * @brief   Number of frames acknowledged since serdes_rel_tx_init()
+ *          (frames are acknowledged in submit order)
+ *
+ * @return  Number of frames acknowledged
+ */
+uint32_t serdes_rel_tx_acked(void)
+{
+	return serdes_rel_tx_ack;
+}
+
+/*********************************************************************
+ * @fn      serdes_rel_tx_task
+ *
+ * @brief   Release acknowledged frames, go back to the oldest frame not
+ *          acknowledged on timeout and send queued frames in the window
+ *          (to be called in loop)
+ *
+ * @return  None
+ */
+void serdes_rel_tx_task(void)
+{
+	uint32_t slot;
+	uint32_t timeout;
+	uint32_t seq;
+	uint32_t t0;
+
+	serdes_rel_tx_ack_poll();
+	if(serdes_rel_tx_next != serdes_rel_tx_ack)
+	{
+		timeout = SERDES_REL_TIMEOUT_US * bsp_get_nbtick_1us();
+		/* SysTick count down */
+		if((serdes_rel_tx_ts[SERDES_REL_SLOT(serdes_rel_tx_ack)] - bsp_get_SysTickCNT_LSB()) > timeout)
+		{
+			serdes_rel_stats.nb_timeout++;
+			soak_error(SOAK_ERR_TIMEOUT);
+			serdes_rel_tx_next = serdes_rel_tx_ack;
+		}
+	}
+	while((serdes_rel_tx_next != serdes_rel_tx_head) &&
+		  ((serdes_rel_tx_next - serdes_rel_tx_ack) < SERDES_REL_WINDOW))
+	{
+		slot = SERDES_REL_SLOT(serdes_rel_tx_next);
+		seq = serdes_rel_tx_next & SERDES_REL_SEQ_MASK;
+		if(soak_fault_inject())
+			seq ^= SERDES_REL_SEQ_MASK; // Wrong sequence number, frame is not acknowledged
+		SerDes_DMA_Tx_CFG(serdes_rel_tx_addr[slot], serdes_rel_tx_len[slot], seq);
+		t0 = bsp_get_SysTickCNT_LSB();
+		TRACE(SERDES_TX_START, serdes_rel_tx_len[slot]);
+		SerDes_DMA_Tx();
+		SerDes_Wait_Txdone();
+		TRACE(SERDES_TX_END, seq);
+		serdes_rel_tx_ts[slot] = bsp_get_SysTickCNT_LSB();
+		serdes_rel_tx_us[slot] = (t0 - serdes_rel_tx_ts[slot]) / bsp_get_nbtick_1us(); // SysTick count down
+		serdes_rel_stats.send_us = serdes_rel_tx_us[slot];
+		serdes_rel_stats.nb_send++;
+		if(serdes_rel_tx_next == serdes_rel_tx_max)
+		{
+			serdes_rel_tx_resent[slot] = 0;
+			serdes_rel_tx_max++;
+		}
+		else
+		{
+			serdes_rel_tx_resent[slot] = 1;
+			serdes_rel_stats.nb_retx++;
+		}
+		serdes_rel_tx_next++;
+		serdes_rel_tx_ack_poll();
+	}
+}
+
+/*********************************************************************
+ * @fn      serdes_rel_rx_init
+ *
+ * @brief   Init SerDes RX (Double DMA) and acknowledge lines (shall be
+ *          called after bsp_sync2boards())
+ *          SERDES_IRQHandler() shall call serdes_rel_rx_irq()
+ *
+ * @param   speed - SerDes speed (SDS_PLL_FREQ_XXX)
+ * @param   rx_dma0_addr - RX DMA0 buffer (SERDES_REL_FRAME_SIZE bytes in RAMX)
+ * @param   rx_dma1_addr - RX DMA1 buffer (SERDES_REL_FRAME_SIZE bytes in RAMX)
+ * @param   handler - In order frame handler (NULL accepts all frames)
+ *                    which can replace the frame buffer with
+ *                    serdes_rel_rx_set_next()
+ *
+ * @return  None
+ */
+void serdes_rel_rx_init(uint32_t speed, uint32_t rx_dma0_addr, uint32_t rx_dma1_addr, serdes_rel_handler_t handler)
+{
+	serdes_rel_rx_addr[0] = rx_dma0_addr;
+	serdes_rel_rx_addr[1] = rx_dma1_addr;
+	serdes_rel_rx_idx = 0;
+	serdes_rel_rx_expected = 0;
+	serdes_rel_rx_handler = handler;
+	fastmem_set((void*)&serdes_rel_stats, 0, sizeof(serdes_rel_stats));
+
+	GPIOA_ResetBits(SERDES_REL_ACK_PINS);
+	GPIOA_ModeCfg(SERDES_REL_ACK_PINS, GPIO_Highspeed_PP_8mA);
+
+	PFIC_EnableIRQ(INT_ID_SERDES);
+	SerDes_DoubleDMA_Rx_CFG(rx_dma0_addr, rx_dma1_addr);
+	SerDes_Rx_Init(speed);
+	SerDes_EnableIT(SDS_RX_INT_EN|SDS_RX_ERR_EN|SDS_FIFO_OV_EN);
+	SerDes_ClearIT(ALL_INT_TYPE);
+}
+
+/*********************************************************************
+ * @fn      serdes_rel_rx_set_next
+ *
+ * @brief   Replace the RX DMA buffer of the frame given to the handler
+ *          (to be called by serdes_rel_handler_t only), the handler keeps
+ *          the frame buffer (zero copy) and the next frames are received
+ *          in addr
+ *
+ * @param   addr - RX buffer (SERDES_REL_FRAME_SIZE bytes in RAMX)
+ *
+ * @return  None
+ */
+void serdes_rel_rx_set_next(uint32_t addr)
+{
+	serdes_rel_rx_addr[serdes_rel_rx_cur] = addr;
+	if(serdes_rel_rx_cur == 0)
+		SDS->SDS_DMA0 = addr;
+	else
+		SDS->SDS_DMA1 = addr;
+}
+
+/*********************************************************************
+ * @fn      serdes_rel_rx_ack
+ *
+ * @brief   Acknowledge next frame (Gray counter, one line changes)
+ *
+ * @return  None
+ */
+static void serdes_rel_rx_ack(void)
+{
+	uint32_t gray;
+
+	serdes_rel_rx_expected++;
+	gray = serdes_rel_rx_expected ^ (serdes_rel_rx_expected >> 1);
+	if(gray & 2)
+		GPIOA_SetBits(GPIO_Pin_14);
+	else
+		GPIOA_ResetBits(GPIO_Pin_14);
+	if(gray & 1)
+		GPIOA_SetBits(GPIO_Pin_12);
+	else
+		GPIOA_ResetBits(GPIO_Pin_12);
+}
+
+/*********************************************************************
+ * @fn      serdes_rel_rx_irq
+ *
+ * @brief   SerDes RX interrupt (to be called by SERDES_IRQHandler())
+ *
+ * @param   sds_it_status - SerDes_StatusIT()
+ *
+ * @return  None
+ */
+void serdes_rel_rx_irq(uint32_t sds_it_status)
+{
+	uint32_t idx;
+	uint32_t len;
+	uint32_t seq;
+
+	if(sds_it_status & SDS_RX_INT_FLG)
+	{
+		idx = serdes_rel_rx_idx;
+		serdes_rel_rx_idx ^= 1;
+		serdes_rel_rx_cur = idx;
+		if(idx == 0)
+		{
+			len = SDS->SDS_RX_LEN0;
+			seq = SDS->SDS_DATA0 & SERDES_REL_SEQ_MASK;
+		}
+		else
+		{
+			len = SDS->SDS_RX_LEN1;
+			seq = SDS->SDS_DATA1 & SERDES_REL_SEQ_MASK;
+		}
+		SerDes_ClearIT(SDS_RX_INT_FLG|SDS_COMMA_INT_FLG);
+
+		if((sds_it_status & SDS_RX_CRC_OK) == 0)
+		{
+			serdes_rel_stats.nb_crc_err++;
+			soak_error(SOAK_ERR_CRC);
+		}
+		else if(seq != (serdes_rel_rx_expected & SERDES_REL_SEQ_MASK))
+		{
+			serdes_rel_stats.nb_seq_err++;
+			soak_error(SOAK_ERR_SEQ);
+		}
+		else if((serdes_rel_rx_handler != NULL) &&
+				(serdes_rel_rx_handler(serdes_rel_rx_expected, (const uint32_t*)serdes_rel_rx_addr[idx], len) != 0))
+		{
+			serdes_rel_stats.nb_data_err++;
+			soak_error(SOAK_ERR_DATA);
+		}
+		else
+		{
+			serdes_rel_rx_ack();
+			serdes_rel_stats.nb_frame++;
+			serdes_rel_stats.nb_bytes += len;
+			soak_frame(len, 0);
+		}
+	}
+	if(sds_it_status & SDS_RX_ERR_FLG)
+	{
+		serdes_rel_stats.nb_rx_err++;
+		soak_error(SOAK_ERR_OVERFLOW);
+		SerDes_ClearIT(SDS_RX_ERR_FLG);
+	}
+	if(sds_it_status & SDS_FIFO_OV_FLG)
+	{
+		serdes_rel_stats.nb_fifo_ov++;
+		soak_error(SOAK_ERR_OVERFLOW);
+		SerDes_ClearIT(SDS_FIFO_OV_FLG);
+	}
+}
+
+/*********************************************************************
+ * @fn      serdes_rel_stats_get
+ *
+ * @brief   Get TX or RX statistics (since init)
+ *
+ * @param   stats - Statistics copy
+ *
+ * @return  None
+ */
+void serdes_rel_stats_get(serdes_rel_stats_t* stats)
+{
+	PFIC_DisableIRQ(INT_ID_SERDES);
+	fastmem_cpy(stats, (const void*)&serdes_rel_stats, sizeof(serdes_rel_stats_t));
+	PFIC_EnableIRQ(INT_ID_SERDES);
+}
+
+/*********************************************************************
+ * @fn      serdes_rel_bench_fill
+ *
+ * @brief   Fill a benchmark frame (32bits word[n] = seq + n)
+ *
+ * @param   seq - Frame sequence number
+ * @param   buf - Frame buffer
+ * @param   len - Frame length in bytes (multiple of 4)
+ *
+ * @return  None
+ */
+void serdes_rel_bench_fill(uint32_t seq, uint32_t* buf, uint32_t len)
+{
+	fastmem_fill_inc32(buf, seq, 1, (len / 4));
+}
+
+/*********************************************************************
+ * @fn      serdes_rel_bench_check
+ *
+ * @brief   Check a benchmark frame (serdes_rel_handler_t)
+ *          Only first and last words are checked (payload is checked by
+ *          SerDes CRC) to keep the interrupt short at full rate
+ *
+ * @param   seq - Frame sequence number
+ * @param   buf - Frame buffer
+ * @param   len - Frame length in bytes (multiple of 4)
+ *
+ * @return  0 if frame is valid else 1
+ */
+int serdes_rel_bench_check(uint32_t seq, const uint32_t* buf, uint32_t len)
+{
+	uint32_t nb_words = len / 4;
+
+	if((nb_words == 0) || (buf[0] != seq) || (buf[nb_words - 1] != (seq + nb_words - 1)))
+		return 1;
+	return 0;
+}
@@ -0,0 +1,101 @@
+/********************************** (C) COPYRIGHT *******************************
+* File Name          : serdes_rel.h
+* Author             : bvernoux
+* Version            : V1.0
+* Date               : 2026/10/19
+* Description        : SerDes reliable frame delivery (sliding window with
+*                      retransmission, acknowledge back channel on the
+*                      J3 sync GPIOs)
+* Copyright (c) 2026 Benjamin VERNOUX
+* SPDX-License-Identifier: Apache-2.0
+*******************************************************************************/
+#ifndef SERDES_REL_H_
+#define SERDES_REL_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+
+/*
+ * - Each frame carries its sequence number in the SerDes custom number
+ *   (28bits, read by RX in SDS_DATA0/1) and is checked by SerDes CRC
+ * - RX acknowledges in order frames only (go-back-N), the number of frames
+ *   acknowledged is a 2bits Gray counter driven by RX on J3 MOSI(PA14)=bit1
+ *   & J3 SCS(PA12)=bit0 and sampled by TX (only one line changes per frame)
+ * - A frame with CRC error, sequence error or rejected by the RX handler is
+ *   not acknowledged (implicit NACK), TX sends again all frames not
+ *   acknowledged after SERDES_REL_TIMEOUT_US
+ * - TX keeps frames in RAMX until acknowledged
+ */
+#define SERDES_REL_FRAME_SIZE (4096) // Max frame size in bytes (SerDes max)
+#define SERDES_REL_NB_SLOT    (4) // TX frames in RAMX (power of 2)
+/*
+ * Frames sent and not acknowledged, limited by RX Double DMA buffers
+ * (frame N+2 overwrites frame N) and by the Gray counter (shall be < 4)
+ * The window keeps the link busy if it covers the acknowledge round trip:
+ * 1 + rtt_max_ns / (send_us * 1000) frames (serdes_rel_stats_t measured by
+ * TX, logged as "window needed"), a larger need cannot be met by this
+ * back channel and shows as throughput below the raw SerDes rate
+ */
+#define SERDES_REL_WINDOW     (2)
+/*
+ * About 35us to transmit 4096bytes @1.2Gbps, shall be greater than the
+ * measured rtt_max_ns (else frames are sent again before their acknowledge)
+ */
+#ifndef SERDES_REL_TIMEOUT_US
+#define SERDES_REL_TIMEOUT_US (200)
+#endif
+
+#define SERDES_REL_SEQ_MASK (0x0FFFFFFF) // SerDes custom number is 28bits
+
+typedef struct
+{
+	uint32_t nb_frame; /* TX: frames acknowledged, RX: frames delivered */
+	uint32_t nb_bytes; /* TX: bytes acknowledged, RX: bytes delivered */
+	uint32_t nb_send; /* TX: frames sent (including retransmissions) */
+	uint32_t nb_retx; /* TX: frames retransmitted */
+	uint32_t nb_timeout; /* TX: acknowledge timeouts */
+	uint32_t rtt_min_ns; /* TX: end of frame send to acknowledge seen (frames sent once) */
+	uint32_t rtt_max_ns; /* TX: idem (includes serdes_rel_tx_task() polling delay) */
+	uint32_t send_us; /* TX: last frame send duration */
+	uint32_t nb_crc_err; /* RX: frames with CRC error */
+	uint32_t nb_seq_err; /* RX: frames out of sequence (lost or duplicated) */
+	uint32_t nb_data_err; /* RX: frames rejected by the handler */
+	uint32_t nb_rx_err; /* RX: SDS_RX_ERR_FLG */
+	uint32_t nb_fifo_ov; /* RX: SDS_FIFO_OV_FLG */
+} serdes_rel_stats_t;
+
+/*
+ * RX in order frame handler (called in SERDES_IRQHandler before the frame is
+ * acknowledged), return 0 to accept the frame else it is sent again by TX
+ * The frame buffer is valid until the next frame is received in it (2 frames later)
+ * except if the handler gives an other buffer with serdes_rel_rx_set_next()
+ */
+typedef int (*serdes_rel_handler_t)(uint32_t seq, const uint32_t* buf, uint32_t len);
+
+/* TX */
+void serdes_rel_tx_init(uint32_t speed);
+uint32_t* serdes_rel_tx_alloc(uint32_t* seq);
+void serdes_rel_tx_submit(uint32_t len);
+int32_t serdes_rel_tx_submit_addr(uint32_t addr, uint32_t len);
+uint32_t serdes_rel_tx_acked(void);
+void serdes_rel_tx_task(void);
+
+/* RX */
+void serdes_rel_rx_init(uint32_t speed, uint32_t rx_dma0_addr, uint32_t rx_dma1_addr, serdes_rel_handler_t handler);
+void serdes_rel_rx_irq(uint32_t sds_it_status);
+void serdes_rel_rx_set_next(uint32_t addr);
+
+void serdes_rel_stats_get(serdes_rel_stats_t* stats);
+
+/* Benchmark pattern (32bits word[n] = seq + n) */
+void serdes_rel_bench_fill(uint32_t seq, uint32_t* buf, uint32_t len);
+int serdes_rel_bench_check(uint32_t seq, const uint32_t* buf, uint32_t len);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SERDES_REL_H_ */
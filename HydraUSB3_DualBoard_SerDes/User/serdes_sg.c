@@ -0,0 +1,114 @@
+/********************************** (C) COPYRIGHT *******************************
+* File Name          : serdes_sg.c
+* Author             : bvernoux
+* Version            : V1.0
+* Date               : 2026/10/19
+* Description        : SerDes scatter-gather send (list of RAMX fragments
+*                      chained by SERDES_IRQHandler)
+* Copyright (c) 2026 Benjamin VERNOUX
+* SPDX-License-Identifier: Apache-2.0
+*******************************************************************************/
+#include "CH56x_common.h"
+#include "trace.h"
+#include "serdes_sg.h"
+
+volatile uint32_t serdes_sg_tx_done;
+
+/* SERDES_IRQHandler variables */
+static const serdes_sg_t* serdes_sg_list;
+static uint32_t serdes_sg_nb;
+static volatile uint32_t serdes_sg_idx; /* Fragment in progress (serdes_sg_nb = idle) */
+
+/*********************************************************************
+ * @fn      serdes_sg_tx_frag
+ *
+ * @brief   Send fragment serdes_sg_idx
+ *
+ * @return  None
+ */
+static void serdes_sg_tx_frag(void)
+{
+	const serdes_sg_t* sg = &serdes_sg_list[serdes_sg_idx];
+
+	SerDes_DMA_Tx_CFG(sg->addr, sg->len, sg->number);
+	TRACE(SERDES_TX_START, sg->len);
+	SerDes_DMA_Tx();
+}
+
+/*********************************************************************
+ * @fn      serdes_sg_tx
+ *
+ * @brief   Start send of nb_sg fragments (one frame each, see serdes_sg_t)
+ *          SerDes TX shall be initialized (SerDes_Tx_Init()),
+ *          EVENT_SERDES_SG_TX_END is posted at the end
+ *
+ * @param   sg - Fragments list (shall stay valid until EVENT_SERDES_SG_TX_END)
+ * @param   nb_sg - Number of fragments
+ *
+ * @return  0 if send is started else -1 (send in progress or invalid fragment)
+ */
+int serdes_sg_tx(const serdes_sg_t* sg, uint32_t nb_sg)
+{
+	uint32_t i;
+
+	if((nb_sg == 0) || serdes_sg_tx_busy())
+		return -1;
+	for(i = 0; i < nb_sg; i++)
+	{
+		if((sg[i].len == 0) || (sg[i].len > SERDES_SG_MAX_LEN) || (sg[i].len & 3) ||
+		   (sg[i].addr & (SERDES_SG_ALIGN - 1)))
+			return -1;
+	}
+	serdes_sg_list = sg;
+	serdes_sg_nb = nb_sg;
+	serdes_sg_idx = 0;
+	SerDes_ClearIT(SDS_TX_INT_FLG);
+	SerDes_EnableIT(SDS_TX_INT_EN);
+	PFIC_EnableIRQ(INT_ID_SERDES);
+	serdes_sg_tx_frag();
+	return 0;
+}
+
+/*********************************************************************
+ * @fn      serdes_sg_tx_busy
+ *
+ * @brief   Check if a fragments list is being sent
+ *
+ * @return  1 if busy else 0
+ */
+int serdes_sg_tx_busy(void)
+{
+	return (serdes_sg_idx < serdes_sg_nb);
+}
+
+/*********************************************************************
+ * @fn      serdes_sg_tx_irq
+ *
+ * @brief   SerDes TX completion (to be called by SERDES_IRQHandler()),
+ *          send next fragment
+ *
+ * @param   sds_it_status - SerDes_StatusIT()
+ *
+ * @return  None
+ */
+void serdes_sg_tx_irq(uint32_t sds_it_status)
+{
+	if((sds_it_status & SDS_TX_INT_FLG) == 0)
+		return;
+	SerDes_ClearIT(SDS_TX_INT_FLG);
+	if(serdes_sg_idx >= serdes_sg_nb)
+		return;
+	TRACE(SERDES_TX_END, serdes_sg_idx);
+	serdes_sg_idx++;
+	if(serdes_sg_idx < serdes_sg_nb)
+	{
+		serdes_sg_tx_frag();
+	}
+	else
+	{
+		/* SerDes_Wait_Txdone() polls SDS_TX_INT_FLG */
+		SDS->SDS_INT_EN &= ~SDS_TX_INT_EN;
+		serdes_sg_tx_done++;
+		event_post(EVENT_SERDES_SG_TX_END);
+	}
+}
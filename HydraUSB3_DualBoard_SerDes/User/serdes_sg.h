@@ -0,0 +1,54 @@
+/********************************** (C) COPYRIGHT *******************************
+* File Name          : serdes_sg.h
+* Author             : bvernoux
+* Version            : V1.0
+* Date               : 2026/10/19
+* Description        : SerDes scatter-gather send (list of RAMX fragments
+*                      chained by SERDES_IRQHandler)
+* Copyright (c) 2026 Benjamin VERNOUX
+* SPDX-License-Identifier: Apache-2.0
+*******************************************************************************/
+#ifndef SERDES_SG_H_
+#define SERDES_SG_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include "event.h"
+
+/*
+ * SerDes DMA sends one contiguous buffer per frame, each fragment of the
+ * list is sent as one frame (for example a protocol header frame then a
+ * payload frame, each in its own RAMX buffer without copy).
+ * SERDES_IRQHandler() shall call serdes_sg_tx_irq(), it points the DMA on
+ * the next fragment at each SerDes TX completion (SDS_TX_INT_FLG) so the
+ * CPU is free (or sleeping in event_wait()) during the whole list.
+ * The list shall stay valid until EVENT_SERDES_SG_TX_END, SerDes TX
+ * interrupt is disabled at the end (SerDes_DMA_Tx()/SerDes_Wait_Txdone()
+ * can be used again).
+ */
+#define EVENT_SERDES_SG_TX_END EVENT_USER(1) // All fragments sent
+
+#define SERDES_SG_ALIGN   (16) // SerDes DMA alignment
+#define SERDES_SG_MAX_LEN (4096) // SerDes max frame size in bytes
+
+typedef struct
+{
+	uint32_t addr; /* Fragment address in RAMX (SERDES_SG_ALIGN aligned) */
+	uint32_t len; /* Fragment length in bytes (multiple of 4, max SERDES_SG_MAX_LEN) */
+	uint32_t number; /* SerDes custom number (28bits, read by RX in SDS_DATA0/1) */
+} serdes_sg_t;
+
+extern volatile uint32_t serdes_sg_tx_done; /* Lists sent */
+
+int serdes_sg_tx(const serdes_sg_t* sg, uint32_t nb_sg);
+int serdes_sg_tx_busy(void);
+void serdes_sg_tx_irq(uint32_t sds_it_status);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SERDES_SG_H_ */
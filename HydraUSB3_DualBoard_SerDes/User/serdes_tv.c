@@ -0,0 +1,49 @@
+/********************************** (C) COPYRIGHT *******************************
+* File Name          : serdes_tv.c
+* Author             : bvernoux
+* Version            : V1.0
+* Date               : 2026/10/19
+* Description        : SerDes TX test vectors (table driven with precomputed
+*                      payloads cached in RAMX)
+* Copyright (c) 2026 Benjamin VERNOUX
+* SPDX-License-Identifier: Apache-2.0
+*******************************************************************************/
+#include "CH56x_common.h"
+#include "fastmem.h"
+#include "serdes_tv.h"
+
+/*******************************************************************************
+ * @fn     serdes_tv_init
+ *
+ * @brief  Precompute all test vectors payloads in pool (done once at startup)
+ *         and set addr of each test vector, the sender then just need to
+ *         configure SerDes DMA with addr/size (no fill before each send)
+ *
+ * @param  tv: Test vectors table
+ * @param  nb_tv: Number of test vectors in table
+ * @param  pool: Payloads pool (in RAMX, SERDES_TV_ALIGN bytes aligned)
+ * @param  pool_size: Size of payloads pool in bytes
+ *
+ * @return Number of bytes used in pool or -1 if pool is too small
+ */
+int serdes_tv_init(serdes_tv_t* tv, int nb_tv, uint8_t* pool, uint32_t pool_size)
+{
+	int n;
+	uint32_t offset = 0;
+
+	for(n = 0; n < nb_tv; n++)
+	{
+		uint32_t* payload;
+
+		if((offset + tv[n].size) > pool_size)
+			return -1;
+		payload = (uint32_t*)&pool[offset];
+		if(tv[n].kind == SERDES_TV_INC)
+			fastmem_fill_inc32(payload, tv[n].seed, tv[n].inc, (tv[n].size / 4));
+		else
+			fastmem_set32(payload, tv[n].seed, (tv[n].size / 4));
+		tv[n].addr = (uint32_t)payload;
+		offset += (tv[n].size + (SERDES_TV_ALIGN - 1)) & ~(SERDES_TV_ALIGN - 1);
+	}
+	return offset;
+}
@@ -0,0 +1,45 @@
+/********************************** (C) COPYRIGHT *******************************
+* File Name          : serdes_tv.h
+* Author             : bvernoux
+* Version            : V1.0
+* Date               : 2026/10/19
+* Description        : SerDes TX test vectors (table driven with precomputed
+*                      payloads cached in RAMX)
+* Copyright (c) 2026 Benjamin VERNOUX
+* SPDX-License-Identifier: Apache-2.0
+*******************************************************************************/
+#ifndef SERDES_TV_H_
+#define SERDES_TV_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+
+typedef enum
+{
+	SERDES_TV_CONST = 0, /* All 32bits words = seed */
+	SERDES_TV_INC, /* 32bits word[n] = seed + (n * inc) */
+} e_serdes_tv_kind;
+
+typedef struct
+{
+	uint16_t size; /* Payload size in bytes (multiple of 4, max 4096) */
+	uint8_t kind; /* Pattern kind see e_serdes_tv_kind */
+	uint8_t repeat; /* Number of times the payload is sent */
+	uint32_t seed; /* First 32bits word of the pattern */
+	uint32_t inc; /* Increment between 32bits words (SERDES_TV_INC only) */
+	uint32_t addr; /* Payload address (set by serdes_tv_init()) */
+} serdes_tv_t;
+
+/* Payloads are 16 bytes aligned for SerDes DMA */
+#define SERDES_TV_ALIGN (16)
+
+int serdes_tv_init(serdes_tv_t* tv, int nb_tv, uint8_t* pool, uint32_t pool_size);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SERDES_TV_H_ */
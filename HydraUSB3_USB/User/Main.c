@@ -18,6 +18,17 @@
 #include "CH56x_usb_devbulk_desc_cmd.h"
 
 #include "hydrausb3_usb_devbulk_vid_pid.h"
+#include "bootprof.h"
+#include "clkgov.h"
+#include "crashdump.h"
+#include "event.h"
+#include "irqprio.h"
+#include "memuse.h"
+#include "trace.h"
+#include "usb_stream.h"
+#include "usb_fwupd.h"
+#include "usb_speed.h"
+#include "soak.h"
 
 #undef FREQ_SYS
 /* System clock / MCU frequency in Hz */
@@ -31,6 +42,14 @@
 #define UART1_BAUD (5000000) // Real baud rate is round to 5Mbauds (For Fsys 120MHz) => Requires USB2HS Serial like FTDI C232HM-DDHSL-0
 #endif
 
+/* Clock governor: FREQ_SYS when USB is used else CLKGOV_FREQ_LOW (see clkgov.h),
+ * enabled with -DCLK_GOVERNOR=1 in Makefile DEFINE_OPTS (also used by usb_cmd.c) */
+#if(defined CLK_GOVERNOR) && (defined DEBUG)
+#define CLK_GOVERNOR_UART1_BAUD (UART1_BAUD) // Shall be reachable at CLKGOV_FREQ_LOW
+#else
+#define CLK_GOVERNOR_UART1_BAUD (0)
+#endif
+
 /* Blink time in ms */
 #define BLINK_FAST (50) // Blink LED each 100ms (50*2)
 
@@ -39,7 +58,8 @@
 
 int blink_ms = BLINK_USB2;
 
-debug_log_buf_t log_buf;
+/* In RAMX (not initialized, cleared before log_init()) to keep RAM for stack */
+debug_log_buf_t log_buf __attribute__((section(".DMADATA")));
 
 /* FLASH_ROMA Read Unique ID (8bytes/64bits) */
 #define FLASH_ROMA_UID_ADDR (0x77fe4)
@@ -52,6 +72,76 @@ usb_descriptor_usb_vid_pid_t vid_pid =
 	.pid = USB_PID
 };
 
+/*********************************************************************
+ * @fn      main_usb_bootprof
+ *
+ * @brief   Boot profile of first USB link training/enumeration
+ *          Called after each wake-up (event_set_wake_hook()) so the state
+ *          changed by USB IRQ is stamped at the end of this IRQ, even while
+ *          the main loop is blinking the LED
+ *
+ * @return  none
+ */
+static void main_usb_bootprof(void)
+{
+	if(g_DeviceConnectstatus != 0)
+	{
+		bootprof_end(BOOTPROF_USB_LINK);
+		bootprof_begin(BOOTPROF_USB_ENUM);
+	}
+	if((g_DeviceConnectstatus == USB_INT_CONNECT_ENUM) &&
+			((g_DeviceUsbType == USB_U20_SPEED) || (g_DeviceUsbType == USB_U30_SPEED)))
+	{
+		bootprof_end(BOOTPROF_USB_ENUM);
+		event_set_wake_hook(NULL); // Only first link training/enumeration is recorded
+	}
+}
+
+/*********************************************************************
+ * @fn      main_sleep_ms
+ *
+ * @brief   Sleep ms while processing Endpoint2 stream events
+ *          (firmware update chunks are programmed and ring benchmark
+ *          buffers are refilled/released during LED blink)
+ *
+ * @return  none
+ */
+static void main_sleep_ms(uint32_t ms)
+{
+	uint32_t events;
+
+	event_timer_start(ms);
+	do
+	{
+		events = event_wait(EVENT_TIMER | EVENT_USB_STREAM);
+		if(events & EVENT_USB_STREAM)
+		{
+			usb_fwupd_task();
+			usb_stream_ring_task();
+		}
+	} while((events & EVENT_TIMER) == 0);
+}
+
+#ifdef CLK_GOVERNOR
+/*********************************************************************
+ * @fn      main_clkgov_task
+ *
+ * @brief   CLKGOV_FREQ_LOW after CLKGOV_IDLE_MS without command, the
+ *          clock is kept at FREQ_SYS while an Endpoint2 stream or a
+ *          firmware update is running (the host may send no command
+ *          meanwhile)
+ *
+ * @return  none
+ */
+static void main_clkgov_task(void)
+{
+	if((usb_stream.mode != USB_STREAM_IDLE) || fwupd_busy())
+		clkgov_activity(); // Idle time restarts at end of stream
+	else
+		clkgov_task();
+}
+#endif
+
 /*********************************************************************
  * @fn      main
  *
@@ -63,22 +153,46 @@ int main()
 {
 
 	int old_DeviceUsbType = -1;
+
+	/* Paint free RAM and stack for stack high-water mark (see memuse.h) */
+	memuse_stack_paint();
 	/* HydraUSB3 configure GPIO In/Out */
 	bsp_gpio_init();
 
 	/* Init BSP (MCU Frequency & SysTick) */
 	bsp_init(FREQ_SYS);
+	/* Boot profile time reference (SysTick started by bsp_init()) */
+	bootprof_init();
+	bootprof_begin(BOOTPROF_LOG_INIT);
+	memset(&log_buf, 0, sizeof(log_buf));
 	log_init(&log_buf);
+	bootprof_end(BOOTPROF_LOG_INIT);
 
 #if(defined DEBUG)
 	/* Configure serial debugging for printf()/log_printf()... */
 	UART1_init(UART1_BAUD, FREQ_SYS);
 #endif
 	log_printf("Start\n");
+	/* Crash snapshot of previous run retained in RAMX (see USB_CMD_CRSH) */
+	crashdump_init();
+	/* Init event dispatcher (main loop sleep with WFI between events) */
+	event_init();
+	/* Init trace points backends (see trace.h) */
+	trace_init();
+	/* Interrupts priority map with preemption (see irqprio.h) */
+	irqprio_init();
+#ifdef CLK_GOVERNOR
+	/* Full speed until USB is enumerated then CLKGOV_FREQ_LOW when idle (see USB_CMD_CLKG) */
+	clkgov_init(FREQ_SYS, CLKGOV_FREQ_LOW, CLKGOV_IDLE_MS, CLK_GOVERNOR_UART1_BAUD);
+#endif
+	/* Soak test statistics of Endpoint2 ring benchmark (see USB_CMD_SOAK) */
+	soak_init(0);
 	log_printf("ChipID(Hex)=%02X\n", R8_CHIP_ID);
 
 	memset(&unique_id, 0, 8);
+	bootprof_begin(BOOTPROF_UID_READ);
 	FLASH_ROMA_READ(FLASH_ROMA_UID_ADDR, (uint32_t*)&unique_id, 8);
+	bootprof_end(BOOTPROF_UID_READ);
 	log_printf("FLASH_ROMA_UID(Hex)=%02X %02X %02X %02X %02X %02X %02X %02X\n",
 			   unique_id.sn_8b[0], unique_id.sn_8b[1], unique_id.sn_8b[2], unique_id.sn_8b[3],
 			   unique_id.sn_8b[4], unique_id.sn_8b[5], unique_id.sn_8b[6], unique_id.sn_8b[7]);
@@ -94,16 +208,23 @@ int main()
 
 	PFIC_EnableIRQ(TMR0_IRQn);
 	R8_TMR0_INTER_EN = RB_TMR_IE_CYC_END;
-	TMR0_TimerInit(67000000); // USB3.0 connection failure timeout about 0.56 seconds
+	/* USB3.0 connection failure timeout about 0.56 seconds or shorter if last boot enumerated in USB2 */
+	TMR0_TimerInit(usb_speed_init());
 
+	bootprof_begin(BOOTPROF_USB_DESC);
 	/* USB Descriptor set String Serial Number with CH569 Unique ID */
 	usb_descriptor_set_string_serial_number(&unique_id);
 
 	/* USB Descriptor set USB VID/PID */
 	usb_descriptor_set_usb_vid_pid(&vid_pid);
+	bootprof_end(BOOTPROF_USB_DESC);
 
 	/* USB3.0 initialization, make sure that the two USB3.0 interrupts are enabled before initialization */
+	bootprof_begin(BOOTPROF_USB30D_INIT);
 	USB30D_init(ENABLE);
+	bootprof_end(BOOTPROF_USB30D_INIT);
+	bootprof_begin(BOOTPROF_USB_LINK);
+	event_set_wake_hook(main_usb_bootprof);
 
 	// Infinite loop USB2/USB3 managed with Interrupt
 	while(1)
@@ -112,9 +233,9 @@ int main()
 		{
 			blink_ms = BLINK_FAST;
 			bsp_uled_on();
-			bsp_wait_ms_delay(blink_ms);
+			main_sleep_ms(blink_ms);
 			bsp_uled_off();
-			bsp_wait_ms_delay(blink_ms);
+			main_sleep_ms(blink_ms);
 		}
 		else
 		{
@@ -126,14 +247,24 @@ int main()
 					{
 						if(g_DeviceUsbType != old_DeviceUsbType)
 						{
+							if(old_DeviceUsbType < 0) // First enumeration
+							{
+								main_usb_bootprof();
+								bootprof_log();
+								memuse_log();
+							}
 							old_DeviceUsbType = g_DeviceUsbType;
 							log_printf("USB2\n");
+							usb_speed_enumerated(USB_SPEED_USB2);
 						}
+#ifdef CLK_GOVERNOR
+						main_clkgov_task();
+#endif
 						blink_ms = BLINK_USB2;
 						bsp_uled_on();
-						bsp_wait_ms_delay(blink_ms);
+						main_sleep_ms(blink_ms);
 						bsp_uled_off();
-						bsp_wait_ms_delay(blink_ms);
+						main_sleep_ms(blink_ms);
 					}
 					break;
 
@@ -141,24 +272,42 @@ int main()
 					{
 						if(g_DeviceUsbType != old_DeviceUsbType)
 						{
+							if(old_DeviceUsbType < 0) // First enumeration
+							{
+								main_usb_bootprof();
+								bootprof_log();
+								memuse_log();
+							}
 							old_DeviceUsbType = g_DeviceUsbType;
 							log_printf("USB3\n");
+							usb_speed_enumerated(USB_SPEED_USB3);
 						}
+#ifdef CLK_GOVERNOR
+						main_clkgov_task();
+#endif
 						blink_ms = BLINK_USB3;
 						bsp_uled_on();
-						bsp_wait_ms_delay(blink_ms);
+						main_sleep_ms(blink_ms);
 						bsp_uled_off();
-						bsp_wait_ms_delay(blink_ms);
+						main_sleep_ms(blink_ms);
 					}
 					break;
 
 					default:
+#ifdef CLK_GOVERNOR
+						clkgov_activity(); // Full speed for USB link training/enumeration
+#endif
 						bsp_uled_on(); // LED is steady until USB3 SS or USB2 HS is ready
+						event_idle(); // Wait next USB interrupt
 				}
 			}
 			else
 			{
+#ifdef CLK_GOVERNOR
+				clkgov_activity(); // Full speed for USB link training/enumeration
+#endif
 				bsp_uled_on(); // LED is steady until USB3 SS or USB2 HS is ready
+				event_idle(); // Wait next USB interrupt
 			}
 		}
 	}
@@ -167,16 +316,22 @@ int main()
 /*********************************************************************
  * @fn      HardFault_Handler
  *
- * @brief   Example of basic HardFault Handler called if an exception occurs
+ * @brief   Save crash snapshot (retained in RAMX, read after reboot with
+ *          USB_CMD_CRSH) and reset
  *
  * @return  none
  */
 __attribute__((interrupt("WCH-Interrupt-fast"))) void HardFault_Handler(void)
 {
-	printf("HardFault\n");
-	printf(" SP=0x%08X\n", __get_SP());
-	printf(" MIE=0x%08X\n", __get_MIE());
-	printf(" MSTATUS=0x%08X\n", __get_MSTATUS());
-	printf(" MCAUSE=0x%08X\n", __get_MCAUSE());
-	bsp_wait_ms_delay(1);
+	crashdump_regs_t regs;
+
+	__asm volatile("mv %0, ra" : "=r"(regs.ra)); // Before any call
+	__asm volatile("csrr %0, mepc" : "=r"(regs.mepc));
+	__asm volatile("csrr %0, mtval" : "=r"(regs.mtval));
+	regs.mcause = __get_MCAUSE();
+	regs.mstatus = __get_MSTATUS();
+	regs.mie = __get_MIE();
+	regs.sp = __get_SP();
+	crashdump_save(&regs);
+	SYS_ResetExecute();
 }
@@ -0,0 +1,130 @@
+/********************************** (C) COPYRIGHT *******************************
+* File Name          : crashdump.c
+* Author             : bvernoux
+* Version            : V1.0
+* Date               : 2026/10/19
+* Description        : Crash snapshot (registers, last trace entries/logs and
+*                      performance counters) retained in RAMX across reset
+* Copyright (c) 2026 Benjamin VERNOUX
+* SPDX-License-Identifier: Apache-2.0
+*******************************************************************************/
+#include <stddef.h>
+
+#include "CH56x_common.h"
+#include "CH56x_debug_log.h"
+#include "crc32.h"
+#include "fastmem.h"
+#include "crashdump.h"
+
+/* In RAMX CRASHDUMP region (NOLOAD, see .ld) to survive SYS_ResetExecute() */
+static crashdump_t crashdump __attribute__((section(".crashdump")));
+
+extern debug_log_buf_t log_buf;
+
+static uint32_t crashdump_crc(void)
+{
+	return crc32c_update(0, &crashdump, offsetof(crashdump_t, crc));
+}
+
+/*******************************************************************************
+ * @fn     crashdump_ring
+ *
+ * @brief  Copy Endpoint2 ring counters (without usb_ring_stats_get() which
+ *         restarts the throughput measurement)
+ *
+ * @return None
+ */
+static void crashdump_ring(const usb_ring_t* ring, usb_ring_stats_t* stats)
+{
+	stats->nb_xfer = ring->nb_xfer;
+	stats->nb_stall = ring->nb_stall;
+	stats->nb_bytes = ring->nb_bytes;
+	stats->kbps = 0;
+	stats->depth_min = ring->depth_min;
+	stats->period_min = ring->period_min;
+	stats->period_max = ring->period_max;
+	stats->nb_crc_err = ring->nb_crc_err;
+}
+
+/*******************************************************************************
+ * @fn     crashdump_init
+ *
+ * @brief  Check the snapshot of previous run (cleared if not valid) and log
+ *         it (shall be called after log_init())
+ *
+ * @return None
+ */
+void crashdump_init(void)
+{
+	if((crashdump.magic != CRASHDUMP_MAGIC) || (crashdump.size != sizeof(crashdump_t)) ||
+	   (crashdump.crc != crashdump_crc()))
+	{
+		fastmem_set(&crashdump, 0, sizeof(crashdump_t)); // Power-on or other firmware layout
+		return;
+	}
+	log_printf("Crash snapshot nb_crash=%d uptime=%dms MCAUSE=0x%08X MEPC=0x%08X MTVAL=0x%08X\n",
+			   crashdump.nb_crash, crashdump.uptime_ms, crashdump.regs.mcause,
+			   crashdump.regs.mepc, crashdump.regs.mtval);
+}
+
+/*******************************************************************************
+ * @fn     crashdump_save
+ *
+ * @brief  Write the snapshot (called by HardFault_Handler() before reset,
+ *         interrupts disabled)
+ *
+ * @param  regs: Registers read at HardFault_Handler() entry
+ *
+ * @return None
+ */
+void crashdump_save(const crashdump_regs_t* regs)
+{
+	uint32_t idx;
+	uint32_t len;
+
+	if(crashdump.magic != CRASHDUMP_MAGIC)
+		crashdump.nb_crash = 0; // No snapshot since last clear
+	crashdump.magic = CRASHDUMP_MAGIC;
+	crashdump.size = sizeof(crashdump_t);
+	crashdump.nb_crash++;
+	crashdump.nbtick_1us = bsp_get_nbtick_1us();
+	crashdump.uptime_ms = (uint32_t)((0 - bsp_get_SysTickCNT()) / crashdump.nbtick_1us / 1000); // SysTick count down
+	crashdump.ts = bsp_get_SysTickCNT_LSB();
+	crashdump.regs = *regs;
+	event_stats_get(&crashdump.event);
+	irqprio_stats_get(&crashdump.irq);
+	crashdump_ring(&usb_ring_in, &crashdump.ring[0]);
+	crashdump_ring(&usb_ring_out, &crashdump.ring[1]);
+	crashdump.nb_trace = trace_ring_last(crashdump.trace, CRASHDUMP_TRACE_NB);
+	idx = log_buf.idx;
+	if(idx > sizeof(log_buf.buf))
+		idx = sizeof(log_buf.buf); // Corrupted index
+	len = (idx > CRASHDUMP_LOG_SIZE) ? CRASHDUMP_LOG_SIZE : idx;
+	fastmem_cpy(crashdump.log, &log_buf.buf[idx - len], len);
+	crashdump.log_len = len;
+	crashdump.crc = crashdump_crc();
+}
+
+/*******************************************************************************
+ * @fn     crashdump_get
+ *
+ * @brief  Copy the snapshot (magic = 0 if no crash since last clear)
+ *
+ * @return None
+ */
+void crashdump_get(crashdump_t* dump)
+{
+	fastmem_cpy(dump, &crashdump, sizeof(crashdump_t));
+}
+
+/*******************************************************************************
+ * @fn     crashdump_clear
+ *
+ * @brief  Clear the snapshot (nb_crash restarts at next crash)
+ *
+ * @return None
+ */
+void crashdump_clear(void)
+{
+	fastmem_set(&crashdump, 0, sizeof(crashdump_t));
+}
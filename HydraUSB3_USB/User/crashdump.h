@@ -0,0 +1,83 @@
+/********************************** (C) COPYRIGHT *******************************
+* File Name          : crashdump.h
+* Author             : bvernoux
+* Version            : V1.0
+* Date               : 2026/10/19
+* Description        : Crash snapshot (registers, last trace entries/logs and
+*                      performance counters) retained in RAMX across reset
+* Copyright (c) 2026 Benjamin VERNOUX
+* SPDX-License-Identifier: Apache-2.0
+*******************************************************************************/
+#ifndef CRASHDUMP_H_
+#define CRASHDUMP_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include "event.h"
+#include "irqprio.h"
+#include "trace.h"
+#include "usb_ring.h"
+
+/*
+ * HardFault_Handler() writes the snapshot with crashdump_save() then resets
+ * the MCU with SYS_ResetExecute(), the snapshot is in .crashdump section
+ * placed in the fixed CRASHDUMP region at the end of RAMX (NOLOAD, see .ld)
+ * so it survives the reset (not a power cycle) and its address does not
+ * change when other RAMX variables are added (read only for USB_CMD_MEMW).
+ * At boot crashdump_init() keeps it only if magic, size (layout) and CRC32C
+ * are valid, it is read with USB_CMD_CRSH until cleared by host and a new
+ * crash overwrites it (nb_crash counts crashes since last clear).
+ * - trace: last CRASHDUMP_TRACE_NB entries of trace RAM ring (oldest first,
+ *   also entries already read with USB_CMD_TRCE, none if no trace point uses
+ *   TRACE_RING)
+ * - log: last CRASHDUMP_LOG_SIZE bytes of logs not yet read with USB_CMD_LOGR
+ */
+#define CRASHDUMP_MAGIC (0x43525348) // CRSH
+#define CRASHDUMP_TRACE_NB (32)
+#define CRASHDUMP_LOG_SIZE (1024)
+
+typedef struct
+{
+	uint32_t mcause; /* Exception cause */
+	uint32_t mepc; /* Faulting instruction address */
+	uint32_t mtval; /* Faulting address or instruction */
+	uint32_t mstatus;
+	uint32_t mie;
+	uint32_t sp; /* HardFault_Handler() stack pointer */
+	uint32_t ra; /* Return address of interrupted code (read at HardFault_Handler() entry) */
+} crashdump_regs_t;
+
+typedef struct
+{
+	uint32_t magic; /* CRASHDUMP_MAGIC (0 if no snapshot) */
+	uint32_t size; /* sizeof(crashdump_t) */
+	uint32_t nb_crash; /* Crashes since last clear */
+	uint32_t uptime_ms; /* Time since SysTick start at crash */
+	uint32_t nbtick_1us; /* SysTick ticks per us (trace timestamps and cycles) */
+	crashdump_regs_t regs;
+	/* Performance counters */
+	event_stats_t event; /* Main loop idle and wake-up latency */
+	irqprio_stats_t irq; /* Interrupts count/duration/latency */
+	usb_ring_stats_t ring[2]; /* Endpoint2 ring IN then OUT (kbps = 0, min/max since last USB_CMD_STRS) */
+	/* Last trace entries and logs */
+	uint32_t ts; /* SysTick (LSB) at crash, trace entries time reference */
+	uint32_t nb_trace;
+	trace_entry_t trace[CRASHDUMP_TRACE_NB];
+	uint32_t log_len;
+	char log[CRASHDUMP_LOG_SIZE];
+	uint32_t crc; /* CRC32C of all previous fields */
+} crashdump_t;
+
+void crashdump_init(void);
+void crashdump_save(const crashdump_regs_t* regs);
+void crashdump_get(crashdump_t* dump);
+void crashdump_clear(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CRASHDUMP_H_ */
@@ -0,0 +1,236 @@
+/********************************** (C) COPYRIGHT *******************************
+* File Name          : fwupd.c
+* Author             : bvernoux
+* Version            : V1.0
+* Date               : 2026/10/19
+* Description        : Firmware update pipeline (erase/program on the fly in
+*                      a staging area, CRC32 verify then install), independent
+*                      of USB and of flash backend (can be built on host with
+*                      FWUPD_FLASH_SIM and common/crc32.c see host/tests)
+* Copyright (c) 2026 Benjamin VERNOUX
+* SPDX-License-Identifier: Apache-2.0
+*******************************************************************************/
+#include <stdint.h>
+#include <string.h>
+
+#include "crc32.h"
+#include "fwupd.h"
+
+/* Read back buffer size for verify and install */
+#define FWUPD_VERIFY_BUF_SIZE (256)
+
+static const fwupd_flash_t* fwupd_flash_ptr;
+static fwupd_status_t fwupd_status;
+static uint32_t fwupd_erased_end; /* End address of erased sectors */
+static uint32_t fwupd_start_us;
+static uint32_t fwupd_buf[FWUPD_VERIFY_BUF_SIZE / 4];
+
+/*******************************************************************************
+ * @fn     fwupd_error
+ *
+ * @brief  Set update in error state
+ *
+ * @return -1
+ */
+static int fwupd_error(uint32_t err)
+{
+	fwupd_status.error = err;
+	fwupd_status.state = FWUPD_STATE_ERROR;
+	return -1;
+}
+
+/*******************************************************************************
+ * @fn     fwupd_verify
+ *
+ * @brief  Read back the whole image from flash and check CRC32
+ *
+ * @param  addr: Image address (staging area or installed image)
+ *
+ * @return 0 if success else -1
+ */
+static int fwupd_verify(uint32_t addr)
+{
+	const fwupd_flash_t* flash = fwupd_flash_ptr;
+	uint32_t offset;
+	uint32_t crc = 0;
+	uint32_t t0 = flash->time_us();
+
+	for(offset = 0; offset < fwupd_status.size; offset += FWUPD_VERIFY_BUF_SIZE)
+	{
+		uint32_t n = fwupd_status.size - offset;
+		if(n > FWUPD_VERIFY_BUF_SIZE)
+			n = FWUPD_VERIFY_BUF_SIZE;
+		if(flash->read(addr + offset, (uint8_t*)fwupd_buf, n) != 0)
+			return fwupd_error(FWUPD_ERR_READ);
+		crc = crc32_update(crc, (const uint8_t*)fwupd_buf, n);
+	}
+	fwupd_status.crc_flash = crc;
+	fwupd_status.verify_us += flash->time_us() - t0;
+	fwupd_status.total_us = flash->time_us() - fwupd_start_us;
+	if((fwupd_status.crc_rx != fwupd_status.crc_expected) ||
+			(fwupd_status.crc_flash != fwupd_status.crc_expected))
+	{
+		return fwupd_error(FWUPD_ERR_CRC);
+	}
+	return 0;
+}
+
+/*******************************************************************************
+ * @fn     fwupd_install
+ *
+ * @brief  Copy the verified staging area to the firmware image (the running
+ *         image is only erased once the whole new image is received and
+ *         its CRC32 checked) then verify the installed image
+ *
+ * @return 0 if success else -1
+ */
+static int fwupd_install(void)
+{
+	const fwupd_flash_t* flash = fwupd_flash_ptr;
+	uint32_t offset;
+	uint32_t t0;
+
+	t0 = flash->time_us();
+	for(offset = 0; offset < fwupd_status.size; offset += flash->sector_size)
+	{
+		if(flash->erase(flash->base + offset, flash->sector_size) != 0)
+			return fwupd_error(FWUPD_ERR_ERASE);
+	}
+	fwupd_status.erase_us += flash->time_us() - t0;
+
+	t0 = flash->time_us();
+	for(offset = 0; offset < fwupd_status.size; offset += FWUPD_VERIFY_BUF_SIZE)
+	{
+		uint32_t n = fwupd_status.size - offset;
+		if(n > FWUPD_VERIFY_BUF_SIZE)
+			n = FWUPD_VERIFY_BUF_SIZE;
+		if(flash->read(flash->stage + offset, (uint8_t*)fwupd_buf, n) != 0)
+			return fwupd_error(FWUPD_ERR_READ);
+		if(flash->write(flash->base + offset, (const uint8_t*)fwupd_buf, n) != 0)
+			return fwupd_error(FWUPD_ERR_WRITE);
+	}
+	fwupd_status.write_us += flash->time_us() - t0;
+
+	if(fwupd_verify(flash->base) != 0)
+		return -1;
+	fwupd_status.state = FWUPD_STATE_DONE;
+	return 0;
+}
+
+/*******************************************************************************
+ * @fn     fwupd_start
+ *
+ * @brief  Start a firmware update
+ *
+ * @param  flash: Flash backend
+ * @param  size: Image size in bytes
+ * @param  crc32: Expected image CRC32
+ *
+ * @return 0 if success else -1 (see fwupd_status_t error)
+ */
+int fwupd_start(const fwupd_flash_t* flash, uint32_t size, uint32_t crc32)
+{
+	fwupd_flash_ptr = flash;
+	memset(&fwupd_status, 0, sizeof(fwupd_status));
+	fwupd_status.size = size;
+	fwupd_status.crc_expected = crc32;
+	if((size == 0) || (size > flash->max_size))
+		return fwupd_error(FWUPD_ERR_SIZE);
+	fwupd_erased_end = flash->stage;
+	fwupd_start_us = flash->time_us();
+	fwupd_status.state = FWUPD_STATE_RECEIVING;
+	return 0;
+}
+
+/*******************************************************************************
+ * @fn     fwupd_write
+ *
+ * @brief  Program next image data in staging area (sectors are erased on the
+ *         fly just before to be programmed), after the last data the staging
+ *         area is verified then installed (see fwupd_install())
+ *
+ * @param  data: Image data (32bits aligned)
+ * @param  len: Length in bytes (max FWUPD_CHUNK_SIZE, multiple of 4 except
+ *         for the last chunk)
+ *
+ * @return 0 if success else -1 (see fwupd_status_t error)
+ */
+int fwupd_write(const uint8_t* data, uint32_t len)
+{
+	const fwupd_flash_t* flash = fwupd_flash_ptr;
+	uint32_t addr;
+	uint32_t t0;
+
+	if(fwupd_status.state == FWUPD_STATE_ERROR)
+		return -1; /* Keep first error */
+	if(fwupd_status.state != FWUPD_STATE_RECEIVING)
+		return fwupd_error(FWUPD_ERR_STATE);
+	if(len > (fwupd_status.size - fwupd_status.programmed))
+		len = fwupd_status.size - fwupd_status.programmed;
+	else if((len & 3) && (len < (fwupd_status.size - fwupd_status.programmed)))
+		return fwupd_error(FWUPD_ERR_LEN); // Next chunk would not be 32bits aligned
+
+	addr = flash->stage + fwupd_status.programmed;
+	t0 = flash->time_us();
+	while(fwupd_erased_end < (addr + len))
+	{
+		if(flash->erase(fwupd_erased_end, flash->sector_size) != 0)
+			return fwupd_error(FWUPD_ERR_ERASE);
+		fwupd_erased_end += flash->sector_size;
+	}
+	fwupd_status.erase_us += flash->time_us() - t0;
+
+	t0 = flash->time_us();
+	if(flash->write(addr, data, len) != 0)
+		return fwupd_error(FWUPD_ERR_WRITE);
+	fwupd_status.write_us += flash->time_us() - t0;
+
+	fwupd_status.crc_rx = crc32_update(fwupd_status.crc_rx, data, len);
+	fwupd_status.programmed += len;
+	if(fwupd_status.programmed == fwupd_status.size)
+	{
+		if(fwupd_verify(flash->stage) != 0)
+			return -1; // Running image not modified
+		return fwupd_install();
+	}
+	return 0;
+}
+
+/*******************************************************************************
+ * @fn     fwupd_busy
+ *
+ * @brief  Check if an update is in progress (reboot shall not be done)
+ *
+ * @return 1 if update in progress else 0
+ */
+int fwupd_busy(void)
+{
+	return (fwupd_status.state == FWUPD_STATE_RECEIVING);
+}
+
+/*******************************************************************************
+ * @fn     fwupd_status_get
+ *
+ * @brief  Get a copy of update status
+ *
+ * @return None
+ */
+void fwupd_status_get(fwupd_status_t* status)
+{
+	*status = fwupd_status;
+	if(fwupd_status.state == FWUPD_STATE_RECEIVING)
+		status->total_us = fwupd_flash_ptr->time_us() - fwupd_start_us;
+}
+
+/*******************************************************************************
+ * @fn     fwupd_abort
+ *
+ * @brief  Abort an update started with fwupd_start() (state back to idle,
+ *         flash already programmed is not restored)
+ *
+ * @return None
+ */
+void fwupd_abort(void)
+{
+	fwupd_status.state = FWUPD_STATE_IDLE;
+}
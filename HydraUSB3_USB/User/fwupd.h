@@ -0,0 +1,89 @@
+/********************************** (C) COPYRIGHT *******************************
+* File Name          : fwupd.h
+* Author             : bvernoux
+* Version            : V1.0
+* Date               : 2026/10/19
+* Description        : Firmware update pipeline (erase/program on the fly in
+*                      a staging area, CRC32 verify then install), independent
+*                      of USB and of flash backend (can be built on host with
+*                      FWUPD_FLASH_SIM see host/tests)
+* Copyright (c) 2026 Benjamin VERNOUX
+* SPDX-License-Identifier: Apache-2.0
+*******************************************************************************/
+#ifndef FWUPD_H_
+#define FWUPD_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+
+/* Flash backend */
+typedef struct
+{
+	uint32_t base; /* Firmware image start address */
+	uint32_t stage; /* Staging area start address (max_size bytes, sector aligned) */
+	uint32_t max_size; /* Maximum firmware image size in bytes */
+	uint32_t sector_size; /* Erase sector size in bytes */
+	int (*erase)(uint32_t addr, uint32_t len); /* Return 0 if success */
+	int (*write)(uint32_t addr, const uint8_t* buf, uint32_t len); /* Return 0 if success */
+	int (*read)(uint32_t addr, uint8_t* buf, uint32_t len); /* Return 0 if success */
+	uint32_t (*time_us)(void); /* Free running time in microseconds */
+} fwupd_flash_t;
+
+/* CH569 CodeFlash backend or host simulated backend (FWUPD_FLASH_SIM) see fwupd_flash.c */
+extern const fwupd_flash_t fwupd_flash;
+
+typedef enum
+{
+	FWUPD_STATE_IDLE = 0,
+	FWUPD_STATE_RECEIVING, /* Image data are programmed in staging area as soon as received */
+	FWUPD_STATE_DONE, /* Image verified, installed and verified again (ready for reboot) */
+	FWUPD_STATE_ERROR,
+} e_fwupd_state;
+
+typedef enum
+{
+	FWUPD_ERR_NONE = 0,
+	FWUPD_ERR_SIZE, /* Image size is 0 or too big */
+	FWUPD_ERR_STATE, /* Update not started */
+	FWUPD_ERR_ERASE, /* Flash erase error */
+	FWUPD_ERR_WRITE, /* Flash write error */
+	FWUPD_ERR_READ, /* Flash read error */
+	FWUPD_ERR_CRC, /* CRC32 of data received or read back from flash is not the expected one */
+	FWUPD_ERR_LEN, /* Chunk length not a multiple of 4 bytes (only allowed for last chunk) */
+} e_fwupd_err;
+
+typedef struct
+{
+	uint32_t state; /* see e_fwupd_state */
+	uint32_t error; /* see e_fwupd_err */
+	uint32_t size; /* Image size in bytes */
+	uint32_t crc_expected; /* Expected image CRC32 */
+	uint32_t crc_rx; /* CRC32 of received data */
+	uint32_t crc_flash; /* CRC32 read back from flash (staging area then installed image) */
+	uint32_t programmed; /* Number of bytes programmed */
+	uint32_t erase_us; /* Time spent to erase (staging area and install) */
+	uint32_t write_us; /* Time spent to program (staging area and install) */
+	uint32_t verify_us; /* Time spent to read back/verify (staging area and installed image) */
+	uint32_t total_us; /* Time from fwupd_start() to end of verify */
+} fwupd_status_t;
+
+/*
+ * Maximum data length for each fwupd_write(), each chunk except the last one
+ * shall be a multiple of 4 bytes (32bits flash programming)
+ */
+#define FWUPD_CHUNK_SIZE (4096)
+
+int fwupd_start(const fwupd_flash_t* flash, uint32_t size, uint32_t crc32);
+int fwupd_write(const uint8_t* data, uint32_t len);
+int fwupd_busy(void);
+void fwupd_status_get(fwupd_status_t* status);
+void fwupd_abort(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* FWUPD_H_ */
@@ -0,0 +1,162 @@
+/********************************** (C) COPYRIGHT *******************************
+* File Name          : fwupd_flash.c
+* Author             : bvernoux
+* Version            : V1.0
+* Date               : 2026/10/19
+* Description        : Firmware update flash backends
+*                      - CH569 CodeFlash (default)
+*                      - RAM simulated flash with simulated erase/program
+*                        timings (FWUPD_FLASH_SIM), built on host by
+*                        host/tests to test the update pipeline without board
+* Copyright (c) 2026 Benjamin VERNOUX
+* SPDX-License-Identifier: Apache-2.0
+*******************************************************************************/
+#include <stdint.h>
+#include <string.h>
+
+#include "fwupd.h"
+
+/*
+ * CodeFlash 448K (see .ld):
+ * - 0x00000 220K firmware image (FLASH)
+ * - 0x37000 220K firmware update staging area (FWUPD_STAGE)
+ * - 0x6E000 4K unused
+ * - 0x6F000 4K reserved for usb_speed.c
+ */
+#define FWUPD_FLASH_BASE (0x00000000)
+#define FWUPD_FLASH_STAGE (0x00037000)
+#define FWUPD_FLASH_SIZE (220 * 1024)
+#define FWUPD_FLASH_SECTOR_SIZE (4096)
+
+#if defined(FWUPD_FLASH_SIM)
+
+/* Simulated timings in microseconds */
+#ifndef FWUPD_FLASH_SIM_ERASE_US
+#define FWUPD_FLASH_SIM_ERASE_US (8000) /* Erase of one sector */
+#endif
+#ifndef FWUPD_FLASH_SIM_WRITE_US
+#define FWUPD_FLASH_SIM_WRITE_US (40) /* Program of 256 bytes */
+#endif
+
+/* Firmware image and staging area */
+#define FWUPD_FLASH_SIM_SIZE (FWUPD_FLASH_STAGE + FWUPD_FLASH_SIZE)
+
+static uint8_t fwupd_flash_sim_mem[FWUPD_FLASH_SIM_SIZE];
+static uint32_t fwupd_flash_sim_us; /* Simulated time */
+
+static int fwupd_flash_sim_erase(uint32_t addr, uint32_t len)
+{
+	addr -= FWUPD_FLASH_BASE;
+	if((addr % FWUPD_FLASH_SECTOR_SIZE) || (len % FWUPD_FLASH_SECTOR_SIZE) ||
+			(addr > FWUPD_FLASH_SIM_SIZE) || (len > (FWUPD_FLASH_SIM_SIZE - addr)))
+	{
+		return -1;
+	}
+	memset(&fwupd_flash_sim_mem[addr], 0xFF, len);
+	fwupd_flash_sim_us += (len / FWUPD_FLASH_SECTOR_SIZE) * FWUPD_FLASH_SIM_ERASE_US;
+	return 0;
+}
+
+static int fwupd_flash_sim_write(uint32_t addr, const uint8_t* buf, uint32_t len)
+{
+	uint32_t i;
+
+	addr -= FWUPD_FLASH_BASE;
+	/* Like CodeFlash, program is done by 32bits words */
+	if((addr & 3) || (addr > FWUPD_FLASH_SIM_SIZE) || (len > (FWUPD_FLASH_SIM_SIZE - addr)))
+		return -1;
+	/* Like real flash, program can only clear bits */
+	for(i = 0; i < len; i++)
+		fwupd_flash_sim_mem[addr + i] &= buf[i];
+	fwupd_flash_sim_us += ((len + 255) / 256) * FWUPD_FLASH_SIM_WRITE_US;
+	return 0;
+}
+
+static int fwupd_flash_sim_read(uint32_t addr, uint8_t* buf, uint32_t len)
+{
+	addr -= FWUPD_FLASH_BASE;
+	if((addr > FWUPD_FLASH_SIM_SIZE) || (len > (FWUPD_FLASH_SIM_SIZE - addr)))
+		return -1;
+	memcpy(buf, &fwupd_flash_sim_mem[addr], len);
+	return 0;
+}
+
+static uint32_t fwupd_flash_sim_time_us(void)
+{
+	return fwupd_flash_sim_us;
+}
+
+const fwupd_flash_t fwupd_flash =
+{
+	.base = FWUPD_FLASH_BASE,
+	.stage = FWUPD_FLASH_STAGE,
+	.max_size = FWUPD_FLASH_SIZE,
+	.sector_size = FWUPD_FLASH_SECTOR_SIZE,
+	.erase = fwupd_flash_sim_erase,
+	.write = fwupd_flash_sim_write,
+	.read = fwupd_flash_sim_read,
+	.time_us = fwupd_flash_sim_time_us,
+};
+
+#else /* CH569 CodeFlash */
+
+#include "CH56x_common.h"
+
+/*
+ * At reset the CH569 copies the CodeFlash to its zero wait state code RAM
+ * and executes from it, so the running firmware can overwrite its own image.
+ * It is only erased by fwupd_install() once the new image is fully received
+ * in the staging area and its CRC32 checked (a power loss during the install
+ * itself leaves an incomplete image, to be reprogrammed with WCH ISP).
+ * The new firmware is started by USB_CMD_BOOT (SYS_ResetExecute()).
+ */
+
+static int fwupd_flash_ch56x_erase(uint32_t addr, uint32_t len)
+{
+	return (FLASH_ROMA_ERASE(addr, len) == 0) ? 0 : -1;
+}
+
+/* buf shall be 32bits aligned */
+static int fwupd_flash_ch56x_write(uint32_t addr, const uint8_t* buf, uint32_t len)
+{
+	uint32_t len32 = (len & ~3UL);
+	uint32_t last;
+
+	if(len32 && (FLASH_ROMA_WRITE(addr, (uint32_t*)buf, len32) != 0))
+		return -1;
+	if(len & 3)
+	{
+		/* Last partial word padded with erased value */
+		last = 0xFFFFFFFF;
+		memcpy(&last, &buf[len32], (len & 3));
+		if(FLASH_ROMA_WRITE(addr + len32, &last, 4) != 0)
+			return -1;
+	}
+	return 0;
+}
+
+/* buf shall be 32bits aligned with space for len rounded up to 4 bytes */
+static int fwupd_flash_ch56x_read(uint32_t addr, uint8_t* buf, uint32_t len)
+{
+	FLASH_ROMA_READ(addr, (uint32_t*)buf, ((len + 3) & ~3UL));
+	return 0;
+}
+
+static uint32_t fwupd_flash_ch56x_time_us(void)
+{
+	return (uint32_t)((0 - bsp_get_SysTickCNT()) / bsp_get_nbtick_1us()); // SysTick count down
+}
+
+const fwupd_flash_t fwupd_flash =
+{
+	.base = FWUPD_FLASH_BASE,
+	.stage = FWUPD_FLASH_STAGE,
+	.max_size = FWUPD_FLASH_SIZE,
+	.sector_size = FWUPD_FLASH_SECTOR_SIZE,
+	.erase = fwupd_flash_ch56x_erase,
+	.write = fwupd_flash_ch56x_write,
+	.read = fwupd_flash_ch56x_read,
+	.time_us = fwupd_flash_ch56x_time_us,
+};
+
+#endif
@@ -0,0 +1,235 @@
+/********************************** (C) COPYRIGHT *******************************
+* File Name          : link_usb.c
+* Author             : bvernoux
+* Version            : V1.0
+* Date               : 2026/10/19
+* Description        : USB2 & USB3 Endpoint2 ring as common links
+*                      (IN = TX link, OUT = RX link, see link.h)
+* Copyright (c) 2026 Benjamin VERNOUX
+* SPDX-License-Identifier: Apache-2.0
+*******************************************************************************/
+#include "CH56x_common.h"
+#include "CH56x_usb20_devbulk.h"
+#include "CH56x_usb30_devbulk.h"
+#include "CH56x_usb30_devbulk_LIB.h"
+
+#include "link.h"
+#include "link_usb.h"
+#include "usb_ring.h"
+#include "usb_stream.h"
+
+link_t link_usb_in;
+link_t link_usb_out;
+
+static link_buf_t link_usb_in_desc[USB_RING_NB_BUF]; /* IN ring buffers */
+static link_buf_t* link_usb_in_sent[USB_RING_NB_BUF]; /* Buffer queued in each IN slot */
+static uint32_t link_usb_in_done; /* Next IN slot to release (follows usb_ring_in.q.tail) */
+static link_buf_t link_usb_out_desc[USB_RING_NB_BUF]; /* OUT ring buffers */
+static uint32_t link_usb_out_next; /* Next OUT slot to give (usb_ring_out.q.tail to head) */
+
+static link_bench_t link_usb_bench;
+static uint32_t link_usb_mode; /* USB_STREAM_RING_IN or USB_STREAM_RING_OUT */
+
+/*******************************************************************************
+ * @fn     link_usb_in_tx_alloc
+ *
+ * @brief  Next free Endpoint2 IN ring buffer
+ *
+ * @return Buffer or NULL if all buffers are queued
+ */
+static link_buf_t* link_usb_in_tx_alloc(link_t* link)
+{
+	int32_t slot = spsc_produce_slot(&usb_ring_in.q, USB_RING_NB_BUF);
+	link_buf_t* buf;
+
+	if(slot < 0)
+		return NULL;
+	buf = &link_usb_in_desc[slot];
+	buf->data = usb_ring_in_alloc();
+	buf->len = 0;
+	buf->size = USB_RING_BUF_SIZE;
+	buf->owner = link;
+	return buf;
+}
+
+/*******************************************************************************
+ * @fn     link_usb_in_tx_submit
+ *
+ * @brief  Queue a buffer (ring buffer or buffer of an other link) on
+ *         Endpoint2 IN
+ *
+ * @return LINK_OK or LINK_ERR_XXX
+ */
+static int link_usb_in_tx_submit(link_t* link, link_buf_t* buf)
+{
+	int32_t slot;
+
+	(void)link;
+	if((buf->len == 0) || (buf->len > USB_RING_BUF_SIZE) || ((uint32_t)buf->data & (USB_STREAM_DMA_ALIGN - 1)))
+		return LINK_ERR_BUF;
+	slot = spsc_produce_slot(&usb_ring_in.q, USB_RING_NB_BUF);
+	if(slot < 0)
+		return LINK_ERR_BUSY;
+	link_usb_in_sent[slot] = buf;
+	usb_ring_in_submit_addr((uint32_t)buf->data, buf->len);
+	return LINK_OK;
+}
+
+/*******************************************************************************
+ * @fn     link_usb_in_task
+ *
+ * @brief  Release buffers sent on Endpoint2 IN to their owner
+ *
+ * @return None
+ */
+static void link_usb_in_task(link_t* link)
+{
+	(void)link;
+	while(link_usb_in_done != usb_ring_in.q.tail)
+	{
+		link_release(link_usb_in_sent[SPSC_SLOT(link_usb_in_done, USB_RING_NB_BUF)]);
+		link_usb_in_done++;
+	}
+}
+
+/*******************************************************************************
+ * @fn     link_usb_in_release
+ *
+ * @brief  Endpoint2 IN ring buffer sent (slot already freed by usb_ring)
+ *
+ * @return None
+ */
+static void link_usb_in_release(link_t* link, link_buf_t* buf)
+{
+	(void)link;
+	(void)buf;
+}
+
+/*******************************************************************************
+ * @fn     link_usb_out_rx_get
+ *
+ * @brief  Next received Endpoint2 OUT buffer
+ *
+ * @return Buffer or NULL if nothing received
+ */
+static link_buf_t* link_usb_out_rx_get(link_t* link)
+{
+	uint32_t slot;
+	link_buf_t* buf;
+
+	if(link_usb_out_next == __atomic_load_n(&usb_ring_out.q.head, __ATOMIC_ACQUIRE))
+		return NULL;
+	slot = SPSC_SLOT(link_usb_out_next, USB_RING_NB_BUF);
+	link_usb_out_next++;
+	buf = &link_usb_out_desc[slot];
+	buf->data = usb_ring_out_buf[slot];
+	buf->len = usb_ring_out.len[slot];
+	buf->size = USB_RING_BUF_SIZE;
+	buf->owner = link;
+	return buf;
+}
+
+/*******************************************************************************
+ * @fn     link_usb_out_release
+ *
+ * @brief  Endpoint2 OUT buffer free for reception (oldest one)
+ *
+ * @return None
+ */
+static void link_usb_out_release(link_t* link, link_buf_t* buf)
+{
+	(void)link;
+	(void)buf;
+	usb_ring_out_release();
+}
+
+static link_buf_t* link_usb_no_tx_alloc(link_t* link)
+{
+	(void)link;
+	return NULL;
+}
+
+static int link_usb_no_tx_submit(link_t* link, link_buf_t* buf)
+{
+	(void)link;
+	(void)buf;
+	return LINK_ERR_BUF;
+}
+
+static link_buf_t* link_usb_no_rx_get(link_t* link)
+{
+	(void)link;
+	return NULL;
+}
+
+static const link_ops_t link_usb_in_ops =
+{
+	.name = "USB_EP2_IN",
+	.tx_alloc = link_usb_in_tx_alloc,
+	.tx_submit = link_usb_in_tx_submit,
+	.rx_get = link_usb_no_rx_get,
+	.release = link_usb_in_release,
+	.task = link_usb_in_task,
+};
+
+static const link_ops_t link_usb_out_ops =
+{
+	.name = "USB_EP2_OUT",
+	.tx_alloc = link_usb_no_tx_alloc,
+	.tx_submit = link_usb_no_tx_submit,
+	.rx_get = link_usb_out_rx_get,
+	.release = link_usb_out_release,
+	.task = NULL,
+};
+
+/*******************************************************************************
+ * @fn     link_usb_start
+ *
+ * @brief  Init Endpoint2 links and link benchmark (called by
+ *         usb_stream_ring_start() with USB_STREAM_RING_LINK before the
+ *         ring is started)
+ *
+ * @param  mode: USB_STREAM_RING_IN or USB_STREAM_RING_OUT
+ *
+ * @return None
+ */
+void link_usb_start(uint32_t mode)
+{
+	link_usb_mode = mode;
+	link_usb_in_done = 0;
+	link_usb_out_next = 0;
+	link_init(&link_usb_in, &link_usb_in_ops);
+	link_init(&link_usb_out, &link_usb_out_ops);
+	if(mode == USB_STREAM_RING_IN)
+		link_bench_init(&link_usb_bench, &link_usb_in, USB_RING_BUF_SIZE);
+	else
+		link_bench_init(&link_usb_bench, &link_usb_out, USB_RING_BUF_SIZE);
+}
+
+/*******************************************************************************
+ * @fn     link_usb_bench_task
+ *
+ * @brief  Endpoint2 link benchmark (common link harness, called by
+ *         usb_stream_ring_task())
+ *
+ * @return None
+ */
+void link_usb_bench_task(void)
+{
+	if(link_usb_mode == USB_STREAM_RING_IN)
+		link_bench_tx_task(&link_usb_bench);
+	else
+		link_bench_rx_task(&link_usb_bench);
+}
+
+/*******************************************************************************
+ * @fn     link_usb_bench_log
+ *
+ * @brief  Log Endpoint2 link benchmark result
+ *
+ * @return None
+ */
+void link_usb_bench_log(void)
+{
+	link_bench_log(&link_usb_bench);
+}
@@ -0,0 +1,32 @@
+/********************************** (C) COPYRIGHT *******************************
+* File Name          : link_usb.h
+* Author             : bvernoux
+* Version            : V1.0
+* Date               : 2026/10/19
+* Description        : USB2 & USB3 Endpoint2 ring as common links
+*                      (IN = TX link, OUT = RX link, see link.h)
+* Copyright (c) 2026 Benjamin VERNOUX
+* SPDX-License-Identifier: Apache-2.0
+*******************************************************************************/
+#ifndef LINK_USB_H_
+#define LINK_USB_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include "link.h"
+
+extern link_t link_usb_in; /* Endpoint2 IN (TX) */
+extern link_t link_usb_out; /* Endpoint2 OUT (RX) */
+
+void link_usb_start(uint32_t mode);
+void link_usb_bench_task(void);
+void link_usb_bench_log(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* LINK_USB_H_ */
@@ -13,79 +13,273 @@
 #include "CH56x_usb30_devbulk_LIB.h"
 
 #include "CH56x_debug_log.h"
+#include "bootprof.h"
+#include "clkgov.h"
+#include "crashdump.h"
+#include "event.h"
+#include "fastmem.h"
+#include "memuse.h"
+#include "soak.h"
+#include "trace.h"
 #include "usb_cmd.h"
+#include "usb_fwupd.h"
+#include "usb_speed.h"
+#include "usb_stream.h"
 
 static int usb_cmd_val_last = 0;
 
+/* Define USB_CMD_TX_FULL (1) (in Makefile DEFINE_OPTS) to always send full
+ * DEF_ENDP1_MAX_SIZE answers like older firmware (round-trip latency comparison) */
+
+/* Last/max usb_cmd_rx() execution time in SysTick cycles */
+static uint32_t usb_cmd_cycles_last;
+static uint32_t usb_cmd_cycles_max;
+
 extern debug_log_buf_t log_buf;
-char cmd_usb_info_buf[CMD_USB_INFO_BUF_SIZE+1];
 
 /*******************************************************************************
- * @fn     usb_cmd_rx
+ * @fn     usb_cmd_mem_stream_status
  *
- * @brief  Callback called by USB2 & USB3 endpoint 1
- *         - For USB3 this usb_cmd_rx() is called from IRQ(USBHS_IRQHandler)
- *           with rx_usb_dma_buff containing 4096 bytes (DEF_ENDP1_MAX_SIZE)
- *         - For USB2 this usb_cmd_rx() is called from IRQ USB30_IRQHandler->EP1_OUT_Callback)
- *           with rx_usb_dma_buff containing 4096 bytes (DEF_ENDP1_MAX_SIZE)
+ * @brief  Convert usb_stream_mem_read_start()/usb_stream_mem_write_start()
+ *         return code to USB_CMD_MEM_XXX status
+ *
+ * @return USB_CMD_MEM_XXX status
+ */
+static uint32_t usb_cmd_mem_stream_status(int ret)
+{
+	if(ret == 0)
+		return USB_CMD_MEM_STREAM;
+	else if(ret == -1)
+		return USB_CMD_MEM_ERR_RANGE;
+	return USB_CMD_MEM_ERR_BUSY;
+}
+
+/*******************************************************************************
+ * @fn     usb_cmd_tx_arm
+ *
+ * @brief  Set Endpoint1 IN answer length (short packet ends the transfer)
  *
  * @param  usb_type: USB Type (USB2 HS or USB3 SS)
- * @param  rx_usb_dma_buff: USB RX DMA buffer containing 4096 bytes of data
- *                          Data received from USB
- * @param  tx_usb_dma_buff: USB TX DMA buffer containing 4096 bytes of data
- *                          Data to be transmitted over USB
+ * @param  len: Answer length in bytes (1 to DEF_ENDP1_MAX_SIZE)
  *
  * @return None
  */
-void usb_cmd_rx(e_usb_type usb_type, uint8_t* rx_usb_dma_buff, uint8_t* tx_usb_dma_buff)
+static void usb_cmd_tx_arm(e_usb_type usb_type, uint32_t len)
+{
+#if(defined USB_CMD_TX_FULL)
+	len = DEF_ENDP1_MAX_SIZE;
+#endif
+	if(usb_type == USB_TYPE_USB3)
+	{
+		uint8_t nump = (len + (DEF_ENDP1_MAX_SIZE / DEF_ENDP1_IN_BURST_LEVEL) - 1) / (DEF_ENDP1_MAX_SIZE / DEF_ENDP1_IN_BURST_LEVEL);
+		uint16_t last_len = len - ((nump - 1) * (DEF_ENDP1_MAX_SIZE / DEF_ENDP1_IN_BURST_LEVEL));
+		USB30_IN_set(ENDP_1, ENABLE, ACK, nump, last_len);
+		USB30_send_ERDY(ENDP_1 | IN, nump);
+	}
+	else
+	{
+		R16_UEP1_T_LEN = len;
+		R8_UEP1_TX_CTRL = (R8_UEP1_TX_CTRL & ~RB_UEP_TRES_MASK) | UEP_T_RES_ACK;
+	}
+}
+
+/*******************************************************************************
+ * @fn     usb_cmd_usbs
+ *
+ * @brief  Format USB status string directly in tx_usb_dma_buff
+ *
+ * @return Answer length in bytes (string with end of string)
+ */
+static uint32_t usb_cmd_usbs(e_usb_type usb_type, uint8_t* tx_usb_dma_buff, uint32_t tx_size)
+{
+	char* str = (char*)tx_usb_dma_buff;
+	usb_speed_status_t speed;
+	event_stats_t ev;
+	int len;
+
+	usb_speed_status_get(&speed);
+	event_stats_get(&ev);
+	if(usb_type == USB_TYPE_USB3)
+	{
+		log_printf("cmd USBS USB3\n");
+		len = snprintf(str, tx_size, "USBS USB3:\n"
+				 "LINK_STATUS=0x%08X\n"
+				 "LINK_ERR_STATUS=0x%08X\n"
+				 "LINK_ERR_CNT=0x%08X\n"
+				 "IDLE=%d%%\n"
+				 "WAKE_MODE=%s WAKE_LAT=%d MIN=%d MAX=%d\n"
+				 "CMD_CYCLES=%d MAX=%d\n"
+				 "ENUM_US=%d LAST_SPEED=%d USB3_TIMEOUT_MS=%d\n",
+				 USBSS->LINK_STATUS,
+				 USBSS->LINK_ERR_STATUS,
+				 USBSS->LINK_ERR_CNT,
+				 event_idle_percent(),
+				 EVENT_IDLE_MODE, ev.wake_lat_last, ev.wake_lat_min, ev.wake_lat_max,
+				 usb_cmd_cycles_last, usb_cmd_cycles_max,
+				 speed.enum_us, speed.last_speed, speed.usb3_timeout_ms);
+	}
+	else
+	{
+		log_printf("cmd USBS USB2\n");
+		len = snprintf(str, tx_size, "USBS USB2:\n"
+				 "USB2 SPEED=%d (0=FS,1=HS,2=LS)\n%s\n"
+				 "IDLE=%d%%\n"
+				 "WAKE_MODE=%s WAKE_LAT=%d MIN=%d MAX=%d\n"
+				 "CMD_CYCLES=%d MAX=%d\n"
+				 "ENUM_US=%d LAST_SPEED=%d USB3_TIMEOUT_MS=%d\n",
+				 (R8_USB_SPD_TYPE & RB_USBSPEED_MASK),
+				 ((R8_USB_SPD_TYPE & RB_USBSPEED_MASK) == 1) ? "Test end with success" : "Test failure end with error",
+				 event_idle_percent(),
+				 EVENT_IDLE_MODE, ev.wake_lat_last, ev.wake_lat_min, ev.wake_lat_max,
+				 usb_cmd_cycles_last, usb_cmd_cycles_max,
+				 speed.enum_us, speed.last_speed, speed.usb3_timeout_ms);
+	}
+	if(len < 0)
+	{
+		len = 0;
+		str[0] = 0;
+	}
+	else if((uint32_t)len >= tx_size)
+	{
+		len = tx_size - 1; // String truncated by snprintf()
+	}
+	return (len + 1);
+}
+
+static uint32_t usb_cmd_exec(e_usb_type usb_type, uint8_t* rx_usb_dma_buff, uint32_t rx_len,
+							 uint8_t* tx_usb_dma_buff, uint32_t tx_size);
+
+/*******************************************************************************
+ * @fn     usb_cmd_req_size
+ *
+ * @brief  Minimum request length of a command (request structure read by
+ *         usb_cmd_exec())
+ *
+ * @return Minimum request length in bytes
+ */
+static uint32_t usb_cmd_req_size(uint32_t cmd_val)
+{
+	switch(cmd_val)
+	{
+		case USB_CMD_MEMR:
+		case USB_CMD_MEMW:
+			return sizeof(usb_cmd_mem_req_t);
+		case USB_CMD_FWUP:
+			return sizeof(usb_cmd_fwup_req_t);
+		case USB_CMD_STRM:
+			return sizeof(usb_cmd_strm_req_t);
+		case USB_CMD_BTCH:
+			return sizeof(usb_cmd_btch_t);
+		default: /* Optional request structure (USB_CMD_SOAK, USB_CMD_CRSH) checked by usb_cmd_exec() */
+			return sizeof(uint32_t);
+	}
+}
+
+/*******************************************************************************
+ * @fn     usb_cmd_btch
+ *
+ * @brief  Execute a batch of commands (see usb_cmd_btch_t)
+ *         All answers are written in one answer with same tags as requests,
+ *         execution stops when remaining answer space is less than
+ *         USB_CMD_ANSWER_MIN_SIZE (answer nb_cmd is the number of commands executed)
+ *
+ * @return Answer length in bytes
+ */
+static uint32_t usb_cmd_btch(e_usb_type usb_type, uint8_t* rx_usb_dma_buff, uint32_t rx_len,
+							 uint8_t* tx_usb_dma_buff, uint32_t tx_size)
+{
+	usb_cmd_btch_t* req = (usb_cmd_btch_t*)rx_usb_dma_buff;
+	usb_cmd_btch_t* resp = (usb_cmd_btch_t*)tx_usb_dma_buff;
+	uint32_t rx_pos = sizeof(usb_cmd_btch_t);
+	uint32_t tx_pos = sizeof(usb_cmd_btch_t);
+	uint32_t rx_end = sizeof(usb_cmd_btch_t) + req->len;
+	uint32_t nb_cmd = req->nb_cmd;
+	uint32_t i;
+
+	if(rx_end > rx_len)
+		rx_end = rx_len;
+	for(i = 0; i < nb_cmd; i++)
+	{
+		usb_cmd_tlv_t* rx_tlv = (usb_cmd_tlv_t*)&rx_usb_dma_buff[rx_pos];
+		usb_cmd_tlv_t* tx_tlv = (usb_cmd_tlv_t*)&tx_usb_dma_buff[tx_pos];
+		uint32_t* cmd = (uint32_t*)&rx_tlv[1];
+
+		if(((rx_pos + sizeof(usb_cmd_tlv_t)) > rx_end) ||
+				(rx_tlv->len < sizeof(uint32_t)) ||
+				(rx_tlv->len > (rx_end - rx_pos - sizeof(usb_cmd_tlv_t))))
+		{
+			log_printf("cmd BTCH invalid TLV %d\n", i);
+			break;
+		}
+		if((tx_pos + sizeof(usb_cmd_tlv_t) + USB_CMD_ANSWER_MIN_SIZE) > tx_size)
+			break; // Answer full (remaining commands to be sent again by host)
+		tx_tlv->tag = rx_tlv->tag;
+		if(cmd[0] == USB_CMD_BTCH)
+			tx_tlv->len = 0; // Nested batch not supported
+		else
+			tx_tlv->len = usb_cmd_exec(usb_type, (uint8_t*)cmd, rx_tlv->len, (uint8_t*)&tx_tlv[1],
+									   tx_size - tx_pos - sizeof(usb_cmd_tlv_t));
+		rx_pos += USB_CMD_TLV_SIZE(rx_tlv->len);
+		tx_pos += USB_CMD_TLV_SIZE(tx_tlv->len);
+	}
+	resp->cmd = USB_CMD_BTCH;
+	resp->nb_cmd = i;
+	resp->len = tx_pos - sizeof(usb_cmd_btch_t);
+	return tx_pos;
+}
+
+/*******************************************************************************
+ * @fn     usb_cmd_exec
+ *
+ * @brief  Execute a command and write its answer in tx_usb_dma_buff
+ *
+ * @param  usb_type: USB Type (USB2 HS or USB3 SS)
+ * @param  rx_usb_dma_buff: Command (32bits aligned)
+ * @param  rx_len: Command length in bytes
+ * @param  tx_usb_dma_buff: Answer buffer (32bits aligned)
+ * @param  tx_size: Answer buffer size in bytes (at least USB_CMD_ANSWER_MIN_SIZE)
+ *
+ * @return Answer length in bytes (0 if the command has no answer or is
+ *         shorter than its request structure)
+ */
+static uint32_t usb_cmd_exec(e_usb_type usb_type, uint8_t* rx_usb_dma_buff, uint32_t rx_len,
+							 uint8_t* tx_usb_dma_buff, uint32_t tx_size)
 {
 	uint32_t* cmd = (uint32_t*)(rx_usb_dma_buff);
+	uint32_t cmd_val;
+	uint32_t tx_len = 0;
 
-	uint32_t cmd_val = cmd[0];
+	if(rx_len < sizeof(uint32_t))
+		return 0;
+	cmd_val = cmd[0];
+	if(rx_len < usb_cmd_req_size(cmd_val))
+	{
+		log_printf("CMD 0x%08X truncated (%d bytes)\n", cmd_val, rx_len);
+		return 0;
+	}
 	switch(cmd_val)
 	{
 		case USB_CMD_LOGR:
 		{
+			uint32_t n = log_buf.idx;
 			usb_cmd_val_last = USB_CMD_LOGR;
 			log_printf("cmd LOGR\n");
-			memcpy(tx_usb_dma_buff, log_buf.buf, log_buf.idx); // Copy log_buff to endp1Tbuff for next receive EP1_IN_Callback
-			tx_usb_dma_buff[log_buf.idx] = 0; // Add end of string
-			/* Reset Log buffer index to 0 */
-			log_buf.idx = 0;
+			if(n > (tx_size - 1))
+				n = tx_size - 1; // Remaining logs returned by next LOGR
+			fastmem_cpy(tx_usb_dma_buff, log_buf.buf, n); // Copy log_buff to endp1Tbuff for next receive EP1_IN_Callback
+			tx_usb_dma_buff[n] = 0; // Add end of string
+			tx_len = n + 1;
+			/* Remove returned logs (Reset Log buffer index to 0 if all logs are returned) */
+			if(n < log_buf.idx)
+				fastmem_move(log_buf.buf, &log_buf.buf[n], log_buf.idx - n); // Overlapping regions
+			log_buf.idx -= n;
 		}
 		break;
 
 		case USB_CMD_USBS:
 		{
 			usb_cmd_val_last = USB_CMD_USBS;
-			if(usb_type == USB_TYPE_USB3)
-			{
-				log_printf("cmd USBS USB3\n");
-				snprintf(cmd_usb_info_buf, CMD_USB_INFO_BUF_SIZE, "USBS USB3:\n"
-						 "LINK_STATUS=0x%08X\n"
-						 "LINK_ERR_STATUS=0x%08X\n"
-						 "LINK_ERR_CNT=0x%08X",
-						 USBSS->LINK_STATUS,
-						 USBSS->LINK_ERR_STATUS,
-						 USBSS->LINK_ERR_CNT);
-			}
-			else
-			{
-				log_printf("cmd USBS USB2\n");
-				if((R8_USB_SPD_TYPE & RB_USBSPEED_MASK) == 1)
-				{
-					snprintf(cmd_usb_info_buf, CMD_USB_INFO_BUF_SIZE, "USBS USB2:\n"
-							 "USB2 SPEED=%d (0=FS,1=HS,2=LS)\nTest end with success\n",
-							 (R8_USB_SPD_TYPE & RB_USBSPEED_MASK));
-				}
-				else
-				{
-					snprintf(cmd_usb_info_buf, CMD_USB_INFO_BUF_SIZE, "USBS USB2:\n"
-							 "USB2 SPEED=%d (0=FS,1=HS,2=LS)\nTest failure end with error\n",
-							 (R8_USB_SPD_TYPE & RB_USBSPEED_MASK));
-				}
-			}
-			memcpy(tx_usb_dma_buff, cmd_usb_info_buf, DEF_ENDP1_MAX_SIZE); // Copy cmd_usb_info_buf to endp1Tbuff for next receive EP1_IN_Callback
+			tx_len = usb_cmd_usbs(usb_type, tx_usb_dma_buff, tx_size);
 		}
 		break;
 
@@ -115,11 +309,255 @@ void usb_cmd_rx(e_usb_type usb_type, uint8_t* rx_usb_dma_buff, uint8_t* tx_usb_d
 
 		case USB_CMD_BOOT: /* Reboot (execute reset) */
 		{
+			if(fwupd_busy())
+			{
+				log_printf("cmd BOOT ignored (FWUPD in progress)\n");
+				break;
+			}
 			SYS_ResetExecute();
 		}
 		break;
 
+		case USB_CMD_MEMR: /* Memory Read */
+		{
+			usb_cmd_mem_req_t* req = (usb_cmd_mem_req_t*)rx_usb_dma_buff;
+			usb_cmd_mem_resp_t* resp = (usb_cmd_mem_resp_t*)tx_usb_dma_buff;
+			usb_cmd_val_last = USB_CMD_MEMR;
+			resp->addr = req->addr;
+			resp->len = req->len;
+			if(req->len <= USB_CMD_MEM_EP1_MAX_SIZE)
+			{
+				if(req->len > (tx_size - sizeof(usb_cmd_mem_resp_t)))
+				{
+					resp->status = USB_CMD_MEM_ERR_SIZE; // Batch answer full
+				}
+				else if(usb_stream_mem_access(req->addr, req->len) & USB_STREAM_MEM_RD)
+				{
+					fastmem_cpy(&resp[1], (const void*)req->addr, req->len);
+					resp->status = USB_CMD_MEM_OK;
+				}
+				else
+				{
+					resp->status = USB_CMD_MEM_ERR_RANGE;
+				}
+			}
+			else
+			{
+				resp->status = usb_cmd_mem_stream_status(usb_stream_mem_read_start(usb_type, req->addr, req->len));
+			}
+			if(resp->status >= USB_CMD_MEM_ERR_RANGE)
+				log_printf("cmd MEMR 0x%08X %d Err %d\n", req->addr, req->len, resp->status);
+			tx_len = sizeof(usb_cmd_mem_resp_t);
+			if(resp->status == USB_CMD_MEM_OK)
+				tx_len += req->len;
+		}
+		break;
+
+		case USB_CMD_MEMW: /* Memory Write */
+		{
+			usb_cmd_mem_req_t* req = (usb_cmd_mem_req_t*)rx_usb_dma_buff;
+			usb_cmd_mem_resp_t* resp = (usb_cmd_mem_resp_t*)tx_usb_dma_buff;
+			usb_cmd_val_last = USB_CMD_MEMW;
+			resp->addr = req->addr;
+			resp->len = req->len;
+			if(req->len <= USB_CMD_MEM_EP1_MAX_SIZE)
+			{
+				if(req->len > (rx_len - sizeof(usb_cmd_mem_req_t)))
+				{
+					resp->status = USB_CMD_MEM_ERR_SIZE; // Data truncated
+				}
+				else if(usb_stream_mem_access(req->addr, req->len) & USB_STREAM_MEM_WR)
+				{
+					fastmem_cpy((void*)req->addr, &req[1], req->len);
+					resp->status = USB_CMD_MEM_OK;
+				}
+				else
+				{
+					resp->status = USB_CMD_MEM_ERR_RANGE;
+				}
+			}
+			else
+			{
+				resp->status = usb_cmd_mem_stream_status(usb_stream_mem_write_start(usb_type, req->addr, req->len));
+			}
+			if(resp->status >= USB_CMD_MEM_ERR_RANGE)
+				log_printf("cmd MEMW 0x%08X %d Err %d\n", req->addr, req->len, resp->status);
+			tx_len = sizeof(usb_cmd_mem_resp_t);
+		}
+		break;
+
+		case USB_CMD_FWUP: /* Firmware Update start */
+		{
+			usb_cmd_fwup_req_t* req = (usb_cmd_fwup_req_t*)rx_usb_dma_buff;
+			usb_cmd_fwup_resp_t* resp = (usb_cmd_fwup_resp_t*)tx_usb_dma_buff;
+			int ret;
+			usb_cmd_val_last = USB_CMD_FWUP;
+			log_printf("cmd FWUP size=%d CRC32=0x%08X\n", req->size, req->crc32);
+			ret = usb_fwupd_start(usb_type, req->size, req->crc32);
+			if(ret == 0)
+				resp->status = USB_CMD_FWUP_OK;
+			else if(ret == -1)
+				resp->status = USB_CMD_FWUP_ERR_SIZE;
+			else
+				resp->status = USB_CMD_FWUP_ERR_BUSY;
+			tx_len = sizeof(usb_cmd_fwup_resp_t);
+		}
+		break;
+
+		case USB_CMD_BTCH: /* Batch of commands */
+		{
+			usb_cmd_val_last = USB_CMD_BTCH;
+			tx_len = usb_cmd_btch(usb_type, rx_usb_dma_buff, rx_len, tx_usb_dma_buff, tx_size);
+		}
+		break;
+
+		case USB_CMD_STRM: /* Endpoint2 ring benchmark start/stop */
+		{
+			usb_cmd_strm_req_t* req = (usb_cmd_strm_req_t*)rx_usb_dma_buff;
+			usb_cmd_strm_resp_t* resp = (usb_cmd_strm_resp_t*)tx_usb_dma_buff;
+			usb_cmd_val_last = USB_CMD_STRM;
+			log_printf("cmd STRM mode=%d flags=0x%X\n", req->mode, req->flags);
+			resp->status = -usb_stream_ring_start(usb_type, req->mode, req->flags);
+			tx_len = sizeof(usb_cmd_strm_resp_t);
+		}
+		break;
+
+		case USB_CMD_STRS: /* Endpoint2 ring statistics */
+		{
+			usb_ring_stats_t* stats = (usb_ring_stats_t*)tx_usb_dma_buff;
+			usb_cmd_val_last = USB_CMD_STRS;
+			usb_ring_stats_get(&usb_ring_in, &stats[0]);
+			usb_ring_stats_get(&usb_ring_out, &stats[1]);
+			tx_len = 2 * sizeof(usb_ring_stats_t);
+		}
+		break;
+
+		case USB_CMD_FWST: /* Firmware Update status */
+		{
+			usb_cmd_val_last = USB_CMD_FWST;
+			fwupd_status_get((fwupd_status_t*)tx_usb_dma_buff);
+			tx_len = sizeof(fwupd_status_t);
+		}
+		break;
+
+		case USB_CMD_BPRF: /* Boot phases timing profile */
+		{
+			usb_cmd_val_last = USB_CMD_BPRF;
+			if(sizeof(bootprof_t) <= tx_size) // Else no answer (remaining USB_CMD_BTCH space too small)
+			{
+				bootprof_get((bootprof_t*)tx_usb_dma_buff);
+				tx_len = sizeof(bootprof_t);
+			}
+		}
+		break;
+
+		case USB_CMD_SOAK: /* Soak test statistics */
+		{
+			usb_cmd_soak_req_t* req = (usb_cmd_soak_req_t*)rx_usb_dma_buff;
+			usb_cmd_val_last = USB_CMD_SOAK;
+			if((rx_len >= sizeof(usb_cmd_soak_req_t)) && (req->fault_every_n != USB_CMD_SOAK_FAULT_KEEP))
+				soak_set_fault(req->fault_every_n);
+			if(sizeof(soak_stats_t) <= tx_size) // Else no answer (remaining USB_CMD_BTCH space too small)
+			{
+				soak_get((soak_stats_t*)tx_usb_dma_buff);
+				tx_len = sizeof(soak_stats_t);
+			}
+		}
+		break;
+
+		case USB_CMD_TRCE: /* Trace RAM ring entries (oldest first, entries which do not fit are returned next time) */
+		{
+			usb_cmd_val_last = USB_CMD_TRCE;
+			tx_len = trace_ring_read(tx_usb_dma_buff, tx_size);
+		}
+		break;
+
+		case USB_CMD_MEMU: /* RAM/RAMX usage and stack high-water mark */
+		{
+			usb_cmd_val_last = USB_CMD_MEMU;
+			memuse_get((memuse_t*)tx_usb_dma_buff);
+			tx_len = sizeof(memuse_t);
+		}
+		break;
+
+		case USB_CMD_CLKG: /* Clock governor statistics */
+		{
+			usb_cmd_val_last = USB_CMD_CLKG;
+			clkgov_stats_get((clkgov_stats_t*)tx_usb_dma_buff);
+			tx_len = sizeof(clkgov_stats_t);
+		}
+		break;
+
+		case USB_CMD_CRSH: /* Crash snapshot retained across reset */
+		{
+			usb_cmd_crsh_req_t* req = (usb_cmd_crsh_req_t*)rx_usb_dma_buff;
+			uint32_t action = USB_CMD_CRSH_GET;
+			usb_cmd_val_last = USB_CMD_CRSH;
+			if(rx_len >= sizeof(usb_cmd_crsh_req_t))
+				action = req->action;
+			if(action == USB_CMD_CRSH_FAULT)
+			{
+#if(defined CRASHDUMP_TEST)
+				log_printf("cmd CRSH fault\n");
+				__asm volatile("unimp"); // Illegal instruction => HardFault_Handler()
+#else
+				log_printf("cmd CRSH fault Err CRASHDUMP_TEST not defined\n");
+				*(uint32_t*)tx_usb_dma_buff = USB_CMD_CRSH_ERR_FAULT;
+				tx_len = sizeof(uint32_t);
+				break;
+#endif
+			}
+			if(sizeof(crashdump_t) <= tx_size) // Else no answer (remaining USB_CMD_BTCH space too small)
+			{
+				crashdump_get((crashdump_t*)tx_usb_dma_buff);
+				tx_len = sizeof(crashdump_t);
+				if(action == USB_CMD_CRSH_CLEAR)
+					crashdump_clear();
+			}
+		}
+		break;
+
 		default:
 			log_printf("CMD UNKN\n");
 	}
+	return tx_len;
+}
+
+/*******************************************************************************
+ * @fn     usb_cmd_rx
+ *
+ * @brief  Callback called by USB2 & USB3 endpoint 1
+ *         - For USB3 this usb_cmd_rx() is called from IRQ(USBHS_IRQHandler)
+ *           with rx_usb_dma_buff containing 4096 bytes (DEF_ENDP1_MAX_SIZE)
+ *         - For USB2 this usb_cmd_rx() is called from IRQ USB30_IRQHandler->EP1_OUT_Callback)
+ *           with rx_usb_dma_buff containing 4096 bytes (DEF_ENDP1_MAX_SIZE)
+ *         The answer is written directly in tx_usb_dma_buff and Endpoint1 IN
+ *         is armed with the answer length (commands without answer keep
+ *         Endpoint1 IN unchanged)
+ *
+ * @param  usb_type: USB Type (USB2 HS or USB3 SS)
+ * @param  rx_usb_dma_buff: USB RX DMA buffer containing 4096 bytes of data
+ *                          Data received from USB
+ * @param  tx_usb_dma_buff: USB TX DMA buffer containing 4096 bytes of data
+ *                          Data to be transmitted over USB
+ *
+ * @return None
+ */
+void usb_cmd_rx(e_usb_type usb_type, uint8_t* rx_usb_dma_buff, uint8_t* tx_usb_dma_buff)
+{
+	uint32_t start;
+	uint32_t tx_len;
+
+#ifdef CLK_GOVERNOR
+	/* Full speed before the command is executed (it can start Endpoint2 stream) */
+	clkgov_activity();
+#endif
+	start = bsp_get_SysTickCNT_LSB();
+	TRACE(USB_CMD, *(uint32_t*)rx_usb_dma_buff);
+	tx_len = usb_cmd_exec(usb_type, rx_usb_dma_buff, DEF_ENDP1_MAX_SIZE, tx_usb_dma_buff, DEF_ENDP1_MAX_SIZE);
+	if(tx_len > 0)
+		usb_cmd_tx_arm(usb_type, tx_len);
+	usb_cmd_cycles_last = start - bsp_get_SysTickCNT_LSB(); // SysTick count down
+	if(usb_cmd_cycles_last > usb_cmd_cycles_max)
+		usb_cmd_cycles_max = usb_cmd_cycles_last;
 }
@@ -15,6 +15,8 @@ extern "C" {
 #endif
 
 #include "CH56x_usb_devbulk_desc_cmd.h"
+#include "fwupd.h"
+#include "usb_ring.h"
 
 /* USB2 or USB3 commands from Host to Device */
 #define USB_CMD_LOGR (0x4C4F4752) // CMD LOGR (Return LOG)
@@ -22,9 +24,174 @@ extern "C" {
 #define USB_CMD_USB2 (0x55534232) // CMD USB2 (Switch to USB2 even if USB3 is available)
 #define USB_CMD_USB3 (0x55534233) // CMD USB3 (Switch to USB3 or do a fall-back to USB2 if not available)
 #define USB_CMD_BOOT (0x424F4F54) // CMD BOOT (Reboot the board)
+#define USB_CMD_MEMR (0x4D454D52) // CMD MEMR (Memory Read see usb_cmd_mem_req_t/usb_cmd_mem_resp_t)
+#define USB_CMD_MEMW (0x4D454D57) // CMD MEMW (Memory Write see usb_cmd_mem_req_t/usb_cmd_mem_resp_t)
+#define USB_CMD_FWUP (0x46575550) // CMD FWUP (Firmware Update start see usb_cmd_fwup_req_t/usb_cmd_fwup_resp_t)
+#define USB_CMD_FWST (0x46575354) // CMD FWST (Firmware Update status see fwupd_status_t)
+#define USB_CMD_BTCH (0x42544348) // CMD BTCH (Batch of commands see usb_cmd_btch_t)
+#define USB_CMD_STRM (0x5354524D) // CMD STRM (Endpoint2 ring benchmark start/stop see usb_cmd_strm_req_t)
+#define USB_CMD_STRS (0x53545253) // CMD STRS (Endpoint2 ring statistics IN & OUT see usb_ring_stats_t)
+#define USB_CMD_BPRF (0x42505246) // CMD BPRF (Boot phases timing profile see bootprof_t)
+#define USB_CMD_SOAK (0x534F414B) // CMD SOAK (Soak test statistics see usb_cmd_soak_req_t/soak_stats_t)
+#define USB_CMD_TRCE (0x54524345) // CMD TRCE (Trace RAM ring entries see trace_dump_t)
+#define USB_CMD_MEMU (0x4D454D55) // CMD MEMU (RAM/RAMX usage by section and stack high-water mark see memuse_t)
+#define USB_CMD_CLKG (0x434C4B47) // CMD CLKG (Clock governor statistics see clkgov_stats_t)
+#define USB_CMD_CRSH (0x43525348) // CMD CRSH (Crash snapshot retained across reset see usb_cmd_crsh_req_t/crashdump_t)
 
-#define CMD_USB_INFO_BUF_SIZE (4096-1) /* Maximum string size */
-extern char cmd_usb_info_buf[CMD_USB_INFO_BUF_SIZE+1];
+/*
+ * USB_CMD_MEMR/USB_CMD_MEMW request (Endpoint1 OUT)
+ * - MEMW: data follows the request (len <= USB_CMD_MEM_EP1_MAX_SIZE)
+ *         or data is sent on Endpoint2 OUT (len > USB_CMD_MEM_EP1_MAX_SIZE)
+ * USB_CMD_MEMR/USB_CMD_MEMW answer (Endpoint1 IN)
+ * - MEMR: data follows the answer (len <= USB_CMD_MEM_EP1_MAX_SIZE)
+ *         or data is sent on Endpoint2 IN (len > USB_CMD_MEM_EP1_MAX_SIZE)
+ *         with status USB_CMD_MEM_STREAM
+ */
+typedef struct
+{
+	uint32_t cmd; /* USB_CMD_MEMR or USB_CMD_MEMW */
+	uint32_t addr; /* Memory start address */
+	uint32_t len; /* Length in bytes */
+} usb_cmd_mem_req_t;
+
+typedef struct
+{
+	uint32_t status; /* USB_CMD_MEM_XXX */
+	uint32_t addr; /* Memory start address */
+	uint32_t len; /* Length in bytes */
+} usb_cmd_mem_resp_t;
+
+#define USB_CMD_MEM_OK        (0) // Data follows the answer(MEMR) or data written(MEMW)
+#define USB_CMD_MEM_STREAM    (1) // Data transfer on Endpoint2 started
+#define USB_CMD_MEM_ERR_RANGE (2) // Invalid memory range or access
+#define USB_CMD_MEM_ERR_BUSY  (3) // Endpoint2 stream already in progress
+#define USB_CMD_MEM_ERR_SIZE  (4) // Data does not fit in USB_CMD_BTCH request/answer
+#define USB_CMD_MEM_ERR_USB2  (5) // Not used (Endpoint2 streams available in USB2 and USB3)
+
+#define USB_CMD_MEM_EP1_MAX_SIZE (DEF_ENDP1_MAX_SIZE - sizeof(usb_cmd_mem_resp_t))
+
+/*
+ * USB_CMD_FWUP request (Endpoint1 OUT)
+ * - Image data (size bytes) are then sent on Endpoint2 OUT, each chunk is
+ *   programmed while next one is received, image is verified with CRC32
+ *   (IEEE 802.3) read back from flash
+ * - Progress/result/timings with USB_CMD_FWST (Endpoint1 IN fwupd_status_t)
+ * - New firmware is started with USB_CMD_BOOT (ignored while update is in progress)
+ */
+typedef struct
+{
+	uint32_t cmd; /* USB_CMD_FWUP */
+	uint32_t size; /* Image size in bytes */
+	uint32_t crc32; /* Image CRC32 */
+} usb_cmd_fwup_req_t;
+
+typedef struct
+{
+	uint32_t status; /* USB_CMD_FWUP_XXX */
+} usb_cmd_fwup_resp_t;
+
+#define USB_CMD_FWUP_OK       (0) // Ready to receive image on Endpoint2 OUT
+#define USB_CMD_FWUP_ERR_SIZE (1) // Invalid image size
+#define USB_CMD_FWUP_ERR_BUSY (2) // Update or Endpoint2 stream already in progress
+#define USB_CMD_FWUP_ERR_USB2 (3) // Not used (Endpoint2 streams available in USB2 and USB3)
+
+/*
+ * USB_CMD_STRM request (Endpoint1 OUT)
+ * - mode USB_STREAM_RING_IN: Endpoint2 IN sends 4KiB buffers continuously
+ * - mode USB_STREAM_RING_OUT: data received on Endpoint2 OUT are dropped
+ * - mode USB_STREAM_IDLE: stop
+ * USB_CMD_STRM answer (Endpoint1 IN) is usb_cmd_strm_resp_t
+ * USB_CMD_STRS answer (Endpoint1 IN) is usb_ring_stats_t IN then usb_ring_stats_t OUT
+ * with throughput measured by the device since previous USB_CMD_STRS
+ */
+typedef struct
+{
+	uint32_t cmd; /* USB_CMD_STRM */
+	uint32_t mode; /* see e_usb_stream_mode */
+	uint32_t flags; /* USB_STREAM_RING_XXX flags */
+} usb_cmd_strm_req_t;
+
+typedef struct
+{
+	uint32_t status; /* 0 success, 1 invalid mode, 2 Endpoint2 stream busy, 3 not available in USB2 */
+} usb_cmd_strm_resp_t;
+
+/*
+ * USB_CMD_SOAK request (Endpoint1 OUT)
+ * - Endpoint2 ring benchmark (USB_CMD_STRM with USB_STREAM_RING_CRC) is
+ *   accounted in soak statistics (counters never reset), OUT buffers CRC
+ *   errors are detected by the device, IN buffers with corrupted CRC
+ *   (fault injection each fault_every_n buffers) shall be detected by host
+ * - fault_every_n = USB_CMD_SOAK_FAULT_KEEP (or request without it) keeps
+ *   actual fault injection period, 0 disables fault injection
+ * USB_CMD_SOAK answer (Endpoint1 IN) is soak_stats_t
+ */
+typedef struct
+{
+	uint32_t cmd; /* USB_CMD_SOAK */
+	uint32_t fault_every_n; /* Fault injection period in buffers */
+} usb_cmd_soak_req_t;
+
+#define USB_CMD_SOAK_FAULT_KEEP (0xFFFFFFFF)
+
+/*
+ * USB_CMD_CRSH request (Endpoint1 OUT) (see crashdump.h)
+ * - action USB_CMD_CRSH_GET (or request without it): return the snapshot
+ * - action USB_CMD_CRSH_CLEAR: return then clear the snapshot
+ * - action USB_CMD_CRSH_FAULT: execute an illegal instruction (HardFault
+ *   test, no answer, the board resets and the snapshot is read after
+ *   enumeration), only in firmware built with CRASHDUMP_TEST defined
+ *   (Makefile DEFINE_OPTS = -DCRASHDUMP_TEST=1) else the answer is only
+ *   USB_CMD_CRSH_ERR_FAULT (uint32_t)
+ * USB_CMD_CRSH answer (Endpoint1 IN) is crashdump_t (magic = 0 if no crash
+ * since last clear)
+ */
+typedef struct
+{
+	uint32_t cmd; /* USB_CMD_CRSH */
+	uint32_t action; /* USB_CMD_CRSH_XXX */
+} usb_cmd_crsh_req_t;
+
+#define USB_CMD_CRSH_GET   (0)
+#define USB_CMD_CRSH_CLEAR (1)
+#define USB_CMD_CRSH_FAULT (2)
+
+#define USB_CMD_CRSH_ERR_FAULT (0xFFFFFFFF) // USB_CMD_CRSH_FAULT not built (CRASHDUMP_TEST not defined)
+
+/*
+ * USB_CMD_BTCH request (Endpoint1 OUT) and answer (Endpoint1 IN)
+ * Several commands in one transfer and all their answers in one transfer
+ * - Request: usb_cmd_btch_t followed by nb_cmd TLV (usb_cmd_tlv_t)
+ *   with value = same data as a single command (32bits command + parameters)
+ * - Answer: usb_cmd_btch_t followed by nb_cmd TLV (usb_cmd_tlv_t)
+ *   with tag of the request and value = same data as single command answer
+ *   (len = 0 for commands without answer or when the TLV value is shorter
+ *   than the command request structure, the command is not executed)
+ * - Each TLV is padded to 32bits (see USB_CMD_TLV_SIZE())
+ * - Commands are executed in order and execution stops when remaining answer
+ *   space is less than USB_CMD_ANSWER_MIN_SIZE, answer nb_cmd is the number
+ *   of commands executed
+ * - USB_CMD_LOGR answer is limited by remaining answer space (remaining logs
+ *   are returned by next USB_CMD_LOGR)
+ * - USB_CMD_BTCH cannot be nested
+ */
+typedef struct
+{
+	uint32_t cmd; /* USB_CMD_BTCH */
+	uint16_t nb_cmd; /* Number of TLV */
+	uint16_t len; /* Length in bytes of all TLV (following this header) */
+} usb_cmd_btch_t;
+
+typedef struct
+{
+	uint16_t tag; /* Tag chosen by host (copied in answer) */
+	uint16_t len; /* Value length in bytes (following this header, without padding) */
+} usb_cmd_tlv_t;
+
+#define USB_CMD_TLV_SIZE(len) (sizeof(usb_cmd_tlv_t) + (((len) + 3) & ~3UL))
+
+/* Minimum answer buffer size for any command */
+#define USB_CMD_ANSWER_MIN_SIZE (64)
 
 #ifdef __cplusplus
 }
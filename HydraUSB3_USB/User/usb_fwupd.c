@@ -0,0 +1,95 @@
+/********************************** (C) COPYRIGHT *******************************
+* File Name          : usb_fwupd.c
+* Author             : bvernoux
+* Version            : V1.0
+* Date               : 2026/10/19
+* Description        : Firmware update over USB2/USB3 Endpoint2 OUT
+*                      Chunks are programmed from main loop while USB DMA
+*                      receives next chunks (Endpoint2 OUT ring see usb_ring.h)
+* Copyright (c) 2026 Benjamin VERNOUX
+* SPDX-License-Identifier: Apache-2.0
+*******************************************************************************/
+#include "CH56x_common.h"
+#include "CH56x_debug_log.h"
+
+#include "usb_fwupd.h"
+#include "usb_ring.h"
+#include "usb_stream.h"
+
+static uint32_t usb_fwupd_state_last = FWUPD_STATE_IDLE;
+static uint32_t usb_fwupd_active; /* Endpoint2 OUT ring used by firmware update */
+
+/*******************************************************************************
+ * @fn     usb_fwupd_start
+ *
+ * @brief  Start firmware update, image data are then received on Endpoint2 OUT
+ *
+ * @param  usb_type: USB Type (USB2 HS or USB3 SS)
+ * @param  size: Image size in bytes
+ * @param  crc32: Expected image CRC32
+ *
+ * @return 0 if success, -1 invalid size, -2 stream busy
+ */
+int usb_fwupd_start(e_usb_type usb_type, uint32_t size, uint32_t crc32)
+{
+	int ret;
+
+	if(fwupd_busy() || (usb_stream.mode != USB_STREAM_IDLE))
+		return -2;
+	if(fwupd_start(&fwupd_flash, size, crc32) != 0)
+		return -1;
+	usb_fwupd_state_last = FWUPD_STATE_RECEIVING;
+	ret = usb_stream_fwupd_start(usb_type, size);
+	if(ret != 0)
+	{
+		fwupd_abort(); // Nothing erased/programmed yet
+		usb_fwupd_state_last = FWUPD_STATE_IDLE;
+		return ret;
+	}
+	usb_fwupd_active = 1;
+	return 0;
+}
+
+/*******************************************************************************
+ * @fn     usb_fwupd_task
+ *
+ * @brief  Program received chunks (to be called from main loop on
+ *         EVENT_USB_STREAM)
+ *
+ * @return None
+ */
+void usb_fwupd_task(void)
+{
+	const uint8_t* data;
+	uint32_t len;
+	fwupd_status_t status;
+
+	/* Endpoint2 OUT ring is also used by other streams */
+	if(usb_fwupd_active == 0)
+		return;
+	while(usb_ring_out_get(&data, &len))
+	{
+		/* In case of error data are dropped until end of image */
+		fwupd_write(data, len);
+		usb_ring_out_release();
+	}
+	if((usb_stream.mode != USB_STREAM_FWUPD) && (fwupd_busy() == 0))
+		usb_fwupd_active = 0;
+	fwupd_status_get(&status);
+	if(status.state == usb_fwupd_state_last)
+		return;
+	usb_fwupd_state_last = status.state;
+	if(status.state == FWUPD_STATE_DONE)
+	{
+		log_printf("FWUPD done size=%d CRC32=0x%08X %dus (erase %dus write %dus verify %dus) %d KB/s\n",
+				   status.size, status.crc_flash, status.total_us,
+				   status.erase_us, status.write_us, status.verify_us,
+				   (uint32_t)(((uint64_t)status.size * 1000000) / (status.total_us ? status.total_us : 1) / 1024) );
+	}
+	else if(status.state == FWUPD_STATE_ERROR)
+	{
+		log_printf("FWUPD error %d at %d/%d CRC32 rx=0x%08X flash=0x%08X expected=0x%08X\n",
+				   status.error, status.programmed, status.size,
+				   status.crc_rx, status.crc_flash, status.crc_expected);
+	}
+}
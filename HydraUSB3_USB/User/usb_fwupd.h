@@ -0,0 +1,27 @@
+/********************************** (C) COPYRIGHT *******************************
+* File Name          : usb_fwupd.h
+* Author             : bvernoux
+* Version            : V1.0
+* Date               : 2026/10/19
+* Description        : Firmware update over USB2/USB3 Endpoint2 OUT
+* Copyright (c) 2026 Benjamin VERNOUX
+* SPDX-License-Identifier: Apache-2.0
+*******************************************************************************/
+#ifndef USB_FWUPD_H_
+#define USB_FWUPD_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "CH56x_usb_devbulk_desc_cmd.h"
+#include "fwupd.h"
+
+int usb_fwupd_start(e_usb_type usb_type, uint32_t size, uint32_t crc32);
+void usb_fwupd_task(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* USB_FWUPD_H_ */
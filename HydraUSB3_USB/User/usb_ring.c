@@ -0,0 +1,342 @@
+/********************************** (C) COPYRIGHT *******************************
+* File Name          : usb_ring.c
+* Author             : bvernoux
+* Version            : V1.0
+* Date               : 2026/10/19
+* Description        : USB2 & USB3 Endpoint2 ring of RAMX buffers
+*                      Lock-free single producer/single consumer queue
+*                      (main loop/USB IRQ), Endpoint2 is re-armed by the
+*                      application only when stalled (no transfer in progress)
+* Copyright (c) 2026 Benjamin VERNOUX
+* SPDX-License-Identifier: Apache-2.0
+*******************************************************************************/
+#include "CH56x_common.h"
+#include "CH56x_usb20_devbulk.h"
+#include "CH56x_usb30_devbulk.h"
+#include "CH56x_usb30_devbulk_LIB.h"
+
+#include "event.h"
+#include "irq_save.h"
+#include "trace.h"
+#include "usb_ring.h"
+#include "usb_stream.h"
+
+__attribute__((aligned(USB_STREAM_DMA_ALIGN))) uint8_t usb_ring_in_buf[USB_RING_NB_BUF][USB_RING_BUF_SIZE] __attribute__((section(".DMADATA")));
+__attribute__((aligned(USB_STREAM_DMA_ALIGN))) uint8_t usb_ring_out_buf[USB_RING_NB_BUF][USB_RING_BUF_SIZE] __attribute__((section(".DMADATA")));
+
+usb_ring_t usb_ring_in;
+usb_ring_t usb_ring_out;
+
+/* Ring counters are updated from USB IRQ (64bits nb_bytes is not atomic) */
+
+static e_usb_type usb_ring_usb_type;
+
+/*******************************************************************************
+ * @fn     usb_ring_reset
+ *
+ * @brief  Reset ring queue and per window statistics
+ *
+ * @return None
+ */
+static void usb_ring_reset(usb_ring_t* ring, uint32_t stalled)
+{
+	spsc_init(&ring->q);
+	ring->stalled = stalled;
+	ring->depth_min = USB_RING_NB_BUF;
+	ring->period_min = 0xFFFFFFFF;
+	ring->period_max = 0;
+	ring->last_done = bsp_get_SysTickCNT_LSB();
+}
+
+/*******************************************************************************
+ * @fn     usb_ring_done_stats
+ *
+ * @brief  Update statistics of a completed transfer (called from USB IRQ)
+ *
+ * @param  ring: &usb_ring_in or &usb_ring_out
+ * @param  len: Transfer length in bytes
+ * @param  depth: Number of buffers ready for next transfers
+ *
+ * @return None
+ */
+static void usb_ring_done_stats(usb_ring_t* ring, uint32_t len, uint32_t depth)
+{
+	uint32_t now = bsp_get_SysTickCNT_LSB();
+	uint32_t period = ring->last_done - now; // SysTick count down
+
+	ring->last_done = now;
+	ring->nb_bytes += len;
+	ring->nb_xfer++;
+	if(depth < ring->depth_min)
+		ring->depth_min = depth;
+	if(period < ring->period_min)
+		ring->period_min = period;
+	if(period > ring->period_max)
+		ring->period_max = period;
+}
+
+/*******************************************************************************
+ * @fn     usb_ring_hw_in_arm
+ *
+ * @brief  Set Endpoint2 IN DMA address and re-arm it
+ *         (USB3 burst parameters computed by usb_ring_in_submit())
+ *
+ * @return None
+ */
+static inline void usb_ring_hw_in_arm(uint32_t slot)
+{
+	uint32_t dma_addr = usb_ring_in.addr[slot];
+
+	if(usb_ring_usb_type == USB_TYPE_USB3)
+	{
+		USBSS->UEP2_TX_DMA = dma_addr;
+		USB30_IN_set(ENDP_2, ENABLE, ACK, usb_ring_in.nump[slot], usb_ring_in.last_len[slot]);
+		USB30_send_ERDY(ENDP_2 | IN, usb_ring_in.nump[slot]);
+	}
+	else
+	{
+		usb_stream_hw_in_arm(USB_TYPE_USB2, dma_addr, usb_ring_in.len[slot]);
+	}
+}
+
+/*******************************************************************************
+ * @fn     usb_ring_in_start
+ *
+ * @brief  Start Endpoint2 IN ring (first transfer starts with first
+ *         usb_ring_in_submit())
+ *
+ * @param  usb_type: USB Type (USB2 HS or USB3 SS)
+ *
+ * @return None
+ */
+void usb_ring_in_start(e_usb_type usb_type)
+{
+	usb_ring_usb_type = usb_type;
+	usb_ring_reset(&usb_ring_in, 1);
+}
+
+/*******************************************************************************
+ * @fn     usb_ring_in_alloc
+ *
+ * @brief  Get next free Endpoint2 IN buffer
+ *
+ * @return Buffer of USB_RING_BUF_SIZE bytes or NULL if all buffers are queued
+ */
+uint8_t* usb_ring_in_alloc(void)
+{
+	int32_t slot = spsc_produce_slot(&usb_ring_in.q, USB_RING_NB_BUF);
+
+	if(slot < 0)
+		return NULL;
+	usb_ring_in.addr[slot] = (uint32_t)usb_ring_in_buf[slot];
+	return usb_ring_in_buf[slot];
+}
+
+/*******************************************************************************
+ * @fn     usb_ring_in_submit
+ *
+ * @brief  Queue buffer returned by usb_ring_in_alloc() for transfer
+ *
+ * @param  len: Length in bytes (1 to USB_RING_BUF_SIZE)
+ *
+ * @return None
+ */
+void usb_ring_in_submit(uint32_t len)
+{
+	const uint32_t pkt_size = (DEF_ENDP2_MAX_SIZE / DEF_ENDP2_IN_BURST_LEVEL);
+	uint32_t slot = SPSC_SLOT(usb_ring_in.q.head, USB_RING_NB_BUF);
+	uint32_t nump = (len + pkt_size - 1) / pkt_size;
+
+	usb_ring_in.len[slot] = len;
+	usb_ring_in.nump[slot] = nump;
+	usb_ring_in.last_len[slot] = len - ((nump - 1) * pkt_size);
+	spsc_push(&usb_ring_in.q);
+	/* Stalled is only set by USB IRQ when Endpoint2 IN is not armed */
+	if(usb_ring_in.stalled)
+	{
+		usb_ring_in.stalled = 0;
+		usb_ring_hw_in_arm(spsc_consume_slot(&usb_ring_in.q, USB_RING_NB_BUF));
+	}
+}
+
+/*******************************************************************************
+ * @fn     usb_ring_in_submit_addr
+ *
+ * @brief  Queue a buffer which is not a ring buffer for transfer (zero copy
+ *         send of a buffer received on an other link), the caller shall
+ *         check a slot is free with usb_ring_in_alloc() and keep the buffer
+ *         until the transfer is done (usb_ring_in.q.tail)
+ *
+ * @param  dma_addr: Buffer address in RAMX (USB_STREAM_DMA_ALIGN aligned)
+ * @param  len: Length in bytes (1 to USB_RING_BUF_SIZE)
+ *
+ * @return None
+ */
+void usb_ring_in_submit_addr(uint32_t dma_addr, uint32_t len)
+{
+	usb_ring_in.addr[SPSC_SLOT(usb_ring_in.q.head, USB_RING_NB_BUF)] = dma_addr;
+	usb_ring_in_submit(len);
+}
+
+/*******************************************************************************
+ * @fn     usb_ring_ep2_in_done
+ *
+ * @brief  Endpoint2 IN transfer completed (called from USB IRQ)
+ *         Endpoint2 IN is re-armed with next queued buffer before statistics
+ *
+ * @param  len: Unused (Endpoint2 IN re-armed by usb_ring)
+ *
+ * @return USB_STREAM_NAK (Endpoint2 IN re-armed here)
+ */
+uint32_t usb_ring_ep2_in_done(uint32_t* len)
+{
+	uint32_t done_len = usb_ring_in.len[SPSC_SLOT(usb_ring_in.q.tail, USB_RING_NB_BUF)];
+	int32_t slot;
+
+	(void)len;
+	spsc_pop(&usb_ring_in.q); // Buffer sent
+	slot = spsc_consume_slot(&usb_ring_in.q, USB_RING_NB_BUF);
+	if(slot >= 0)
+	{
+		usb_ring_hw_in_arm(slot);
+		TRACE(USB_RING_IN_REARM, slot);
+	}
+	else
+	{
+		usb_ring_in.stalled = 1;
+		usb_ring_in.nb_stall++;
+	}
+	usb_ring_done_stats(&usb_ring_in, done_len, spsc_count(&usb_ring_in.q));
+	event_post(EVENT_USB_STREAM);
+	return USB_STREAM_NAK;
+}
+
+/*******************************************************************************
+ * @fn     usb_ring_out_start
+ *
+ * @brief  Start Endpoint2 OUT ring (Endpoint2 OUT armed with first buffer)
+ *
+ * @param  usb_type: USB Type (USB2 HS or USB3 SS)
+ *
+ * @return None
+ */
+void usb_ring_out_start(e_usb_type usb_type)
+{
+	usb_ring_usb_type = usb_type;
+	usb_ring_reset(&usb_ring_out, 0);
+	usb_stream_hw_out_arm(usb_type, (uint32_t)usb_ring_out_buf[0]);
+}
+
+/*******************************************************************************
+ * @fn     usb_ring_out_get
+ *
+ * @brief  Get oldest received Endpoint2 OUT buffer
+ *
+ * @param  data: Returned buffer
+ * @param  len: Returned length in bytes
+ *
+ * @return 1 if a buffer is available else 0
+ */
+int usb_ring_out_get(const uint8_t** data, uint32_t* len)
+{
+	int32_t slot = spsc_consume_slot(&usb_ring_out.q, USB_RING_NB_BUF);
+
+	if(slot < 0)
+		return 0;
+	*data = usb_ring_out_buf[slot];
+	*len = usb_ring_out.len[slot];
+	return 1;
+}
+
+/*******************************************************************************
+ * @fn     usb_ring_out_release
+ *
+ * @brief  Release buffer returned by usb_ring_out_get()
+ *
+ * @return None
+ */
+void usb_ring_out_release(void)
+{
+	spsc_pop(&usb_ring_out.q);
+	/* Stalled is only set by USB IRQ when Endpoint2 OUT is not armed */
+	if(usb_ring_out.stalled)
+	{
+		usb_ring_out.stalled = 0;
+		usb_stream_hw_out_arm(usb_ring_usb_type,
+							  (uint32_t)usb_ring_out_buf[spsc_produce_slot(&usb_ring_out.q, USB_RING_NB_BUF)]);
+	}
+}
+
+/*******************************************************************************
+ * @fn     usb_ring_ep2_out_done
+ *
+ * @brief  Endpoint2 OUT transfer completed (called from USB IRQ)
+ *         Endpoint2 OUT is re-armed with next free buffer before statistics
+ *
+ * @param  len: Length of received data
+ *
+ * @return USB_STREAM_NAK (Endpoint2 OUT re-armed here)
+ */
+uint32_t usb_ring_ep2_out_done(uint32_t len)
+{
+	int32_t slot;
+
+	usb_ring_out.len[SPSC_SLOT(usb_ring_out.q.head, USB_RING_NB_BUF)] = len;
+	spsc_push(&usb_ring_out.q); // Buffer received
+	slot = spsc_produce_slot(&usb_ring_out.q, USB_RING_NB_BUF);
+	if(slot >= 0)
+	{
+		usb_stream_hw_out_arm(usb_ring_usb_type, (uint32_t)usb_ring_out_buf[slot]);
+		TRACE(USB_RING_OUT_REARM, slot);
+	}
+	else
+	{
+		usb_ring_out.stalled = 1;
+		usb_ring_out.nb_stall++;
+	}
+	usb_ring_done_stats(&usb_ring_out, len, USB_RING_NB_BUF - spsc_count(&usb_ring_out.q));
+	event_post(EVENT_USB_STREAM);
+	return USB_STREAM_NAK;
+}
+
+/*******************************************************************************
+ * @fn     usb_ring_stats_get
+ *
+ * @brief  Get ring statistics, throughput and min/max values since
+ *         previous call
+ *
+ * @param  ring: &usb_ring_in or &usb_ring_out
+ * @param  stats: Destination of statistics
+ *
+ * @return None
+ */
+void usb_ring_stats_get(usb_ring_t* ring, usb_ring_stats_t* stats)
+{
+	uint32_t mstatus;
+	uint32_t now;
+	uint32_t nb_us;
+	uint64_t stats_bytes;
+
+	/* Snapshot and restart of the window shall not be split by USB IRQ */
+	mstatus = irq_save();
+	now = bsp_get_SysTickCNT_LSB();
+	stats->nb_xfer = ring->nb_xfer;
+	stats->nb_stall = ring->nb_stall;
+	stats->nb_bytes = ring->nb_bytes;
+	stats->depth_min = ring->depth_min;
+	stats->period_min = (ring->period_min == 0xFFFFFFFF) ? 0 : ring->period_min;
+	stats->period_max = ring->period_max;
+	stats->nb_crc_err = ring->nb_crc_err;
+	nb_us = (ring->stats_start - now) / bsp_get_nbtick_1us(); // SysTick count down
+	stats_bytes = ring->stats_bytes;
+	ring->stats_bytes = stats->nb_bytes;
+	ring->stats_start = now;
+	ring->depth_min = USB_RING_NB_BUF;
+	ring->period_min = 0xFFFFFFFF;
+	ring->period_max = 0;
+	irq_restore(mstatus);
+
+	stats->kbps = 0;
+	if(nb_us > 0)
+		stats->kbps = (uint32_t)(((stats->nb_bytes - stats_bytes) * 1000000) / nb_us / 1024);
+}
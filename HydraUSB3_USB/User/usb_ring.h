@@ -0,0 +1,94 @@
+/********************************** (C) COPYRIGHT *******************************
+* File Name          : usb_ring.h
+* Author             : bvernoux
+* Version            : V1.0
+* Date               : 2026/10/19
+* Description        : USB2 & USB3 Endpoint2 ring of RAMX buffers
+* Copyright (c) 2026 Benjamin VERNOUX
+* SPDX-License-Identifier: Apache-2.0
+*******************************************************************************/
+#ifndef USB_RING_H_
+#define USB_RING_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "CH56x_usb_devbulk_desc_cmd.h"
+#include "spsc.h"
+
+/*
+ * Endpoint2 IN: application fills free buffers (usb_ring_in_alloc()/
+ * usb_ring_in_submit()), USB IRQ sends them in order.
+ * Endpoint2 OUT: USB IRQ receives in free buffers, application consumes
+ * them in order (usb_ring_out_get()/usb_ring_out_release()).
+ * Up to 3 buffers are queued behind the one in transfer, the USB IRQ only
+ * swaps Endpoint2 DMA address and re-arms it (USB3 burst parameters are
+ * computed at submit) before any bookkeeping, the application produces/
+ * consumes buffers through a lock-free SPSC queue (see spsc.h) so it never
+ * blocks the USB IRQ.
+ * When application is late Endpoint2 NAK (stall counter) until a buffer
+ * is submitted/released.
+ */
+#define USB_RING_NB_BUF (4) /* Power of 2 */
+#define USB_RING_BUF_SIZE (DEF_ENDP2_MAX_SIZE)
+
+typedef struct
+{
+	spsc_t q; /* IN: application produces, USB IRQ consumes. OUT: the reverse */
+	volatile uint32_t stalled; /* Endpoint2 not armed (IN: no buffer to send, OUT: no free buffer) */
+	uint32_t len[USB_RING_NB_BUF];
+	uint32_t addr[USB_RING_NB_BUF]; /* IN DMA address (ring buffer or buffer of an other link) */
+	uint8_t nump[USB_RING_NB_BUF]; /* USB3 IN number of packets */
+	uint16_t last_len[USB_RING_NB_BUF]; /* USB3 IN last packet length */
+	/* Statistics */
+	uint32_t nb_xfer; /* Number of transfers */
+	uint32_t nb_stall; /* Number of times Endpoint2 waited for application */
+	uint64_t nb_bytes; /* Number of bytes transferred */
+	uint32_t nb_crc_err; /* Number of buffers with CRC error (checked by application) */
+	uint32_t depth_min; /* Min number of buffers ready when a transfer completes */
+	uint32_t period_min; /* Min SysTick cycles between two transfers completion */
+	uint32_t period_max; /* Max SysTick cycles between two transfers completion */
+	uint32_t last_done; /* SysTick at last transfer completion */
+	uint64_t stats_bytes; /* nb_bytes at previous usb_ring_stats_get() */
+	uint32_t stats_start; /* SysTick at previous usb_ring_stats_get() */
+} usb_ring_t;
+
+typedef struct
+{
+	uint32_t nb_xfer; /* Number of transfers */
+	uint32_t nb_stall; /* Number of times Endpoint2 waited for application */
+	uint64_t nb_bytes; /* Number of bytes transferred */
+	uint32_t kbps; /* Throughput in KB/s since previous usb_ring_stats_get() */
+	/* Following values since previous usb_ring_stats_get() */
+	uint32_t depth_min; /* Min number of buffers ready when a transfer completes */
+	uint32_t period_min; /* Min SysTick cycles between two transfers completion */
+	uint32_t period_max; /* Max SysTick cycles between two transfers completion (jitter) */
+	uint32_t nb_crc_err; /* Number of buffers with CRC error (USB_STREAM_RING_CRC) */
+} usb_ring_stats_t;
+
+extern usb_ring_t usb_ring_in;
+extern usb_ring_t usb_ring_out;
+extern uint8_t usb_ring_in_buf[USB_RING_NB_BUF][USB_RING_BUF_SIZE];
+extern uint8_t usb_ring_out_buf[USB_RING_NB_BUF][USB_RING_BUF_SIZE];
+
+void usb_ring_in_start(e_usb_type usb_type);
+uint8_t* usb_ring_in_alloc(void);
+void usb_ring_in_submit(uint32_t len);
+void usb_ring_in_submit_addr(uint32_t dma_addr, uint32_t len);
+
+void usb_ring_out_start(e_usb_type usb_type);
+int usb_ring_out_get(const uint8_t** data, uint32_t* len);
+void usb_ring_out_release(void);
+
+/* Called by usb_stream Endpoint2 hooks (USB IRQ) */
+uint32_t usb_ring_ep2_in_done(uint32_t* len);
+uint32_t usb_ring_ep2_out_done(uint32_t len);
+
+void usb_ring_stats_get(usb_ring_t* ring, usb_ring_stats_t* stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* USB_RING_H_ */
@@ -0,0 +1,123 @@
+/********************************** (C) COPYRIGHT *******************************
+* File Name          : usb_speed.c
+* Author             : bvernoux
+* Version            : V1.0
+* Date               : 2026/10/19
+* Description        : Remember last enumerated USB speed (flash) to select
+*                      USB3 connection timeout at boot
+*                      Flash is written only when enumerated speed changes
+* Copyright (c) 2026 Benjamin VERNOUX
+* SPDX-License-Identifier: Apache-2.0
+*******************************************************************************/
+#include "CH56x_common.h"
+#include "CH56x_debug_log.h"
+
+#include "usb_speed.h"
+
+#define USB_SPEED_CFG_MAGIC (0x55535044) // USPD
+
+typedef struct
+{
+	uint32_t magic; /* USB_SPEED_CFG_MAGIC */
+	uint32_t speed; /* see e_usb_speed */
+	uint32_t nb_usb2; /* Consecutive boots enumerated in USB2 (up to USB_SPEED_USB2_FALLBACK_NB) */
+	uint32_t nb_write; /* Number of configuration writes */
+	uint32_t check; /* ~(magic ^ speed ^ nb_usb2 ^ nb_write) */
+} usb_speed_cfg_t;
+
+#define USB_SPEED_CFG_CHECK(cfg) (~((cfg)->magic ^ (cfg)->speed ^ (cfg)->nb_usb2 ^ (cfg)->nb_write))
+
+static usb_speed_cfg_t usb_speed_cfg;
+static usb_speed_status_t usb_speed_status;
+static uint64_t usb_speed_start;
+
+/*******************************************************************************
+ * @fn     usb_speed_init
+ *
+ * @brief  Read last enumerated USB speed from flash and start time to
+ *         enumeration measurement (to be called before USB30D_init())
+ *
+ * @return USB3 connection timeout for TMR0_TimerInit() in cycles
+ */
+uint32_t usb_speed_init(void)
+{
+	usb_speed_start = bsp_get_SysTickCNT();
+	FLASH_ROMA_READ(USB_SPEED_CFG_ADDR, (uint32_t*)&usb_speed_cfg, sizeof(usb_speed_cfg));
+	if((usb_speed_cfg.magic != USB_SPEED_CFG_MAGIC) ||
+			(usb_speed_cfg.check != USB_SPEED_CFG_CHECK(&usb_speed_cfg)))
+	{
+		usb_speed_cfg.speed = USB_SPEED_UNKNOWN; // Erased or invalid
+		usb_speed_cfg.nb_usb2 = 0;
+		usb_speed_cfg.nb_write = 0;
+	}
+	usb_speed_status.last_speed = usb_speed_cfg.speed;
+	usb_speed_status.nb_write = usb_speed_cfg.nb_write;
+	if(usb_speed_cfg.speed == USB_SPEED_USB2)
+		usb_speed_status.usb3_timeout_ms = USB_SPEED_USB3_TIMEOUT_SHORT_MS;
+	else
+		usb_speed_status.usb3_timeout_ms = USB_SPEED_USB3_TIMEOUT_FULL_MS;
+	log_printf("USB last speed=%d USB3 timeout=%dms\n", usb_speed_status.last_speed, usb_speed_status.usb3_timeout_ms);
+	return (usb_speed_status.usb3_timeout_ms * 1000 * bsp_get_nbtick_1us());
+}
+
+/*******************************************************************************
+ * @fn     usb_speed_enumerated
+ *
+ * @brief  USB enumerated (to be called from main loop, not from IRQ)
+ *         Store speed in flash if it changed (USB2 only after
+ *         USB_SPEED_USB2_FALLBACK_NB consecutive boots enumerated in USB2)
+ *
+ * @param  speed: USB_SPEED_USB2 or USB_SPEED_USB3
+ *
+ * @return None
+ */
+void usb_speed_enumerated(uint32_t speed)
+{
+	uint32_t first = (usb_speed_status.enum_us == 0);
+	uint32_t nb_usb2;
+
+	if(first)
+	{
+		usb_speed_status.enum_us = (uint32_t)((usb_speed_start - bsp_get_SysTickCNT()) / bsp_get_nbtick_1us()); // SysTick count down
+		log_printf("USB enumerated in %dus\n", usb_speed_status.enum_us);
+	}
+	usb_speed_status.speed = speed;
+	if((speed == usb_speed_cfg.speed) && ((usb_speed_cfg.nb_usb2 == 0) || (speed == USB_SPEED_USB2)))
+		return; // Nothing changed
+	if(speed == USB_SPEED_USB2)
+	{
+		if(!first)
+			return; // USB_CMD_USB2 switch is not a fall-back
+		nb_usb2 = usb_speed_cfg.nb_usb2 + 1;
+		if(nb_usb2 < USB_SPEED_USB2_FALLBACK_NB)
+			speed = usb_speed_cfg.speed; // Count the fall-back, keep FULL timeout
+	}
+	else
+	{
+		nb_usb2 = 0;
+	}
+	usb_speed_cfg.magic = USB_SPEED_CFG_MAGIC;
+	usb_speed_cfg.speed = speed;
+	usb_speed_cfg.nb_usb2 = nb_usb2;
+	usb_speed_cfg.nb_write++;
+	usb_speed_cfg.check = USB_SPEED_CFG_CHECK(&usb_speed_cfg);
+	if((FLASH_ROMA_ERASE(USB_SPEED_CFG_ADDR, USB_SPEED_CFG_SIZE) != 0) ||
+			(FLASH_ROMA_WRITE(USB_SPEED_CFG_ADDR, (uint32_t*)&usb_speed_cfg, sizeof(usb_speed_cfg)) != 0))
+	{
+		log_printf("USB speed cfg write error\n");
+		return;
+	}
+	usb_speed_status.nb_write = usb_speed_cfg.nb_write;
+}
+
+/*******************************************************************************
+ * @fn     usb_speed_status_get
+ *
+ * @brief  Get a copy of USB speed status
+ *
+ * @return None
+ */
+void usb_speed_status_get(usb_speed_status_t* status)
+{
+	*status = usb_speed_status;
+}
@@ -0,0 +1,61 @@
+/********************************** (C) COPYRIGHT *******************************
+* File Name          : usb_speed.h
+* Author             : bvernoux
+* Version            : V1.0
+* Date               : 2026/10/19
+* Description        : Remember last enumerated USB speed (flash) to select
+*                      USB3 connection timeout at boot
+* Copyright (c) 2026 Benjamin VERNOUX
+* SPDX-License-Identifier: Apache-2.0
+*******************************************************************************/
+#ifndef USB_SPEED_H_
+#define USB_SPEED_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+
+/* Last 4K sector of CodeFlash (reserved in .ld) */
+#define USB_SPEED_CFG_ADDR (0x0006F000)
+#define USB_SPEED_CFG_SIZE (4096)
+
+/*
+ * USB3 connection timeout before fall-back to USB2 (TMR0_IRQHandler())
+ * - FULL: unknown or last speed USB3 (original 67000000 cycles at 120MHz)
+ * - SHORT: last speed USB2 (USB2 only host), if a USB3 host needs more time
+ *   USB_CMD_USB3 switches to USB3 and next boots use FULL timeout again
+ * USB2 is stored as last speed only after USB_SPEED_USB2_FALLBACK_NB
+ * consecutive boots enumerated in USB2 with FULL timeout, a single slow
+ * USB3 link training does not reduce the timeout of next boots
+ */
+#define USB_SPEED_USB3_TIMEOUT_FULL_MS (558)
+#define USB_SPEED_USB3_TIMEOUT_SHORT_MS (150)
+#define USB_SPEED_USB2_FALLBACK_NB (3)
+
+typedef enum
+{
+	USB_SPEED_UNKNOWN = 0,
+	USB_SPEED_USB2,
+	USB_SPEED_USB3,
+} e_usb_speed;
+
+typedef struct
+{
+	uint32_t last_speed; /* Speed read from flash at boot (see e_usb_speed) */
+	uint32_t speed; /* Enumerated speed (see e_usb_speed) */
+	uint32_t usb3_timeout_ms; /* USB3 connection timeout used at boot */
+	uint32_t enum_us; /* Time from usb_speed_init() to first enumeration (0 if not enumerated) */
+	uint32_t nb_write; /* Number of configuration writes (speed changes) */
+} usb_speed_status_t;
+
+uint32_t usb_speed_init(void);
+void usb_speed_enumerated(uint32_t speed);
+void usb_speed_status_get(usb_speed_status_t* status);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* USB_SPEED_H_ */
@@ -0,0 +1,720 @@
+/********************************** (C) COPYRIGHT *******************************
+* File Name          : usb_stream.c
+* Author             : bvernoux
+* Version            : V1.0
+* Date               : 2026/10/19
+* Description        : USB2 & USB3 Endpoint2 streaming (memory read/write)
+*                      RAMX ranges are sent/received directly by USB DMA
+*                      (zero copy), other ranges (RAM, Flash, Peripherals
+*                      registers) use a RAMX bounce buffer
+*                      Firmware update data and benchmark streams use the
+*                      Endpoint2 ring of RAMX buffers (see usb_ring.c)
+* Copyright (c) 2026 Benjamin VERNOUX
+* SPDX-License-Identifier: Apache-2.0
+*******************************************************************************/
+#include "CH56x_common.h"
+#include "CH56x_usb20_devbulk.h"
+#include "CH56x_usb30_devbulk.h"
+#include "CH56x_usb30_devbulk_LIB.h"
+
+#include "crc32.h"
+#include "soak.h"
+#include "fastmem.h"
+#include "link_usb.h"
+#include "usb_ring.h"
+#include "usb_stream.h"
+
+typedef struct
+{
+	uint32_t start;
+	uint32_t end; /* Last address + 1 */
+	uint32_t flags;
+} usb_stream_mem_region_t;
+
+/* Linker script (.ld) symbols */
+extern uint8_t _data_vma[]; /* RAM .data start */
+extern uint8_t _ebss[]; /* RAM .bss end */
+
+/* First region containing the whole range gives the access flags */
+static const usb_stream_mem_region_t usb_stream_mem_regions[] =
+{
+	{ 0x00000000, 0x00070000, USB_STREAM_MEM_RD }, /* FLASH (code 448K) */
+	{ (uint32_t)_data_vma, (uint32_t)_ebss, USB_STREAM_MEM_RD | USB_STREAM_MEM_WR }, /* RAM application .data/.bss */
+	{ 0x20000000, 0x20004000, USB_STREAM_MEM_RD }, /* RAM 16K (free RAM and stack are read only) */
+	{ 0x20020000, 0x20037000, USB_STREAM_MEM_RD | USB_STREAM_MEM_WR | USB_STREAM_MEM_DMA }, /* RAMX 92K */
+	{ 0x20020000, 0x20038000, USB_STREAM_MEM_RD | USB_STREAM_MEM_DMA }, /* RAMX 96K (last 4K crash snapshot is read only, see crashdump.h) */
+	{ 0x40000000, 0x40040000, USB_STREAM_MEM_RD }, /* Peripherals registers (read only) */
+};
+#define USB_STREAM_MEM_REGIONS_NB (sizeof(usb_stream_mem_regions) / sizeof(usb_stream_mem_regions[0]))
+
+__attribute__((aligned(USB_STREAM_DMA_ALIGN))) uint8_t usb_stream_bounce[USB_STREAM_CHUNK_SIZE] __attribute__((section(".DMADATA")));
+
+usb_stream_t usb_stream;
+
+static uint32_t usb_stream_flags; /* Access flags of actual stream memory range */
+static uint32_t usb_stream_ring_flags; /* USB_STREAM_RING_XXX flags */
+static uint32_t usb_stream_ring_val; /* Next USB_STREAM_RING_PATTERN value */
+static uint32_t usb_stream_ring_crc; /* USB_STREAM_RING_CRC running CRC32C */
+
+/* devbulk Endpoint2 DMA buffers (default loopback/benchmark path) saved at stream start */
+static e_usb_type usb_stream_usb_type;
+static uint32_t usb_stream_dflt_tx_dma;
+static uint32_t usb_stream_dflt_rx_dma;
+
+/* USB2 Endpoint2 transfer actually split in USB_STREAM_USB2_PKT_SIZE packets */
+static uint32_t usb_stream_usb2_in_addr;
+static uint32_t usb_stream_usb2_in_len;
+static uint32_t usb_stream_usb2_in_off;
+static uint32_t usb_stream_usb2_out_addr;
+static uint32_t usb_stream_usb2_out_off;
+
+/* devbulk Endpoint2 callbacks and USB2 IRQ (USB_WEAK_SYMS aliases created by Makefile) */
+void usb_devbulk_EP2_IN_Callback(void);
+void usb_devbulk_EP2_OUT_Callback(void);
+void usb_devbulk_USBHS_IRQHandler(void);
+
+/*******************************************************************************
+ * @fn     usb_stream_mem_access
+ *
+ * @brief  Return access flags of a memory range
+ *
+ * @param  addr: Start address
+ * @param  len: Length in bytes
+ *
+ * @return Access flags (USB_STREAM_MEM_XXX) or 0 if range is not valid
+ */
+uint32_t usb_stream_mem_access(uint32_t addr, uint32_t len)
+{
+	uint32_t i;
+
+	for(i = 0; i < USB_STREAM_MEM_REGIONS_NB; i++)
+	{
+		const usb_stream_mem_region_t* region = &usb_stream_mem_regions[i];
+		if((addr >= region->start) && (addr < region->end) &&
+				(len <= (region->end - addr)))
+		{
+			return region->flags;
+		}
+	}
+	return 0;
+}
+
+/*******************************************************************************
+ * @fn     usb_stream_usb2_in_pkt
+ *
+ * @brief  Set USB2 Endpoint2 IN ready to send next packet of actual transfer
+ *
+ * @return None
+ */
+static void usb_stream_usb2_in_pkt(void)
+{
+	uint32_t n = usb_stream_usb2_in_len - usb_stream_usb2_in_off;
+
+	if(n > USB_STREAM_USB2_PKT_SIZE)
+		n = USB_STREAM_USB2_PKT_SIZE;
+	R32_UEP2_TX_DMA = usb_stream_usb2_in_addr + usb_stream_usb2_in_off;
+	R16_UEP2_T_LEN = n;
+	R8_UEP2_TX_CTRL = (R8_UEP2_TX_CTRL & ~RB_UEP_TRES_MASK) | UEP_T_RES_ACK;
+}
+
+/*******************************************************************************
+ * @fn     usb_stream_hw_in_arm
+ *
+ * @brief  Configure Endpoint2 IN DMA address/length and set it ready to send
+ *         (USB2: sent in USB_STREAM_USB2_PKT_SIZE packets by usb_stream_usb2_irq())
+ *
+ * @return None
+ */
+void usb_stream_hw_in_arm(e_usb_type usb_type, uint32_t dma_addr, uint32_t len)
+{
+	if(usb_type == USB_TYPE_USB3)
+	{
+		uint8_t nump = (len + (DEF_ENDP2_MAX_SIZE / DEF_ENDP2_IN_BURST_LEVEL) - 1) / (DEF_ENDP2_MAX_SIZE / DEF_ENDP2_IN_BURST_LEVEL);
+		uint16_t last_len = len - ((nump - 1) * (DEF_ENDP2_MAX_SIZE / DEF_ENDP2_IN_BURST_LEVEL));
+		USBSS->UEP2_TX_DMA = dma_addr;
+		USB30_IN_set(ENDP_2, ENABLE, ACK, nump, last_len);
+		USB30_send_ERDY(ENDP_2 | IN, nump);
+	}
+	else
+	{
+		usb_stream_usb2_in_addr = dma_addr;
+		usb_stream_usb2_in_len = len;
+		usb_stream_usb2_in_off = 0;
+		usb_stream_usb2_in_pkt();
+	}
+}
+
+/*******************************************************************************
+ * @fn     usb_stream_hw_out_arm
+ *
+ * @brief  Configure Endpoint2 OUT DMA address and set it ready to receive
+ *         (USB2: up to USB_STREAM_CHUNK_SIZE bytes or a short packet
+ *         received by usb_stream_usb2_irq())
+ *
+ * @return None
+ */
+void usb_stream_hw_out_arm(e_usb_type usb_type, uint32_t dma_addr)
+{
+	if(usb_type == USB_TYPE_USB3)
+	{
+		USBSS->UEP2_RX_DMA = dma_addr;
+		USB30_OUT_set(ENDP_2, ACK, DEF_ENDP2_OUT_BURST_LEVEL);
+		USB30_send_ERDY(ENDP_2 | OUT, DEF_ENDP2_OUT_BURST_LEVEL);
+	}
+	else
+	{
+		usb_stream_usb2_out_addr = dma_addr;
+		usb_stream_usb2_out_off = 0;
+		R32_UEP2_RX_DMA = dma_addr;
+		R8_UEP2_RX_CTRL = (R8_UEP2_RX_CTRL & ~RB_UEP_RRES_MASK) | UEP_R_RES_ACK;
+	}
+}
+
+/*******************************************************************************
+ * @fn     usb_stream_hw_save
+ *
+ * @brief  Save devbulk Endpoint2 DMA buffers before a stream uses Endpoint2
+ *
+ * @param  usb_type: USB Type (USB2 HS or USB3 SS)
+ *
+ * @return None
+ */
+static void usb_stream_hw_save(e_usb_type usb_type)
+{
+	usb_stream_usb_type = usb_type;
+	if(usb_type == USB_TYPE_USB3)
+	{
+		usb_stream_dflt_tx_dma = USBSS->UEP2_TX_DMA;
+		usb_stream_dflt_rx_dma = USBSS->UEP2_RX_DMA;
+	}
+	else
+	{
+		usb_stream_dflt_tx_dma = R32_UEP2_TX_DMA;
+		usb_stream_dflt_rx_dma = R32_UEP2_RX_DMA;
+	}
+}
+
+/*******************************************************************************
+ * @fn     usb_stream_hw_restore
+ *
+ * @brief  Give Endpoint2 back to devbulk default loopback/benchmark path at
+ *         end of a stream: devbulk DMA buffers restored and Endpoint2 IN/OUT
+ *         re-armed for a full burst as after enumeration
+ *
+ * @return None
+ */
+static void usb_stream_hw_restore(void)
+{
+	usb_stream_hw_out_arm(usb_stream_usb_type, usb_stream_dflt_rx_dma);
+	usb_stream_hw_in_arm(usb_stream_usb_type, usb_stream_dflt_tx_dma, DEF_ENDP2_MAX_SIZE);
+}
+
+/*******************************************************************************
+ * @fn     usb_stream_in_next
+ *
+ * @brief  Prepare next memory read chunk to send
+ *
+ * @param  len: Returned length of the chunk
+ *
+ * @return DMA address of the chunk or 0 if the stream is finished
+ */
+static uint32_t usb_stream_in_next(uint32_t* len)
+{
+	uint32_t n = usb_stream.remaining;
+	uint32_t dma_addr;
+
+	if(n == 0)
+	{
+		usb_stream.mode = USB_STREAM_IDLE;
+		return 0;
+	}
+	if(n > USB_STREAM_CHUNK_SIZE)
+		n = USB_STREAM_CHUNK_SIZE;
+	if((usb_stream_flags & USB_STREAM_MEM_DMA) && ((usb_stream.addr & (USB_STREAM_DMA_ALIGN - 1)) == 0))
+	{
+		dma_addr = usb_stream.addr;
+		usb_stream.nb_zero_copy++;
+	}
+	else
+	{
+		fastmem_cpy(usb_stream_bounce, (const void*)usb_stream.addr, n);
+		dma_addr = (uint32_t)usb_stream_bounce;
+		usb_stream.nb_copy++;
+	}
+	usb_stream.addr += n;
+	usb_stream.remaining -= n;
+	usb_stream.total_bytes += n;
+	*len = n;
+	return dma_addr;
+}
+
+/*******************************************************************************
+ * @fn     usb_stream_out_next
+ *
+ * @brief  Return DMA address for next memory write chunk
+ *         (directly memory only for full chunk to never write after the end)
+ *
+ * @return DMA address
+ */
+static uint32_t usb_stream_out_next(void)
+{
+	if((usb_stream_flags & USB_STREAM_MEM_DMA) &&
+			((usb_stream.addr & (USB_STREAM_DMA_ALIGN - 1)) == 0) &&
+			(usb_stream.remaining >= USB_STREAM_CHUNK_SIZE))
+	{
+		return usb_stream.addr;
+	}
+	return (uint32_t)usb_stream_bounce;
+}
+
+/*******************************************************************************
+ * @fn     usb_stream_mem_read_start
+ *
+ * @brief  Start to send a memory range on Endpoint2 IN
+ *
+ * @param  usb_type: USB Type (USB2 HS or USB3 SS)
+ * @param  addr: Start address
+ * @param  len: Length in bytes
+ *
+ * @return 0 if success, -1 invalid range, -2 stream busy
+ */
+int usb_stream_mem_read_start(e_usb_type usb_type, uint32_t addr, uint32_t len)
+{
+	uint32_t dma_addr;
+	uint32_t dma_len;
+
+	usb_stream_flags = usb_stream_mem_access(addr, len);
+	if(((usb_stream_flags & USB_STREAM_MEM_RD) == 0) || (len == 0))
+		return -1;
+	if(usb_stream.mode != USB_STREAM_IDLE)
+		return -2;
+	usb_stream_hw_save(usb_type);
+	usb_stream.addr = addr;
+	usb_stream.remaining = len;
+	usb_stream.mode = USB_STREAM_MEM_READ;
+	dma_addr = usb_stream_in_next(&dma_len);
+	usb_stream_hw_in_arm(usb_type, dma_addr, dma_len);
+	return 0;
+}
+
+/*******************************************************************************
+ * @fn     usb_stream_mem_write_start
+ *
+ * @brief  Start to write a memory range with data received on Endpoint2 OUT
+ *
+ * @param  usb_type: USB Type (USB2 HS or USB3 SS)
+ * @param  addr: Start address
+ * @param  len: Length in bytes
+ *
+ * @return 0 if success, -1 invalid range, -2 stream busy
+ */
+int usb_stream_mem_write_start(e_usb_type usb_type, uint32_t addr, uint32_t len)
+{
+	usb_stream_flags = usb_stream_mem_access(addr, len);
+	if(((usb_stream_flags & USB_STREAM_MEM_WR) == 0) || (len == 0))
+		return -1;
+	if(usb_stream.mode != USB_STREAM_IDLE)
+		return -2;
+	usb_stream_hw_save(usb_type);
+	usb_stream.addr = addr;
+	usb_stream.remaining = len;
+	usb_stream.mode = USB_STREAM_MEM_WRITE;
+	usb_stream_hw_out_arm(usb_type, usb_stream_out_next());
+	return 0;
+}
+
+/*******************************************************************************
+ * @fn     usb_stream_fwupd_start
+ *
+ * @brief  Start to receive firmware update data on Endpoint2 OUT ring
+ *         (see usb_ring_out_get()/usb_ring_out_release())
+ *
+ * @param  usb_type: USB Type (USB2 HS or USB3 SS)
+ * @param  len: Firmware image length in bytes
+ *
+ * @return 0 if success, -2 stream busy
+ */
+int usb_stream_fwupd_start(e_usb_type usb_type, uint32_t len)
+{
+	if(usb_stream.mode != USB_STREAM_IDLE)
+		return -2;
+	usb_stream_hw_save(usb_type);
+	usb_stream.remaining = len;
+	usb_stream.mode = USB_STREAM_FWUPD;
+	usb_ring_out_start(usb_type);
+	return 0;
+}
+
+/*******************************************************************************
+ * @fn     usb_stream_fwupd_out_done
+ *
+ * @brief  Firmware update chunk received (called from USB IRQ)
+ *
+ * @return USB_STREAM_NAK (Endpoint2 OUT re-armed by usb_ring)
+ */
+static uint32_t usb_stream_fwupd_out_done(uint32_t len)
+{
+	uint32_t dma_addr;
+
+	if(len > usb_stream.remaining)
+		len = usb_stream.remaining;
+	usb_stream.remaining -= len;
+	usb_stream.total_bytes += len;
+	usb_stream.nb_zero_copy++;
+	dma_addr = usb_ring_ep2_out_done(len);
+	if(usb_stream.remaining == 0)
+		usb_stream.mode = USB_STREAM_IDLE;
+	return dma_addr;
+}
+
+/*******************************************************************************
+ * @fn     usb_stream_ring_start
+ *
+ * @brief  Start/stop Endpoint2 ring benchmark stream
+ *         - USB_STREAM_RING_IN: buffers sent continuously on Endpoint2 IN
+ *         - USB_STREAM_RING_OUT: data received on Endpoint2 OUT are dropped
+ *           (after CRC check with USB_STREAM_RING_CRC)
+ *
+ * @param  usb_type: USB Type (USB2 HS or USB3 SS)
+ * @param  mode: USB_STREAM_RING_IN, USB_STREAM_RING_OUT or USB_STREAM_IDLE to stop
+ * @param  flags: USB_STREAM_RING_XXX flags
+ *
+ * @return 0 if success, -1 invalid mode, -2 stream busy
+ */
+int usb_stream_ring_start(e_usb_type usb_type, uint32_t mode, uint32_t flags)
+{
+	if(mode == USB_STREAM_IDLE)
+	{
+		if((usb_stream.mode == USB_STREAM_RING_IN) || (usb_stream.mode == USB_STREAM_RING_OUT))
+		{
+			if(usb_stream_ring_flags & USB_STREAM_RING_LINK)
+				link_usb_bench_log();
+			usb_stream_abort();
+		}
+		return 0;
+	}
+	if((mode != USB_STREAM_RING_IN) && (mode != USB_STREAM_RING_OUT))
+		return -1;
+	if(usb_stream.mode != USB_STREAM_IDLE)
+		return -2;
+	usb_stream_ring_flags = flags;
+	usb_stream_ring_val = 0;
+	usb_stream_ring_crc = 0;
+	if(flags & USB_STREAM_RING_LINK)
+		link_usb_start(mode);
+	usb_stream_hw_save(usb_type);
+	usb_stream.mode = mode;
+	if(mode == USB_STREAM_RING_IN)
+	{
+		usb_ring_in_start(usb_type);
+		usb_stream_ring_task(); // Queue all buffers
+	}
+	else
+	{
+		usb_ring_out_start(usb_type);
+	}
+	return 0;
+}
+
+/*******************************************************************************
+ * @fn     usb_stream_ring_task
+ *
+ * @brief  Refill Endpoint2 IN ring or release Endpoint2 OUT ring buffers
+ *         (to be called from main loop on EVENT_USB_STREAM)
+ *
+ * @return None
+ */
+void usb_stream_ring_task(void)
+{
+	if(((usb_stream.mode == USB_STREAM_RING_IN) || (usb_stream.mode == USB_STREAM_RING_OUT)) &&
+	   (usb_stream_ring_flags & USB_STREAM_RING_LINK))
+	{
+		link_usb_bench_task();
+		return;
+	}
+	if(usb_stream.mode == USB_STREAM_RING_IN)
+	{
+		uint8_t* buf;
+		while((buf = usb_ring_in_alloc()) != NULL)
+		{
+			if(usb_stream_ring_flags & USB_STREAM_RING_PATTERN)
+			{
+				fastmem_fill_inc32((uint32_t*)buf, usb_stream_ring_val, 1, USB_RING_BUF_SIZE / 4);
+				usb_stream_ring_val += (USB_RING_BUF_SIZE / 4);
+			}
+			if(usb_stream_ring_flags & USB_STREAM_RING_CRC)
+			{
+				usb_stream_ring_crc = crc32c_update(usb_stream_ring_crc, buf, USB_RING_BUF_SIZE - 4);
+				((uint32_t*)buf)[(USB_RING_BUF_SIZE / 4) - 1] = usb_stream_ring_crc;
+				if(soak_fault_inject())
+					((uint32_t*)buf)[(USB_RING_BUF_SIZE / 4) - 1] ^= 0xFFFFFFFF; // Only this buffer CRC is wrong
+			}
+			soak_frame(USB_RING_BUF_SIZE, 0);
+			usb_ring_in_submit(USB_RING_BUF_SIZE);
+		}
+	}
+	else if(usb_stream.mode == USB_STREAM_RING_OUT)
+	{
+		const uint8_t* data;
+		uint32_t len;
+		while(usb_ring_out_get(&data, &len))
+		{
+			if((usb_stream_ring_flags & USB_STREAM_RING_CRC) && (len >= 8) && ((len & 3) == 0))
+			{
+				uint32_t crc_rx = ((const uint32_t*)data)[(len / 4) - 1];
+				usb_stream_ring_crc = crc32c_update(usb_stream_ring_crc, data, len - 4);
+				if(usb_stream_ring_crc != crc_rx)
+				{
+					usb_ring_out.nb_crc_err++;
+					soak_error(SOAK_ERR_CRC);
+					usb_stream_ring_crc = crc_rx; // Resynchronize on host CRC
+				}
+				else
+				{
+					soak_frame(len, 0);
+				}
+			}
+			else
+			{
+				soak_frame(len, 0);
+			}
+			usb_ring_out_release();
+		}
+	}
+}
+
+/*******************************************************************************
+ * @fn     usb_stream_abort
+ *
+ * @brief  Abort actual stream (Endpoint2 given back to devbulk)
+ *
+ * @return None
+ */
+void usb_stream_abort(void)
+{
+	if(usb_stream.mode == USB_STREAM_IDLE)
+		return;
+	usb_stream.remaining = 0;
+	usb_stream.mode = USB_STREAM_IDLE;
+	usb_stream_hw_restore();
+}
+
+/*******************************************************************************
+ * @fn     usb_stream_ep2_in_done
+ *
+ * @brief  Endpoint2 IN transfer completed (called from USB IRQ)
+ *
+ * @param  usb_type: USB Type (USB2 HS or USB3 SS)
+ * @param  len: Returned length of next transfer
+ *
+ * @return DMA address of next transfer, 0 if no stream (Endpoint2 given
+ *         back to devbulk) or USB_STREAM_NAK
+ */
+uint32_t usb_stream_ep2_in_done(e_usb_type usb_type, uint32_t* len)
+{
+	(void)usb_type;
+	if(usb_stream.mode == USB_STREAM_RING_IN)
+		return usb_ring_ep2_in_done(len);
+	if(usb_stream.mode != USB_STREAM_MEM_READ)
+		return 0;
+	return usb_stream_in_next(len);
+}
+
+/*******************************************************************************
+ * @fn     usb_stream_ep2_out_done
+ *
+ * @brief  Endpoint2 OUT transfer completed (called from USB IRQ)
+ *
+ * @param  usb_type: USB Type (USB2 HS or USB3 SS)
+ * @param  rx_addr: DMA address of received data
+ * @param  len: Length of received data
+ *
+ * @return DMA address of next transfer, 0 if no stream (Endpoint2 given
+ *         back to devbulk) or USB_STREAM_NAK
+ */
+uint32_t usb_stream_ep2_out_done(e_usb_type usb_type, uint32_t rx_addr, uint32_t len)
+{
+	(void)usb_type;
+	if(usb_stream.mode == USB_STREAM_FWUPD)
+		return usb_stream_fwupd_out_done(len);
+	if(usb_stream.mode == USB_STREAM_RING_OUT)
+	{
+		usb_stream.total_bytes += len;
+		return usb_ring_ep2_out_done(len);
+	}
+	if(usb_stream.mode != USB_STREAM_MEM_WRITE)
+		return 0;
+	if(len > usb_stream.remaining)
+		len = usb_stream.remaining;
+	if(rx_addr == (uint32_t)usb_stream_bounce)
+	{
+		fastmem_cpy((void*)usb_stream.addr, usb_stream_bounce, len);
+		usb_stream.nb_copy++;
+	}
+	else
+	{
+		usb_stream.nb_zero_copy++;
+	}
+	usb_stream.addr += len;
+	usb_stream.remaining -= len;
+	usb_stream.total_bytes += len;
+	if(usb_stream.remaining == 0)
+	{
+		usb_stream.mode = USB_STREAM_IDLE;
+		return 0;
+	}
+	return usb_stream_out_next();
+}
+
+/*******************************************************************************
+ * @fn     EP2_IN_Callback
+ *
+ * @brief  USB3 Endpoint2 IN transfer completed (called from USBSS IRQ by
+ *         USB30 library, replace devbulk one see USB_WEAK_SYMS in Makefile)
+ *         devbulk default loopback/benchmark path is kept when no stream
+ *         is running
+ *
+ * @return None
+ */
+void EP2_IN_Callback(void)
+{
+	uint32_t dma_addr;
+	uint32_t len = 0;
+
+	if(usb_stream.mode == USB_STREAM_IDLE)
+	{
+		usb_devbulk_EP2_IN_Callback();
+		return;
+	}
+	USB30_IN_clearIT(ENDP_2);
+	dma_addr = usb_stream_ep2_in_done(USB_TYPE_USB3, &len);
+	if(usb_stream.mode == USB_STREAM_IDLE)
+		usb_stream_hw_restore(); // End of stream
+	else if((dma_addr != 0) && (dma_addr != USB_STREAM_NAK))
+		usb_stream_hw_in_arm(USB_TYPE_USB3, dma_addr, len);
+}
+
+/*******************************************************************************
+ * @fn     EP2_OUT_Callback
+ *
+ * @brief  USB3 Endpoint2 OUT transfer completed (called from USBSS IRQ by
+ *         USB30 library, replace devbulk one see USB_WEAK_SYMS in Makefile)
+ *         devbulk default loopback/benchmark path is kept when no stream
+ *         is running
+ *
+ * @return None
+ */
+void EP2_OUT_Callback(void)
+{
+	uint16_t rx_len;
+	uint8_t nump;
+	uint8_t status;
+	uint32_t len;
+	uint32_t dma_addr;
+
+	if(usb_stream.mode == USB_STREAM_IDLE)
+	{
+		usb_devbulk_EP2_OUT_Callback();
+		return;
+	}
+	USB30_OUT_status(ENDP_2, &nump, &rx_len, &status); // nump: packets not received, rx_len: last packet length
+	USB30_OUT_clearIT(ENDP_2);
+	len = ((DEF_ENDP2_OUT_BURST_LEVEL - nump - 1) * (DEF_ENDP2_MAX_SIZE / DEF_ENDP2_OUT_BURST_LEVEL)) + rx_len;
+	dma_addr = usb_stream_ep2_out_done(USB_TYPE_USB3, USBSS->UEP2_RX_DMA, len);
+	if(usb_stream.mode == USB_STREAM_IDLE)
+		usb_stream_hw_restore(); // End of stream
+	else if((dma_addr != 0) && (dma_addr != USB_STREAM_NAK))
+		usb_stream_hw_out_arm(USB_TYPE_USB3, dma_addr);
+}
+
+/*******************************************************************************
+ * @fn     usb_stream_usb2_irq
+ *
+ * @brief  USB2 Endpoint2 transfer completion while a stream is running
+ *         (called by USBHS_IRQHandler() before devbulk one)
+ *         Each packet moves the DMA address in the actual transfer, the
+ *         stream hooks are called at end of transfer (like USB3 bursts)
+ *
+ * @return 1 if the interrupt is handled else 0 (devbulk USBHS_IRQHandler)
+ */
+uint32_t usb_stream_usb2_irq(void)
+{
+	uint8_t int_st;
+	uint32_t dma_addr;
+	uint32_t len = 0;
+
+	if((usb_stream.mode == USB_STREAM_IDLE) || ((R8_USB_INT_FG & RB_USB_IF_TRANSFER) == 0))
+		return 0;
+	int_st = R8_USB_INT_ST;
+	if((int_st & MASK_UIS_ENDP) != ENDP_2)
+		return 0;
+	if((int_st & MASK_UIS_TOKEN) == UIS_TOKEN_IN)
+	{
+		R8_UEP2_TX_CTRL ^= RB_UEP_T_TOG_1;
+		R8_UEP2_TX_CTRL = (R8_UEP2_TX_CTRL & ~RB_UEP_TRES_MASK) | UEP_T_RES_NAK;
+		usb_stream_usb2_in_off += R16_UEP2_T_LEN;
+		if(usb_stream_usb2_in_off < usb_stream_usb2_in_len)
+		{
+			usb_stream_usb2_in_pkt();
+		}
+		else
+		{
+			dma_addr = usb_stream_ep2_in_done(USB_TYPE_USB2, &len);
+			if(usb_stream.mode == USB_STREAM_IDLE)
+				usb_stream_hw_restore(); // End of stream
+			else if((dma_addr != 0) && (dma_addr != USB_STREAM_NAK))
+				usb_stream_hw_in_arm(USB_TYPE_USB2, dma_addr, len);
+		}
+	}
+	else if((int_st & MASK_UIS_TOKEN) == UIS_TOKEN_OUT)
+	{
+		if(int_st & RB_USB_ST_TOGOK)
+		{
+			uint32_t rx_len = R16_USB_RX_LEN;
+
+			R8_UEP2_RX_CTRL ^= RB_UEP_R_TOG_1;
+			R8_UEP2_RX_CTRL = (R8_UEP2_RX_CTRL & ~RB_UEP_RRES_MASK) | UEP_R_RES_NAK;
+			usb_stream_usb2_out_off += rx_len;
+			if((rx_len == USB_STREAM_USB2_PKT_SIZE) && (usb_stream_usb2_out_off < USB_STREAM_CHUNK_SIZE))
+			{
+				R32_UEP2_RX_DMA = usb_stream_usb2_out_addr + usb_stream_usb2_out_off;
+				R8_UEP2_RX_CTRL = (R8_UEP2_RX_CTRL & ~RB_UEP_RRES_MASK) | UEP_R_RES_ACK;
+			}
+			else
+			{
+				dma_addr = usb_stream_ep2_out_done(USB_TYPE_USB2, usb_stream_usb2_out_addr, usb_stream_usb2_out_off);
+				if(usb_stream.mode == USB_STREAM_IDLE)
+					usb_stream_hw_restore(); // End of stream
+				else if((dma_addr != 0) && (dma_addr != USB_STREAM_NAK))
+					usb_stream_hw_out_arm(USB_TYPE_USB2, dma_addr);
+			}
+		}
+		/* else packet with wrong data toggle (retry): dropped, Endpoint2 OUT stays armed */
+	}
+	else
+	{
+		return 0;
+	}
+	R8_USB_INT_FG = RB_USB_IF_TRANSFER;
+	return 1;
+}
+
+/*******************************************************************************
+ * @fn     USBHS_IRQHandler
+ *
+ * @brief  USB2 interrupt, replace devbulk one (see USB_WEAK_SYMS in Makefile)
+ *         Endpoint2 stream transfers are handled by usb_stream_usb2_irq()
+ *         all other interrupts jump to devbulk USBHS_IRQHandler()
+ *         Registers are saved by hardware (HPE, WCH-Interrupt-fast) on
+ *         interrupt entry so both handlers share the same entry
+ *
+ * @return None
+ */
+__attribute__((naked)) void USBHS_IRQHandler(void)
+{
+	__asm volatile(
+		"call usb_stream_usb2_irq\n"
+		"bnez a0, 1f\n"
+		"j usb_devbulk_USBHS_IRQHandler\n"
+		"1: mret\n");
+}
@@ -0,0 +1,120 @@
+/********************************** (C) COPYRIGHT *******************************
+* File Name          : usb_stream.h
+* Author             : bvernoux
+* Version            : V1.0
+* Date               : 2026/10/19
+* Description        : USB2 & USB3 Endpoint2 streaming (memory read/write)
+* Copyright (c) 2026 Benjamin VERNOUX
+* SPDX-License-Identifier: Apache-2.0
+*******************************************************************************/
+#ifndef USB_STREAM_H_
+#define USB_STREAM_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "CH56x_usb_devbulk_desc_cmd.h"
+#include "event.h"
+
+/* Endpoint2 chunk size (one USB2/USB3 transfer) */
+#define USB_STREAM_CHUNK_SIZE (DEF_ENDP2_MAX_SIZE)
+
+/* USB DMA requirement for zero copy (data directly sent/received from/to memory) */
+#define USB_STREAM_DMA_ALIGN (16)
+
+/*
+ * Endpoint2 streams run in USB2 and USB3: the USB3 Endpoint2 completion
+ * callbacks are provided by usb_stream.c (EP2_IN_Callback()/
+ * EP2_OUT_Callback()) and USB2 Endpoint2 transfers are handled by
+ * usb_stream_usb2_irq() from USBHS_IRQHandler() (usb_stream.c) before
+ * devbulk one.
+ * When no stream is running the devbulk ones are called
+ * (usb_devbulk_EP2_IN_Callback()/usb_devbulk_EP2_OUT_Callback()/
+ * usb_devbulk_USBHS_IRQHandler() aliases created by Makefile) so the
+ * default loopback/benchmark path is kept, Endpoint2 is given back to it
+ * at end of each stream.
+ */
+
+/* USB2 High Speed bulk max packet size */
+#define USB_STREAM_USB2_PKT_SIZE (512)
+
+/* Event posted on each Endpoint2 ring transfer (see usb_ring.h) */
+#define EVENT_USB_STREAM EVENT_USER(0)
+
+/* Hooks return value to not re-arm Endpoint2 (already re-armed by usb_ring
+ * or NAK until a buffer is free) */
+#define USB_STREAM_NAK (0xFFFFFFFF)
+
+/* Memory regions access flags */
+#define USB_STREAM_MEM_RD  (1 << 0)
+#define USB_STREAM_MEM_WR  (1 << 1)
+#define USB_STREAM_MEM_DMA (1 << 2) /* Accessible by USB DMA (zero copy) */
+
+typedef enum
+{
+	USB_STREAM_IDLE = 0, /* Endpoint2 owned by devbulk (default loopback/benchmark) */
+	USB_STREAM_MEM_READ, /* Endpoint2 IN send memory range */
+	USB_STREAM_MEM_WRITE, /* Endpoint2 OUT write memory range */
+	USB_STREAM_FWUPD, /* Endpoint2 OUT firmware update data (see fwupd.h) */
+	USB_STREAM_RING_IN, /* Endpoint2 IN ring benchmark */
+	USB_STREAM_RING_OUT, /* Endpoint2 OUT ring benchmark */
+} e_usb_stream_mode;
+
+typedef struct
+{
+	uint32_t mode; /* see e_usb_stream_mode */
+	uint32_t addr; /* Next memory address */
+	uint32_t remaining; /* Remaining bytes */
+	uint32_t total_bytes; /* Total bytes transferred since startup */
+	uint32_t nb_zero_copy; /* Number of chunks transferred directly by USB DMA */
+	uint32_t nb_copy; /* Number of chunks transferred with bounce buffer */
+} usb_stream_t;
+
+extern usb_stream_t usb_stream;
+
+uint32_t usb_stream_mem_access(uint32_t addr, uint32_t len);
+
+int usb_stream_mem_read_start(e_usb_type usb_type, uint32_t addr, uint32_t len);
+int usb_stream_mem_write_start(e_usb_type usb_type, uint32_t addr, uint32_t len);
+void usb_stream_abort(void);
+
+int usb_stream_fwupd_start(e_usb_type usb_type, uint32_t len);
+
+/* Ring benchmark flags */
+#define USB_STREAM_RING_PATTERN (1 << 0) /* IN buffers filled with 32bits incremental counter */
+/*
+ * Last 32bits of each buffer is the running CRC32C (see crc32.h) of all
+ * previous bytes of the stream (CRC words excluded), IN: added by device,
+ * OUT: checked by device (usb_ring_stats_t nb_crc_err)
+ */
+#define USB_STREAM_RING_CRC (1 << 1)
+/*
+ * Buffers are produced/consumed by the common link benchmark harness
+ * (see link.h and link_usb.c) instead of USB_STREAM_RING_PATTERN/CRC
+ */
+#define USB_STREAM_RING_LINK (1 << 2)
+
+int usb_stream_ring_start(e_usb_type usb_type, uint32_t mode, uint32_t flags);
+void usb_stream_ring_task(void);
+
+void usb_stream_hw_in_arm(e_usb_type usb_type, uint32_t dma_addr, uint32_t len);
+void usb_stream_hw_out_arm(e_usb_type usb_type, uint32_t dma_addr);
+
+uint32_t usb_stream_usb2_irq(void);
+
+/*
+ * Endpoint2 hooks called by USB3 EP2_IN_Callback()/EP2_OUT_Callback()
+ * and USB2 usb_stream_usb2_irq() (usb_stream.c) on transfer completion.
+ * Returned value is the DMA address to use for next transfer,
+ * 0 at end of stream (Endpoint2 given back to devbulk) or USB_STREAM_NAK
+ * when Endpoint2 is already re-armed (or NAK) by usb_ring.
+ */
+uint32_t usb_stream_ep2_in_done(e_usb_type usb_type, uint32_t* len);
+uint32_t usb_stream_ep2_out_done(e_usb_type usb_type, uint32_t rx_addr, uint32_t len);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* USB_STREAM_H_ */
@@ -0,0 +1,148 @@
+/********************************** (C) COPYRIGHT *******************************
+* File Name          : bootprof.c
+* Author             : bvernoux
+* Version            : V1.0
+* Date               : 2026/10/19
+* Description        : Boot phases timing profile (SysTick)
+*                      Each phase is recorded only once (first begin/end)
+* Copyright (c) 2026 Benjamin VERNOUX
+* SPDX-License-Identifier: Apache-2.0
+*******************************************************************************/
+#include "CH56x_common.h"
+#include "CH56x_debug_log.h"
+#include "bootprof.h"
+
+static const char* const bootprof_name[BOOTPROF_NB_PHASE] =
+{
+	"log_init",
+	"UID read",
+	"USB desc",
+	"USB30D_init",
+	"USB link",
+	"USB enum",
+	"sync2boards",
+};
+
+static uint32_t bootprof_started; /* Bit mask of started phases */
+static uint32_t bootprof_ended; /* Bit mask of ended phases */
+static uint32_t bootprof_start[BOOTPROF_NB_PHASE]; /* us since bootprof_init() */
+static uint32_t bootprof_duration[BOOTPROF_NB_PHASE]; /* us */
+static uint64_t bootprof_t0; /* SysTick at bootprof_init() or bootprof_reclock_end() */
+static uint32_t bootprof_base_us; /* Time from bootprof_init() to bootprof_t0 */
+
+/* Time since bootprof_init() in us (SysTick count down) */
+static inline uint32_t bootprof_us(void)
+{
+	return bootprof_base_us + (uint32_t)((bootprof_t0 - bsp_get_SysTickCNT()) / bsp_get_nbtick_1us());
+}
+
+/*******************************************************************************
+ * @fn     bootprof_init
+ *
+ * @brief  Start time reference of boot profile (to be called just after
+ *         bsp_init() which starts SysTick)
+ *
+ * @return None
+ */
+void bootprof_init(void)
+{
+	bootprof_t0 = bsp_get_SysTickCNT();
+	bootprof_base_us = 0;
+}
+
+/*******************************************************************************
+ * @fn     bootprof_reclock_begin
+ *
+ * @brief  To be called before system clock change (bsp_init() restarts
+ *         SysTick), interrupts shall be disabled until bootprof_reclock_end()
+ *
+ * @return None
+ */
+void bootprof_reclock_begin(void)
+{
+	bootprof_base_us = bootprof_us();
+}
+
+/*******************************************************************************
+ * @fn     bootprof_reclock_end
+ *
+ * @brief  To be called after system clock change (new SysTick reference)
+ *
+ * @return None
+ */
+void bootprof_reclock_end(void)
+{
+	bootprof_t0 = bsp_get_SysTickCNT();
+}
+
+/*******************************************************************************
+ * @fn     bootprof_begin
+ *
+ * @brief  Start of a boot phase (ignored if phase already started)
+ *
+ * @return None
+ */
+void bootprof_begin(e_bootprof_phase phase)
+{
+	if(bootprof_started & (1UL << phase))
+		return;
+	bootprof_started |= (1UL << phase);
+	bootprof_start[phase] = bootprof_us();
+}
+
+/*******************************************************************************
+ * @fn     bootprof_end
+ *
+ * @brief  End of a boot phase (ignored if phase not started or already ended)
+ *
+ * @return 1 if phase duration is recorded else 0
+ */
+int bootprof_end(e_bootprof_phase phase)
+{
+	if(((bootprof_started & (1UL << phase)) == 0) || (bootprof_ended & (1UL << phase)))
+		return 0;
+	bootprof_duration[phase] = bootprof_us() - bootprof_start[phase];
+	bootprof_ended |= (1UL << phase);
+	return 1;
+}
+
+/*******************************************************************************
+ * @fn     bootprof_get
+ *
+ * @brief  Get boot profile in microseconds
+ *
+ * @return None
+ */
+void bootprof_get(bootprof_t* prof)
+{
+	uint32_t i;
+
+	prof->nb_phase = BOOTPROF_NB_PHASE;
+	prof->valid = bootprof_ended;
+	for(i = 0; i < BOOTPROF_NB_PHASE; i++)
+	{
+		prof->start_us[i] = bootprof_start[i];
+		prof->duration_us[i] = bootprof_duration[i];
+	}
+}
+
+/*******************************************************************************
+ * @fn     bootprof_log
+ *
+ * @brief  Log measured boot phases
+ *
+ * @return None
+ */
+void bootprof_log(void)
+{
+	uint32_t i;
+
+	for(i = 0; i < BOOTPROF_NB_PHASE; i++)
+	{
+		if(bootprof_ended & (1UL << i))
+		{
+			log_printf("BOOT %s start=%dus duration=%dus\n", bootprof_name[i],
+					   bootprof_start[i], bootprof_duration[i]);
+		}
+	}
+}
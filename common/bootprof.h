@@ -0,0 +1,61 @@
+/********************************** (C) COPYRIGHT *******************************
+* File Name          : bootprof.h
+* Author             : bvernoux
+* Version            : V1.0
+* Date               : 2026/10/19
+* Description        : Boot phases timing profile (SysTick)
+* Copyright (c) 2026 Benjamin VERNOUX
+* SPDX-License-Identifier: Apache-2.0
+*******************************************************************************/
+#ifndef BOOTPROF_H_
+#define BOOTPROF_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+
+typedef enum
+{
+	BOOTPROF_LOG_INIT = 0, /* log_init() */
+	BOOTPROF_UID_READ, /* FLASH_ROMA_READ() of Unique ID */
+	BOOTPROF_USB_DESC, /* USB descriptors setup */
+	BOOTPROF_USB30D_INIT, /* USB30D_init() */
+	BOOTPROF_USB_LINK, /* USB link training (end of USB30D_init() to USB connected) */
+	BOOTPROF_USB_ENUM, /* USB enumeration (USB connected to USB_INT_CONNECT_ENUM) */
+	BOOTPROF_SYNC2BOARDS, /* bsp_sync2boards() (dual board) */
+	BOOTPROF_NB_PHASE
+} e_bootprof_phase;
+
+/*
+ * Boot profile, times in microseconds since bootprof_init() (just after
+ * bsp_init()), converted when each phase starts/ends so a system clock change
+ * (bootprof_reclock_begin()/bootprof_reclock_end()) keeps them valid.
+ * bsp_gpio_init() and bsp_init() are executed before SysTick is started and
+ * are not phases: SysTick (started by bsp_init()) is the only time base of
+ * the BSP and bsp_init() changes the system clock, so their time cannot be
+ * measured by the firmware (measure it from reset with a GPIO toggled after
+ * bsp_init() and an oscilloscope/logic analyzer)
+ */
+typedef struct
+{
+	uint32_t nb_phase; /* BOOTPROF_NB_PHASE */
+	uint32_t valid; /* Bit mask of measured phases (1 << e_bootprof_phase) */
+	uint32_t start_us[BOOTPROF_NB_PHASE]; /* Phase start */
+	uint32_t duration_us[BOOTPROF_NB_PHASE]; /* Phase duration */
+} bootprof_t;
+
+void bootprof_init(void);
+void bootprof_reclock_begin(void);
+void bootprof_reclock_end(void);
+void bootprof_begin(e_bootprof_phase phase);
+int bootprof_end(e_bootprof_phase phase);
+void bootprof_get(bootprof_t* prof);
+void bootprof_log(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* BOOTPROF_H_ */
@@ -0,0 +1,184 @@
+/********************************** (C) COPYRIGHT *******************************
+* File Name          : clkgov.c
+* Author             : bvernoux
+* Version            : V1.0
+* Date               : 2026/10/19
+* Description        : System clock governor (low frequency when idle,
+*                      full speed before link traffic) with ramp-up latency
+* Copyright (c) 2026 Benjamin VERNOUX
+* SPDX-License-Identifier: Apache-2.0
+*******************************************************************************/
+#include "CH56x_common.h"
+#include "CH56x_debug_log.h"
+#include "bootprof.h"
+#include "fastmem.h"
+#include "irq_save.h"
+#include "event.h"
+#include "trace.h"
+#include "clkgov.h"
+
+/* clkgov_activity() can be called from ISR and main loop */
+
+static uint32_t clkgov_enabled;
+static uint32_t clkgov_is_low;
+static uint32_t clkgov_freq_high;
+static uint32_t clkgov_freq_low;
+static uint32_t clkgov_idle_ms;
+static uint32_t clkgov_uart_baud;
+static uint32_t clkgov_activity_ts; /* SysTick LSB of last clkgov_activity() (at freq_high) */
+static clkgov_stats_t clkgov_stats;
+
+/*******************************************************************************
+ * @fn     clkgov_switch
+ *
+ * @brief  Switch system clock (shall be called with interrupts disabled)
+ *
+ * @param  freq: New system clock in Hz
+ *
+ * @return Switch duration in ns (SysTick before and after bsp_init())
+ */
+static uint32_t clkgov_switch(uint32_t freq)
+{
+	uint32_t start = bsp_get_SysTickCNT_LSB();
+	uint32_t old_ns;
+
+	TRACE(CLK_SWITCH, freq / 1000000);
+	if(clkgov_uart_baud != 0)
+	{
+		/* Do not corrupt the character being sent */
+		while((R8_UART1_LSR & RB_LSR_TX_ALL_EMP) == 0);
+	}
+	old_ns = ((start - bsp_get_SysTickCNT_LSB()) * 1000) / bsp_get_nbtick_1us(); // SysTick count down
+	bootprof_reclock_begin();
+	bsp_init(freq); // SysTick restarted with new bsp_get_nbtick_1us()
+	bootprof_reclock_end();
+	if(clkgov_uart_baud != 0)
+		UART1_init(clkgov_uart_baud, freq);
+	event_reclock();
+	clkgov_stats.freq = freq;
+	TRACE(CLK_SWITCH, 0);
+	return old_ns + (((0 - bsp_get_SysTickCNT_LSB()) * 1000) / bsp_get_nbtick_1us());
+}
+
+/*******************************************************************************
+ * @fn     clkgov_init
+ *
+ * @brief  Enable clock governor (shall be called after bsp_init(freq_high),
+ *         UART1_init() and event_init())
+ *
+ * @param  freq_high: System clock in Hz for link traffic (current clock)
+ * @param  freq_low: System clock in Hz when idle
+ * @param  idle_ms: Time without clkgov_activity() before switch to freq_low
+ * @param  uart_baud: UART1 baud rate (0 if UART1 is not used)
+ *
+ * @return None
+ */
+void clkgov_init(uint32_t freq_high, uint32_t freq_low, uint32_t idle_ms, uint32_t uart_baud)
+{
+	fastmem_set(&clkgov_stats, 0, sizeof(clkgov_stats_t));
+	clkgov_stats.freq = freq_high;
+	clkgov_freq_high = freq_high;
+	clkgov_freq_low = freq_low;
+	clkgov_idle_ms = idle_ms;
+	clkgov_uart_baud = uart_baud;
+	clkgov_is_low = 0;
+	clkgov_activity_ts = bsp_get_SysTickCNT_LSB();
+	clkgov_enabled = 1;
+}
+
+/*******************************************************************************
+ * @fn     clkgov_activity
+ *
+ * @brief  Link traffic will start or is running, switch to freq_high if
+ *         needed and restart idle time (can be called from ISR)
+ *
+ * @return None
+ */
+void clkgov_activity(void)
+{
+	uint32_t mstatus;
+	uint32_t ns;
+
+	if(clkgov_enabled == 0)
+		return;
+	mstatus = irq_save();
+	if(clkgov_is_low)
+	{
+		/* SysTick started at switch to freq_low */
+		clkgov_stats.low_ms += (uint32_t)((0 - bsp_get_SysTickCNT()) / bsp_get_nbtick_1us() / 1000);
+		ns = clkgov_switch(clkgov_freq_high);
+		clkgov_is_low = 0;
+		clkgov_stats.nb_up++;
+		clkgov_stats.ramp_ns_last = ns;
+		if((clkgov_stats.ramp_ns_min == 0) || (ns < clkgov_stats.ramp_ns_min))
+			clkgov_stats.ramp_ns_min = ns;
+		if(ns > clkgov_stats.ramp_ns_max)
+			clkgov_stats.ramp_ns_max = ns;
+	}
+	clkgov_activity_ts = bsp_get_SysTickCNT_LSB();
+	irq_restore(mstatus);
+}
+
+/*******************************************************************************
+ * @fn     clkgov_task
+ *
+ * @brief  Switch to freq_low after idle_ms without clkgov_activity()
+ *         (to be called from main loop, not while a SysTick duration is measured)
+ *
+ * @return None
+ */
+void clkgov_task(void)
+{
+	uint32_t mstatus;
+	uint32_t idle_us;
+
+	if(clkgov_enabled == 0)
+		return;
+	mstatus = irq_save();
+	if(clkgov_is_low == 0)
+	{
+		idle_us = (clkgov_activity_ts - bsp_get_SysTickCNT_LSB()) / bsp_get_nbtick_1us(); // SysTick count down
+		if(idle_us >= (clkgov_idle_ms * 1000))
+		{
+			clkgov_switch(clkgov_freq_low);
+			clkgov_is_low = 1;
+			clkgov_stats.nb_down++;
+		}
+	}
+	irq_restore(mstatus);
+}
+
+/*******************************************************************************
+ * @fn     clkgov_stats_get
+ *
+ * @brief  Get a consistent copy of clock governor statistics
+ *
+ * @return None
+ */
+void clkgov_stats_get(clkgov_stats_t* stats)
+{
+	uint32_t mstatus;
+
+	mstatus = irq_save();
+	fastmem_cpy(stats, &clkgov_stats, sizeof(clkgov_stats_t));
+	if(clkgov_is_low)
+		stats->low_ms += (uint32_t)((0 - bsp_get_SysTickCNT()) / bsp_get_nbtick_1us() / 1000);
+	irq_restore(mstatus);
+}
+
+/*******************************************************************************
+ * @fn     clkgov_log
+ *
+ * @brief  Log clock governor statistics
+ *
+ * @return None
+ */
+void clkgov_log(void)
+{
+	clkgov_stats_t stats;
+
+	clkgov_stats_get(&stats);
+	log_printf("CLKGOV %dMHz up=%d down=%d ramp=%dns(min=%d max=%d) low=%dms\n",
+			   stats.freq / 1000000, stats.nb_up, stats.nb_down, stats.ramp_ns_last,
+			   stats.ramp_ns_min, stats.ramp_ns_max, stats.low_ms);
+}
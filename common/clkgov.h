@@ -0,0 +1,59 @@
+/********************************** (C) COPYRIGHT *******************************
+* File Name          : clkgov.h
+* Author             : bvernoux
+* Version            : V1.0
+* Date               : 2026/10/19
+* Description        : System clock governor (low frequency when idle,
+*                      full speed before link traffic) with ramp-up latency
+* Copyright (c) 2026 Benjamin VERNOUX
+* SPDX-License-Identifier: Apache-2.0
+*******************************************************************************/
+#ifndef CLKGOV_H_
+#define CLKGOV_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+
+/*
+ * Governor is disabled (clkgov_activity()/clkgov_task() do nothing) until
+ * clkgov_init() is called, the application starts at freq_high.
+ * - clkgov_activity() shall be called before HSPI/SerDes/USB traffic (can be
+ *   called from ISR), it switches to freq_high if needed
+ * - clkgov_task() (main loop only) switches to freq_low after idle_ms without
+ *   clkgov_activity()
+ * Each switch calls bsp_init() (SysTick restarted with new
+ * bsp_get_nbtick_1us(), bsp_wait_us_delay()/bsp_wait_ms_delay() stay exact),
+ * UART1_init() (uart_baud shall be reachable at freq_low) and event_reclock().
+ * SysTick durations spanning a switch are not valid (bootprof_t since boot,
+ * soak_stats_t uptime, trace ring timestamps).
+ * freq_low/freq_high shall be valid for bsp_init() (480MHz PLL divided
+ * by 4 to 32, for example 15/30/60/120MHz).
+ */
+#define CLKGOV_FREQ_LOW (30000000) /* Default idle system clock in Hz */
+#define CLKGOV_IDLE_MS (1000) /* Default idle time before switch to low frequency */
+
+typedef struct
+{
+	uint32_t freq; /* Current system clock in Hz */
+	uint32_t nb_up; /* Switch to freq_high (ramp-up) */
+	uint32_t nb_down; /* Switch to freq_low */
+	uint32_t ramp_ns_last; /* Ramp-up duration (switch start to freq_high ready) */
+	uint32_t ramp_ns_min;
+	uint32_t ramp_ns_max;
+	uint32_t low_ms; /* Total time spent at freq_low */
+} clkgov_stats_t;
+
+void clkgov_init(uint32_t freq_high, uint32_t freq_low, uint32_t idle_ms, uint32_t uart_baud);
+void clkgov_activity(void);
+void clkgov_task(void);
+void clkgov_stats_get(clkgov_stats_t* stats);
+void clkgov_log(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CLKGOV_H_ */
@@ -0,0 +1,185 @@
+/********************************** (C) COPYRIGHT *******************************
+* File Name          : crc32.c
+* Author             : bvernoux
+* Version            : V1.0
+* Date               : 2026/10/19
+* Description        : CRC32 (IEEE 802.3) & CRC32C (Castagnoli) table driven
+*                      slicing-by-4/by-8, portable (firmware and host)
+*                      Head bytes are processed one by one up to 32bits
+*                      alignment then 32bits loads are used (byte swapped
+*                      on big endian host)
+* Copyright (c) 2026 Benjamin VERNOUX
+* SPDX-License-Identifier: Apache-2.0
+*******************************************************************************/
+#include <stdint.h>
+#include <string.h>
+
+#include "crc32.h"
+#include "crc32_table.h"
+
+static const uint32_t (* const crc32_tables[])[256] =
+{
+	crc32_table_ieee,
+	crc32_table_c,
+};
+
+static const uint32_t crc32_polys[] =
+{
+	0xEDB88320,
+	0x82F63B78,
+};
+
+/* Little endian 32bits load, memcpy() (no strict aliasing issue) is compiled as one lw */
+static inline uint32_t crc32_load32(const uint8_t* p)
+{
+	uint32_t v;
+
+	memcpy(&v, p, sizeof(v));
+#if defined(__BYTE_ORDER__) && (__BYTE_ORDER__ == __ORDER_BIG_ENDIAN__)
+	v = __builtin_bswap32(v);
+#endif
+	return v;
+}
+
+/*******************************************************************************
+ * @fn     crc32_bitwise
+ *
+ * @brief  CRC32 bit by bit (reference, no table)
+ *
+ * @param  poly: CRC32_POLY_IEEE or CRC32_POLY_C
+ * @param  crc: Previous CRC (0 for first call)
+ * @param  data: Data
+ * @param  len: Length in bytes
+ *
+ * @return Updated CRC
+ */
+uint32_t crc32_bitwise(e_crc32_poly poly, uint32_t crc, const void* data, uint32_t len)
+{
+	const uint8_t* p = (const uint8_t*)data;
+	const uint32_t polynomial = crc32_polys[poly];
+	int i;
+
+	crc = ~crc;
+	while(len--)
+	{
+		crc ^= *p++;
+		for(i = 0; i < 8; i++)
+			crc = (crc >> 1) ^ (polynomial & (0 - (crc & 1)));
+	}
+	return ~crc;
+}
+
+/*******************************************************************************
+ * @fn     crc32_slice4
+ *
+ * @brief  CRC32 slicing-by-4 (4 bytes per iteration, 4KB of table)
+ *
+ * @param  poly: CRC32_POLY_IEEE or CRC32_POLY_C
+ * @param  crc: Previous CRC (0 for first call)
+ * @param  data: Data
+ * @param  len: Length in bytes
+ *
+ * @return Updated CRC
+ */
+uint32_t crc32_slice4(e_crc32_poly poly, uint32_t crc, const void* data, uint32_t len)
+{
+	const uint32_t (*t)[256] = crc32_tables[poly];
+	const uint8_t* p = (const uint8_t*)data;
+
+	crc = ~crc;
+	while((((uintptr_t)p) & 3) && len)
+	{
+		crc = (crc >> 8) ^ t[0][(crc ^ *p++) & 0xFF];
+		len--;
+	}
+	while(len >= 4)
+	{
+		uint32_t a = crc32_load32(p) ^ crc;
+		crc = t[3][a & 0xFF] ^ t[2][(a >> 8) & 0xFF] ^
+			  t[1][(a >> 16) & 0xFF] ^ t[0][a >> 24];
+		p += 4;
+		len -= 4;
+	}
+	while(len--)
+		crc = (crc >> 8) ^ t[0][(crc ^ *p++) & 0xFF];
+	return ~crc;
+}
+
+/*******************************************************************************
+ * @fn     crc32_slice8
+ *
+ * @brief  CRC32 slicing-by-8 (8 bytes per iteration, 8KB of table)
+ *
+ * @param  poly: CRC32_POLY_IEEE or CRC32_POLY_C
+ * @param  crc: Previous CRC (0 for first call)
+ * @param  data: Data
+ * @param  len: Length in bytes
+ *
+ * @return Updated CRC
+ */
+uint32_t crc32_slice8(e_crc32_poly poly, uint32_t crc, const void* data, uint32_t len)
+{
+	const uint32_t (*t)[256] = crc32_tables[poly];
+	const uint8_t* p = (const uint8_t*)data;
+
+	crc = ~crc;
+	while((((uintptr_t)p) & 3) && len)
+	{
+		crc = (crc >> 8) ^ t[0][(crc ^ *p++) & 0xFF];
+		len--;
+	}
+	while(len >= 8)
+	{
+		uint32_t a = crc32_load32(p) ^ crc;
+		uint32_t b = crc32_load32(p + 4);
+		crc = t[7][a & 0xFF] ^ t[6][(a >> 8) & 0xFF] ^
+			  t[5][(a >> 16) & 0xFF] ^ t[4][a >> 24] ^
+			  t[3][b & 0xFF] ^ t[2][(b >> 8) & 0xFF] ^
+			  t[1][(b >> 16) & 0xFF] ^ t[0][b >> 24];
+		p += 8;
+		len -= 8;
+	}
+	while(len--)
+		crc = (crc >> 8) ^ t[0][(crc ^ *p++) & 0xFF];
+	return ~crc;
+}
+
+/*******************************************************************************
+ * @fn     crc32_update
+ *
+ * @brief  CRC32 (IEEE 802.3 reflected polynomial 0xEDB88320)
+ *
+ * @param  crc: Previous CRC (0 for first call)
+ * @param  data: Data
+ * @param  len: Length in bytes
+ *
+ * @return Updated CRC
+ */
+uint32_t crc32_update(uint32_t crc, const void* data, uint32_t len)
+{
+#if(CRC32_SLICE_BY == 4)
+	return crc32_slice4(CRC32_POLY_IEEE, crc, data, len);
+#else
+	return crc32_slice8(CRC32_POLY_IEEE, crc, data, len);
+#endif
+}
+
+/*******************************************************************************
+ * @fn     crc32c_update
+ *
+ * @brief  CRC32C (Castagnoli reflected polynomial 0x82F63B78)
+ *
+ * @param  crc: Previous CRC (0 for first call)
+ * @param  data: Data
+ * @param  len: Length in bytes
+ *
+ * @return Updated CRC
+ */
+uint32_t crc32c_update(uint32_t crc, const void* data, uint32_t len)
+{
+#if(CRC32_SLICE_BY == 4)
+	return crc32_slice4(CRC32_POLY_C, crc, data, len);
+#else
+	return crc32_slice8(CRC32_POLY_C, crc, data, len);
+#endif
+}
@@ -0,0 +1,53 @@
+/********************************** (C) COPYRIGHT *******************************
+* File Name          : crc32.h
+* Author             : bvernoux
+* Version            : V1.0
+* Date               : 2026/10/19
+* Description        : CRC32 (IEEE 802.3) & CRC32C (Castagnoli) table driven
+*                      slicing-by-4/by-8, portable (firmware and host)
+* Copyright (c) 2026 Benjamin VERNOUX
+* SPDX-License-Identifier: Apache-2.0
+*******************************************************************************/
+#ifndef CRC32_H_
+#define CRC32_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+
+/*
+ * crc is the value returned by previous call (0 for first call) so a
+ * CRC can be computed in several blocks (running checksum).
+ * CRC32("123456789") = 0xCBF43926, CRC32C("123456789") = 0xE3069283
+ *
+ * Define CRC32_SLICE_BY (4) to use slicing-by-4 for crc32_update()/
+ * crc32c_update() (default slicing-by-8, faster but twice more tables
+ * accessed per 8 bytes, tables are always in flash)
+ */
+#ifndef CRC32_SLICE_BY
+#define CRC32_SLICE_BY (8)
+#endif
+
+typedef enum
+{
+	CRC32_POLY_IEEE = 0, /* CRC32 reflected 0xEDB88320 (Ethernet, zlib) */
+	CRC32_POLY_C, /* CRC32C reflected 0x82F63B78 (iSCSI, ext4) */
+} e_crc32_poly;
+
+uint32_t crc32_update(uint32_t crc, const void* data, uint32_t len);
+uint32_t crc32c_update(uint32_t crc, const void* data, uint32_t len);
+
+uint32_t crc32_bitwise(e_crc32_poly poly, uint32_t crc, const void* data, uint32_t len);
+uint32_t crc32_slice4(e_crc32_poly poly, uint32_t crc, const void* data, uint32_t len);
+uint32_t crc32_slice8(e_crc32_poly poly, uint32_t crc, const void* data, uint32_t len);
+
+/* Benchmark cycles/byte of each version (firmware only, result with log_printf()) */
+void crc32_benchmark(const uint8_t* buf, uint32_t size);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CRC32_H_ */
@@ -0,0 +1,66 @@
+/********************************** (C) COPYRIGHT *******************************
+* File Name          : crc32_bench.c
+* Author             : bvernoux
+* Version            : V1.0
+* Date               : 2026/10/19
+* Description        : CRC32/CRC32C cycles per byte benchmark (firmware only,
+*                      crc32.c is portable and can be built on host alone)
+* Copyright (c) 2026 Benjamin VERNOUX
+* SPDX-License-Identifier: Apache-2.0
+*******************************************************************************/
+#include "CH56x_common.h"
+#include "CH56x_debug_log.h"
+#include "crc32.h"
+
+typedef uint32_t (*crc32_fn_t)(e_crc32_poly poly, uint32_t crc, const void* data, uint32_t len);
+
+/*******************************************************************************
+ * @fn     crc32_bench_one
+ *
+ * @brief  Measure and log one CRC version
+ *
+ * @return None
+ */
+static void crc32_bench_one(const char* name, crc32_fn_t fn, e_crc32_poly poly,
+							const uint8_t* buf, uint32_t size)
+{
+	uint32_t start;
+	uint32_t cycles;
+	uint32_t crc;
+	uint32_t nb_us;
+
+	start = bsp_get_SysTickCNT_LSB();
+	crc = fn(poly, 0, buf, size);
+	cycles = start - bsp_get_SysTickCNT_LSB(); // SysTick count down
+	nb_us = cycles / bsp_get_nbtick_1us();
+	if(nb_us == 0)
+		nb_us = 1;
+	/* cycles/byte with 2 decimals */
+	log_printf("%s %s=0x%08X %d cycles %d.%02d cycles/byte (%d MB/s)\n",
+			   name, (poly == CRC32_POLY_IEEE) ? "CRC32 " : "CRC32C", crc, cycles,
+			   cycles / size, ((cycles % size) * 100) / size, (size / nb_us));
+}
+
+/*******************************************************************************
+ * @fn     crc32_benchmark
+ *
+ * @brief  Benchmark bitwise, slicing-by-4 and slicing-by-8 CRC32/CRC32C,
+ *         results are displayed with log_printf()
+ *
+ * @param  buf: Data (RAM or RAMX)
+ * @param  size: Size in bytes
+ *
+ * @return None
+ */
+void crc32_benchmark(const uint8_t* buf, uint32_t size)
+{
+	int poly;
+
+	log_printf("crc32 benchmark size=%d bytes\n", size);
+	for(poly = CRC32_POLY_IEEE; poly <= CRC32_POLY_C; poly++)
+	{
+		crc32_bench_one("bitwise", crc32_bitwise, poly, buf, size);
+		crc32_bench_one("slice4 ", crc32_slice4, poly, buf, size);
+		crc32_bench_one("slice8 ", crc32_slice8, poly, buf, size);
+	}
+}
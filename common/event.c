@@ -0,0 +1,373 @@
+/********************************** (C) COPYRIGHT *******************************
+* File Name          : event.c
+* Author             : bvernoux
+* Version            : V1.0
+* Date               : 2026/10/19
+* Description        : Minimal event/flag dispatcher (ISR post / main loop WFI wait)
+*                      Timer events use TMR1 (TMR0 is reserved for USB)
+* Copyright (c) 2026 Benjamin VERNOUX
+* SPDX-License-Identifier: Apache-2.0
+*******************************************************************************/
+#include "CH56x_common.h"
+#include "event.h"
+#include "irq_save.h"
+#include "irqprio.h"
+#include "trace.h"
+
+static volatile uint32_t event_pending;
+static volatile uint32_t event_post_ts[32]; /* SysTick LSB of event_post() per event bit (first post while not pending) */
+static volatile uint32_t event_timer_ms;
+
+static uint64_t event_window_start; /* SysTick at start of idle measurement window (64bits, no wrap) */
+static uint64_t event_idle_cycles; /* SysTick cycles spent in sleep since event_window_start */
+static volatile uint32_t event_reclocked; /* SysTick restarted during event_sleep() */
+static event_stats_t event_stats;
+static event_wake_hook_t event_wake_hook;
+
+/*******************************************************************************
+ * @fn     event_init
+ *
+ * @brief  Initialize event dispatcher and statistics
+ *         Shall be called after bsp_init() (SysTick shall be started)
+ *
+ * @return None
+ */
+void event_init(void)
+{
+	event_pending = 0;
+	event_timer_ms = 0;
+	memset(&event_stats, 0, sizeof(event_stats));
+	event_stats.wake_lat_min = 0xFFFFFFFF;
+	event_idle_cycles = 0;
+	event_window_start = bsp_get_SysTickCNT();
+}
+
+/*******************************************************************************
+ * @fn     event_set_wake_hook
+ *
+ * @brief  Set hook called after each wake-up from sleep (see event_wake_hook_t)
+ *
+ * @param  hook: Function to call or NULL
+ *
+ * @return None
+ */
+void event_set_wake_hook(event_wake_hook_t hook)
+{
+	event_wake_hook = hook;
+}
+
+/*******************************************************************************
+ * @fn     event_post
+ *
+ * @brief  Post event(s) (can be called from ISR or main loop)
+ *
+ * @param  events: Event(s) bit mask to post
+ *
+ * @return None
+ */
+void event_post(uint32_t events)
+{
+	uint32_t ts = bsp_get_SysTickCNT_LSB();
+	uint32_t first;
+
+	/* Keep timestamp of first post, a re-post of a pending event shall not hide the wake-up latency */
+	first = events & ~__atomic_fetch_or(&event_pending, events, __ATOMIC_RELAXED);
+	while(first)
+	{
+		event_post_ts[__builtin_ctz(first)] = ts;
+		first &= (first - 1);
+	}
+}
+
+/*******************************************************************************
+ * @fn     event_poll
+ *
+ * @brief  Return and clear pending event(s) without waiting
+ *
+ * @param  mask: Event(s) bit mask to check
+ *
+ * @return Pending event(s) in mask (0 if none)
+ */
+uint32_t event_poll(uint32_t mask)
+{
+	uint32_t events = event_pending & mask;
+	if(events)
+		__atomic_fetch_and(&event_pending, ~events, __ATOMIC_RELAXED);
+	return events;
+}
+
+/*******************************************************************************
+ * @fn     event_sleep
+ *
+ * @brief  Sleep until next interrupt and account the time spent in sleep
+ *         Shall be called with global interrupts disabled by irq_save(),
+ *         WFI wake-up even if mstatus.MIE is cleared and pending ISR is
+ *         executed when global interrupts are restored.
+ *
+ * @param  mask: Event(s) bit mask which shall wake-up (EVENT_IDLE_POLL only)
+ * @param  mstatus: Value returned by irq_save()
+ *
+ * @return None
+ */
+static void event_sleep(uint32_t mask, uint32_t mstatus)
+{
+	uint64_t start;
+
+	start = bsp_get_SysTickCNT();
+#if(defined EVENT_IDLE_POLL)
+	irq_restore(mstatus);
+	while((event_pending & mask) == 0)
+	{
+		if(event_wake_hook)
+			event_wake_hook();
+	}
+#else
+	(void)mask;
+	__WFI();
+	irq_restore(mstatus); // Pending ISR executed here
+	if(event_wake_hook)
+		event_wake_hook();
+#endif
+	TRACE(EVENT_WAKE, event_pending);
+	/* Masked: event_idle_percent()/event_reclock() can be called from ISR */
+	mstatus = irq_save();
+	if(event_reclocked)
+		event_reclocked = 0; // start is from previous SysTick
+	else
+		event_idle_cycles += (start - bsp_get_SysTickCNT()); // SysTick count down
+	irq_restore(mstatus);
+}
+
+/*******************************************************************************
+ * @fn     event_wait
+ *
+ * @brief  Wait (in sleep mode) until at least one event in mask is posted
+ *
+ * @param  mask: Event(s) bit mask to wait
+ *
+ * @return Posted event(s) in mask (cleared from pending events)
+ */
+uint32_t event_wait(uint32_t mask)
+{
+	uint32_t events;
+	uint32_t bits;
+	uint32_t now;
+	uint32_t lat;
+	uint32_t mstatus;
+
+	while(1)
+	{
+		mstatus = irq_save();
+		events = event_pending & mask;
+		if(events)
+		{
+			__atomic_fetch_and(&event_pending, ~events, __ATOMIC_RELAXED);
+			irq_restore(mstatus);
+			break;
+		}
+		event_sleep(mask, mstatus);
+	}
+	/* Latency from the oldest posted event (the one which wake-up the core) */
+	now = bsp_get_SysTickCNT_LSB();
+	lat = 0;
+	for(bits = events; bits; bits &= (bits - 1))
+	{
+		uint32_t l = event_post_ts[__builtin_ctz(bits)] - now; // SysTick count down
+		if(l > lat)
+			lat = l;
+	}
+	event_stats.wake_count++;
+	event_stats.wake_lat_last = lat;
+	if(lat < event_stats.wake_lat_min)
+		event_stats.wake_lat_min = lat;
+	if(lat > event_stats.wake_lat_max)
+		event_stats.wake_lat_max = lat;
+	return events;
+}
+
+/*******************************************************************************
+ * @fn     event_idle
+ *
+ * @brief  Sleep until next interrupt (any interrupt wake-up the core)
+ *         To be used by main loop checking state updated by ISR without event
+ *
+ * @return None
+ */
+void event_idle(void)
+{
+#if(defined EVENT_IDLE_POLL)
+	if(event_wake_hook)
+		event_wake_hook();
+	return; // The caller loop is the busy polling loop
+#else
+	event_sleep(0, irq_save());
+#endif
+}
+
+/*******************************************************************************
+ * @fn     event_timer_start
+ *
+ * @brief  Start TMR1 with 1ms period, EVENT_TIMER is posted after ms
+ *
+ * @param  ms: Delay in milliseconds (shall be > 0)
+ *
+ * @return None
+ */
+void event_timer_start(uint32_t ms)
+{
+	event_poll(EVENT_TIMER); // Clear old timer event
+	event_timer_ms = ms;
+	R8_TMR1_INTER_EN = RB_TMR_IE_CYC_END;
+	TMR1_TimerInit(bsp_get_nbtick_1us() * 1000);
+	PFIC_EnableIRQ(TMR1_IRQn);
+}
+
+/*******************************************************************************
+ * @fn     event_timer_stop
+ *
+ * @brief  Stop TMR1 (EVENT_TIMER will not be posted)
+ *
+ * @return None
+ */
+void event_timer_stop(void)
+{
+	TMR1_Disable();
+	PFIC_DisableIRQ(TMR1_IRQn);
+	event_timer_ms = 0;
+}
+
+/*******************************************************************************
+ * @fn     event_reclock
+ *
+ * @brief  To be called after system clock change (bsp_init() restarts SysTick
+ *         with new bsp_get_nbtick_1us()), can be called from ISR
+ *         - TMR1 period is updated if timer is running (remaining ms are kept)
+ *         - Idle measurement window and wake-up latency are restarted
+ *
+ * @return None
+ */
+void event_reclock(void)
+{
+	uint32_t i;
+	uint32_t mstatus;
+	uint32_t now;
+
+	if(event_timer_ms != 0)
+		TMR1_TimerInit(bsp_get_nbtick_1us() * 1000);
+	mstatus = irq_save();
+	event_reclocked = 1;
+	event_idle_cycles = 0;
+	event_window_start = bsp_get_SysTickCNT();
+	now = bsp_get_SysTickCNT_LSB();
+	for(i = 0; i < 32; i++)
+		event_post_ts[i] = now;
+	irq_restore(mstatus);
+}
+
+/*******************************************************************************
+ * @fn     event_sleep_ms
+ *
+ * @brief  Replacement of bsp_wait_ms_delay() which sleep (WFI) until
+ *         delay is elapsed
+ *
+ * @param  ms: Delay in milliseconds
+ *
+ * @return None
+ */
+void event_sleep_ms(uint32_t ms)
+{
+	if(ms == 0)
+		return;
+	event_timer_start(ms);
+	event_wait(EVENT_TIMER);
+}
+
+/*******************************************************************************
+ * @fn     event_sat32
+ *
+ * @brief  Saturate a 64bits cycle count to 32bits (event_stats_t fields)
+ *
+ * @param  cycles: Nb SysTick cycles
+ *
+ * @return cycles or 0xFFFFFFFF if it does not fit in 32bits
+ */
+static uint32_t event_sat32(uint64_t cycles)
+{
+	return (cycles > 0xFFFFFFFF) ? 0xFFFFFFFF : (uint32_t)cycles;
+}
+
+/*******************************************************************************
+ * @fn     event_stats_get
+ *
+ * @brief  Get a copy of event statistics (can be called from ISR)
+ *         idle_cycles/total_cycles saturate to 0xFFFFFFFF (about 35.8s at
+ *         120MHz), use event_idle_percent() for longer windows
+ *
+ * @param  stats: Destination of statistics
+ *
+ * @return None
+ */
+void event_stats_get(event_stats_t* stats)
+{
+	uint32_t mstatus;
+
+	mstatus = irq_save();
+	event_stats.idle_cycles = event_sat32(event_idle_cycles);
+	event_stats.total_cycles = event_sat32(event_window_start - bsp_get_SysTickCNT());
+	*stats = event_stats;
+	irq_restore(mstatus);
+}
+
+/*******************************************************************************
+ * @fn     event_idle_percent
+ *
+ * @brief  Return percentage of time spent in sleep since last call
+ *         and start a new measurement window (can be called from ISR)
+ *         64bits SysTick window, no wrap whatever the call period
+ *
+ * @return Idle percentage (0 to 100)
+ */
+uint32_t event_idle_percent(void)
+{
+	uint32_t mstatus;
+	uint64_t now;
+	uint64_t total;
+	uint64_t idle;
+
+	/* Snapshot and restart the window atomically (called from USB ISR) */
+	mstatus = irq_save();
+	now = bsp_get_SysTickCNT();
+	total = event_window_start - now; // SysTick count down
+	idle = event_idle_cycles;
+	event_window_start = now;
+	event_idle_cycles = 0;
+	irq_restore(mstatus);
+
+	if(total == 0)
+		return 0;
+	if(idle > total)
+		idle = total;
+	return (uint32_t)((idle * 100) / total);
+}
+
+/*********************************************************************
+ * @fn      TMR1_IRQHandler
+ *
+ * @brief   TMR1 handler (1ms period) for event_timer_start()
+ *
+ * @return  none
+ */
+__attribute__((interrupt("WCH-Interrupt-fast"))) void TMR1_IRQHandler(void)
+{
+	IRQPRIO_ENTER(start);
+	TRACE(TMR1_IRQ, event_timer_ms);
+	TMR1_ClearITFlag(RB_TMR_IF_CYC_END);
+	if(event_timer_ms > 0)
+		event_timer_ms--;
+	if(event_timer_ms == 0)
+	{
+		TMR1_Disable();
+		event_post(EVENT_TIMER);
+	}
+	IRQPRIO_EXIT(IRQPRIO_ID_TMR1, start);
+}
@@ -0,0 +1,75 @@
+/********************************** (C) COPYRIGHT *******************************
+* File Name          : event.h
+* Author             : bvernoux
+* Version            : V1.0
+* Date               : 2026/10/19
+* Description        : Minimal event/flag dispatcher (ISR post / main loop WFI wait)
+* Copyright (c) 2026 Benjamin VERNOUX
+* SPDX-License-Identifier: Apache-2.0
+*******************************************************************************/
+#ifndef EVENT_H_
+#define EVENT_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+
+/*
+ * Events are bits of a 32bits word.
+ * ISRs post events with event_post(), the main loop wait for them with
+ * event_wait() which put the core in sleep mode (WFI) until an interrupt occurs.
+ *
+ * Define EVENT_IDLE_POLL (1) (in Makefile DEFINE_OPTS) to replace WFI by a busy
+ * polling loop, this allows to compare the wake-up latency of both modes
+ * with the same event_stats_t counters.
+ */
+#if(defined EVENT_IDLE_POLL)
+#define EVENT_IDLE_MODE "POLL" // Idle mode name reported with latency statistics
+#else
+#define EVENT_IDLE_MODE "WFI"
+#endif
+
+#define EVENT_TIMER    (1UL << 0) // Timer started with event_timer_start() is elapsed
+#define EVENT_USER(n)  (1UL << (1 + (n))) // Application events (n from 0 to 30)
+
+typedef struct
+{
+	uint32_t idle_cycles; /* Nb SysTick cycles spent in sleep since last event_idle_percent() */
+	uint32_t total_cycles; /* Nb SysTick cycles since last event_idle_percent() */
+	uint32_t wake_count; /* Nb wake-up from event_post() */
+	uint32_t wake_lat_last; /* Last ISR event_post() to main wake-up latency in SysTick cycles */
+	uint32_t wake_lat_min; /* Min ISR event_post() to main wake-up latency in SysTick cycles */
+	uint32_t wake_lat_max; /* Max ISR event_post() to main wake-up latency in SysTick cycles */
+} event_stats_t;
+
+/*
+ * Wake-up hook called by event_wait()/event_idle() just after each interrupt
+ * which wake-up the core (also in event_wait() while the main loop waits for
+ * other events), allows to sample a state updated by an ISR without event
+ * (like USB state) at the end of this ISR, NULL to remove it
+ */
+typedef void (*event_wake_hook_t)(void);
+
+void event_init(void);
+void event_set_wake_hook(event_wake_hook_t hook);
+
+void event_post(uint32_t events);
+uint32_t event_wait(uint32_t mask);
+uint32_t event_poll(uint32_t mask);
+void event_idle(void);
+
+void event_timer_start(uint32_t ms);
+void event_timer_stop(void);
+void event_sleep_ms(uint32_t ms);
+void event_reclock(void);
+
+void event_stats_get(event_stats_t* stats);
+uint32_t event_idle_percent(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* EVENT_H_ */
@@ -0,0 +1,296 @@
+/********************************** (C) COPYRIGHT *******************************
+* File Name          : fastmem.c
+* Author             : bvernoux
+* Version            : V1.0
+* Date               : 2026/10/19
+* Description        : Fast word aligned memory copy/set/fill for RV32IMAC
+*                      (RAM/RAMX buffers)
+*                      newlib-nano memcpy()/memset() are optimized for size
+*                      (byte loop), those versions use 32bits load/store
+*                      unrolled by 8 words (32 bytes per iteration)
+* Copyright (c) 2026 Benjamin VERNOUX
+* SPDX-License-Identifier: Apache-2.0
+*******************************************************************************/
+#include "CH56x_common.h"
+#include "CH56x_debug_log.h"
+#include "fastmem.h"
+
+/* Avoid GCC to replace the loops by memcpy()/memset() calls */
+#define FASTMEM_NO_LIBCALL __attribute__((optimize("no-tree-loop-distribute-patterns")))
+
+/*******************************************************************************
+ * @fn     fastmem_cpy
+ *
+ * @brief  Copy memory (32bits unrolled copy if dst & src have same alignment)
+ *         Forward copy, each block is loaded before it is stored so
+ *         overlapping regions with dst below src are copied correctly
+ *         (see fastmem_move())
+ *
+ * @param  dst: Destination address
+ * @param  src: Source address
+ * @param  len: Number of bytes to copy
+ *
+ * @return None
+ */
+FASTMEM_NO_LIBCALL void fastmem_cpy(void* dst, const void* src, uint32_t len)
+{
+	uint8_t* d8 = (uint8_t*)dst;
+	const uint8_t* s8 = (const uint8_t*)src;
+
+	if((((uint32_t)d8 ^ (uint32_t)s8) & 3) == 0)
+	{
+		uint32_t* d32;
+		const uint32_t* s32;
+
+		/* Copy head bytes up to 32bits alignment */
+		while((((uint32_t)d8) & 3) && len)
+		{
+			*d8++ = *s8++;
+			len--;
+		}
+		d32 = (uint32_t*)d8;
+		s32 = (const uint32_t*)s8;
+		while(len >= 32)
+		{
+			uint32_t w0 = s32[0], w1 = s32[1], w2 = s32[2], w3 = s32[3];
+			uint32_t w4 = s32[4], w5 = s32[5], w6 = s32[6], w7 = s32[7];
+			d32[0] = w0; d32[1] = w1; d32[2] = w2; d32[3] = w3;
+			d32[4] = w4; d32[5] = w5; d32[6] = w6; d32[7] = w7;
+			d32 += 8;
+			s32 += 8;
+			len -= 32;
+		}
+		while(len >= 4)
+		{
+			*d32++ = *s32++;
+			len -= 4;
+		}
+		d8 = (uint8_t*)d32;
+		s8 = (const uint8_t*)s32;
+	}
+	/* Tail bytes (or different alignment of dst & src) */
+	while(len--)
+	{
+		*d8++ = *s8++;
+	}
+}
+
+/*******************************************************************************
+ * @fn     fastmem_move
+ *
+ * @brief  Copy memory with overlapping regions (memmove())
+ *         Forward fastmem_cpy() if dst is below src or regions do not
+ *         overlap else backward copy (32bits if dst & src have same alignment)
+ *
+ * @param  dst: Destination address
+ * @param  src: Source address
+ * @param  len: Number of bytes to copy
+ *
+ * @return None
+ */
+FASTMEM_NO_LIBCALL void fastmem_move(void* dst, const void* src, uint32_t len)
+{
+	uint8_t* d8 = (uint8_t*)dst + len;
+	const uint8_t* s8 = (const uint8_t*)src + len;
+
+	if(((uint32_t)dst <= (uint32_t)src) || ((uint32_t)dst >= ((uint32_t)src + len)))
+	{
+		fastmem_cpy(dst, src, len);
+		return;
+	}
+	/* dst above src with overlap: backward copy */
+	if((((uint32_t)d8 ^ (uint32_t)s8) & 3) == 0)
+	{
+		uint32_t* d32;
+		const uint32_t* s32;
+
+		/* Copy tail bytes down to 32bits alignment */
+		while((((uint32_t)d8) & 3) && len)
+		{
+			*--d8 = *--s8;
+			len--;
+		}
+		d32 = (uint32_t*)d8;
+		s32 = (const uint32_t*)s8;
+		while(len >= 4)
+		{
+			*--d32 = *--s32;
+			len -= 4;
+		}
+		d8 = (uint8_t*)d32;
+		s8 = (const uint8_t*)s32;
+	}
+	/* Head bytes (or different alignment of dst & src) */
+	while(len--)
+	{
+		*--d8 = *--s8;
+	}
+}
+
+/*******************************************************************************
+ * @fn     fastmem_set32
+ *
+ * @brief  Set 32bits words (unrolled by 8 words)
+ *
+ * @param  dst: Destination address (shall be 32bits aligned)
+ * @param  val: 32bits value to set
+ * @param  nb_words: Number of 32bits words to set
+ *
+ * @return None
+ */
+FASTMEM_NO_LIBCALL void fastmem_set32(uint32_t* dst, uint32_t val, uint32_t nb_words)
+{
+	while(nb_words >= 8)
+	{
+		dst[0] = val; dst[1] = val; dst[2] = val; dst[3] = val;
+		dst[4] = val; dst[5] = val; dst[6] = val; dst[7] = val;
+		dst += 8;
+		nb_words -= 8;
+	}
+	while(nb_words--)
+	{
+		*dst++ = val;
+	}
+}
+
+/*******************************************************************************
+ * @fn     fastmem_set
+ *
+ * @brief  Set memory (32bits unrolled set for aligned part)
+ *
+ * @param  dst: Destination address
+ * @param  val: 8bits value to set
+ * @param  len: Number of bytes to set
+ *
+ * @return None
+ */
+FASTMEM_NO_LIBCALL void fastmem_set(void* dst, uint8_t val, uint32_t len)
+{
+	uint8_t* d8 = (uint8_t*)dst;
+
+	while((((uint32_t)d8) & 3) && len)
+	{
+		*d8++ = val;
+		len--;
+	}
+	fastmem_set32((uint32_t*)d8, val * 0x01010101UL, len / 4);
+	d8 += (len & ~3UL);
+	len &= 3;
+	while(len--)
+	{
+		*d8++ = val;
+	}
+}
+
+/*******************************************************************************
+ * @fn     fastmem_fill_inc32
+ *
+ * @brief  Fill 32bits words with incremental pattern
+ *         dst[n] = val + (n * inc)
+ *
+ * @param  dst: Destination address (shall be 32bits aligned)
+ * @param  val: First 32bits value
+ * @param  inc: Increment added to value for each 32bits word
+ * @param  nb_words: Number of 32bits words to fill
+ *
+ * @return None
+ */
+FASTMEM_NO_LIBCALL void fastmem_fill_inc32(uint32_t* dst, uint32_t val, uint32_t inc, uint32_t nb_words)
+{
+	const uint32_t inc2 = inc * 2;
+	const uint32_t inc8 = inc * 8;
+	uint32_t val1 = val + inc;
+
+	/* Two independent values to avoid a dependency chain on each store */
+	while(nb_words >= 8)
+	{
+		dst[0] = val;
+		dst[1] = val1;
+		dst[2] = val + inc2;
+		dst[3] = val1 + inc2;
+		dst[4] = val + inc2 * 2;
+		dst[5] = val1 + inc2 * 2;
+		dst[6] = val + inc2 * 3;
+		dst[7] = val1 + inc2 * 3;
+		val += inc8;
+		val1 += inc8;
+		dst += 8;
+		nb_words -= 8;
+	}
+	while(nb_words--)
+	{
+		*dst++ = val;
+		val += inc;
+	}
+}
+
+/*******************************************************************************
+ * @fn     fastmem_bench_mbps
+ *
+ * @brief  Convert a number of bytes processed in nb_cycles to MB/s
+ *
+ * @return Throughput in MB/s
+ */
+static uint32_t fastmem_bench_mbps(uint32_t size, uint32_t nb_cycles)
+{
+	uint32_t nb_us = nb_cycles / bsp_get_nbtick_1us();
+	if(nb_us == 0)
+		nb_us = 1;
+	return (size / nb_us);
+}
+
+/*******************************************************************************
+ * @fn     fastmem_benchmark
+ *
+ * @brief  Benchmark fastmem versus newlib-nano memcpy()/memset() and
+ *         versus scalar loops, results are displayed with log_printf()
+ *
+ * @param  buf0: Buffer of size bytes (32bits aligned)
+ * @param  buf1: Buffer of size bytes (32bits aligned)
+ * @param  size: Size in bytes of each buffer (multiple of 32)
+ *
+ * @return None
+ */
+FASTMEM_NO_LIBCALL void fastmem_benchmark(uint32_t* buf0, uint32_t* buf1, uint32_t size)
+{
+	uint32_t start;
+	uint32_t cycles[2];
+	uint32_t i;
+	volatile uint32_t* vbuf = buf0;
+
+	log_printf("fastmem benchmark size=%d bytes\n", size);
+
+	start = bsp_get_SysTickCNT_LSB();
+	memcpy(buf1, buf0, size);
+	cycles[0] = start - bsp_get_SysTickCNT_LSB(); // SysTick count down
+	start = bsp_get_SysTickCNT_LSB();
+	fastmem_cpy(buf1, buf0, size);
+	cycles[1] = start - bsp_get_SysTickCNT_LSB();
+	log_printf("cpy  newlib=%d cycles(%d MB/s) fastmem=%d cycles(%d MB/s)\n",
+			   cycles[0], fastmem_bench_mbps(size, cycles[0]),
+			   cycles[1], fastmem_bench_mbps(size, cycles[1]));
+
+	start = bsp_get_SysTickCNT_LSB();
+	memset(buf0, 0, size);
+	cycles[0] = start - bsp_get_SysTickCNT_LSB();
+	start = bsp_get_SysTickCNT_LSB();
+	fastmem_set(buf0, 0, size);
+	cycles[1] = start - bsp_get_SysTickCNT_LSB();
+	log_printf("set  newlib=%d cycles(%d MB/s) fastmem=%d cycles(%d MB/s)\n",
+			   cycles[0], fastmem_bench_mbps(size, cycles[0]),
+			   cycles[1], fastmem_bench_mbps(size, cycles[1]));
+
+	/* Scalar loop as used before in examples (volatile to keep it as is) */
+	start = bsp_get_SysTickCNT_LSB();
+	for(i = 0; i < (size / 4); i++)
+	{
+		vbuf[i] = (i + 0x55555555);
+	}
+	cycles[0] = start - bsp_get_SysTickCNT_LSB();
+	start = bsp_get_SysTickCNT_LSB();
+	fastmem_fill_inc32(buf0, 0x55555555, 1, (size / 4));
+	cycles[1] = start - bsp_get_SysTickCNT_LSB();
+	log_printf("fill loop=%d cycles(%d MB/s) fastmem=%d cycles(%d MB/s)\n",
+			   cycles[0], fastmem_bench_mbps(size, cycles[0]),
+			   cycles[1], fastmem_bench_mbps(size, cycles[1]));
+}
@@ -0,0 +1,40 @@
+/********************************** (C) COPYRIGHT *******************************
+* File Name          : fastmem.h
+* Author             : bvernoux
+* Version            : V1.0
+* Date               : 2026/10/19
+* Description        : Fast word aligned memory copy/set/fill for RV32IMAC
+*                      (RAM/RAMX buffers)
+* Copyright (c) 2026 Benjamin VERNOUX
+* SPDX-License-Identifier: Apache-2.0
+*******************************************************************************/
+#ifndef FASTMEM_H_
+#define FASTMEM_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+
+/*
+ * Generic copy/set (any alignment, fastest when dst/src are 32bits aligned)
+ * fastmem_cpy() regions shall not overlap (forward copy, only dst below src
+ * is safe), use fastmem_move() for overlapping regions (memmove())
+ */
+void fastmem_cpy(void* dst, const void* src, uint32_t len);
+void fastmem_move(void* dst, const void* src, uint32_t len);
+void fastmem_set(void* dst, uint8_t val, uint32_t len);
+
+/* 32bits aligned set/pattern fill (nb_words is the number of 32bits words) */
+void fastmem_set32(uint32_t* dst, uint32_t val, uint32_t nb_words);
+void fastmem_fill_inc32(uint32_t* dst, uint32_t val, uint32_t inc, uint32_t nb_words);
+
+/* Benchmark fastmem vs newlib-nano memcpy()/memset() (result with log_printf()) */
+void fastmem_benchmark(uint32_t* buf0, uint32_t* buf1, uint32_t size);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* FASTMEM_H_ */
@@ -0,0 +1,58 @@
+/********************************** (C) COPYRIGHT *******************************
+* File Name          : irq_save.h
+* Author             : bvernoux
+* Version            : V1.0
+* Date               : 2026/10/19
+* Description        : Global interrupts (mstatus.MIE) save/restore for
+*                      short critical sections shared between main loop and
+*                      ISR or between nested interrupt levels (see irqprio.h)
+* Copyright (c) 2026 Benjamin VERNOUX
+* SPDX-License-Identifier: Apache-2.0
+*******************************************************************************/
+#ifndef IRQ_SAVE_H_
+#define IRQ_SAVE_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+
+#define IRQ_SAVE_MSTATUS_MIE (0x8)
+
+/*******************************************************************************
+ * @fn     irq_save
+ *
+ * @brief  Disable global interrupts
+ *
+ * @return Previous mstatus to be given to irq_restore()
+ */
+static inline uint32_t irq_save(void)
+{
+	uint32_t mstatus;
+
+	__asm volatile("csrrci %0, mstatus, 0x8" : "=r"(mstatus) :: "memory");
+	return mstatus;
+}
+
+/*******************************************************************************
+ * @fn     irq_restore
+ *
+ * @brief  Enable global interrupts again only if they were enabled at
+ *         irq_save() (critical sections can be nested or used in ISR)
+ *
+ * @param  mstatus: Value returned by irq_save()
+ *
+ * @return None
+ */
+static inline void irq_restore(uint32_t mstatus)
+{
+	if(mstatus & IRQ_SAVE_MSTATUS_MIE)
+		__asm volatile("csrsi mstatus, 0x8" ::: "memory");
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* IRQ_SAVE_H_ */
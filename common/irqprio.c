@@ -0,0 +1,226 @@
+/********************************** (C) COPYRIGHT *******************************
+* File Name          : irqprio.c
+* Author             : bvernoux
+* Version            : V1.0
+* Date               : 2026/10/19
+* Description        : Central interrupt priority map with preemption,
+*                      per IRQ duration and worst-case latency stress test
+* Copyright (c) 2026 Benjamin VERNOUX
+* SPDX-License-Identifier: Apache-2.0
+*******************************************************************************/
+#include "CH56x_common.h"
+#include "CH56x_debug_log.h"
+#include "fastmem.h"
+#include "irq_save.h"
+#include "irqprio.h"
+
+/* QingKe V3A INTSYSCR CSR (HWSTKEN bit0 is set by startup) */
+#define IRQPRIO_CSR_INTSYSCR 0x804
+#define IRQPRIO_INTSYSCR_INESTEN (1 << 1) /* Interrupt nesting enable */
+
+static irqprio_stats_t irqprio_stats;
+
+static const char* const irqprio_irq_name[IRQPRIO_ID_NB] =
+{
+	"HSPI",
+	"SERDES",
+	"TMR1",
+	"LOAD",
+};
+
+/* Same order as e_irqprio_id */
+static const uint8_t irqprio_irq_class[IRQPRIO_ID_NB] =
+{
+	IRQPRIO_CLASS_LINK_DMA,
+	IRQPRIO_CLASS_LINK_DMA,
+	IRQPRIO_CLASS_TIMER,
+	IRQPRIO_CLASS_USB_DATA,
+};
+
+#if(defined IRQPRIO_STRESS)
+static const uint8_t irqprio_class_prio[IRQPRIO_CLASS_NB] =
+{
+	IRQPRIO_LINK_DMA,
+	IRQPRIO_USB_DATA,
+	IRQPRIO_TIMER,
+};
+
+static volatile uint32_t irqprio_load_us;
+static uint32_t irqprio_probe_class;
+static uint32_t irqprio_probe_nb;
+#endif
+
+/*******************************************************************************
+ * @fn     irqprio_init
+ *
+ * @brief  Apply the priority map to all interrupts used by the examples and
+ *         enable interrupt nesting (shall be called before PFIC_EnableIRQ())
+ *
+ * @return None
+ */
+void irqprio_init(void)
+{
+	fastmem_set(&irqprio_stats, 0, sizeof(irqprio_stats_t));
+	PFIC_SetPriority(HSPI_IRQn, IRQPRIO_LINK_DMA);
+	PFIC_SetPriority(INT_ID_SERDES, IRQPRIO_LINK_DMA);
+	PFIC_SetPriority(USBSS_IRQn, IRQPRIO_USB_DATA);
+	PFIC_SetPriority(LINK_IRQn, IRQPRIO_USB_DATA);
+	PFIC_SetPriority(USBHS_IRQn, IRQPRIO_USB_DATA);
+	PFIC_SetPriority(TMR0_IRQn, IRQPRIO_TIMER);
+	PFIC_SetPriority(TMR1_IRQn, IRQPRIO_TIMER);
+	PFIC_SetPriority(TMR2_IRQn, IRQPRIO_TIMER);
+#if(!defined IRQPRIO_FLAT)
+	__asm volatile("csrs %0, %1" :: "i"(IRQPRIO_CSR_INTSYSCR), "r"(IRQPRIO_INTSYSCR_INESTEN));
+#endif
+}
+
+/*******************************************************************************
+ * @fn     irqprio_irq_exit
+ *
+ * @brief  Account interrupt duration (called by IRQPRIO_EXIT() at end of ISR)
+ *
+ * @param  id: e_irqprio_id
+ * @param  start: SysTick at ISR entry (IRQPRIO_ENTER())
+ *
+ * @return None
+ */
+void irqprio_irq_exit(uint32_t id, uint32_t start)
+{
+	uint32_t dur = start - bsp_get_SysTickCNT_LSB(); // SysTick count down
+
+	irqprio_stats.irq[id].count++;
+	if(dur > irqprio_stats.irq[id].dur_max)
+		irqprio_stats.irq[id].dur_max = dur;
+}
+
+/*******************************************************************************
+ * @fn     irqprio_stats_get
+ *
+ * @brief  Get a consistent copy of interrupts statistics
+ *
+ * @return None
+ */
+void irqprio_stats_get(irqprio_stats_t* stats)
+{
+	uint32_t mstatus;
+
+	mstatus = irq_save();
+	fastmem_cpy(stats, &irqprio_stats, sizeof(irqprio_stats_t));
+	irq_restore(mstatus);
+	stats->nbtick_1us = bsp_get_nbtick_1us();
+}
+
+/*******************************************************************************
+ * @fn     irqprio_log
+ *
+ * @brief  Log count, max duration and worst-case latency (probe latency of
+ *         its class, 0 if not measured) of each interrupt
+ *
+ * @return None
+ */
+void irqprio_log(void)
+{
+	irqprio_stats_t stats;
+	uint32_t i;
+	uint32_t cl;
+
+	irqprio_stats_get(&stats);
+	log_printf("IRQ priorities %s\n", IRQPRIO_MAP_NAME);
+	for(i = 0; i < IRQPRIO_ID_NB; i++)
+	{
+		cl = irqprio_irq_class[i];
+		log_printf("IRQ %s count=%d dur_max=%dns lat_max=%dns (%d samples)\n",
+				   irqprio_irq_name[i], stats.irq[i].count,
+				   (stats.irq[i].dur_max * 1000) / stats.nbtick_1us,
+				   (stats.lat_max[cl] * 1000) / stats.nbtick_1us, stats.lat_nb[cl]);
+	}
+}
+
+#if(defined IRQPRIO_STRESS)
+/*******************************************************************************
+ * @fn     irqprio_stress_start
+ *
+ * @brief  Start stress test load (TMR0) and latency probe (TMR2)
+ *
+ * @param  load_us: Load duration each period (0 = latency probe only)
+ * @param  period_us: Load period (shall be greater than load_us)
+ *
+ * @return None
+ */
+void irqprio_stress_start(uint32_t load_us, uint32_t period_us)
+{
+	irqprio_load_us = load_us;
+	if(load_us > 0)
+	{
+		PFIC_SetPriority(TMR0_IRQn, IRQPRIO_USB_DATA);
+		R8_TMR0_INTER_EN = RB_TMR_IE_CYC_END;
+		TMR0_TimerInit(bsp_get_nbtick_1us() * period_us);
+		PFIC_EnableIRQ(TMR0_IRQn);
+	}
+	irqprio_probe_class = IRQPRIO_CLASS_LINK_DMA;
+	irqprio_probe_nb = 0;
+	PFIC_SetPriority(TMR2_IRQn, irqprio_class_prio[irqprio_probe_class]);
+	R8_TMR2_INTER_EN = RB_TMR_IE_CYC_END;
+	TMR2_TimerInit(bsp_get_nbtick_1us() * IRQPRIO_PROBE_PERIOD_US);
+	PFIC_EnableIRQ(TMR2_IRQn);
+}
+
+/*******************************************************************************
+ * @fn     irqprio_stress_stop
+ *
+ * @brief  Stop stress test load and latency probe (statistics are kept)
+ *
+ * @return None
+ */
+void irqprio_stress_stop(void)
+{
+	PFIC_DisableIRQ(TMR0_IRQn);
+	TMR0_Disable();
+	PFIC_DisableIRQ(TMR2_IRQn);
+	TMR2_Disable();
+	PFIC_SetPriority(TMR0_IRQn, IRQPRIO_TIMER);
+	PFIC_SetPriority(TMR2_IRQn, IRQPRIO_TIMER);
+}
+
+/*********************************************************************
+ * @fn      TMR0_IRQHandler
+ *
+ * @brief   Stress test load (long USB command handler)
+ *
+ * @return  none
+ */
+__attribute__((interrupt("WCH-Interrupt-fast"))) void TMR0_IRQHandler(void)
+{
+	IRQPRIO_ENTER(start);
+	TMR0_ClearITFlag(RB_TMR_IF_CYC_END);
+	bsp_wait_us_delay(irqprio_load_us);
+	IRQPRIO_EXIT(IRQPRIO_ID_LOAD, start);
+}
+
+/*********************************************************************
+ * @fn      TMR2_IRQHandler
+ *
+ * @brief   Latency probe, counter is the number of cycles since the
+ *          interrupt request (counter restarted at end of period)
+ *
+ * @return  none
+ */
+__attribute__((interrupt("WCH-Interrupt-fast"))) void TMR2_IRQHandler(void)
+{
+	uint32_t lat = R32_TMR2_COUNT;
+
+	TMR2_ClearITFlag(RB_TMR_IF_CYC_END);
+	irqprio_stats.lat_nb[irqprio_probe_class]++;
+	if(lat > irqprio_stats.lat_max[irqprio_probe_class])
+		irqprio_stats.lat_max[irqprio_probe_class] = lat;
+	irqprio_probe_nb++;
+	if(irqprio_probe_nb >= IRQPRIO_PROBE_NB)
+	{
+		irqprio_probe_nb = 0;
+		irqprio_probe_class++;
+		if(irqprio_probe_class >= IRQPRIO_CLASS_NB)
+			irqprio_probe_class = IRQPRIO_CLASS_LINK_DMA;
+		PFIC_SetPriority(TMR2_IRQn, irqprio_class_prio[irqprio_probe_class]);
+	}
+}
+#endif
@@ -0,0 +1,123 @@
+/********************************** (C) COPYRIGHT *******************************
+* File Name          : irqprio.h
+* Author             : bvernoux
+* Version            : V1.0
+* Date               : 2026/10/19
+* Description        : Central interrupt priority map with preemption,
+*                      per IRQ duration and worst-case latency stress test
+* Copyright (c) 2026 Benjamin VERNOUX
+* SPDX-License-Identifier: Apache-2.0
+*******************************************************************************/
+#ifndef IRQPRIO_H_
+#define IRQPRIO_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+
+/*
+ * PFIC priority (lower value = higher priority), irqprio_init() enables
+ * interrupt nesting (INTSYSCR.INESTEN) with 2 levels:
+ * - An interrupt with IRQPRIO_PREEMPT bit cleared preempts an interrupt
+ *   with IRQPRIO_PREEMPT bit set
+ * - Interrupts of the same level never preempt each other, the lowest
+ *   value is served first when several are pending
+ * Link DMA completion (HSPI RX re-arm, SerDes Double DMA) is never delayed
+ * by a long USB command (Endpoint1 commands are executed in USB IRQ).
+ * Code shared between levels shall mask interrupts (irq_save()/irq_restore()
+ * see irq_save.h) as already done by event_post()/trace_ring_put()...
+ */
+#define IRQPRIO_PREEMPT (0x80)
+
+#if(defined IRQPRIO_FLAT)
+/*
+ * Baseline without priority map (DEFINE_OPTS = -DIRQPRIO_FLAT=1): same
+ * priority for all interrupts and no nesting, to measure the worst-case
+ * latencies before/after the map with the same stress test
+ */
+#define IRQPRIO_LINK_DMA (IRQPRIO_PREEMPT | 0x00)
+#define IRQPRIO_USB_DATA (IRQPRIO_PREEMPT | 0x00)
+#define IRQPRIO_TIMER    (IRQPRIO_PREEMPT | 0x00)
+#define IRQPRIO_MAP_NAME "flat"
+#else
+#define IRQPRIO_LINK_DMA (0x00) /* HSPI, SerDes */
+#define IRQPRIO_USB_DATA (IRQPRIO_PREEMPT | 0x00) /* USBSS, LINK, USBHS (Endpoint2 data and Endpoint1 commands) */
+#define IRQPRIO_TIMER    (IRQPRIO_PREEMPT | 0x40) /* TMR0 (USB3 timeout), TMR1 (event timer) */
+#define IRQPRIO_MAP_NAME "map"
+#endif
+
+/* Priority classes of the latency probe (see irqprio_stress_start()) */
+typedef enum
+{
+	IRQPRIO_CLASS_LINK_DMA = 0,
+	IRQPRIO_CLASS_USB_DATA,
+	IRQPRIO_CLASS_TIMER,
+	IRQPRIO_CLASS_NB
+} e_irqprio_class;
+
+/* Interrupts with measured duration (IRQPRIO_ENTER()/IRQPRIO_EXIT()) */
+typedef enum
+{
+	IRQPRIO_ID_HSPI = 0, /* HSPI_IRQHandler() (IRQPRIO_CLASS_LINK_DMA) */
+	IRQPRIO_ID_SERDES, /* SERDES_IRQHandler() (IRQPRIO_CLASS_LINK_DMA) */
+	IRQPRIO_ID_TMR1, /* TMR1_IRQHandler() (IRQPRIO_CLASS_TIMER) */
+	IRQPRIO_ID_LOAD, /* Stress test load (IRQPRIO_CLASS_USB_DATA) */
+	IRQPRIO_ID_NB
+} e_irqprio_id;
+
+typedef struct
+{
+	uint32_t count;
+	uint32_t dur_max; /* SysTick cycles (includes preemption by higher level) */
+} irqprio_irq_stats_t;
+
+typedef struct
+{
+	uint32_t nbtick_1us; /* SysTick/Timers ticks per us */
+	irqprio_irq_stats_t irq[IRQPRIO_ID_NB];
+	uint32_t lat_max[IRQPRIO_CLASS_NB]; /* Probe worst-case entry latency in cycles */
+	uint32_t lat_nb[IRQPRIO_CLASS_NB]; /* Probe samples */
+} irqprio_stats_t;
+
+#define IRQPRIO_ENTER(start) uint32_t start = bsp_get_SysTickCNT_LSB()
+#define IRQPRIO_EXIT(id, start) irqprio_irq_exit((id), (start))
+
+void irqprio_init(void);
+void irqprio_irq_exit(uint32_t id, uint32_t start);
+void irqprio_stats_get(irqprio_stats_t* stats);
+void irqprio_log(void);
+
+/*
+ * Stress test (build with DEFINE_OPTS = -DIRQPRIO_STRESS=1, not in
+ * HydraUSB3_USB as TMR0 is used by USB stack), started by HSPI/SerDes
+ * examples before soak test/link benchmark with IRQPRIO_STRESS_LOAD_US
+ * each IRQPRIO_STRESS_PERIOD_US
+ * - Load: TMR0 at IRQPRIO_USB_DATA busy for load_us each period_us
+ *   (long USB command handler)
+ * - Probe: TMR2 each IRQPRIO_PROBE_PERIOD_US, its counter read at
+ *   TMR2_IRQHandler() entry is the entry latency, its priority moves to
+ *   next class each IRQPRIO_PROBE_NB samples, the worst-case latency of an
+ *   interrupt is lat_max of its class
+ * HSPI/SerDes overruns are reported by the link statistics (soak test or
+ * link benchmark running with the stress test)
+ */
+#define IRQPRIO_PROBE_PERIOD_US (97) /* Not a multiple of load/traffic periods */
+#define IRQPRIO_PROBE_NB (1024)
+
+#ifndef IRQPRIO_STRESS_LOAD_US
+#define IRQPRIO_STRESS_LOAD_US (200)
+#endif
+#ifndef IRQPRIO_STRESS_PERIOD_US
+#define IRQPRIO_STRESS_PERIOD_US (1000)
+#endif
+
+void irqprio_stress_start(uint32_t load_us, uint32_t period_us);
+void irqprio_stress_stop(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* IRQPRIO_H_ */
@@ -0,0 +1,298 @@
+/********************************** (C) COPYRIGHT *******************************
+* File Name          : link.c
+* Author             : bvernoux
+* Version            : V1.0
+* Date               : 2026/10/19
+* Description        : Common link interface (USB Endpoint2, HSPI, SerDes)
+*                      with zero copy buffer hand-off, bridge and benchmark
+* Copyright (c) 2026 Benjamin VERNOUX
+* SPDX-License-Identifier: Apache-2.0
+*******************************************************************************/
+#include "CH56x_common.h"
+#include "CH56x_debug_log.h"
+#include "fastmem.h"
+#include "link.h"
+
+/*******************************************************************************
+ * @fn     link_init
+ *
+ * @brief  Init link with its operations and clear its statistics
+ *
+ * @param  link: Link
+ * @param  ops: Link operations (transport specific)
+ *
+ * @return None
+ */
+void link_init(link_t* link, const link_ops_t* ops)
+{
+	link->ops = ops;
+	fastmem_set(&link->stats, 0, sizeof(link_stats_t));
+}
+
+/*******************************************************************************
+ * @fn     link_tx_alloc
+ *
+ * @brief  Get a free TX buffer of the link
+ *
+ * @return Buffer or NULL if no free buffer
+ */
+link_buf_t* link_tx_alloc(link_t* link)
+{
+	return link->ops->tx_alloc(link);
+}
+
+/*******************************************************************************
+ * @fn     link_tx_submit
+ *
+ * @brief  Send a buffer (from link_tx_alloc() of this link or link_rx_get()
+ *         of any link), the buffer is released to its owner once sent
+ *
+ * @return LINK_OK or LINK_ERR_XXX (buffer still owned by caller)
+ */
+int link_tx_submit(link_t* link, link_buf_t* buf)
+{
+	int ret;
+
+	ret = link->ops->tx_submit(link, buf);
+	if(ret == LINK_OK)
+	{
+		link->stats.nb_tx++;
+		link->stats.tx_bytes += buf->len;
+	}
+	else if(ret == LINK_ERR_BUSY)
+	{
+		link->stats.nb_tx_busy++;
+	}
+	return ret;
+}
+
+/*******************************************************************************
+ * @fn     link_rx_get
+ *
+ * @brief  Get oldest received buffer (to be released with link_release()
+ *         or sent with link_tx_submit())
+ *
+ * @return Buffer or NULL if nothing received
+ */
+link_buf_t* link_rx_get(link_t* link)
+{
+	link_buf_t* buf;
+
+	buf = link->ops->rx_get(link);
+	if(buf != NULL)
+	{
+		link->stats.nb_rx++;
+		link->stats.rx_bytes += buf->len;
+	}
+	return buf;
+}
+
+/*******************************************************************************
+ * @fn     link_release
+ *
+ * @brief  Give back a buffer to its owner link
+ *
+ * @return None
+ */
+void link_release(link_buf_t* buf)
+{
+	buf->owner->ops->release(buf->owner, buf);
+}
+
+/*******************************************************************************
+ * @fn     link_task
+ *
+ * @brief  Process link completions (to be called from main loop)
+ *
+ * @return None
+ */
+void link_task(link_t* link)
+{
+	if(link->ops->task != NULL)
+		link->ops->task(link);
+}
+
+/*******************************************************************************
+ * @fn     link_stats_get
+ *
+ * @brief  Get link statistics (since link_init())
+ *
+ * @return None
+ */
+void link_stats_get(link_t* link, link_stats_t* stats)
+{
+	fastmem_cpy(stats, &link->stats, sizeof(link_stats_t));
+}
+
+/*******************************************************************************
+ * @fn     link_bridge_init
+ *
+ * @brief  Init zero copy bridge from a link to an other link
+ *
+ * @return None
+ */
+void link_bridge_init(link_bridge_t* bridge, link_t* from, link_t* to)
+{
+	bridge->from = from;
+	bridge->to = to;
+	bridge->pending = NULL;
+	bridge->nb_drop = 0;
+}
+
+/*******************************************************************************
+ * @fn     link_bridge_task
+ *
+ * @brief  Send all buffers received on bridge->from to bridge->to
+ *         (to be called from main loop)
+ *
+ * @return Number of buffers forwarded
+ */
+uint32_t link_bridge_task(link_bridge_t* bridge)
+{
+	uint32_t nb = 0;
+	int ret;
+
+	link_task(bridge->from);
+	link_task(bridge->to);
+	while(1)
+	{
+		if(bridge->pending == NULL)
+			bridge->pending = link_rx_get(bridge->from);
+		if(bridge->pending == NULL)
+			break;
+		ret = link_tx_submit(bridge->to, bridge->pending);
+		if(ret == LINK_ERR_BUSY)
+			break; // Keep it for next call
+		if(ret != LINK_OK)
+		{
+			bridge->nb_drop++;
+			link_release(bridge->pending);
+		}
+		else
+		{
+			nb++;
+		}
+		bridge->pending = NULL;
+	}
+	return nb;
+}
+
+/*******************************************************************************
+ * @fn     link_bench_init
+ *
+ * @brief  Init benchmark of a link
+ *
+ * @param  bench: Benchmark state
+ * @param  link: Link
+ * @param  len: TX buffers length in bytes (multiple of 4)
+ *
+ * @return None
+ */
+void link_bench_init(link_bench_t* bench, link_t* link, uint32_t len)
+{
+	bench->link = link;
+	bench->len = len;
+	bench->seq = 0;
+	bench->nb_err = 0;
+	bench->bytes = 0;
+	bench->prev_bytes = 0;
+	bench->prev_ts = bsp_get_SysTickCNT_LSB();
+}
+
+/*******************************************************************************
+ * @fn     link_bench_tx_task
+ *
+ * @brief  Fill and send all free TX buffers (to be called from main loop)
+ *
+ * @return None
+ */
+void link_bench_tx_task(link_bench_t* bench)
+{
+	link_buf_t* buf;
+	uint32_t len;
+
+	link_task(bench->link);
+	while((buf = link_tx_alloc(bench->link)) != NULL)
+	{
+		len = (bench->len < buf->size) ? bench->len : buf->size;
+		fastmem_fill_inc32((uint32_t*)buf->data, bench->seq, 1, (len / 4));
+		buf->len = len;
+		if(link_tx_submit(bench->link, buf) != LINK_OK)
+			break; // Buffer stays allocated, sent next time
+		bench->seq += (len / 4);
+		bench->bytes += len;
+	}
+}
+
+/*******************************************************************************
+ * @fn     link_bench_rx_task
+ *
+ * @brief  Check and release all received buffers (to be called from main loop)
+ *         Each word of the payload is checked (one error counted per buffer)
+ *
+ * @return None
+ */
+void link_bench_rx_task(link_bench_t* bench)
+{
+	link_buf_t* buf;
+	const uint32_t* d;
+	uint32_t nb_words;
+	uint32_t i;
+
+	link_task(bench->link);
+	while((buf = link_rx_get(bench->link)) != NULL)
+	{
+		d = (const uint32_t*)buf->data;
+		nb_words = buf->len / 4;
+		if(nb_words > 0)
+		{
+			for(i = 0; i < nb_words; i++)
+			{
+				if(d[i] != (bench->seq + i))
+				{
+					bench->nb_err++;
+					break;
+				}
+			}
+			bench->seq = d[nb_words - 1] + 1; // Resynchronize on received data
+		}
+		bench->bytes += buf->len;
+		link_release(buf);
+	}
+}
+
+/*******************************************************************************
+ * @fn     link_bench_mbps
+ *
+ * @brief  Throughput since previous call
+ *
+ * @return Throughput in Mbit/s
+ */
+uint32_t link_bench_mbps(link_bench_t* bench)
+{
+	uint32_t now = bsp_get_SysTickCNT_LSB();
+	uint32_t nb_us = (bench->prev_ts - now) / bsp_get_nbtick_1us(); // SysTick count down
+	uint32_t mbps = 0;
+
+	if(nb_us > 0)
+		mbps = (uint32_t)(((bench->bytes - bench->prev_bytes) * 8) / nb_us);
+	bench->prev_bytes = bench->bytes;
+	bench->prev_ts = now;
+	return mbps;
+}
+
+/*******************************************************************************
+ * @fn     link_bench_log
+ *
+ * @brief  Log benchmark throughput since previous call and link statistics
+ *
+ * @return None
+ */
+void link_bench_log(link_bench_t* bench)
+{
+	link_t* link = bench->link;
+
+	log_printf("LINK %s %dMbps tx=%d busy=%d rx=%d err=%d pattern_err=%d\n",
+			   link->ops->name, link_bench_mbps(bench), link->stats.nb_tx, link->stats.nb_tx_busy,
+			   link->stats.nb_rx, link->stats.nb_err, bench->nb_err);
+}
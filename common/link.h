@@ -0,0 +1,124 @@
+/********************************** (C) COPYRIGHT *******************************
+* File Name          : link.h
+* Author             : bvernoux
+* Version            : V1.0
+* Date               : 2026/10/19
+* Description        : Common link interface (USB Endpoint2, HSPI, SerDes)
+*                      with zero copy buffer hand-off, bridge and benchmark
+* Copyright (c) 2026 Benjamin VERNOUX
+* SPDX-License-Identifier: Apache-2.0
+*******************************************************************************/
+#ifndef LINK_H_
+#define LINK_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+
+/*
+ * Buffers are in RAMX (DMA capable) and owned by the link which allocated
+ * them (link_tx_alloc() or link_rx_get()), data is never copied:
+ * - link_tx_alloc() => fill => link_tx_submit(): the TX link gives the
+ *   buffer back to its owner (link_release()) once sent
+ * - link_rx_get() => read => link_release(): the buffer is given back to
+ *   the RX link (re-armed for reception)
+ * - link_rx_get() => link_tx_submit() on an other link: the buffer received
+ *   is sent as is and given back to the RX link once sent (see link_bridge_task())
+ * link_tx_alloc() returns the next free TX buffer, it is reserved only by
+ * link_tx_submit() (same buffer returned until submitted).
+ * Buffers are released by each link in the order they were obtained.
+ * All functions are called from main loop (links do their IRQ bookkeeping
+ * in their task()).
+ */
+#define LINK_BUF_ALIGN (16) /* DMA alignment of all link buffers */
+
+typedef struct link_s link_t;
+
+typedef struct
+{
+	uint8_t* data; /* Buffer in RAMX */
+	uint32_t len; /* Data length in bytes */
+	uint32_t size; /* Buffer size in bytes */
+	link_t* owner; /* Link which allocated the buffer */
+} link_buf_t;
+
+/* link_tx_submit() return codes */
+#define LINK_OK       (0)
+#define LINK_ERR_BUSY (-1) /* No TX slot free, submit again later */
+#define LINK_ERR_BUF  (-2) /* Buffer cannot be sent by this link (size/alignment) */
+
+typedef struct
+{
+	const char* name;
+	link_buf_t* (*tx_alloc)(link_t* link); /* NULL if no free buffer */
+	int (*tx_submit)(link_t* link, link_buf_t* buf); /* LINK_OK or LINK_ERR_XXX */
+	link_buf_t* (*rx_get)(link_t* link); /* NULL if nothing received */
+	void (*release)(link_t* link, link_buf_t* buf); /* Buffer back to its owner */
+	void (*task)(link_t* link); /* IRQ completions bookkeeping (releases sent buffers) */
+} link_ops_t;
+
+typedef struct
+{
+	uint32_t nb_tx; /* Buffers submitted */
+	uint64_t tx_bytes;
+	uint32_t nb_tx_busy; /* link_tx_submit() LINK_ERR_BUSY */
+	uint32_t nb_rx; /* Buffers received */
+	uint64_t rx_bytes;
+	uint32_t nb_err; /* Errors reported by the link (CRC, overrun...) */
+} link_stats_t;
+
+struct link_s
+{
+	const link_ops_t* ops;
+	link_stats_t stats;
+};
+
+void link_init(link_t* link, const link_ops_t* ops);
+link_buf_t* link_tx_alloc(link_t* link);
+int link_tx_submit(link_t* link, link_buf_t* buf);
+link_buf_t* link_rx_get(link_t* link);
+void link_release(link_buf_t* buf);
+void link_task(link_t* link);
+void link_stats_get(link_t* link, link_stats_t* stats);
+
+/* Zero copy bridge (buffers received on from are sent on to) */
+typedef struct
+{
+	link_t* from;
+	link_t* to;
+	link_buf_t* pending; /* Received buffer waiting a TX slot */
+	uint32_t nb_drop; /* Buffers not accepted by to (LINK_ERR_BUF) */
+} link_bridge_t;
+
+void link_bridge_init(link_bridge_t* bridge, link_t* from, link_t* to);
+uint32_t link_bridge_task(link_bridge_t* bridge);
+
+/*
+ * Benchmark harness (same for all links)
+ * TX: buffers of len bytes with 32bits word[n] = seq + n (seq incremented
+ * by the number of words of each buffer), RX: all words checked
+ */
+typedef struct
+{
+	link_t* link;
+	uint32_t len; /* TX buffer length */
+	uint32_t seq; /* Next first word (TX: sent, RX: expected) */
+	uint32_t nb_err; /* RX: pattern errors */
+	uint64_t bytes; /* Bytes sent/received since link_bench_init() */
+	uint64_t prev_bytes; /* bytes at previous link_bench_mbps() */
+	uint32_t prev_ts; /* SysTick at previous link_bench_mbps() */
+} link_bench_t;
+
+void link_bench_init(link_bench_t* bench, link_t* link, uint32_t len);
+void link_bench_tx_task(link_bench_t* bench);
+void link_bench_rx_task(link_bench_t* bench);
+uint32_t link_bench_mbps(link_bench_t* bench);
+void link_bench_log(link_bench_t* bench);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* LINK_H_ */
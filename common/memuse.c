@@ -0,0 +1,95 @@
+/********************************** (C) COPYRIGHT *******************************
+* File Name          : memuse.c
+* Author             : bvernoux
+* Version            : V1.0
+* Date               : 2026/10/19
+* Description        : RAM/RAMX usage by section (linker symbols) and stack
+*                      high-water mark (stack painting)
+* Copyright (c) 2026 Benjamin VERNOUX
+* SPDX-License-Identifier: Apache-2.0
+*******************************************************************************/
+#include "CH56x_common.h"
+#include "CH56x_debug_log.h"
+#include "memuse.h"
+
+/* Linker symbols (see .ld) */
+extern uint32_t _data_vma[];
+extern uint32_t _edata[];
+extern uint32_t _sbss[];
+extern uint32_t _ebss[];
+extern uint32_t _susrstack[];
+extern uint32_t _eusrstack[];
+extern uint32_t _dmadata_start[];
+extern uint32_t _dmadata_end[];
+
+/*******************************************************************************
+ * @fn     memuse_stack_paint
+ *
+ * @brief  Paint free RAM and stack below the actual stack pointer
+ *         (to be called first in main() before any interrupt is enabled)
+ *
+ * @return None
+ */
+__attribute__((noinline)) void memuse_stack_paint(void)
+{
+	volatile uint32_t* p = (volatile uint32_t*)_ebss;
+	uint32_t sp;
+
+	__asm volatile("mv %0, sp" : "=r"(sp));
+	sp &= ~3UL;
+	while((uint32_t)p < sp)
+		*p++ = MEMUSE_STACK_PAINT;
+}
+
+/*******************************************************************************
+ * @fn     memuse_stack_used_max
+ *
+ * @brief  Stack high-water mark (lowest word no more painted)
+ *
+ * @return Maximum stack used in bytes since memuse_stack_paint()
+ */
+uint32_t memuse_stack_used_max(void)
+{
+	const volatile uint32_t* p = (const volatile uint32_t*)_ebss;
+
+	while(((uint32_t)p < (uint32_t)_eusrstack) && (*p == MEMUSE_STACK_PAINT))
+		p++;
+	return ((uint32_t)_eusrstack - (uint32_t)p);
+}
+
+/*******************************************************************************
+ * @fn     memuse_get
+ *
+ * @brief  Get RAM/RAMX usage by section and stack high-water mark
+ *
+ * @return None
+ */
+void memuse_get(memuse_t* mem)
+{
+	mem->ram_size = (uint32_t)_eusrstack - MEMUSE_RAM_ADDR;
+	mem->data_size = (uint32_t)_edata - (uint32_t)_data_vma;
+	mem->bss_size = (uint32_t)_ebss - (uint32_t)_sbss;
+	mem->free_size = (uint32_t)_susrstack - (uint32_t)_ebss;
+	mem->stack_size = (uint32_t)_eusrstack - (uint32_t)_susrstack;
+	mem->stack_used_max = memuse_stack_used_max();
+	mem->ramx_size = MEMUSE_RAMX_SIZE;
+	mem->dmadata_size = (uint32_t)_dmadata_end - (uint32_t)_dmadata_start;
+}
+
+/*******************************************************************************
+ * @fn     memuse_log
+ *
+ * @brief  Log RAM/RAMX usage and stack high-water mark
+ *
+ * @return None
+ */
+void memuse_log(void)
+{
+	memuse_t mem;
+
+	memuse_get(&mem);
+	log_printf("RAM %d data=%d bss=%d free=%d stack=%d used_max=%d%s\n",
+			   mem.ram_size, mem.data_size, mem.bss_size, mem.free_size, mem.stack_size,
+			   mem.stack_used_max, (mem.stack_used_max > mem.stack_size) ? " OVERFLOW" : "");
+	log_printf("RAMX %d DMADATA=%d\n", mem.ramx_size, mem.dmadata_size);
+}
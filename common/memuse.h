@@ -0,0 +1,56 @@
+/********************************** (C) COPYRIGHT *******************************
+* File Name          : memuse.h
+* Author             : bvernoux
+* Version            : V1.0
+* Date               : 2026/10/19
+* Description        : RAM/RAMX usage by section (linker symbols) and stack
+*                      high-water mark (stack painting)
+* Copyright (c) 2026 Benjamin VERNOUX
+* SPDX-License-Identifier: Apache-2.0
+*******************************************************************************/
+#ifndef MEMUSE_H_
+#define MEMUSE_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+
+/* Memory regions (see .ld) */
+#define MEMUSE_RAM_ADDR  (0x20000000)
+#define MEMUSE_RAMX_ADDR (0x20020000)
+#define MEMUSE_RAMX_SIZE (96 * 1024)
+
+/*
+ * Free RAM between end of .bss and the stack (no heap) and the stack are
+ * painted with MEMUSE_STACK_PAINT by memuse_stack_paint() (first call of
+ * main()), the high-water mark is the lowest word no more painted
+ * (ISR use the same stack)
+ * stack_used_max > stack_size means the stack went below __stack_size
+ * (into free RAM, or .bss if free_size is 0)
+ */
+#define MEMUSE_STACK_PAINT (0xA5A5A5A5)
+
+typedef struct
+{
+	uint32_t ram_size; /* RAM region size (16K) */
+	uint32_t data_size; /* .data (initialized variables) */
+	uint32_t bss_size; /* .bss (zeroed variables) */
+	uint32_t free_size; /* RAM not used between .bss and stack */
+	uint32_t stack_size; /* __stack_size */
+	uint32_t stack_used_max; /* Stack high-water mark since memuse_stack_paint() */
+	uint32_t ramx_size; /* RAMX region size (96K) */
+	uint32_t dmadata_size; /* .DMADATA (RAMX buffers, not initialized) */
+} memuse_t;
+
+void memuse_stack_paint(void);
+uint32_t memuse_stack_used_max(void);
+void memuse_get(memuse_t* mem);
+void memuse_log(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* MEMUSE_H_ */
@@ -0,0 +1,189 @@
+/********************************** (C) COPYRIGHT *******************************
+* File Name          : soak.c
+* Author             : bvernoux
+* Version            : V1.0
+* Date               : 2026/10/19
+* Description        : Long duration link soak test statistics (counters
+*                      never reset) with TX fault injection and recovery time
+* Copyright (c) 2026 Benjamin VERNOUX
+* SPDX-License-Identifier: Apache-2.0
+*******************************************************************************/
+#include "CH56x_common.h"
+#include "CH56x_debug_log.h"
+#include "fastmem.h"
+#include "irq_save.h"
+#include "soak.h"
+
+/* Updated by application and ISR (soak_frame()/soak_error() can be called in ISR) */
+static volatile soak_stats_t soak_stats;
+static uint64_t soak_start; /* SysTick at soak_init() */
+static uint32_t soak_err_pending; /* Error not yet recovered */
+static uint32_t soak_err_ts; /* SysTick (LSB) of first error not recovered */
+static uint32_t soak_fault_cnt; /* TX frames since last fault injected */
+
+/*******************************************************************************
+ * @fn     soak_init
+ *
+ * @brief  Clear soak statistics (to be called once at start of the test)
+ *
+ * @param  fault_every_n: Fault injection period in frames (0 = disabled)
+ *
+ * @return None
+ */
+void soak_init(uint32_t fault_every_n)
+{
+	uint32_t mstatus;
+
+	mstatus = irq_save();
+	fastmem_set((void*)&soak_stats, 0, sizeof(soak_stats));
+	soak_stats.fault_every_n = fault_every_n;
+	soak_start = bsp_get_SysTickCNT();
+	soak_err_pending = 0;
+	soak_fault_cnt = 0;
+	irq_restore(mstatus);
+}
+
+/*******************************************************************************
+ * @fn     soak_set_fault
+ *
+ * @brief  Change fault injection period while test is running
+ *
+ * @param  fault_every_n: Fault injection period in frames (0 = disabled)
+ *
+ * @return None
+ */
+void soak_set_fault(uint32_t fault_every_n)
+{
+	soak_stats.fault_every_n = fault_every_n;
+	soak_fault_cnt = 0;
+}
+
+/*******************************************************************************
+ * @fn     soak_frame
+ *
+ * @brief  Record a good frame (end of recovery if an error is pending)
+ *
+ * @param  len: Frame length in bytes
+ * @param  burst_us: Frame transfer time in us (0 if not measured)
+ *
+ * @return None
+ */
+void soak_frame(uint32_t len, uint32_t burst_us)
+{
+	uint32_t us;
+
+	soak_stats.nb_bytes += len;
+	soak_stats.nb_frame++;
+	if(burst_us != 0)
+	{
+		if((soak_stats.burst_us_min == 0) || (burst_us < soak_stats.burst_us_min))
+			soak_stats.burst_us_min = burst_us;
+		if(burst_us > soak_stats.burst_us_max)
+			soak_stats.burst_us_max = burst_us;
+	}
+	if(soak_err_pending)
+	{
+		soak_err_pending = 0;
+		us = (soak_err_ts - bsp_get_SysTickCNT_LSB()) / bsp_get_nbtick_1us(); // SysTick count down
+		soak_stats.recovery_us_last = us;
+		if(us > soak_stats.recovery_us_max)
+			soak_stats.recovery_us_max = us;
+		soak_stats.nb_recovery++;
+	}
+}
+
+/*******************************************************************************
+ * @fn     soak_error
+ *
+ * @brief  Record an error (start of recovery if no error is pending)
+ *
+ * @param  err: Error type
+ *
+ * @return None
+ */
+void soak_error(e_soak_err err)
+{
+	if(err >= SOAK_ERR_NB)
+		return;
+	soak_stats.nb_err[err]++;
+	if(soak_err_pending == 0)
+	{
+		soak_err_pending = 1;
+		soak_err_ts = bsp_get_SysTickCNT_LSB();
+	}
+}
+
+/*******************************************************************************
+ * @fn     soak_reinit
+ *
+ * @brief  Record a link re-init after error
+ *
+ * @return None
+ */
+void soak_reinit(void)
+{
+	soak_stats.nb_reinit++;
+}
+
+/*******************************************************************************
+ * @fn     soak_fault_inject
+ *
+ * @brief  To be called by TX for each frame, the frame shall be corrupted
+ *         when 1 is returned (each fault_every_n frames)
+ *
+ * @return 1 if frame shall be corrupted else 0
+ */
+int soak_fault_inject(void)
+{
+	if(soak_stats.fault_every_n == 0)
+		return 0;
+	soak_fault_cnt++;
+	if(soak_fault_cnt < soak_stats.fault_every_n)
+		return 0;
+	soak_fault_cnt = 0;
+	soak_stats.nb_fault++;
+	return 1;
+}
+
+/*******************************************************************************
+ * @fn     soak_get
+ *
+ * @brief  Get a consistent copy of soak statistics (can be called while
+ *         test is running)
+ *
+ * @return None
+ */
+void soak_get(soak_stats_t* stats)
+{
+	uint64_t now;
+	uint32_t mstatus;
+
+	mstatus = irq_save();
+	fastmem_cpy(stats, (const void*)&soak_stats, sizeof(soak_stats_t));
+	irq_restore(mstatus);
+	now = bsp_get_SysTickCNT();
+	stats->uptime_s = (uint32_t)((soak_start - now) / bsp_get_nbtick_1us() / 1000000); // SysTick count down
+}
+
+/*******************************************************************************
+ * @fn     soak_log
+ *
+ * @brief  Log soak statistics
+ *
+ * @param  name: Link name
+ *
+ * @return None
+ */
+void soak_log(const char* name)
+{
+	soak_stats_t stats;
+
+	soak_get(&stats);
+	log_printf("SOAK %s %ds MB=%d frames=%d crc=%d seq=%d data=%d ovf=%d timeout=%d reinit=%d\n",
+			   name, stats.uptime_s, (uint32_t)(stats.nb_bytes >> 20), stats.nb_frame,
+			   stats.nb_err[SOAK_ERR_CRC], stats.nb_err[SOAK_ERR_SEQ], stats.nb_err[SOAK_ERR_DATA],
+			   stats.nb_err[SOAK_ERR_OVERFLOW], stats.nb_err[SOAK_ERR_TIMEOUT], stats.nb_reinit);
+	log_printf("SOAK %s burst=%d/%dus fault=%d/%d recovery=%d last=%dus max=%dus\n",
+			   name, stats.burst_us_min, stats.burst_us_max, stats.nb_fault, stats.fault_every_n,
+			   stats.nb_recovery, stats.recovery_us_last, stats.recovery_us_max);
+}
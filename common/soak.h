@@ -0,0 +1,70 @@
+/********************************** (C) COPYRIGHT *******************************
+* File Name          : soak.h
+* Author             : bvernoux
+* Version            : V1.0
+* Date               : 2026/10/19
+* Description        : Long duration link soak test statistics (counters
+*                      never reset) with TX fault injection and recovery time
+* Copyright (c) 2026 Benjamin VERNOUX
+* SPDX-License-Identifier: Apache-2.0
+*******************************************************************************/
+#ifndef SOAK_H_
+#define SOAK_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+
+typedef enum
+{
+	SOAK_ERR_CRC = 0, /* Frame CRC error */
+	SOAK_ERR_SEQ, /* Frame sequence number mismatch (lost/duplicated frame) */
+	SOAK_ERR_DATA, /* Frame data verify error */
+	SOAK_ERR_OVERFLOW, /* RX FIFO overflow or RX error */
+	SOAK_ERR_TIMEOUT, /* Frame not acknowledged/received in time */
+	SOAK_ERR_NB
+} e_soak_err;
+
+/*
+ * Soak test statistics
+ * - Counters are only cleared by soak_init() (link re-init does not clear them)
+ * - Recovery time is the time from the first error to the next good frame
+ *   (includes link re-init and retransmissions)
+ * - Fault injection: TX corrupts one frame each fault_every_n frames
+ *   (see soak_fault_inject()), the error path shall detect and recover it
+ */
+typedef struct
+{
+	uint32_t uptime_s; /* Seconds since soak_init() */
+	uint32_t fault_every_n; /* Fault injection period in frames (0 = disabled) */
+	uint64_t nb_bytes; /* Bytes of good frames */
+	uint32_t nb_frame; /* Good frames */
+	uint32_t nb_err[SOAK_ERR_NB]; /* Errors by e_soak_err */
+	uint32_t nb_reinit; /* Link re-init after error */
+	uint32_t nb_fault; /* Faults injected (TX) */
+	uint32_t burst_us_min; /* Frame/burst transfer time (0 if not measured) */
+	uint32_t burst_us_max;
+	uint32_t recovery_us_last; /* Error to next good frame */
+	uint32_t recovery_us_max;
+	uint32_t nb_recovery; /* Number of recoveries (errors bursts) */
+} soak_stats_t;
+
+/* soak_log() period for applications which log statistics on serial port */
+#define SOAK_LOG_MS (10000)
+
+void soak_init(uint32_t fault_every_n);
+void soak_set_fault(uint32_t fault_every_n);
+void soak_frame(uint32_t len, uint32_t burst_us);
+void soak_error(e_soak_err err);
+void soak_reinit(void);
+int soak_fault_inject(void);
+void soak_get(soak_stats_t* stats);
+void soak_log(const char* name);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SOAK_H_ */
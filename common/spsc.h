@@ -0,0 +1,81 @@
+/********************************** (C) COPYRIGHT *******************************
+* File Name          : spsc.h
+* Author             : bvernoux
+* Version            : V1.0
+* Date               : 2026/10/19
+* Description        : Lock-free single producer/single consumer queue indexes
+*                      (ISR <-> main loop), the queue storage (buffers/
+*                      descriptors of power of 2 size) is owned by the user
+* Copyright (c) 2026 Benjamin VERNOUX
+* SPDX-License-Identifier: Apache-2.0
+*******************************************************************************/
+#ifndef SPSC_H_
+#define SPSC_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+
+/*
+ * head is only written by the producer and tail only by the consumer
+ * (free running indexes, slot is index & (size - 1)).
+ * Release/acquire ordering guarantees slot content is written before
+ * the producer publishes it and read before the consumer frees it.
+ */
+typedef struct
+{
+	volatile uint32_t head; /* Producer index */
+	volatile uint32_t tail; /* Consumer index */
+} spsc_t;
+
+#define SPSC_SLOT(idx, size) ((idx) & ((size) - 1))
+
+static inline void spsc_init(spsc_t* q)
+{
+	q->head = 0;
+	q->tail = 0;
+}
+
+/* Number of slots produced and not yet consumed */
+static inline uint32_t spsc_count(const spsc_t* q)
+{
+	return __atomic_load_n(&q->head, __ATOMIC_ACQUIRE) - __atomic_load_n(&q->tail, __ATOMIC_ACQUIRE);
+}
+
+/* Producer: slot to fill or -1 if queue is full */
+static inline int32_t spsc_produce_slot(const spsc_t* q, uint32_t size)
+{
+	uint32_t head = q->head;
+	if((head - __atomic_load_n(&q->tail, __ATOMIC_ACQUIRE)) >= size)
+		return -1;
+	return SPSC_SLOT(head, size);
+}
+
+/* Producer: publish filled slot */
+static inline void spsc_push(spsc_t* q)
+{
+	__atomic_store_n(&q->head, q->head + 1, __ATOMIC_RELEASE);
+}
+
+/* Consumer: oldest slot or -1 if queue is empty */
+static inline int32_t spsc_consume_slot(const spsc_t* q, uint32_t size)
+{
+	uint32_t tail = q->tail;
+	if(__atomic_load_n(&q->head, __ATOMIC_ACQUIRE) == tail)
+		return -1;
+	return SPSC_SLOT(tail, size);
+}
+
+/* Consumer: free oldest slot */
+static inline void spsc_pop(spsc_t* q)
+{
+	__atomic_store_n(&q->tail, q->tail + 1, __ATOMIC_RELEASE);
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SPSC_H_ */
@@ -0,0 +1,215 @@
+/********************************** (C) COPYRIGHT *******************************
+* File Name          : trace.c
+* Author             : bvernoux
+* Version            : V1.0
+* Date               : 2026/10/19
+* Description        : Compile time trace points (disabled, GPIO toggle or
+*                      timestamped entry in a RAM ring)
+* Copyright (c) 2026 Benjamin VERNOUX
+* SPDX-License-Identifier: Apache-2.0
+*******************************************************************************/
+#include "CH56x_common.h"
+#include "CH56x_debug_log.h"
+#include "fastmem.h"
+#include "irq_save.h"
+#include "trace.h"
+
+#if TRACE_CFG_ANY(TRACE_RING)
+/* Written by ISR and main loop (trace_ring_put() with interrupts disabled) */
+static trace_entry_t trace_ring[TRACE_RING_SIZE];
+static uint32_t trace_ring_head; /* Next entry written */
+static uint32_t trace_ring_tail; /* Oldest entry not read */
+static uint32_t trace_ring_lost;
+
+/* Same order as e_trace_id */
+static const char* const trace_name[TRACE_ID_NB] =
+{
+	"EVENT_WAKE",
+	"TMR1_IRQ",
+	"HSPI_IRQ_ENTER",
+	"HSPI_IRQ_EXIT",
+	"HSPI_TX_START",
+	"HSPI_RX_REARM",
+	"SERDES_IRQ_ENTER",
+	"SERDES_IRQ_EXIT",
+	"SERDES_TX_START",
+	"SERDES_TX_END",
+	"USB_CMD",
+	"USB_RING_IN_REARM",
+	"USB_RING_OUT_REARM",
+	"CLK_SWITCH",
+};
+#endif
+
+/*******************************************************************************
+ * @fn     trace_init
+ *
+ * @brief  Init trace backends used by trace points (TRACE_GPIO_PIN output
+ *         low, RAM ring empty)
+ *
+ * @return None
+ */
+void trace_init(void)
+{
+#if TRACE_CFG_ANY(TRACE_GPIO)
+	GPIOA_ResetBits(TRACE_GPIO_PIN);
+	GPIOA_ModeCfg(TRACE_GPIO_PIN, GPIO_Highspeed_PP_8mA);
+#endif
+#if TRACE_CFG_ANY(TRACE_RING)
+	trace_ring_head = 0;
+	trace_ring_tail = 0;
+	trace_ring_lost = 0;
+#endif
+}
+
+/*******************************************************************************
+ * @fn     trace_ring_put
+ *
+ * @brief  Write a timestamped entry in the RAM ring (ISR or main loop),
+ *         the oldest entry is overwritten when the ring is full
+ *
+ * @param  id: e_trace_id
+ * @param  arg: Trace point argument (16 LSB kept)
+ *
+ * @return None
+ */
+void trace_ring_put(uint32_t id, uint32_t arg)
+{
+#if TRACE_CFG_ANY(TRACE_RING)
+	trace_entry_t* e;
+	uint32_t mstatus;
+
+	mstatus = irq_save();
+	e = &trace_ring[trace_ring_head & (TRACE_RING_SIZE - 1)];
+	e->ts = bsp_get_SysTickCNT_LSB();
+	e->id = (uint16_t)id;
+	e->arg = (uint16_t)arg;
+	trace_ring_head++;
+	if((trace_ring_head - trace_ring_tail) > TRACE_RING_SIZE)
+	{
+		trace_ring_tail++;
+		trace_ring_lost++;
+	}
+	irq_restore(mstatus);
+#else
+	(void)id;
+	(void)arg;
+#endif
+}
+
+/*******************************************************************************
+ * @fn     trace_ring_read
+ *
+ * @brief  Read (and remove) the RAM ring entries, oldest first
+ *
+ * @param  dst: trace_dump_t followed by the entries
+ * @param  size: dst size in bytes (entries which do not fit stay in the ring)
+ *
+ * @return Bytes written in dst (0 if size < sizeof(trace_dump_t))
+ */
+uint32_t trace_ring_read(void* dst, uint32_t size)
+{
+	trace_dump_t* dump = (trace_dump_t*)dst;
+	uint32_t nb = 0;
+#if TRACE_CFG_ANY(TRACE_RING)
+	trace_entry_t* e = (trace_entry_t*)(dump + 1);
+	uint32_t mstatus;
+	uint32_t max;
+#endif
+
+	if(size < sizeof(trace_dump_t))
+		return 0;
+	dump->nb_lost = 0;
+#if TRACE_CFG_ANY(TRACE_RING)
+	max = (size - sizeof(trace_dump_t)) / sizeof(trace_entry_t);
+	mstatus = irq_save();
+	while((trace_ring_tail != trace_ring_head) && (nb < max))
+	{
+		e[nb] = trace_ring[trace_ring_tail & (TRACE_RING_SIZE - 1)];
+		trace_ring_tail++;
+		nb++;
+	}
+	dump->nb_lost = trace_ring_lost;
+	trace_ring_lost = 0;
+	irq_restore(mstatus);
+#endif
+	dump->nb_entry = nb;
+	dump->nbtick_1us = bsp_get_nbtick_1us();
+	dump->ts_now = bsp_get_SysTickCNT_LSB();
+	return sizeof(trace_dump_t) + (nb * sizeof(trace_entry_t));
+}
+
+/*******************************************************************************
+ * @fn     trace_ring_last
+ *
+ * @brief  Copy the last written RAM ring entries, oldest first (entries
+ *         already read are included and the ring is not modified, for
+ *         crash snapshot)
+ *
+ * @param  dst: Entries
+ * @param  nb: Max number of entries
+ *
+ * @return Number of entries written in dst
+ */
+uint32_t trace_ring_last(trace_entry_t* dst, uint32_t nb)
+{
+#if TRACE_CFG_ANY(TRACE_RING)
+	uint32_t mstatus;
+	uint32_t head;
+	uint32_t i;
+
+	mstatus = irq_save();
+	head = trace_ring_head;
+	if(nb > TRACE_RING_SIZE)
+		nb = TRACE_RING_SIZE;
+	if(nb > head)
+		nb = head;
+	for(i = 0; i < nb; i++)
+		dst[i] = trace_ring[(head - nb + i) & (TRACE_RING_SIZE - 1)];
+	irq_restore(mstatus);
+	return nb;
+#else
+	(void)dst;
+	(void)nb;
+	return 0;
+#endif
+}
+
+/*******************************************************************************
+ * @fn     trace_log
+ *
+ * @brief  Log (and remove) the RAM ring entries with time relative to the
+ *         oldest entry (for examples without USB)
+ *
+ * @return None
+ */
+void trace_log(void)
+{
+#if TRACE_CFG_ANY(TRACE_RING)
+	trace_entry_t e;
+	uint32_t t0 = 0;
+	uint32_t mstatus;
+	uint32_t nb = 0;
+
+	while(1)
+	{
+		mstatus = irq_save();
+		if(trace_ring_tail == trace_ring_head)
+		{
+			irq_restore(mstatus);
+			break;
+		}
+		e = trace_ring[trace_ring_tail & (TRACE_RING_SIZE - 1)];
+		trace_ring_tail++;
+		irq_restore(mstatus);
+		if(nb == 0)
+			t0 = e.ts;
+		nb++;
+		log_printf("TRACE %dns %s 0x%04X\n",
+				   ((t0 - e.ts) * 1000) / bsp_get_nbtick_1us(), // SysTick count down
+				   (e.id < TRACE_ID_NB) ? trace_name[e.id] : "?", e.arg);
+	}
+	log_printf("TRACE %d entries lost=%d\n", nb, trace_ring_lost);
+	trace_ring_lost = 0;
+#endif
+}
@@ -0,0 +1,169 @@
+/********************************** (C) COPYRIGHT *******************************
+* File Name          : trace.h
+* Author             : bvernoux
+* Version            : V1.0
+* Date               : 2026/10/19
+* Description        : Compile time trace points (disabled, GPIO toggle or
+*                      timestamped entry in a RAM ring)
+* Copyright (c) 2026 Benjamin VERNOUX
+* SPDX-License-Identifier: Apache-2.0
+*******************************************************************************/
+#ifndef TRACE_H_
+#define TRACE_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+
+/*
+ * Each trace point is used with TRACE(name, arg) and its backend is chosen
+ * at compile time with TRACE_CFG_<name> (default TRACE_DEFAULT), for example
+ * DEFINE_OPTS = -DTRACE_DEFAULT=TRACE_RING -DTRACE_CFG_HSPI_IRQ_ENTER=TRACE_GPIO
+ * - TRACE_OFF: no code
+ * - TRACE_GPIO: TRACE_GPIO_PIN (GPIOA) is toggled (an ENTER/EXIT pair gives
+ *   a pulse to be measured with Oscilloscope/LA)
+ * - TRACE_RING: SysTick timestamp, id and arg (16bits) are written in a RAM
+ *   ring of TRACE_RING_SIZE entries (oldest entries are overwritten) read
+ *   with trace_ring_read() (USB_CMD_TRCE) or trace_log()
+ * Backend values shall stay plain numbers (used for token pasting)
+ */
+#define TRACE_OFF  0
+#define TRACE_GPIO 1
+#define TRACE_RING 2
+
+#ifndef TRACE_DEFAULT
+#define TRACE_DEFAULT TRACE_OFF
+#endif
+
+#ifndef TRACE_GPIO_PIN
+#define TRACE_GPIO_PIN (GPIO_Pin_13) // J3 SCK(PA13) not used by bsp_sync2boards()
+#endif
+
+#ifndef TRACE_RING_SIZE
+#define TRACE_RING_SIZE (128) // Power of 2 (8 bytes per entry in RAM)
+#endif
+
+typedef enum
+{
+	TRACE_ID_EVENT_WAKE = 0, /* Main loop wake-up from WFI (arg: pending events) */
+	TRACE_ID_TMR1_IRQ, /* event_timer TMR1_IRQHandler() (arg: remaining ms) */
+	TRACE_ID_HSPI_IRQ_ENTER, /* HSPI_IRQHandler() entry (arg: R8_HSPI_INT_FLAG) */
+	TRACE_ID_HSPI_IRQ_EXIT, /* HSPI_IRQHandler() exit */
+	TRACE_ID_HSPI_TX_START, /* HSPI transfer started (arg: address LSB) */
+	TRACE_ID_HSPI_RX_REARM, /* HSPI RX DMA re-armed at first packet (arg: address LSB) */
+	TRACE_ID_SERDES_IRQ_ENTER, /* SERDES_IRQHandler() entry (arg: SerDes_StatusIT()) */
+	TRACE_ID_SERDES_IRQ_EXIT, /* SERDES_IRQHandler() exit */
+	TRACE_ID_SERDES_TX_START, /* SerDes_DMA_Tx() (arg: length) */
+	TRACE_ID_SERDES_TX_END, /* SerDes_Wait_Txdone() done */
+	TRACE_ID_USB_CMD, /* Endpoint1 command received in USB IRQ (arg: opcode LSB) */
+	TRACE_ID_USB_RING_IN_REARM, /* Endpoint2 IN re-armed in USB IRQ (arg: slot) */
+	TRACE_ID_USB_RING_OUT_REARM, /* Endpoint2 OUT re-armed in USB IRQ (arg: slot) */
+	TRACE_ID_CLK_SWITCH, /* clkgov system clock switch start (arg: new MHz) and end (arg: 0) */
+	TRACE_ID_NB
+} e_trace_id;
+
+#ifndef TRACE_CFG_EVENT_WAKE
+#define TRACE_CFG_EVENT_WAKE TRACE_DEFAULT
+#endif
+#ifndef TRACE_CFG_TMR1_IRQ
+#define TRACE_CFG_TMR1_IRQ TRACE_DEFAULT
+#endif
+#ifndef TRACE_CFG_HSPI_IRQ_ENTER
+#define TRACE_CFG_HSPI_IRQ_ENTER TRACE_DEFAULT
+#endif
+#ifndef TRACE_CFG_HSPI_IRQ_EXIT
+#define TRACE_CFG_HSPI_IRQ_EXIT TRACE_DEFAULT
+#endif
+#ifndef TRACE_CFG_HSPI_TX_START
+#define TRACE_CFG_HSPI_TX_START TRACE_DEFAULT
+#endif
+#ifndef TRACE_CFG_HSPI_RX_REARM
+#define TRACE_CFG_HSPI_RX_REARM TRACE_DEFAULT
+#endif
+#ifndef TRACE_CFG_SERDES_IRQ_ENTER
+#define TRACE_CFG_SERDES_IRQ_ENTER TRACE_DEFAULT
+#endif
+#ifndef TRACE_CFG_SERDES_IRQ_EXIT
+#define TRACE_CFG_SERDES_IRQ_EXIT TRACE_DEFAULT
+#endif
+#ifndef TRACE_CFG_SERDES_TX_START
+#define TRACE_CFG_SERDES_TX_START TRACE_DEFAULT
+#endif
+#ifndef TRACE_CFG_SERDES_TX_END
+#define TRACE_CFG_SERDES_TX_END TRACE_DEFAULT
+#endif
+#ifndef TRACE_CFG_USB_CMD
+#define TRACE_CFG_USB_CMD TRACE_DEFAULT
+#endif
+#ifndef TRACE_CFG_USB_RING_IN_REARM
+#define TRACE_CFG_USB_RING_IN_REARM TRACE_DEFAULT
+#endif
+#ifndef TRACE_CFG_USB_RING_OUT_REARM
+#define TRACE_CFG_USB_RING_OUT_REARM TRACE_DEFAULT
+#endif
+#ifndef TRACE_CFG_CLK_SWITCH
+#define TRACE_CFG_CLK_SWITCH TRACE_DEFAULT
+#endif
+
+/* 1 if at least one trace point uses backend b (usable in #if) */
+#define TRACE_CFG_ANY(b) \
+	((TRACE_CFG_EVENT_WAKE == (b)) || (TRACE_CFG_TMR1_IRQ == (b)) || \
+	 (TRACE_CFG_HSPI_IRQ_ENTER == (b)) || (TRACE_CFG_HSPI_IRQ_EXIT == (b)) || \
+	 (TRACE_CFG_HSPI_TX_START == (b)) || (TRACE_CFG_HSPI_RX_REARM == (b)) || \
+	 (TRACE_CFG_SERDES_IRQ_ENTER == (b)) || (TRACE_CFG_SERDES_IRQ_EXIT == (b)) || \
+	 (TRACE_CFG_SERDES_TX_START == (b)) || (TRACE_CFG_SERDES_TX_END == (b)) || \
+	 (TRACE_CFG_USB_CMD == (b)) || (TRACE_CFG_USB_RING_IN_REARM == (b)) || \
+	 (TRACE_CFG_USB_RING_OUT_REARM == (b)) || (TRACE_CFG_CLK_SWITCH == (b)))
+
+/* TRACE_GPIO_PIN is configured by trace_init() only if a trace point uses it */
+#if TRACE_CFG_ANY(TRACE_GPIO)
+#define TRACE_GPIO_USED (1)
+#include "CH56x_common.h"
+#include "irq_save.h"
+
+/* Toggle with interrupts disabled (GPIOA output is also written by ISR) */
+static inline void trace_gpio_toggle(void)
+{
+	uint32_t mstatus = irq_save();
+
+	GPIOA_InverseBits(TRACE_GPIO_PIN);
+	irq_restore(mstatus);
+}
+#endif
+
+#define TRACE(name, arg) TRACE_EMIT(TRACE_CFG_##name, TRACE_ID_##name, (arg))
+#define TRACE_EMIT(cfg, id, arg) TRACE_EMIT_(cfg, id, arg)
+#define TRACE_EMIT_(cfg, id, arg) TRACE_EMIT_##cfg(id, arg)
+#define TRACE_EMIT_0(id, arg) ((void)0)
+#define TRACE_EMIT_1(id, arg) trace_gpio_toggle()
+#define TRACE_EMIT_2(id, arg) trace_ring_put((id), (uint32_t)(arg))
+
+typedef struct
+{
+	uint32_t ts; /* SysTick (LSB, count down) */
+	uint16_t id; /* e_trace_id */
+	uint16_t arg;
+} trace_entry_t;
+
+/* trace_ring_read() header followed by nb_entry trace_entry_t (oldest first) */
+typedef struct
+{
+	uint32_t nb_entry;
+	uint32_t nb_lost; /* Entries overwritten since previous trace_ring_read() */
+	uint32_t nbtick_1us; /* SysTick ticks per us */
+	uint32_t ts_now; /* SysTick (LSB) at read */
+} trace_dump_t;
+
+void trace_init(void);
+void trace_ring_put(uint32_t id, uint32_t arg);
+uint32_t trace_ring_read(void* dst, uint32_t size);
+uint32_t trace_ring_last(trace_entry_t* dst, uint32_t nb);
+void trace_log(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* TRACE_H_ */
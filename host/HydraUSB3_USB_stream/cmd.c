@@ -0,0 +1,257 @@
+/********************************** (C) COPYRIGHT *******************************
+* File Name          : cmd.c
+* Author             : bvernoux
+* Version            : V1.0
+* Date               : 2026/10/19
+* Description        : HydraUSB3_USB Endpoint1 commands (asynchronous
+*                      request/answer, USB_CMD_BTCH batches)
+* Copyright (c) 2026 Benjamin VERNOUX
+* SPDX-License-Identifier: Apache-2.0
+*******************************************************************************/
+#include <string.h>
+#include "cmd.h"
+
+/*******************************************************************************
+ * @fn     cmd_done
+ *
+ * @brief  Endpoint1 OUT/IN completion, answer callback once both are done
+ *
+ * @return None
+ */
+static void cmd_done(dev_xfer_t* xfer)
+{
+	cmd_t* cmd = (cmd_t*)xfer->user;
+	cmd_answer_cb_t cb = cmd->cb;
+
+	if((xfer->status != DEV_OK) && (cmd->status == DEV_OK))
+	{
+		cmd->status = xfer->status;
+		if((xfer == &cmd->out) && cmd->in.busy)
+			dev_cancel(&cmd->in); // Command not sent, no answer
+	}
+	cmd->pending--;
+	if(cmd->pending > 0)
+		return;
+	if(cmd->status != DEV_OK)
+	{
+		cmd->nb_err++;
+		if(cb)
+			cb(cmd, cmd->status, NULL, 0);
+		return;
+	}
+	cmd->nb_done++;
+	if(cmd->in.submit_ns)
+	{
+		hist_add(&cmd->lat, cmd->in.done_ns - cmd->out.submit_ns);
+		cmd->nb_ans++;
+		cmd->nb_ans_bytes += cmd->in.actual;
+	}
+	if(cb)
+	{
+		if(cmd->in.submit_ns)
+			cb(cmd, DEV_OK, cmd->in_buf, cmd->in.actual);
+		else
+			cb(cmd, DEV_OK, NULL, 0);
+	}
+}
+
+int cmd_init(cmd_t* cmd, dev_handle_t* dev)
+{
+	memset(cmd, 0, sizeof(cmd_t));
+	cmd->dev = dev;
+	hist_init(&cmd->lat);
+	cmd->out_buf = dev_buf_alloc(dev, HYDRAUSB3_EP1_MAX_SIZE);
+	cmd->in_buf = dev_buf_alloc(dev, HYDRAUSB3_EP1_MAX_SIZE);
+	if((cmd->out_buf == NULL) || (cmd->in_buf == NULL))
+		return DEV_ERR_IO;
+	if(dev_xfer_init(dev, &cmd->out, HYDRAUSB3_EP1_OUT, cmd->out_buf, 0, cmd_done, cmd) != DEV_OK)
+		return DEV_ERR_IO;
+	if(dev_xfer_init(dev, &cmd->in, HYDRAUSB3_EP1_IN, cmd->in_buf, HYDRAUSB3_EP1_MAX_SIZE, cmd_done, cmd) != DEV_OK)
+		return DEV_ERR_IO;
+	cmd->out.timeout_ms = CMD_TIMEOUT_MS;
+	cmd->in.timeout_ms = CMD_TIMEOUT_MS;
+	return DEV_OK;
+}
+
+void cmd_deinit(cmd_t* cmd)
+{
+	while(cmd->pending)
+		dev_handle_events(cmd->dev, 100);
+	dev_xfer_free(&cmd->out);
+	dev_xfer_free(&cmd->in);
+	dev_buf_free(cmd->dev, cmd->out_buf, HYDRAUSB3_EP1_MAX_SIZE);
+	dev_buf_free(cmd->dev, cmd->in_buf, HYDRAUSB3_EP1_MAX_SIZE);
+}
+
+int cmd_busy(cmd_t* cmd)
+{
+	return (cmd->pending > 0);
+}
+
+/*******************************************************************************
+ * @fn     cmd_submit
+ *
+ * @brief  Send a request (Endpoint1 OUT) and receive its answer (Endpoint1
+ *         IN) asynchronously, cb is called from dev_handle_events()
+ *
+ * @param  cmd: Endpoint1 commands
+ * @param  req: Request (32bits command + parameters or cmd_btch_t buf)
+ * @param  len: Request length in bytes (max HYDRAUSB3_EP1_MAX_SIZE)
+ * @param  has_answer: 0 for commands without answer (USB2, USB3, BOOT)
+ * @param  cb: Answer callback (can be NULL)
+ * @param  user: Callback data (cmd->user)
+ *
+ * @return DEV_OK or DEV_ERR_XXX (DEV_ERR_PARAM if a request is in flight)
+ */
+int cmd_submit(cmd_t* cmd, const void* req, uint32_t len, int has_answer, cmd_answer_cb_t cb, void* user)
+{
+	int ret;
+
+	if(cmd->pending || (len > HYDRAUSB3_EP1_MAX_SIZE) || (len < sizeof(uint32_t)))
+		return DEV_ERR_PARAM;
+	memcpy(cmd->out_buf, req, len);
+	cmd->out.len = len;
+	cmd->cb = cb;
+	cmd->user = user;
+	cmd->status = DEV_OK;
+	cmd->in.submit_ns = 0;
+	if(has_answer)
+	{
+		ret = dev_submit(&cmd->in);
+		if(ret != DEV_OK)
+			return ret;
+		cmd->pending++;
+	}
+	ret = dev_submit(&cmd->out);
+	if(ret != DEV_OK)
+	{
+		cmd->status = ret;
+		if(has_answer)
+			dev_cancel(&cmd->in); // cb called with the error
+		return ret;
+	}
+	cmd->pending++;
+	return DEV_OK;
+}
+
+typedef struct
+{
+	void* ans;
+	uint32_t ans_size;
+	uint32_t* ans_len;
+	int status;
+} cmd_call_t;
+
+static void cmd_call_cb(cmd_t* cmd, int status, const uint8_t* ans, uint32_t len)
+{
+	cmd_call_t* call = (cmd_call_t*)cmd->user;
+
+	call->status = status;
+	if(len > call->ans_size)
+		len = call->ans_size;
+	if(ans && call->ans)
+		memcpy(call->ans, ans, len);
+	if(call->ans_len)
+		*call->ans_len = len;
+}
+
+/*******************************************************************************
+ * @fn     cmd_call
+ *
+ * @brief  Send a request and wait its answer (other transfers in flight are
+ *         processed meanwhile)
+ *
+ * @param  ans: Answer buffer (NULL for commands without answer)
+ * @param  ans_size: Answer buffer size in bytes
+ * @param  ans_len: Answer length in bytes (can be NULL)
+ *
+ * @return DEV_OK or DEV_ERR_XXX
+ */
+int cmd_call(cmd_t* cmd, const void* req, uint32_t len, void* ans, uint32_t ans_size, uint32_t* ans_len)
+{
+	cmd_call_t call = { ans, ans_size, ans_len, DEV_OK };
+	int ret;
+
+	while(cmd->pending)
+		dev_handle_events(cmd->dev, 100);
+	ret = cmd_submit(cmd, req, len, (ans != NULL), cmd_call_cb, &call);
+	if(ret != DEV_OK)
+	{
+		while(cmd->pending)
+			dev_handle_events(cmd->dev, 100);
+		return ret;
+	}
+	while(cmd->pending)
+		dev_handle_events(cmd->dev, 100);
+	return call.status;
+}
+
+void cmd_btch_init(cmd_btch_t* btch)
+{
+	usb_cmd_btch_t* hdr = (usb_cmd_btch_t*)btch->buf;
+
+	hdr->cmd = USB_CMD_BTCH;
+	hdr->nb_cmd = 0;
+	hdr->len = 0;
+	btch->len = sizeof(usb_cmd_btch_t);
+	btch->nb_cmd = 0;
+}
+
+/*******************************************************************************
+ * @fn     cmd_btch_add
+ *
+ * @brief  Add a command to a batch
+ *
+ * @param  tag: Tag copied in the answer TLV
+ * @param  req: Command (32bits command + parameters)
+ * @param  len: Command length in bytes
+ *
+ * @return DEV_OK or DEV_ERR_PARAM (batch full)
+ */
+int cmd_btch_add(cmd_btch_t* btch, uint16_t tag, const void* req, uint32_t len)
+{
+	usb_cmd_btch_t* hdr = (usb_cmd_btch_t*)btch->buf;
+	usb_cmd_tlv_t* tlv = (usb_cmd_tlv_t*)&((uint8_t*)btch->buf)[btch->len];
+
+	if((len < sizeof(uint32_t)) || ((btch->len + USB_CMD_TLV_SIZE(len)) > HYDRAUSB3_EP1_MAX_SIZE))
+		return DEV_ERR_PARAM;
+	tlv->tag = tag;
+	tlv->len = (uint16_t)len;
+	memcpy(&tlv[1], req, len);
+	memset(&((uint8_t*)&tlv[1])[len], 0, USB_CMD_TLV_SIZE(len) - sizeof(usb_cmd_tlv_t) - len);
+	btch->len += USB_CMD_TLV_SIZE(len);
+	btch->nb_cmd++;
+	hdr->nb_cmd = btch->nb_cmd;
+	hdr->len = (uint16_t)(btch->len - sizeof(usb_cmd_btch_t));
+	return DEV_OK;
+}
+
+/*******************************************************************************
+ * @fn     cmd_btch_next
+ *
+ * @brief  Next TLV of a USB_CMD_BTCH answer
+ *
+ * @param  ans: Answer
+ * @param  len: Answer length in bytes
+ * @param  pos: Position in answer (0 for first TLV, updated)
+ *
+ * @return TLV (value follows it) or NULL if no more TLV
+ */
+const usb_cmd_tlv_t* cmd_btch_next(const uint8_t* ans, uint32_t len, uint32_t* pos)
+{
+	const usb_cmd_tlv_t* tlv;
+
+	if(*pos == 0)
+	{
+		if((len < sizeof(usb_cmd_btch_t)) || (((const usb_cmd_btch_t*)ans)->cmd != USB_CMD_BTCH))
+			return NULL;
+		*pos = sizeof(usb_cmd_btch_t);
+	}
+	if((*pos + sizeof(usb_cmd_tlv_t)) > len)
+		return NULL;
+	tlv = (const usb_cmd_tlv_t*)&ans[*pos];
+	if((*pos + sizeof(usb_cmd_tlv_t) + tlv->len) > len)
+		return NULL;
+	*pos += USB_CMD_TLV_SIZE(tlv->len);
+	return tlv;
+}
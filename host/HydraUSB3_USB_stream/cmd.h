@@ -0,0 +1,78 @@
+/********************************** (C) COPYRIGHT *******************************
+* File Name          : cmd.h
+* Author             : bvernoux
+* Version            : V1.0
+* Date               : 2026/10/19
+* Description        : HydraUSB3_USB Endpoint1 commands (asynchronous
+*                      request/answer, USB_CMD_BTCH batches)
+* Copyright (c) 2026 Benjamin VERNOUX
+* SPDX-License-Identifier: Apache-2.0
+*******************************************************************************/
+#ifndef CMD_H_
+#define CMD_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include "dev.h"
+#include "hist.h"
+#include "hydrausb3_proto.h"
+
+/*
+ * The firmware has one Endpoint1 answer buffer (overwritten by each command
+ * with an answer) so one request is in flight at a time on Endpoint1, the
+ * commands are pipelined in USB_CMD_BTCH batches (all answers in one
+ * transfer) while Endpoint2 transfers stay in flight.
+ * The Endpoint1 IN transfer is submitted with the OUT transfer (IN waits
+ * the answer on the bus, no polling).
+ */
+#define CMD_TIMEOUT_MS (1000)
+
+typedef struct
+{
+	uint32_t buf[HYDRAUSB3_EP1_MAX_SIZE / 4];
+	uint32_t len; /* Request length in bytes */
+	uint16_t nb_cmd;
+} cmd_btch_t;
+
+typedef struct cmd_s cmd_t;
+
+/* Answer callback (len = 0 and ans = NULL on error or command without answer) */
+typedef void (*cmd_answer_cb_t)(cmd_t* cmd, int status, const uint8_t* ans, uint32_t len);
+
+struct cmd_s
+{
+	dev_handle_t* dev;
+	uint8_t* out_buf;
+	uint8_t* in_buf;
+	dev_xfer_t out;
+	dev_xfer_t in;
+	uint32_t pending; /* Transfers in flight (0 = idle) */
+	int status; /* First error of actual request */
+	cmd_answer_cb_t cb;
+	void* user;
+	/* Statistics */
+	hist_t lat; /* Round-trip (OUT submit to IN completion) */
+	uint64_t nb_ans_bytes; /* Answers received in bytes (USB_CMD_TX_FULL firmware: 4KiB each) */
+	uint32_t nb_ans; /* Answers received */
+	uint32_t nb_done;
+	uint32_t nb_err;
+};
+
+int cmd_init(cmd_t* cmd, dev_handle_t* dev);
+void cmd_deinit(cmd_t* cmd);
+int cmd_submit(cmd_t* cmd, const void* req, uint32_t len, int has_answer, cmd_answer_cb_t cb, void* user);
+int cmd_call(cmd_t* cmd, const void* req, uint32_t len, void* ans, uint32_t ans_size, uint32_t* ans_len);
+int cmd_busy(cmd_t* cmd);
+
+void cmd_btch_init(cmd_btch_t* btch);
+int cmd_btch_add(cmd_btch_t* btch, uint16_t tag, const void* req, uint32_t len);
+const usb_cmd_tlv_t* cmd_btch_next(const uint8_t* ans, uint32_t len, uint32_t* pos);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CMD_H_ */
@@ -0,0 +1,245 @@
+/********************************** (C) COPYRIGHT *******************************
+* File Name          : dev.c
+* Author             : bvernoux
+* Version            : V1.0
+* Date               : 2026/10/19
+* Description        : Asynchronous bulk transfers with pluggable device
+*                      backends (libusb or in-process fake device)
+* Copyright (c) 2026 Benjamin VERNOUX
+* SPDX-License-Identifier: Apache-2.0
+*******************************************************************************/
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include "dev.h"
+
+/* First one is the default backend */
+static const dev_ops_t* const dev_backends[] =
+{
+#if(defined HAVE_LIBUSB)
+	&dev_libusb_ops,
+#endif
+	&dev_fake_ops,
+};
+#define DEV_NB_BACKENDS (sizeof(dev_backends) / sizeof(dev_backends[0]))
+
+/*******************************************************************************
+ * @fn     dev_time_ns
+ *
+ * @brief  Monotonic time
+ *
+ * @return Time in ns
+ */
+uint64_t dev_time_ns(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ((uint64_t)ts.tv_sec * 1000000000ULL) + (uint64_t)ts.tv_nsec;
+}
+
+/*******************************************************************************
+ * @fn     dev_list
+ *
+ * @brief  Print backends available (first one is the default)
+ *
+ * @return None
+ */
+void dev_list(void)
+{
+	uint32_t i;
+
+	for(i = 0; i < DEV_NB_BACKENDS; i++)
+		printf("  %s%s %s\n", dev_backends[i]->name, (i == 0) ? " (default)" : "", dev_backends[i]->help);
+}
+
+/*******************************************************************************
+ * @fn     dev_open
+ *
+ * @brief  Open a device with backend name
+ *
+ * @param  dev: Device
+ * @param  name: Backend name (NULL for default backend)
+ * @param  arg: Backend argument (NULL for backend default)
+ *
+ * @return DEV_OK or DEV_ERR_XXX
+ */
+int dev_open(dev_handle_t* dev, const char* name, const char* arg)
+{
+	uint32_t i;
+
+	memset(dev, 0, sizeof(dev_handle_t));
+	dev->speed = "unknown";
+	for(i = 0; i < DEV_NB_BACKENDS; i++)
+	{
+		if((name == NULL) || (strcmp(name, dev_backends[i]->name) == 0))
+		{
+			dev->ops = dev_backends[i];
+			return dev->ops->open(dev, arg);
+		}
+	}
+	return DEV_ERR_PARAM;
+}
+
+void dev_close(dev_handle_t* dev)
+{
+	if(dev->ops)
+		dev->ops->close(dev);
+	dev->ops = NULL;
+}
+
+uint8_t* dev_buf_alloc(dev_handle_t* dev, uint32_t size)
+{
+	return dev->ops->buf_alloc(dev, size);
+}
+
+void dev_buf_free(dev_handle_t* dev, uint8_t* buf, uint32_t size)
+{
+	if(buf)
+		dev->ops->buf_free(dev, buf, size);
+}
+
+/*******************************************************************************
+ * @fn     dev_xfer_init
+ *
+ * @brief  Init a transfer (shall be freed with dev_xfer_free())
+ *
+ * @param  dev: Device
+ * @param  xfer: Transfer
+ * @param  ep: Endpoint address (bit7 = IN)
+ * @param  buf: Buffer from dev_buf_alloc()
+ * @param  len: Length in bytes
+ * @param  cb: Completion callback (called from dev_handle_events())
+ * @param  user: Callback data
+ *
+ * @return DEV_OK or DEV_ERR_XXX
+ */
+int dev_xfer_init(dev_handle_t* dev, dev_xfer_t* xfer, uint8_t ep, uint8_t* buf, uint32_t len,
+				  dev_xfer_cb_t cb, void* user)
+{
+	memset(xfer, 0, sizeof(dev_xfer_t));
+	xfer->dev = dev;
+	xfer->ep = ep;
+	xfer->buf = buf;
+	xfer->len = len;
+	xfer->cb = cb;
+	xfer->user = user;
+	return dev->ops->xfer_init(dev, xfer);
+}
+
+void dev_xfer_free(dev_xfer_t* xfer)
+{
+	if(xfer->dev)
+		xfer->dev->ops->xfer_free(xfer->dev, xfer);
+	xfer->dev = NULL;
+}
+
+/*******************************************************************************
+ * @fn     dev_submit
+ *
+ * @brief  Queue a transfer (len, timeout_ms, buf can be changed between submits)
+ *
+ * @return DEV_OK or DEV_ERR_XXX
+ */
+int dev_submit(dev_xfer_t* xfer)
+{
+	int ret;
+
+	if(xfer->busy)
+		return DEV_ERR_PARAM;
+	xfer->actual = 0;
+	xfer->status = DEV_OK;
+	xfer->busy = 1;
+	xfer->submit_ns = dev_time_ns();
+	ret = xfer->dev->ops->submit(xfer->dev, xfer);
+	if(ret != DEV_OK)
+		xfer->busy = 0;
+	return ret;
+}
+
+/*******************************************************************************
+ * @fn     dev_cancel
+ *
+ * @brief  Cancel a transfer in flight (completed with DEV_ERR_CANCEL by
+ *         next dev_handle_events())
+ *
+ * @return DEV_OK or DEV_ERR_XXX
+ */
+int dev_cancel(dev_xfer_t* xfer)
+{
+	if(xfer->busy == 0)
+		return DEV_OK;
+	return xfer->dev->ops->cancel(xfer->dev, xfer);
+}
+
+/*******************************************************************************
+ * @fn     dev_handle_events
+ *
+ * @brief  Process completions (callbacks are called from here)
+ *
+ * @param  timeout_ms: Max wait if nothing completed
+ *
+ * @return DEV_OK or DEV_ERR_XXX
+ */
+int dev_handle_events(dev_handle_t* dev, uint32_t timeout_ms)
+{
+	return dev->ops->handle_events(dev, timeout_ms);
+}
+
+/*******************************************************************************
+ * @fn     dev_xfer_sync
+ *
+ * @brief  Submit a transfer and wait its completion (other transfers in
+ *         flight are processed meanwhile)
+ *
+ * @return Transfer status
+ */
+int dev_xfer_sync(dev_xfer_t* xfer)
+{
+	int ret;
+
+	ret = dev_submit(xfer);
+	if(ret != DEV_OK)
+		return ret;
+	while(xfer->busy)
+	{
+		ret = dev_handle_events(xfer->dev, 100);
+		if(ret != DEV_OK)
+		{
+			dev_cancel(xfer);
+			return ret;
+		}
+	}
+	return xfer->status;
+}
+
+void dev_xfer_done(dev_xfer_t* xfer, int status, uint32_t actual)
+{
+	xfer->status = status;
+	xfer->actual = actual;
+	xfer->done_ns = dev_time_ns();
+	xfer->busy = 0;
+	if(xfer->cb)
+		xfer->cb(xfer);
+}
+
+const char* dev_strerror(int status)
+{
+	switch(status)
+	{
+		case DEV_OK:
+			return "OK";
+		case DEV_ERR_IO:
+			return "I/O error";
+		case DEV_ERR_TIMEOUT:
+			return "Timeout";
+		case DEV_ERR_CANCEL:
+			return "Cancelled";
+		case DEV_ERR_NODEV:
+			return "No device";
+		case DEV_ERR_PARAM:
+			return "Invalid parameter";
+		default:
+			return "Unknown error";
+	}
+}
@@ -0,0 +1,109 @@
+/********************************** (C) COPYRIGHT *******************************
+* File Name          : dev.h
+* Author             : bvernoux
+* Version            : V1.0
+* Date               : 2026/10/19
+* Description        : Asynchronous bulk transfers with pluggable device
+*                      backends (libusb or in-process fake device)
+* Copyright (c) 2026 Benjamin VERNOUX
+* SPDX-License-Identifier: Apache-2.0
+*******************************************************************************/
+#ifndef DEV_H_
+#define DEV_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+
+/*
+ * Same model as libusb asynchronous API:
+ * - dev_submit() queues a transfer and returns immediately, any number of
+ *   transfers can be in flight on each endpoint (completed in submit order)
+ * - Completion callbacks are only called from dev_handle_events() (never
+ *   from dev_submit()), a callback can submit again its transfer
+ * Backends ("libusb" if built with libusb-1.0, "fake" always) are selected
+ * by name in dev_open().
+ */
+typedef struct dev_s dev_handle_t;
+typedef struct dev_xfer_s dev_xfer_t;
+
+typedef void (*dev_xfer_cb_t)(dev_xfer_t* xfer);
+
+/* dev_xfer_t status and functions return codes */
+#define DEV_OK          (0)
+#define DEV_ERR_IO      (-1)
+#define DEV_ERR_TIMEOUT (-2)
+#define DEV_ERR_CANCEL  (-3)
+#define DEV_ERR_NODEV   (-4)
+#define DEV_ERR_PARAM   (-5)
+
+struct dev_xfer_s
+{
+	dev_handle_t* dev;
+	uint8_t ep; /* Endpoint address (bit7 = IN) */
+	uint8_t* buf; /* Buffer from dev_buf_alloc() */
+	uint32_t len; /* Requested length in bytes */
+	uint32_t timeout_ms; /* 0 = no timeout */
+	dev_xfer_cb_t cb;
+	void* user;
+	/* Set by dev layer */
+	uint32_t actual; /* Transferred length in bytes */
+	int status; /* DEV_OK or DEV_ERR_XXX */
+	int busy; /* Submitted and not completed */
+	uint64_t submit_ns; /* dev_time_ns() at submit */
+	uint64_t done_ns; /* dev_time_ns() at completion */
+	void* priv; /* Backend transfer */
+};
+
+typedef struct
+{
+	const char* name;
+	const char* help; /* Backend argument (dev_open() arg) */
+	int (*open)(dev_handle_t* dev, const char* arg);
+	void (*close)(dev_handle_t* dev);
+	uint8_t* (*buf_alloc)(dev_handle_t* dev, uint32_t size);
+	void (*buf_free)(dev_handle_t* dev, uint8_t* buf, uint32_t size);
+	int (*xfer_init)(dev_handle_t* dev, dev_xfer_t* xfer);
+	void (*xfer_free)(dev_handle_t* dev, dev_xfer_t* xfer);
+	int (*submit)(dev_handle_t* dev, dev_xfer_t* xfer);
+	int (*cancel)(dev_handle_t* dev, dev_xfer_t* xfer);
+	int (*handle_events)(dev_handle_t* dev, uint32_t timeout_ms);
+} dev_ops_t;
+
+struct dev_s
+{
+	const dev_ops_t* ops;
+	void* priv; /* Backend state */
+	const char* speed; /* Bus speed string set by backend */
+};
+
+uint64_t dev_time_ns(void);
+void dev_list(void);
+int dev_open(dev_handle_t* dev, const char* name, const char* arg);
+void dev_close(dev_handle_t* dev);
+uint8_t* dev_buf_alloc(dev_handle_t* dev, uint32_t size);
+void dev_buf_free(dev_handle_t* dev, uint8_t* buf, uint32_t size);
+int dev_xfer_init(dev_handle_t* dev, dev_xfer_t* xfer, uint8_t ep, uint8_t* buf, uint32_t len,
+				  dev_xfer_cb_t cb, void* user);
+void dev_xfer_free(dev_xfer_t* xfer);
+int dev_submit(dev_xfer_t* xfer);
+int dev_cancel(dev_xfer_t* xfer);
+int dev_handle_events(dev_handle_t* dev, uint32_t timeout_ms);
+int dev_xfer_sync(dev_xfer_t* xfer);
+const char* dev_strerror(int status);
+
+/* Called by backends on transfer completion (from their handle_events()) */
+void dev_xfer_done(dev_xfer_t* xfer, int status, uint32_t actual);
+
+extern const dev_ops_t dev_fake_ops;
+#if(defined HAVE_LIBUSB)
+extern const dev_ops_t dev_libusb_ops;
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* DEV_H_ */
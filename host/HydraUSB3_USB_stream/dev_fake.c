@@ -0,0 +1,630 @@
+/********************************** (C) COPYRIGHT *******************************
+* File Name          : dev_fake.c
+* Author             : bvernoux
+* Version            : V1.0
+* Date               : 2026/10/19
+* Description        : In-process fake HydraUSB3_USB device (firmware
+*                      Endpoint1 commands and Endpoint2 ring benchmark
+*                      semantics) to run the host tool without a board
+* Copyright (c) 2026 Benjamin VERNOUX
+* SPDX-License-Identifier: Apache-2.0
+*******************************************************************************/
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "crc32.h"
+#include "dev.h"
+#include "hydrausb3_proto.h"
+
+/*
+ * Same behavior as HydraUSB3_USB/User/usb_cmd.c and usb_stream.c for:
+ * LOGR, USBS, USB2, USB3, MEMR, MEMW (Endpoint1 data only), BTCH, STRM,
+ * STRS (other commands are logged "CMD UNKN" without answer like unknown
+ * commands in firmware).
+ * - Endpoint1 IN answer is the answer of the last command with an answer
+ *   (one answer buffer like firmware), an Endpoint1 IN transfer waits (NAK)
+ *   until a command is answered
+ * - Endpoint2 IN/OUT transfers wait (NAK) while the ring benchmark is not
+ *   started in their direction, then complete with whole length (device
+ *   sends/receives HYDRAUSB3_EP2_BUF_SIZE buffers back to back)
+ * - Backend argument is the Endpoint2 throughput limit in MB/s (default 0 =
+ *   unlimited, the host tool own limits are measured)
+ */
+#define DEV_FAKE_NB_PENDING (256)
+#define DEV_FAKE_LOG_SIZE (4096)
+#define DEV_FAKE_RAMX_ADDR (0x20020000)
+#define DEV_FAKE_RAMX_SIZE (32768)
+
+typedef struct
+{
+	dev_xfer_t* xfer;
+	uint64_t done_ns; /* Endpoint2 scheduled completion (0 = not scheduled) */
+	int cancel;
+} dev_fake_pending_t;
+
+typedef struct
+{
+	uint32_t nb_xfer;
+	uint64_t nb_bytes;
+	uint32_t nb_crc_err;
+	uint64_t stats_bytes; /* nb_bytes at previous USB_CMD_STRS */
+	uint64_t stats_ns; /* Time of previous USB_CMD_STRS */
+} dev_fake_ring_t;
+
+typedef struct
+{
+	uint32_t rate_mbps; /* Endpoint2 throughput limit (0 = unlimited) */
+	uint64_t ep2_busy_ns; /* Endpoint2 link busy until (rate_mbps) */
+	dev_fake_pending_t pending[DEV_FAKE_NB_PENDING];
+	uint32_t nb_pending;
+	/* Firmware state */
+	char log[DEV_FAKE_LOG_SIZE];
+	uint32_t log_idx;
+	uint8_t ans[HYDRAUSB3_EP1_MAX_SIZE];
+	uint32_t ans_len; /* Endpoint1 IN armed with ans_len bytes (0 = NAK) */
+	uint32_t nb_cmd;
+	uint32_t mode; /* USB_STREAM_IDLE, USB_STREAM_RING_IN or USB_STREAM_RING_OUT */
+	uint32_t flags;
+	uint32_t ring_val; /* USB_STREAM_RING_PATTERN next value */
+	uint32_t ring_crc; /* USB_STREAM_RING_CRC running CRC32C */
+	dev_fake_ring_t ring_in;
+	dev_fake_ring_t ring_out;
+	uint32_t ramx[DEV_FAKE_RAMX_SIZE / 4];
+} dev_fake_t;
+
+static dev_fake_t dev_fake;
+
+/*******************************************************************************
+ * @fn     dev_fake_log
+ *
+ * @brief  log_printf() of fake device (read with USB_CMD_LOGR)
+ *
+ * @return None
+ */
+static void dev_fake_log(const char* fmt, ...)
+{
+	va_list args;
+	uint32_t size = DEV_FAKE_LOG_SIZE - dev_fake.log_idx;
+	int len;
+
+	if(size <= 1)
+		return; // Log buffer full
+	va_start(args, fmt);
+	len = vsnprintf(&dev_fake.log[dev_fake.log_idx], size, fmt, args);
+	va_end(args);
+	if(len < 0)
+		return;
+	if((uint32_t)len >= size)
+		len = size - 1; // Truncated
+	dev_fake.log_idx += len;
+}
+
+static int dev_fake_open(dev_handle_t* dev, const char* arg)
+{
+	memset(&dev_fake, 0, sizeof(dev_fake_t));
+	if(arg)
+		dev_fake.rate_mbps = (uint32_t)strtoul(arg, NULL, 0);
+	dev_fake.ring_in.stats_ns = dev_time_ns();
+	dev_fake.ring_out.stats_ns = dev_fake.ring_in.stats_ns;
+	dev->priv = &dev_fake;
+	dev->speed = "fake";
+	dev_fake_log("Fake device EP2 rate=%u MB/s (0=unlimited)\n", dev_fake.rate_mbps);
+	return DEV_OK;
+}
+
+static void dev_fake_close(dev_handle_t* dev)
+{
+	dev->priv = NULL;
+}
+
+static uint8_t* dev_fake_buf_alloc(dev_handle_t* dev, uint32_t size)
+{
+	(void)dev;
+	return malloc(size);
+}
+
+static void dev_fake_buf_free(dev_handle_t* dev, uint8_t* buf, uint32_t size)
+{
+	(void)dev;
+	(void)size;
+	free(buf);
+}
+
+static int dev_fake_xfer_init(dev_handle_t* dev, dev_xfer_t* xfer)
+{
+	(void)dev;
+	(void)xfer;
+	return DEV_OK;
+}
+
+static void dev_fake_xfer_free(dev_handle_t* dev, dev_xfer_t* xfer)
+{
+	(void)dev;
+	(void)xfer;
+}
+
+static int dev_fake_submit(dev_handle_t* dev, dev_xfer_t* xfer)
+{
+	dev_fake_pending_t* p;
+
+	(void)dev;
+	if(dev_fake.nb_pending >= DEV_FAKE_NB_PENDING)
+		return DEV_ERR_IO;
+	p = &dev_fake.pending[dev_fake.nb_pending++];
+	p->xfer = xfer;
+	p->done_ns = 0;
+	p->cancel = 0;
+	return DEV_OK;
+}
+
+static int32_t dev_fake_find(dev_xfer_t* xfer)
+{
+	uint32_t i;
+
+	for(i = 0; i < dev_fake.nb_pending; i++)
+	{
+		if(dev_fake.pending[i].xfer == xfer)
+			return (int32_t)i;
+	}
+	return -1;
+}
+
+static int dev_fake_cancel(dev_handle_t* dev, dev_xfer_t* xfer)
+{
+	int32_t i = dev_fake_find(xfer);
+
+	(void)dev;
+	if(i < 0)
+		return DEV_ERR_PARAM;
+	dev_fake.pending[i].cancel = 1;
+	return DEV_OK;
+}
+
+/*******************************************************************************
+ * @fn     dev_fake_usbs
+ *
+ * @brief  USB_CMD_USBS answer
+ *
+ * @return Answer length in bytes (string with end of string)
+ */
+static uint32_t dev_fake_usbs(uint8_t* tx, uint32_t tx_size)
+{
+	char* str = (char*)tx;
+	int len;
+
+	dev_fake_log("cmd USBS FAKE\n");
+	len = snprintf(str, tx_size, "USBS FAKE:\n"
+				   "CMD_NB=%u\n"
+				   "EP2_RATE_MBPS=%u (0=unlimited)\n"
+				   "MODE=%u FLAGS=0x%X\n",
+				   dev_fake.nb_cmd, dev_fake.rate_mbps, dev_fake.mode, dev_fake.flags);
+	if(len < 0)
+	{
+		len = 0;
+		str[0] = 0;
+	}
+	else if((uint32_t)len >= tx_size)
+	{
+		len = tx_size - 1; // String truncated by snprintf()
+	}
+	return (len + 1);
+}
+
+/*******************************************************************************
+ * @fn     dev_fake_ramx
+ *
+ * @brief  Fake RAMX address of a memory range
+ *
+ * @return Pointer or NULL if range is not in fake RAMX
+ */
+static uint8_t* dev_fake_ramx(uint32_t addr, uint32_t len)
+{
+	if((addr < DEV_FAKE_RAMX_ADDR) || (len > DEV_FAKE_RAMX_SIZE) ||
+	   ((addr - DEV_FAKE_RAMX_ADDR) > (DEV_FAKE_RAMX_SIZE - len)))
+		return NULL;
+	return &((uint8_t*)dev_fake.ramx)[addr - DEV_FAKE_RAMX_ADDR];
+}
+
+static void dev_fake_ring_stats(dev_fake_ring_t* ring, usb_ring_stats_t* stats, uint64_t now)
+{
+	uint64_t nb_us = (now - ring->stats_ns) / 1000;
+
+	memset(stats, 0, sizeof(usb_ring_stats_t));
+	stats->nb_xfer = ring->nb_xfer;
+	stats->nb_bytes = ring->nb_bytes;
+	stats->nb_crc_err = ring->nb_crc_err;
+	if(nb_us > 0)
+		stats->kbps = (uint32_t)(((ring->nb_bytes - ring->stats_bytes) * 1000000) / nb_us / 1024);
+	ring->stats_bytes = ring->nb_bytes;
+	ring->stats_ns = now;
+}
+
+static uint32_t dev_fake_exec(uint8_t* rx, uint32_t rx_len, uint8_t* tx, uint32_t tx_size);
+
+/*******************************************************************************
+ * @fn     dev_fake_btch
+ *
+ * @brief  USB_CMD_BTCH (same as firmware usb_cmd_btch())
+ *
+ * @return Answer length in bytes
+ */
+static uint32_t dev_fake_btch(uint8_t* rx, uint32_t rx_len, uint8_t* tx, uint32_t tx_size)
+{
+	usb_cmd_btch_t* req = (usb_cmd_btch_t*)rx;
+	usb_cmd_btch_t* resp = (usb_cmd_btch_t*)tx;
+	uint32_t rx_pos = sizeof(usb_cmd_btch_t);
+	uint32_t tx_pos = sizeof(usb_cmd_btch_t);
+	uint32_t rx_end = sizeof(usb_cmd_btch_t) + req->len;
+	uint32_t nb_cmd = req->nb_cmd;
+	uint32_t i;
+
+	if(rx_end > rx_len)
+		rx_end = rx_len;
+	for(i = 0; i < nb_cmd; i++)
+	{
+		usb_cmd_tlv_t* rx_tlv = (usb_cmd_tlv_t*)&rx[rx_pos];
+		usb_cmd_tlv_t* tx_tlv = (usb_cmd_tlv_t*)&tx[tx_pos];
+		uint32_t* cmd = (uint32_t*)&rx_tlv[1];
+
+		if(((rx_pos + sizeof(usb_cmd_tlv_t)) > rx_end) ||
+		   (rx_tlv->len < sizeof(uint32_t)) ||
+		   (rx_tlv->len > (rx_end - rx_pos - sizeof(usb_cmd_tlv_t))))
+		{
+			dev_fake_log("cmd BTCH invalid TLV %u\n", i);
+			break;
+		}
+		if((tx_pos + sizeof(usb_cmd_tlv_t) + USB_CMD_ANSWER_MIN_SIZE) > tx_size)
+			break; // Answer full
+		tx_tlv->tag = rx_tlv->tag;
+		if(cmd[0] == USB_CMD_BTCH)
+			tx_tlv->len = 0; // Nested batch not supported
+		else
+			tx_tlv->len = dev_fake_exec((uint8_t*)cmd, rx_tlv->len, (uint8_t*)&tx_tlv[1],
+										tx_size - tx_pos - sizeof(usb_cmd_tlv_t));
+		rx_pos += USB_CMD_TLV_SIZE(rx_tlv->len);
+		tx_pos += USB_CMD_TLV_SIZE(tx_tlv->len);
+	}
+	resp->cmd = USB_CMD_BTCH;
+	resp->nb_cmd = i;
+	resp->len = tx_pos - sizeof(usb_cmd_btch_t);
+	return tx_pos;
+}
+
+/*******************************************************************************
+ * @fn     dev_fake_exec
+ *
+ * @brief  Execute a command (same as firmware usb_cmd_exec())
+ *
+ * @return Answer length in bytes (0 if the command has no answer)
+ */
+static uint32_t dev_fake_exec(uint8_t* rx, uint32_t rx_len, uint8_t* tx, uint32_t tx_size)
+{
+	uint32_t cmd_val;
+	uint32_t tx_len = 0;
+
+	if(rx_len < sizeof(uint32_t))
+		return 0;
+	memcpy(&cmd_val, rx, sizeof(uint32_t));
+	dev_fake.nb_cmd++;
+	switch(cmd_val)
+	{
+		case USB_CMD_LOGR:
+		{
+			uint32_t n;
+			dev_fake_log("cmd LOGR\n");
+			n = dev_fake.log_idx;
+			if(n > (tx_size - 1))
+				n = tx_size - 1; // Remaining logs returned by next LOGR
+			memcpy(tx, dev_fake.log, n);
+			tx[n] = 0;
+			tx_len = n + 1;
+			memmove(dev_fake.log, &dev_fake.log[n], dev_fake.log_idx - n);
+			dev_fake.log_idx -= n;
+		}
+		break;
+
+		case USB_CMD_USBS:
+			tx_len = dev_fake_usbs(tx, tx_size);
+			break;
+
+		case USB_CMD_USB2:
+			dev_fake_log("cmd USB2\n");
+			break;
+
+		case USB_CMD_USB3:
+			dev_fake_log("cmd USB3\n");
+			break;
+
+		case USB_CMD_MEMR:
+		case USB_CMD_MEMW:
+		{
+			usb_cmd_mem_req_t* req = (usb_cmd_mem_req_t*)rx;
+			usb_cmd_mem_resp_t* resp = (usb_cmd_mem_resp_t*)tx;
+			uint8_t* mem = dev_fake_ramx(req->addr, req->len);
+			resp->addr = req->addr;
+			resp->len = req->len;
+			tx_len = sizeof(usb_cmd_mem_resp_t);
+			if((mem == NULL) || (req->len > USB_CMD_MEM_EP1_MAX_SIZE))
+				resp->status = USB_CMD_MEM_ERR_RANGE; // Endpoint2 memory streams not simulated
+			else if(cmd_val == USB_CMD_MEMW)
+				resp->status = (req->len > (rx_len - sizeof(usb_cmd_mem_req_t))) ? USB_CMD_MEM_ERR_SIZE : USB_CMD_MEM_OK;
+			else
+				resp->status = (req->len > (tx_size - sizeof(usb_cmd_mem_resp_t))) ? USB_CMD_MEM_ERR_SIZE : USB_CMD_MEM_OK;
+			if(resp->status == USB_CMD_MEM_OK)
+			{
+				if(cmd_val == USB_CMD_MEMW)
+				{
+					memcpy(mem, &req[1], req->len);
+				}
+				else
+				{
+					memcpy(&resp[1], mem, req->len);
+					tx_len += req->len;
+				}
+			}
+			else
+			{
+				dev_fake_log("cmd %s 0x%08X %u Err %u\n", (cmd_val == USB_CMD_MEMW) ? "MEMW" : "MEMR",
+							 req->addr, req->len, resp->status);
+			}
+		}
+		break;
+
+		case USB_CMD_BTCH:
+			tx_len = dev_fake_btch(rx, rx_len, tx, tx_size);
+			break;
+
+		case USB_CMD_STRM:
+		{
+			usb_cmd_strm_req_t* req = (usb_cmd_strm_req_t*)rx;
+			usb_cmd_strm_resp_t* resp = (usb_cmd_strm_resp_t*)tx;
+			dev_fake_log("cmd STRM mode=%u flags=0x%X\n", req->mode, req->flags);
+			if(req->mode == USB_STREAM_IDLE)
+			{
+				dev_fake.mode = USB_STREAM_IDLE;
+				resp->status = 0;
+			}
+			else if((req->mode != USB_STREAM_RING_IN) && (req->mode != USB_STREAM_RING_OUT))
+			{
+				resp->status = 1;
+			}
+			else if(dev_fake.mode != USB_STREAM_IDLE)
+			{
+				resp->status = 2;
+			}
+			else
+			{
+				dev_fake.mode = req->mode;
+				dev_fake.flags = req->flags;
+				dev_fake.ring_val = 0;
+				dev_fake.ring_crc = 0;
+				resp->status = 0;
+			}
+			tx_len = sizeof(usb_cmd_strm_resp_t);
+		}
+		break;
+
+		case USB_CMD_STRS:
+		{
+			usb_ring_stats_t* stats = (usb_ring_stats_t*)tx;
+			uint64_t now = dev_time_ns();
+			dev_fake_ring_stats(&dev_fake.ring_in, &stats[0], now);
+			dev_fake_ring_stats(&dev_fake.ring_out, &stats[1], now);
+			tx_len = 2 * sizeof(usb_ring_stats_t);
+		}
+		break;
+
+		default:
+			dev_fake_log("CMD UNKN\n");
+	}
+	return tx_len;
+}
+
+/*******************************************************************************
+ * @fn     dev_fake_ep2_in
+ *
+ * @brief  Fill Endpoint2 IN data (same as firmware usb_stream_ring_task())
+ *
+ * @return None
+ */
+static void dev_fake_ep2_in(uint8_t* buf, uint32_t len)
+{
+	uint32_t off;
+	uint32_t i;
+
+	for(off = 0; (off + HYDRAUSB3_EP2_BUF_SIZE) <= len; off += HYDRAUSB3_EP2_BUF_SIZE)
+	{
+		uint32_t* w = (uint32_t*)&buf[off];
+		if(dev_fake.flags & USB_STREAM_RING_PATTERN)
+		{
+			for(i = 0; i < (HYDRAUSB3_EP2_BUF_SIZE / 4); i++)
+				w[i] = dev_fake.ring_val + i;
+			dev_fake.ring_val += (HYDRAUSB3_EP2_BUF_SIZE / 4);
+		}
+		if(dev_fake.flags & USB_STREAM_RING_CRC)
+		{
+			dev_fake.ring_crc = crc32c_update(dev_fake.ring_crc, w, HYDRAUSB3_EP2_BUF_SIZE - 4);
+			w[(HYDRAUSB3_EP2_BUF_SIZE / 4) - 1] = dev_fake.ring_crc;
+		}
+		dev_fake.ring_in.nb_xfer++;
+		dev_fake.ring_in.nb_bytes += HYDRAUSB3_EP2_BUF_SIZE;
+	}
+}
+
+/*******************************************************************************
+ * @fn     dev_fake_ep2_out
+ *
+ * @brief  Consume Endpoint2 OUT data (same as firmware usb_stream_ring_task())
+ *
+ * @return None
+ */
+static void dev_fake_ep2_out(const uint8_t* buf, uint32_t len)
+{
+	uint32_t off;
+	uint32_t n;
+
+	for(off = 0; off < len; off += n)
+	{
+		const uint32_t* w = (const uint32_t*)&buf[off];
+		n = len - off;
+		if(n > HYDRAUSB3_EP2_BUF_SIZE)
+			n = HYDRAUSB3_EP2_BUF_SIZE;
+		if((dev_fake.flags & USB_STREAM_RING_CRC) && (n >= 8) && ((n & 3) == 0))
+		{
+			uint32_t crc_rx = w[(n / 4) - 1];
+			dev_fake.ring_crc = crc32c_update(dev_fake.ring_crc, w, n - 4);
+			if(dev_fake.ring_crc != crc_rx)
+			{
+				dev_fake.ring_out.nb_crc_err++;
+				dev_fake.ring_crc = crc_rx; // Resynchronize on host CRC
+			}
+		}
+		dev_fake.ring_out.nb_xfer++;
+		dev_fake.ring_out.nb_bytes += n;
+	}
+}
+
+/*******************************************************************************
+ * @fn     dev_fake_try
+ *
+ * @brief  Complete a pending transfer if the fake device can
+ *
+ * @return 1 if completed (status/actual set) else 0 (NAK)
+ */
+static int dev_fake_try(dev_fake_pending_t* p, uint64_t now, int* status, uint32_t* actual)
+{
+	dev_xfer_t* xfer = p->xfer;
+
+	*status = DEV_OK;
+	*actual = 0;
+	if(p->cancel)
+	{
+		*status = DEV_ERR_CANCEL;
+		return 1;
+	}
+	switch(xfer->ep)
+	{
+		case HYDRAUSB3_EP1_OUT:
+		{
+			uint32_t len = (xfer->len < HYDRAUSB3_EP1_MAX_SIZE) ? xfer->len : HYDRAUSB3_EP1_MAX_SIZE;
+			uint32_t tx_len;
+			uint32_t rx_buf[HYDRAUSB3_EP1_MAX_SIZE / 4];
+			memset(rx_buf, 0, sizeof(rx_buf));
+			memcpy(rx_buf, xfer->buf, len);
+			/* Firmware always executes on whole Endpoint1 buffer */
+			tx_len = dev_fake_exec((uint8_t*)rx_buf, HYDRAUSB3_EP1_MAX_SIZE, dev_fake.ans, HYDRAUSB3_EP1_MAX_SIZE);
+			if(tx_len > 0)
+				dev_fake.ans_len = tx_len;
+			*actual = len;
+			return 1;
+		}
+		case HYDRAUSB3_EP1_IN:
+			if(dev_fake.ans_len == 0)
+				break;
+			*actual = (xfer->len < dev_fake.ans_len) ? xfer->len : dev_fake.ans_len;
+			memcpy(xfer->buf, dev_fake.ans, *actual);
+			dev_fake.ans_len = 0;
+			return 1;
+		case HYDRAUSB3_EP2_IN:
+		case HYDRAUSB3_EP2_OUT:
+			if(dev_fake.mode != ((xfer->ep == HYDRAUSB3_EP2_IN) ? USB_STREAM_RING_IN : USB_STREAM_RING_OUT))
+				break;
+			if(dev_fake.rate_mbps > 0)
+			{
+				if(p->done_ns == 0)
+				{
+					/* 1MB/s = 1 byte/us */
+					if(dev_fake.ep2_busy_ns < now)
+						dev_fake.ep2_busy_ns = now;
+					dev_fake.ep2_busy_ns += ((uint64_t)xfer->len * 1000) / dev_fake.rate_mbps;
+					p->done_ns = dev_fake.ep2_busy_ns;
+				}
+				if(now < p->done_ns)
+					break;
+			}
+			if(xfer->ep == HYDRAUSB3_EP2_IN)
+				dev_fake_ep2_in(xfer->buf, xfer->len);
+			else
+				dev_fake_ep2_out(xfer->buf, xfer->len);
+			*actual = xfer->len;
+			return 1;
+		default:
+			*status = DEV_ERR_IO; // Endpoint not simulated (STALL)
+			return 1;
+	}
+	if(xfer->timeout_ms && ((now - xfer->submit_ns) >= ((uint64_t)xfer->timeout_ms * 1000000)))
+	{
+		*status = DEV_ERR_TIMEOUT;
+		return 1;
+	}
+	return 0;
+}
+
+/*******************************************************************************
+ * @fn     dev_fake_process
+ *
+ * @brief  Complete pending transfers in submit order (transfers submitted
+ *         by callbacks are processed by next call)
+ *
+ * @return Number of transfers completed
+ */
+static uint32_t dev_fake_process(void)
+{
+	dev_xfer_t* snap[DEV_FAKE_NB_PENDING];
+	uint32_t nb_snap = dev_fake.nb_pending;
+	uint32_t nb_done = 0;
+	uint64_t now = dev_time_ns();
+	uint32_t i;
+	int32_t idx;
+	int status;
+	uint32_t actual;
+
+	for(i = 0; i < nb_snap; i++)
+		snap[i] = dev_fake.pending[i].xfer;
+	for(i = 0; i < nb_snap; i++)
+	{
+		idx = dev_fake_find(snap[i]);
+		if(idx < 0)
+			continue;
+		if(dev_fake_try(&dev_fake.pending[idx], now, &status, &actual) == 0)
+			continue;
+		dev_fake.nb_pending--;
+		memmove(&dev_fake.pending[idx], &dev_fake.pending[idx + 1],
+				(dev_fake.nb_pending - idx) * sizeof(dev_fake_pending_t));
+		dev_xfer_done(snap[i], status, actual);
+		nb_done++;
+	}
+	return nb_done;
+}
+
+static int dev_fake_handle_events(dev_handle_t* dev, uint32_t timeout_ms)
+{
+	uint64_t deadline = dev_time_ns() + ((uint64_t)timeout_ms * 1000000);
+	struct timespec ts = { 0, 20000 };
+
+	(void)dev;
+	while(dev_fake_process() == 0)
+	{
+		if(dev_time_ns() >= deadline)
+			break;
+		nanosleep(&ts, NULL); // Nothing ready (NAK or rate limit)
+	}
+	return DEV_OK;
+}
+
+const dev_ops_t dev_fake_ops =
+{
+	.name = "fake",
+	.help = "[:rate_mbps] in-process fake device (Endpoint2 limited to rate_mbps MB/s, default unlimited)",
+	.open = dev_fake_open,
+	.close = dev_fake_close,
+	.buf_alloc = dev_fake_buf_alloc,
+	.buf_free = dev_fake_buf_free,
+	.xfer_init = dev_fake_xfer_init,
+	.xfer_free = dev_fake_xfer_free,
+	.submit = dev_fake_submit,
+	.cancel = dev_fake_cancel,
+	.handle_events = dev_fake_handle_events,
+};
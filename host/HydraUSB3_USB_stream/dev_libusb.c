@@ -0,0 +1,203 @@
+/********************************** (C) COPYRIGHT *******************************
+* File Name          : dev_libusb.c
+* Author             : bvernoux
+* Version            : V1.0
+* Date               : 2026/10/19
+* Description        : HydraUSB3_USB device with libusb-1.0 asynchronous API
+* Copyright (c) 2026 Benjamin VERNOUX
+* SPDX-License-Identifier: Apache-2.0
+*******************************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <libusb.h>
+#include "dev.h"
+#include "hydrausb3_proto.h"
+
+typedef struct
+{
+	libusb_context* ctx;
+	libusb_device_handle* handle;
+	int dev_mem; /* Buffers allocated with libusb_dev_mem_alloc() */
+} dev_libusb_t;
+
+static dev_libusb_t dev_libusb;
+
+/*******************************************************************************
+ * @fn     dev_libusb_open
+ *
+ * @brief  Open first HydraUSB3 device and claim interface 0
+ *
+ * @param  arg: "VID:PID" in hexadecimal (NULL = HYDRAUSB3_VID:HYDRAUSB3_PID)
+ *
+ * @return DEV_OK or DEV_ERR_XXX
+ */
+static int dev_libusb_open(dev_handle_t* dev, const char* arg)
+{
+	unsigned int vid = HYDRAUSB3_VID;
+	unsigned int pid = HYDRAUSB3_PID;
+	uint8_t* buf;
+	int ret;
+
+	if(arg && (sscanf(arg, "%x:%x", &vid, &pid) != 2))
+		return DEV_ERR_PARAM;
+	ret = libusb_init(&dev_libusb.ctx);
+	if(ret < 0)
+	{
+		printf("libusb_init() Err %s\n", libusb_error_name(ret));
+		return DEV_ERR_IO;
+	}
+	dev_libusb.handle = libusb_open_device_with_vid_pid(dev_libusb.ctx, (uint16_t)vid, (uint16_t)pid);
+	if(dev_libusb.handle == NULL)
+	{
+		printf("Device %04X:%04X not found\n", vid, pid);
+		libusb_exit(dev_libusb.ctx);
+		return DEV_ERR_NODEV;
+	}
+	ret = libusb_claim_interface(dev_libusb.handle, 0);
+	if(ret < 0)
+	{
+		printf("libusb_claim_interface() Err %s\n", libusb_error_name(ret));
+		libusb_close(dev_libusb.handle);
+		libusb_exit(dev_libusb.ctx);
+		return DEV_ERR_IO;
+	}
+	/* Zero copy usbfs DMA memory (Linux) if supported */
+	buf = libusb_dev_mem_alloc(dev_libusb.handle, HYDRAUSB3_EP2_BUF_SIZE);
+	dev_libusb.dev_mem = (buf != NULL);
+	if(buf)
+		libusb_dev_mem_free(dev_libusb.handle, buf, HYDRAUSB3_EP2_BUF_SIZE);
+	switch(libusb_get_device_speed(libusb_get_device(dev_libusb.handle)))
+	{
+		case LIBUSB_SPEED_HIGH:
+			dev->speed = "USB2 HS";
+			break;
+		case LIBUSB_SPEED_SUPER:
+			dev->speed = "USB3 SS";
+			break;
+		default:
+			dev->speed = "unknown";
+	}
+	dev->priv = &dev_libusb;
+	return DEV_OK;
+}
+
+static void dev_libusb_close(dev_handle_t* dev)
+{
+	libusb_release_interface(dev_libusb.handle, 0);
+	libusb_close(dev_libusb.handle);
+	libusb_exit(dev_libusb.ctx);
+	dev->priv = NULL;
+}
+
+/*******************************************************************************
+ * @fn     dev_libusb_buf_alloc
+ *
+ * @brief  Buffer for transfers, zero copy usbfs DMA memory when supported
+ *         (Linux) else heap
+ *
+ * @return Buffer or NULL
+ */
+static uint8_t* dev_libusb_buf_alloc(dev_handle_t* dev, uint32_t size)
+{
+	(void)dev;
+	if(dev_libusb.dev_mem)
+		return libusb_dev_mem_alloc(dev_libusb.handle, size);
+	return malloc(size);
+}
+
+static void dev_libusb_buf_free(dev_handle_t* dev, uint8_t* buf, uint32_t size)
+{
+	(void)dev;
+	if(dev_libusb.dev_mem)
+		libusb_dev_mem_free(dev_libusb.handle, buf, size);
+	else
+		free(buf);
+}
+
+static void LIBUSB_CALL dev_libusb_cb(struct libusb_transfer* t)
+{
+	dev_xfer_t* xfer = (dev_xfer_t*)t->user_data;
+	int status;
+
+	switch(t->status)
+	{
+		case LIBUSB_TRANSFER_COMPLETED:
+			status = DEV_OK;
+			break;
+		case LIBUSB_TRANSFER_TIMED_OUT:
+			status = DEV_ERR_TIMEOUT;
+			break;
+		case LIBUSB_TRANSFER_CANCELLED:
+			status = DEV_ERR_CANCEL;
+			break;
+		case LIBUSB_TRANSFER_NO_DEVICE:
+			status = DEV_ERR_NODEV;
+			break;
+		default:
+			status = DEV_ERR_IO;
+	}
+	dev_xfer_done(xfer, status, (uint32_t)t->actual_length);
+}
+
+static int dev_libusb_xfer_init(dev_handle_t* dev, dev_xfer_t* xfer)
+{
+	(void)dev;
+	xfer->priv = libusb_alloc_transfer(0);
+	return (xfer->priv != NULL) ? DEV_OK : DEV_ERR_IO;
+}
+
+static void dev_libusb_xfer_free(dev_handle_t* dev, dev_xfer_t* xfer)
+{
+	(void)dev;
+	libusb_free_transfer((struct libusb_transfer*)xfer->priv);
+	xfer->priv = NULL;
+}
+
+static int dev_libusb_submit(dev_handle_t* dev, dev_xfer_t* xfer)
+{
+	struct libusb_transfer* t = (struct libusb_transfer*)xfer->priv;
+	int ret;
+
+	(void)dev;
+	libusb_fill_bulk_transfer(t, dev_libusb.handle, xfer->ep, xfer->buf, (int)xfer->len,
+							  dev_libusb_cb, xfer, xfer->timeout_ms);
+	ret = libusb_submit_transfer(t);
+	if(ret == LIBUSB_ERROR_NO_DEVICE)
+		return DEV_ERR_NODEV;
+	return (ret == LIBUSB_SUCCESS) ? DEV_OK : DEV_ERR_IO;
+}
+
+static int dev_libusb_cancel(dev_handle_t* dev, dev_xfer_t* xfer)
+{
+	(void)dev;
+	return (libusb_cancel_transfer((struct libusb_transfer*)xfer->priv) == LIBUSB_SUCCESS) ? DEV_OK : DEV_ERR_IO;
+}
+
+static int dev_libusb_handle_events(dev_handle_t* dev, uint32_t timeout_ms)
+{
+	struct timeval tv;
+	int ret;
+
+	(void)dev;
+	tv.tv_sec = timeout_ms / 1000;
+	tv.tv_usec = (timeout_ms % 1000) * 1000;
+	ret = libusb_handle_events_timeout_completed(dev_libusb.ctx, &tv, NULL);
+	if(ret == LIBUSB_ERROR_NO_DEVICE)
+		return DEV_ERR_NODEV;
+	return ((ret == LIBUSB_SUCCESS) || (ret == LIBUSB_ERROR_INTERRUPTED)) ? DEV_OK : DEV_ERR_IO;
+}
+
+const dev_ops_t dev_libusb_ops =
+{
+	.name = "libusb",
+	.help = "[:VID:PID] HydraUSB3_USB firmware with libusb-1.0 (default 16C0:05DC)",
+	.open = dev_libusb_open,
+	.close = dev_libusb_close,
+	.buf_alloc = dev_libusb_buf_alloc,
+	.buf_free = dev_libusb_buf_free,
+	.xfer_init = dev_libusb_xfer_init,
+	.xfer_free = dev_libusb_xfer_free,
+	.submit = dev_libusb_submit,
+	.cancel = dev_libusb_cancel,
+	.handle_events = dev_libusb_handle_events,
+};
@@ -0,0 +1,106 @@
+/********************************** (C) COPYRIGHT *******************************
+* File Name          : hist.c
+* Author             : bvernoux
+* Version            : V1.0
+* Date               : 2026/10/19
+* Description        : Latency histogram (power of 2 microseconds buckets)
+* Copyright (c) 2026 Benjamin VERNOUX
+* SPDX-License-Identifier: Apache-2.0
+*******************************************************************************/
+#include <stdio.h>
+#include <string.h>
+#include "hist.h"
+
+#define HIST_BAR_WIDTH (40)
+
+void hist_init(hist_t* hist)
+{
+	memset(hist, 0, sizeof(hist_t));
+	hist->min_ns = UINT64_MAX;
+}
+
+void hist_add(hist_t* hist, uint64_t ns)
+{
+	uint64_t us = ns / 1000;
+	uint32_t b = 0;
+
+	while((us > 0) && (b < (HIST_NB_BUCKET - 1)))
+	{
+		us >>= 1;
+		b++;
+	}
+	hist->count[b]++;
+	hist->nb++;
+	hist->sum_ns += ns;
+	if(ns < hist->min_ns)
+		hist->min_ns = ns;
+	if(ns > hist->max_ns)
+		hist->max_ns = ns;
+}
+
+/*******************************************************************************
+ * @fn     hist_percentile_us
+ *
+ * @brief  Upper bound of the bucket containing the percentile
+ *
+ * @param  pct: Percentile (1 to 100)
+ *
+ * @return Latency in us (0 if no sample)
+ */
+uint64_t hist_percentile_us(const hist_t* hist, uint32_t pct)
+{
+	uint64_t target = ((hist->nb * pct) + 99) / 100;
+	uint64_t sum = 0;
+	uint32_t b;
+
+	if(hist->nb == 0)
+		return 0;
+	for(b = 0; b < HIST_NB_BUCKET; b++)
+	{
+		sum += hist->count[b];
+		if(sum >= target)
+			break;
+	}
+	if(b >= HIST_NB_BUCKET)
+		b = HIST_NB_BUCKET - 1;
+	return (1ULL << b);
+}
+
+void hist_print(const hist_t* hist, const char* name)
+{
+	uint64_t max = 0;
+	uint32_t b;
+	uint32_t n;
+	char bar[HIST_BAR_WIDTH + 1];
+
+	if(hist->nb == 0)
+	{
+		printf("%s latency: no sample\n", name);
+		return;
+	}
+	printf("%s latency: nb=%llu min=%lluus avg=%lluus max=%lluus p50<%lluus p99<%lluus\n",
+		   name, (unsigned long long)hist->nb,
+		   (unsigned long long)(hist->min_ns / 1000),
+		   (unsigned long long)(hist->sum_ns / hist->nb / 1000),
+		   (unsigned long long)(hist->max_ns / 1000),
+		   (unsigned long long)hist_percentile_us(hist, 50),
+		   (unsigned long long)hist_percentile_us(hist, 99));
+	for(b = 0; b < HIST_NB_BUCKET; b++)
+	{
+		if(hist->count[b] > max)
+			max = hist->count[b];
+	}
+	for(b = 0; b < HIST_NB_BUCKET; b++)
+	{
+		if(hist->count[b] == 0)
+			continue;
+		n = (uint32_t)((hist->count[b] * HIST_BAR_WIDTH + max - 1) / max);
+		memset(bar, '#', n);
+		bar[n] = 0;
+		if(b == 0)
+			printf("  %19s %10llu %s\n", "<1us", (unsigned long long)hist->count[b], bar);
+		else
+			printf("  %8llu-%-8lluus %10llu %s\n", (unsigned long long)(1ULL << (b - 1)),
+				   (unsigned long long)(1ULL << b), (unsigned long long)hist->count[b], bar);
+	}
+}
@@ -0,0 +1,40 @@
+/********************************** (C) COPYRIGHT *******************************
+* File Name          : hist.h
+* Author             : bvernoux
+* Version            : V1.0
+* Date               : 2026/10/19
+* Description        : Latency histogram (power of 2 microseconds buckets)
+* Copyright (c) 2026 Benjamin VERNOUX
+* SPDX-License-Identifier: Apache-2.0
+*******************************************************************************/
+#ifndef HIST_H_
+#define HIST_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+
+/* Bucket 0: < 1us, bucket n: [2^(n-1), 2^n) us */
+#define HIST_NB_BUCKET (32)
+
+typedef struct
+{
+	uint64_t count[HIST_NB_BUCKET];
+	uint64_t nb;
+	uint64_t sum_ns;
+	uint64_t min_ns;
+	uint64_t max_ns;
+} hist_t;
+
+void hist_init(hist_t* hist);
+void hist_add(hist_t* hist, uint64_t ns);
+uint64_t hist_percentile_us(const hist_t* hist, uint32_t pct);
+void hist_print(const hist_t* hist, const char* name);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* HIST_H_ */
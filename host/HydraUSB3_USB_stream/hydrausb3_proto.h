@@ -0,0 +1,133 @@
+/********************************** (C) COPYRIGHT *******************************
+* File Name          : hydrausb3_proto.h
+* Author             : bvernoux
+* Version            : V1.0
+* Date               : 2026/10/19
+* Description        : HydraUSB3_USB firmware protocol seen from the host
+*                      (same values/layouts as HydraUSB3_USB/User/usb_cmd.h,
+*                      usb_stream.h and usb_ring.h which depend on the BSP)
+* Copyright (c) 2026 Benjamin VERNOUX
+* SPDX-License-Identifier: Apache-2.0
+*******************************************************************************/
+#ifndef HYDRAUSB3_PROTO_H_
+#define HYDRAUSB3_PROTO_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+
+/* Default USB VID/PID (see HydraUSB3_USB/User/hydrausb3_usb_devbulk_vid_pid.h) */
+#define HYDRAUSB3_VID (0x16C0)
+#define HYDRAUSB3_PID (0x05DC)
+
+#define HYDRAUSB3_EP1_OUT (0x01) /* Commands */
+#define HYDRAUSB3_EP1_IN  (0x81) /* Answers */
+#define HYDRAUSB3_EP2_OUT (0x02) /* Bulk data */
+#define HYDRAUSB3_EP2_IN  (0x82) /* Bulk data */
+
+#define HYDRAUSB3_EP1_MAX_SIZE (4096) /* DEF_ENDP1_MAX_SIZE (one command/answer) */
+#define HYDRAUSB3_EP2_BUF_SIZE (4096) /* DEF_ENDP2_MAX_SIZE (one device ring buffer) */
+
+/* Commands from Host to Device (Endpoint1 OUT) */
+#define USB_CMD_LOGR (0x4C4F4752) // CMD LOGR (Return LOG)
+#define USB_CMD_USBS (0x55534253) // CMD USBS (USB Status)
+#define USB_CMD_USB2 (0x55534232) // CMD USB2 (Switch to USB2 even if USB3 is available)
+#define USB_CMD_USB3 (0x55534233) // CMD USB3 (Switch to USB3 or do a fall-back to USB2 if not available)
+#define USB_CMD_BOOT (0x424F4F54) // CMD BOOT (Reboot the board)
+#define USB_CMD_MEMR (0x4D454D52) // CMD MEMR (Memory Read)
+#define USB_CMD_MEMW (0x4D454D57) // CMD MEMW (Memory Write)
+#define USB_CMD_FWUP (0x46575550) // CMD FWUP (Firmware Update start)
+#define USB_CMD_FWST (0x46575354) // CMD FWST (Firmware Update status)
+#define USB_CMD_BTCH (0x42544348) // CMD BTCH (Batch of commands)
+#define USB_CMD_STRM (0x5354524D) // CMD STRM (Endpoint2 ring benchmark start/stop)
+#define USB_CMD_STRS (0x53545253) // CMD STRS (Endpoint2 ring statistics IN & OUT)
+#define USB_CMD_BPRF (0x42505246) // CMD BPRF (Boot phases timing profile)
+#define USB_CMD_SOAK (0x534F414B) // CMD SOAK (Soak test statistics)
+#define USB_CMD_TRCE (0x54524345) // CMD TRCE (Trace RAM ring entries)
+#define USB_CMD_MEMU (0x4D454D55) // CMD MEMU (RAM/RAMX usage)
+#define USB_CMD_CLKG (0x434C4B47) // CMD CLKG (Clock governor statistics)
+#define USB_CMD_CRSH (0x43525348) // CMD CRSH (Crash snapshot retained across reset)
+
+typedef struct
+{
+	uint32_t cmd; /* USB_CMD_MEMR or USB_CMD_MEMW */
+	uint32_t addr; /* Memory start address */
+	uint32_t len; /* Length in bytes */
+} usb_cmd_mem_req_t;
+
+typedef struct
+{
+	uint32_t status; /* USB_CMD_MEM_XXX */
+	uint32_t addr; /* Memory start address */
+	uint32_t len; /* Length in bytes */
+} usb_cmd_mem_resp_t;
+
+#define USB_CMD_MEM_OK        (0)
+#define USB_CMD_MEM_STREAM    (1)
+#define USB_CMD_MEM_ERR_RANGE (2)
+#define USB_CMD_MEM_ERR_BUSY  (3)
+#define USB_CMD_MEM_ERR_SIZE  (4)
+#define USB_CMD_MEM_ERR_USB2  (5)
+
+#define USB_CMD_MEM_EP1_MAX_SIZE (HYDRAUSB3_EP1_MAX_SIZE - sizeof(usb_cmd_mem_resp_t))
+
+/* Endpoint2 modes (e_usb_stream_mode) */
+#define USB_STREAM_IDLE     (0)
+#define USB_STREAM_RING_IN  (4)
+#define USB_STREAM_RING_OUT (5)
+
+/* Ring benchmark flags */
+#define USB_STREAM_RING_PATTERN (1 << 0) /* IN buffers filled with 32bits incremental counter */
+#define USB_STREAM_RING_CRC     (1 << 1) /* Last 32bits of each buffer is the running CRC32C of the stream */
+#define USB_STREAM_RING_LINK    (1 << 2) /* Common link benchmark harness */
+
+typedef struct
+{
+	uint32_t cmd; /* USB_CMD_STRM */
+	uint32_t mode; /* USB_STREAM_XXX */
+	uint32_t flags; /* USB_STREAM_RING_XXX flags */
+} usb_cmd_strm_req_t;
+
+typedef struct
+{
+	uint32_t status; /* 0 success, 1 invalid mode, 2 Endpoint2 stream busy */
+} usb_cmd_strm_resp_t;
+
+/* USB_CMD_STRS answer is usb_ring_stats_t IN then usb_ring_stats_t OUT */
+typedef struct
+{
+	uint32_t nb_xfer; /* Number of transfers */
+	uint32_t nb_stall; /* Number of times Endpoint2 waited for application */
+	uint64_t nb_bytes; /* Number of bytes transferred */
+	uint32_t kbps; /* Throughput in KB/s since previous USB_CMD_STRS */
+	uint32_t depth_min; /* Min number of buffers ready when a transfer completes */
+	uint32_t period_min; /* Min SysTick cycles between two transfers completion */
+	uint32_t period_max; /* Max SysTick cycles between two transfers completion (jitter) */
+	uint32_t nb_crc_err; /* Number of buffers with CRC error (USB_STREAM_RING_CRC) */
+} usb_ring_stats_t;
+
+typedef struct
+{
+	uint32_t cmd; /* USB_CMD_BTCH */
+	uint16_t nb_cmd; /* Number of TLV */
+	uint16_t len; /* Length in bytes of all TLV (following this header) */
+} usb_cmd_btch_t;
+
+typedef struct
+{
+	uint16_t tag; /* Tag chosen by host (copied in answer) */
+	uint16_t len; /* Value length in bytes (following this header, without padding) */
+} usb_cmd_tlv_t;
+
+#define USB_CMD_TLV_SIZE(len) (sizeof(usb_cmd_tlv_t) + (((len) + 3) & ~3UL))
+
+/* Minimum answer buffer size for any command */
+#define USB_CMD_ANSWER_MIN_SIZE (64)
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* HYDRAUSB3_PROTO_H_ */
@@ -0,0 +1,362 @@
+/********************************** (C) COPYRIGHT *******************************
+* File Name          : main.c
+* Author             : bvernoux
+* Version            : V1.0
+* Date               : 2026/10/19
+* Description        : HydraUSB3_USB host streaming client/benchmark
+*                      (Endpoint2 ring benchmark with asynchronous transfers,
+*                      Endpoint1 commands pipelined meanwhile)
+* Copyright (c) 2026 Benjamin VERNOUX
+* SPDX-License-Identifier: Apache-2.0
+*******************************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <signal.h>
+#include <unistd.h>
+#include "dev.h"
+#include "hist.h"
+#include "cmd.h"
+#include "stream.h"
+#include "hydrausb3_proto.h"
+
+/* USB_CMD_BTCH tags */
+#define TAG_USBS (1)
+#define TAG_STRS (2)
+#define TAG_LOGR (3)
+
+typedef struct
+{
+	const char* backend; /* dev_open() name (NULL = default) */
+	const char* backend_arg;
+	uint32_t mode; /* USB_STREAM_RING_IN/OUT or USB_STREAM_IDLE (commands only) */
+	uint32_t flags;
+	uint32_t xfer_size;
+	uint32_t nb_xfer;
+	uint32_t duration_s;
+	uint32_t cmd_period_ms; /* 0 = no periodic commands */
+	int log; /* Print device logs (USB_CMD_LOGR) */
+	int verbose; /* Print USB_CMD_USBS answer */
+} opt_t;
+
+static volatile sig_atomic_t stop_req;
+static usb_ring_stats_t dev_stats[2]; /* Last USB_CMD_STRS answer (IN, OUT) */
+
+static void sig_handler(int sig)
+{
+	(void)sig;
+	stop_req = 1;
+}
+
+static void usage(const char* prog)
+{
+	printf("Usage: %s [options]\n"
+		   " -d backend[:arg] Device backend (default first listed)\n"
+		   " -m in|out|none   Endpoint2 direction (default in, none = commands only)\n"
+		   " -s size          Endpoint2 transfer size in bytes (multiple of %u, default 65536)\n"
+		   " -n nb            Endpoint2 transfers in flight (1 to %u, default 16)\n"
+		   " -t seconds       Duration (default 5)\n"
+		   " -p               Pattern data (USB_STREAM_RING_PATTERN)\n"
+		   " -c               CRC32C data (USB_STREAM_RING_CRC)\n"
+		   " -i ms            Endpoint1 commands batch period (default 100, 0 = disabled)\n"
+		   " -l               Print device logs (USB_CMD_LOGR in each batch)\n"
+		   " -v               Print device USB status (USB_CMD_USBS)\n"
+		   " -h               This help\n",
+		   prog, HYDRAUSB3_EP2_BUF_SIZE, STREAM_XFER_MAX);
+	dev_list();
+}
+
+/*******************************************************************************
+ * @fn     batch_answer
+ *
+ * @brief  Periodic USB_CMD_BTCH answer (called from dev_handle_events())
+ *
+ * @return None
+ */
+static void batch_answer(cmd_t* cmd, int status, const uint8_t* ans, uint32_t len)
+{
+	const opt_t* opt = (const opt_t*)cmd->user;
+	const usb_cmd_tlv_t* tlv;
+	const char* val;
+	uint32_t pos = 0;
+
+	if(status != DEV_OK)
+	{
+		fprintf(stderr, "Batch error: %s\n", dev_strerror(status));
+		return;
+	}
+	while((tlv = cmd_btch_next(ans, len, &pos)) != NULL)
+	{
+		val = (const char*)&tlv[1];
+		switch(tlv->tag)
+		{
+			case TAG_STRS:
+				if(tlv->len >= sizeof(dev_stats))
+					memcpy(dev_stats, val, sizeof(dev_stats));
+				break;
+			case TAG_LOGR:
+				if(opt->log && (tlv->len > 1))
+					printf("%.*s", (int)(tlv->len - 1), val); // Without end of string
+				break;
+			case TAG_USBS:
+				if(opt->verbose && (tlv->len > 1))
+					printf("%.*s", (int)(tlv->len - 1), val); // Without end of string
+				break;
+			default:
+				break;
+		}
+	}
+}
+
+/*******************************************************************************
+ * @fn     batch_submit
+ *
+ * @brief  Submit periodic USB_CMD_BTCH (USB_CMD_USBS, USB_CMD_STRS and
+ *         USB_CMD_LOGR), skipped if previous batch is in flight
+ *
+ * @return None
+ */
+static void batch_submit(cmd_t* cmd, const opt_t* opt)
+{
+	static cmd_btch_t btch;
+	uint32_t req;
+
+	if(cmd_busy(cmd))
+		return;
+	cmd_btch_init(&btch);
+	req = USB_CMD_STRS;
+	cmd_btch_add(&btch, TAG_STRS, &req, sizeof(req));
+	if(opt->verbose)
+	{
+		req = USB_CMD_USBS;
+		cmd_btch_add(&btch, TAG_USBS, &req, sizeof(req));
+	}
+	if(opt->log)
+	{
+		req = USB_CMD_LOGR;
+		cmd_btch_add(&btch, TAG_LOGR, &req, sizeof(req));
+	}
+	cmd_submit(cmd, btch.buf, btch.len, 1, batch_answer, (void*)opt);
+}
+
+static int strm_cmd(cmd_t* cmd, uint32_t mode, uint32_t flags)
+{
+	usb_cmd_strm_req_t req = { USB_CMD_STRM, mode, flags };
+	usb_cmd_strm_resp_t resp = { 0 };
+	uint32_t len = 0;
+	int ret;
+
+	ret = cmd_call(cmd, &req, sizeof(req), &resp, sizeof(resp), &len);
+	if(ret != DEV_OK)
+	{
+		fprintf(stderr, "STRM error: %s\n", dev_strerror(ret));
+		return ret;
+	}
+	if((len < sizeof(resp)) || (resp.status != 0))
+	{
+		fprintf(stderr, "STRM mode=%u status=%u (%s)\n", mode, resp.status,
+				(resp.status == 2) ? "Endpoint2 stream busy" : "invalid mode");
+		return DEV_ERR_PARAM;
+	}
+	return DEV_OK;
+}
+
+static void stats_print(const char* name, const usb_ring_stats_t* stats)
+{
+	printf("Device %s: nb_xfer=%u nb_bytes=%llu nb_stall=%u depth_min=%u nb_crc_err=%u\n",
+		   name, stats->nb_xfer, (unsigned long long)stats->nb_bytes, stats->nb_stall,
+		   stats->depth_min, stats->nb_crc_err);
+}
+
+static int parse_opt(int argc, char** argv, opt_t* opt)
+{
+	static char backend[64];
+	char* sep;
+	int c;
+
+	memset(opt, 0, sizeof(opt_t));
+	opt->mode = USB_STREAM_RING_IN;
+	opt->xfer_size = 65536;
+	opt->nb_xfer = 16;
+	opt->duration_s = 5;
+	opt->cmd_period_ms = 100;
+	while((c = getopt(argc, argv, "d:m:s:n:t:pci:lvh")) != -1)
+	{
+		switch(c)
+		{
+			case 'd':
+				snprintf(backend, sizeof(backend), "%s", optarg);
+				sep = strchr(backend, ':');
+				if(sep)
+				{
+					*sep = 0;
+					opt->backend_arg = sep + 1;
+				}
+				opt->backend = backend;
+				break;
+			case 'm':
+				if(strcmp(optarg, "in") == 0)
+					opt->mode = USB_STREAM_RING_IN;
+				else if(strcmp(optarg, "out") == 0)
+					opt->mode = USB_STREAM_RING_OUT;
+				else if(strcmp(optarg, "none") == 0)
+					opt->mode = USB_STREAM_IDLE;
+				else
+					return -1;
+				break;
+			case 's':
+				opt->xfer_size = strtoul(optarg, NULL, 0);
+				break;
+			case 'n':
+				opt->nb_xfer = strtoul(optarg, NULL, 0);
+				break;
+			case 't':
+				opt->duration_s = strtoul(optarg, NULL, 0);
+				break;
+			case 'p':
+				opt->flags |= USB_STREAM_RING_PATTERN;
+				break;
+			case 'c':
+				opt->flags |= USB_STREAM_RING_CRC;
+				break;
+			case 'i':
+				opt->cmd_period_ms = strtoul(optarg, NULL, 0);
+				break;
+			case 'l':
+				opt->log = 1;
+				break;
+			case 'v':
+				opt->verbose = 1;
+				break;
+			default:
+				return -1;
+		}
+	}
+	if((opt->xfer_size == 0) || (opt->xfer_size % HYDRAUSB3_EP2_BUF_SIZE) ||
+	   (opt->nb_xfer == 0) || (opt->nb_xfer > STREAM_XFER_MAX))
+		return -1;
+	return 0;
+}
+
+int main(int argc, char** argv)
+{
+	opt_t opt;
+	dev_handle_t dev;
+	cmd_t cmd;
+	stream_t strm;
+	uint64_t start_ns, now_ns, end_ns, next_cmd_ns, next_print_ns;
+	uint64_t prev_bytes = 0;
+	uint64_t prev_ns;
+	int ret = EXIT_FAILURE;
+
+	if(parse_opt(argc, argv, &opt) != 0)
+	{
+		usage(argv[0]);
+		return EXIT_FAILURE;
+	}
+	if(dev_open(&dev, opt.backend, opt.backend_arg) != DEV_OK)
+	{
+		fprintf(stderr, "Cannot open device (backend %s)\n", opt.backend ? opt.backend : "default");
+		return EXIT_FAILURE;
+	}
+	printf("Backend %s (%s)\n", dev.ops->name, dev.speed ? dev.speed : "unknown speed");
+	if(cmd_init(&cmd, &dev) != DEV_OK)
+	{
+		fprintf(stderr, "Endpoint1 init error\n");
+		goto exit_close;
+	}
+	memset(&strm, 0, sizeof(strm));
+	if(opt.mode != USB_STREAM_IDLE)
+	{
+		if(stream_init(&strm, &dev, opt.mode, opt.flags, opt.xfer_size, opt.nb_xfer) != DEV_OK)
+		{
+			fprintf(stderr, "Endpoint2 init error\n");
+			goto exit_cmd;
+		}
+		if(strm_cmd(&cmd, opt.mode, opt.flags) != DEV_OK)
+			goto exit_strm;
+		printf("Endpoint2 %s flags=0x%X xfer_size=%u inflight=%u\n",
+			   (opt.mode == USB_STREAM_RING_IN) ? "IN" : "OUT",
+			   opt.flags, opt.xfer_size, opt.nb_xfer);
+		if(stream_start(&strm) != DEV_OK)
+		{
+			fprintf(stderr, "Endpoint2 start error\n");
+			strm_cmd(&cmd, USB_STREAM_IDLE, 0);
+			goto exit_strm;
+		}
+	}
+
+	signal(SIGINT, sig_handler);
+	start_ns = dev_time_ns();
+	end_ns = start_ns + (opt.duration_s * 1000000000ULL);
+	next_cmd_ns = start_ns;
+	next_print_ns = start_ns + 1000000000ULL;
+	prev_ns = start_ns;
+	while(!stop_req)
+	{
+		dev_handle_events(&dev, 10);
+		now_ns = dev_time_ns();
+		if(now_ns >= end_ns)
+			break;
+		if(strm.status != DEV_OK)
+		{
+			fprintf(stderr, "Endpoint2 error: %s\n", dev_strerror(strm.status));
+			break;
+		}
+		if(opt.cmd_period_ms && (now_ns >= next_cmd_ns))
+		{
+			batch_submit(&cmd, &opt);
+			next_cmd_ns = now_ns + (opt.cmd_period_ms * 1000000ULL);
+		}
+		if(now_ns >= next_print_ns)
+		{
+			printf("%6.1f s: %8.2f MB/s (device %u KB/s) pattern_err=%u crc_err=%u\n",
+				   (double)(now_ns - start_ns) / 1e9,
+				   (double)(strm.nb_bytes - prev_bytes) * 1000.0 / (double)(now_ns - prev_ns),
+				   (opt.mode == USB_STREAM_RING_OUT) ? dev_stats[1].kbps : dev_stats[0].kbps,
+				   strm.nb_pattern_err, strm.nb_crc_err);
+			fflush(stdout);
+			prev_bytes = strm.nb_bytes;
+			prev_ns = now_ns;
+			next_print_ns += 1000000000ULL;
+		}
+	}
+	now_ns = dev_time_ns();
+	ret = EXIT_SUCCESS;
+
+	if(opt.mode != USB_STREAM_IDLE)
+	{
+		stream_stop(&strm);
+		if(strm_cmd(&cmd, USB_STREAM_IDLE, 0) != DEV_OK)
+			ret = EXIT_FAILURE;
+	}
+	{
+		uint32_t req = USB_CMD_STRS;
+		if(cmd_call(&cmd, &req, sizeof(req), dev_stats, sizeof(dev_stats), NULL) == DEV_OK)
+		{
+			stats_print("IN", &dev_stats[0]);
+			stats_print("OUT", &dev_stats[1]);
+		}
+	}
+	if(opt.mode != USB_STREAM_IDLE)
+	{
+		printf("Host: %llu bytes in %.3f s = %.2f MB/s, xfer=%llu err=%u pattern_err=%u crc_err=%u\n",
+			   (unsigned long long)strm.nb_bytes, (double)(now_ns - start_ns) / 1e9,
+			   (double)strm.nb_bytes * 1000.0 / (double)(now_ns - start_ns),
+			   (unsigned long long)strm.nb_done, strm.nb_err, strm.nb_pattern_err, strm.nb_crc_err);
+		hist_print(&strm.lat, "Endpoint2 transfer");
+		if(strm.nb_err || strm.nb_pattern_err || strm.nb_crc_err)
+			ret = EXIT_FAILURE;
+	}
+	printf("Endpoint1 requests: done=%u err=%u answer avg=%llu bytes\n", cmd.nb_done, cmd.nb_err,
+		   cmd.nb_ans ? (unsigned long long)(cmd.nb_ans_bytes / cmd.nb_ans) : 0ULL);
+	hist_print(&cmd.lat, "Endpoint1 round-trip");
+
+exit_strm:
+	stream_deinit(&strm);
+exit_cmd:
+	cmd_deinit(&cmd);
+exit_close:
+	dev_close(&dev);
+	return ret;
+}
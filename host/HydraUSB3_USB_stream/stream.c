@@ -0,0 +1,250 @@
+/********************************** (C) COPYRIGHT *******************************
+* File Name          : stream.c
+* Author             : bvernoux
+* Version            : V1.0
+* Date               : 2026/10/19
+* Description        : HydraUSB3_USB Endpoint2 ring benchmark stream (many
+*                      asynchronous transfers in flight, data check/generation)
+* Copyright (c) 2026 Benjamin VERNOUX
+* SPDX-License-Identifier: Apache-2.0
+*******************************************************************************/
+#include <string.h>
+#include "crc32.h"
+#include "stream.h"
+
+#define STREAM_UNIT_NB_WORD (HYDRAUSB3_EP2_BUF_SIZE / 4)
+
+/*******************************************************************************
+ * @fn     stream_check
+ *
+ * @brief  Check Endpoint2 IN data (each HYDRAUSB3_EP2_BUF_SIZE unit)
+ *
+ * @return None
+ */
+static void stream_check(stream_t* strm, const uint8_t* buf, uint32_t len)
+{
+	uint32_t off;
+	uint32_t nb_word;
+	uint32_t i;
+
+	nb_word = STREAM_UNIT_NB_WORD;
+	if(strm->flags & USB_STREAM_RING_CRC)
+		nb_word--; // Last word is the CRC
+	for(off = 0; (off + HYDRAUSB3_EP2_BUF_SIZE) <= len; off += HYDRAUSB3_EP2_BUF_SIZE)
+	{
+		const uint32_t* w = (const uint32_t*)&buf[off];
+		if(strm->flags & USB_STREAM_RING_PATTERN)
+		{
+			for(i = 0; i < nb_word; i++)
+			{
+				if(w[i] != (strm->val + i))
+				{
+					strm->nb_pattern_err++;
+					break;
+				}
+			}
+			strm->val = w[0] + STREAM_UNIT_NB_WORD; // Resynchronize on device counter
+		}
+		if(strm->flags & USB_STREAM_RING_CRC)
+		{
+			strm->crc = crc32c_update(strm->crc, w, HYDRAUSB3_EP2_BUF_SIZE - 4);
+			if(strm->crc != w[STREAM_UNIT_NB_WORD - 1])
+			{
+				strm->nb_crc_err++;
+				strm->crc = w[STREAM_UNIT_NB_WORD - 1]; // Resynchronize on device CRC
+			}
+		}
+	}
+}
+
+/*******************************************************************************
+ * @fn     stream_fill
+ *
+ * @brief  Generate Endpoint2 OUT data (each HYDRAUSB3_EP2_BUF_SIZE unit)
+ *
+ * @return None
+ */
+static void stream_fill(stream_t* strm, uint8_t* buf, uint32_t len)
+{
+	uint32_t off;
+	uint32_t i;
+
+	for(off = 0; (off + HYDRAUSB3_EP2_BUF_SIZE) <= len; off += HYDRAUSB3_EP2_BUF_SIZE)
+	{
+		uint32_t* w = (uint32_t*)&buf[off];
+		if(strm->flags & USB_STREAM_RING_PATTERN)
+		{
+			for(i = 0; i < STREAM_UNIT_NB_WORD; i++)
+				w[i] = strm->val + i;
+			strm->val += STREAM_UNIT_NB_WORD;
+		}
+		if(strm->flags & USB_STREAM_RING_CRC)
+		{
+			strm->crc = crc32c_update(strm->crc, w, HYDRAUSB3_EP2_BUF_SIZE - 4);
+			w[STREAM_UNIT_NB_WORD - 1] = strm->crc;
+		}
+	}
+}
+
+/*******************************************************************************
+ * @fn     stream_done
+ *
+ * @brief  Endpoint2 transfer completion, account/check then resubmit
+ *
+ * @return None
+ */
+static void stream_done(dev_xfer_t* xfer)
+{
+	stream_t* strm = (stream_t*)xfer->user;
+
+	strm->nb_busy--;
+	if(xfer->status != DEV_OK)
+	{
+		if(xfer->status != DEV_ERR_CANCEL)
+		{
+			strm->nb_err++;
+			if(strm->status == DEV_OK)
+				strm->status = xfer->status;
+		}
+		return; // Stream stopped on first error
+	}
+	hist_add(&strm->lat, xfer->done_ns - xfer->submit_ns);
+	strm->nb_bytes += xfer->actual;
+	strm->nb_done++;
+	if(strm->mode == USB_STREAM_RING_IN)
+		stream_check(strm, xfer->buf, xfer->actual);
+	if(!strm->running || (strm->status != DEV_OK))
+		return;
+	if(strm->mode == USB_STREAM_RING_OUT)
+		stream_fill(strm, xfer->buf, xfer->len);
+	if(dev_submit(xfer) == DEV_OK)
+		strm->nb_busy++;
+}
+
+/*******************************************************************************
+ * @fn     stream_init
+ *
+ * @brief  Allocate Endpoint2 transfers
+ *
+ * @param  mode: USB_STREAM_RING_IN or USB_STREAM_RING_OUT
+ * @param  flags: USB_STREAM_RING_PATTERN | USB_STREAM_RING_CRC
+ * @param  xfer_size: Transfer size (multiple of HYDRAUSB3_EP2_BUF_SIZE)
+ * @param  nb_xfer: Transfers in flight (1 to STREAM_XFER_MAX)
+ *
+ * @return DEV_OK or DEV_ERR_XXX
+ */
+int stream_init(stream_t* strm, dev_handle_t* dev, uint32_t mode, uint32_t flags,
+				uint32_t xfer_size, uint32_t nb_xfer)
+{
+	uint8_t ep;
+	uint8_t* buf;
+	uint32_t i;
+
+	memset(strm, 0, sizeof(stream_t));
+	if((xfer_size == 0) || (xfer_size % HYDRAUSB3_EP2_BUF_SIZE) ||
+	   (nb_xfer == 0) || (nb_xfer > STREAM_XFER_MAX))
+		return DEV_ERR_PARAM;
+	if(mode == USB_STREAM_RING_IN)
+		ep = HYDRAUSB3_EP2_IN;
+	else if(mode == USB_STREAM_RING_OUT)
+		ep = HYDRAUSB3_EP2_OUT;
+	else
+		return DEV_ERR_PARAM;
+	strm->dev = dev;
+	strm->mode = mode;
+	strm->flags = flags;
+	strm->xfer_size = xfer_size;
+	hist_init(&strm->lat);
+	for(i = 0; i < nb_xfer; i++)
+	{
+		buf = dev_buf_alloc(dev, xfer_size);
+		if(buf == NULL)
+			break;
+		if(dev_xfer_init(dev, &strm->xfer[i], ep, buf, xfer_size, stream_done, strm) != DEV_OK)
+		{
+			dev_buf_free(dev, buf, xfer_size);
+			break;
+		}
+		strm->xfer[i].timeout_ms = STREAM_TIMEOUT_MS;
+		strm->nb_xfer++;
+	}
+	if(strm->nb_xfer != nb_xfer)
+	{
+		stream_deinit(strm);
+		return DEV_ERR_IO;
+	}
+	return DEV_OK;
+}
+
+void stream_deinit(stream_t* strm)
+{
+	uint32_t i;
+
+	stream_stop(strm);
+	for(i = 0; i < strm->nb_xfer; i++)
+	{
+		dev_buf_free(strm->dev, strm->xfer[i].buf, strm->xfer_size);
+		dev_xfer_free(&strm->xfer[i]);
+	}
+	strm->nb_xfer = 0;
+}
+
+/*******************************************************************************
+ * @fn     stream_start
+ *
+ * @brief  Submit all transfers (shall be called after USB_CMD_STRM start,
+ *         data check/generation restarts like the firmware)
+ *
+ * @return DEV_OK or DEV_ERR_XXX
+ */
+int stream_start(stream_t* strm)
+{
+	uint32_t i;
+	int ret;
+
+	strm->val = 0;
+	strm->crc = 0;
+	strm->status = DEV_OK;
+	strm->running = 1;
+	for(i = 0; i < strm->nb_xfer; i++)
+	{
+		if(strm->mode == USB_STREAM_RING_OUT)
+			stream_fill(strm, strm->xfer[i].buf, strm->xfer_size);
+		ret = dev_submit(&strm->xfer[i]);
+		if(ret != DEV_OK)
+		{
+			stream_stop(strm);
+			return ret;
+		}
+		strm->nb_busy++;
+	}
+	return DEV_OK;
+}
+
+/*******************************************************************************
+ * @fn     stream_stop
+ *
+ * @brief  Stop resubmit and wait transfers in flight (cancelled after
+ *         STREAM_TIMEOUT_MS), shall be called before USB_CMD_STRM idle
+ *
+ * @return None
+ */
+void stream_stop(stream_t* strm)
+{
+	uint64_t end_ns;
+	uint32_t i;
+
+	strm->running = 0;
+	end_ns = dev_time_ns() + (STREAM_TIMEOUT_MS * 1000000ULL);
+	while(strm->nb_busy && (dev_time_ns() < end_ns))
+		dev_handle_events(strm->dev, 10);
+	if(strm->nb_busy == 0)
+		return;
+	for(i = 0; i < strm->nb_xfer; i++)
+	{
+		if(strm->xfer[i].busy)
+			dev_cancel(&strm->xfer[i]);
+	}
+	while(strm->nb_busy)
+		dev_handle_events(strm->dev, 100);
+}
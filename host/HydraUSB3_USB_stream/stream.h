@@ -0,0 +1,69 @@
+/********************************** (C) COPYRIGHT *******************************
+* File Name          : stream.h
+* Author             : bvernoux
+* Version            : V1.0
+* Date               : 2026/10/19
+* Description        : HydraUSB3_USB Endpoint2 ring benchmark stream (many
+*                      asynchronous transfers in flight, data check/generation)
+* Copyright (c) 2026 Benjamin VERNOUX
+* SPDX-License-Identifier: Apache-2.0
+*******************************************************************************/
+#ifndef STREAM_H_
+#define STREAM_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include "dev.h"
+#include "hist.h"
+#include "hydrausb3_proto.h"
+
+/*
+ * Each transfer is resubmitted from its completion callback so nb_xfer
+ * transfers stay in flight, the host never waits a completion to queue
+ * the next transfer.
+ * Data format is the firmware ring benchmark one (each
+ * HYDRAUSB3_EP2_BUF_SIZE unit, restarted on each USB_CMD_STRM start):
+ * - USB_STREAM_RING_PATTERN: 32bits incremental counter
+ * - USB_STREAM_RING_CRC: last 32bits is the running CRC32C of the stream
+ *   (previous bytes without the CRC words)
+ */
+#define STREAM_XFER_MAX (64)
+#define STREAM_TIMEOUT_MS (1000)
+
+typedef struct
+{
+	dev_handle_t* dev;
+	uint32_t mode; /* USB_STREAM_RING_IN or USB_STREAM_RING_OUT */
+	uint32_t flags; /* USB_STREAM_RING_XXX */
+	uint32_t xfer_size; /* Multiple of HYDRAUSB3_EP2_BUF_SIZE */
+	uint32_t nb_xfer; /* Transfers in flight */
+	dev_xfer_t xfer[STREAM_XFER_MAX];
+	int running; /* Resubmit on completion */
+	uint32_t nb_busy; /* Transfers submitted and not completed */
+	/* Data check (IN) / generation (OUT) */
+	uint32_t val; /* Next USB_STREAM_RING_PATTERN value */
+	uint32_t crc; /* Running CRC32C */
+	/* Statistics */
+	hist_t lat; /* Transfer submit to completion */
+	uint64_t nb_bytes;
+	uint64_t nb_done;
+	uint32_t nb_err; /* Transfers failed */
+	uint32_t nb_pattern_err; /* Units with pattern error */
+	uint32_t nb_crc_err; /* Units with CRC error */
+	int status; /* First transfer error */
+} stream_t;
+
+int stream_init(stream_t* strm, dev_handle_t* dev, uint32_t mode, uint32_t flags,
+				uint32_t xfer_size, uint32_t nb_xfer);
+void stream_deinit(stream_t* strm);
+int stream_start(stream_t* strm);
+void stream_stop(stream_t* strm);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* STREAM_H_ */
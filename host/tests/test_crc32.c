@@ -0,0 +1,99 @@
+/********************************** (C) COPYRIGHT *******************************
+* File Name          : test_crc32.c
+* Author             : bvernoux
+* Version            : V1.0
+* Date               : 2026/10/19
+* Description        : Host test of CRC32/CRC32C (crc32.c) check values and
+*                      agreement of bitwise/slicing-by-4/slicing-by-8 versions
+* Copyright (c) 2026 Benjamin VERNOUX
+* SPDX-License-Identifier: Apache-2.0
+*******************************************************************************/
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "crc32.h"
+
+#define TEST_BUF_SIZE (1024)
+#define TEST_MAX_OFFSET (8) /* Start offsets 0 to 7 (all alignments of slicing-by-8) */
+
+static uint8_t test_buf[TEST_BUF_SIZE + TEST_MAX_OFFSET];
+static int test_nb_fail;
+
+#define TEST_CHECK(cond) \
+	do { if(!(cond)) { printf("FAIL %s:%d %s\n", __FILE__, __LINE__, #cond); test_nb_fail++; } } while(0)
+
+/*******************************************************************************
+ * @fn     test_check_values
+ *
+ * @brief  CRC32/CRC32C check values of "123456789" with each version
+ *
+ * @return None
+ */
+static void test_check_values(void)
+{
+	static const char check[] = "123456789";
+	uint32_t len = sizeof(check) - 1;
+
+	TEST_CHECK(crc32_update(0, check, len) == 0xCBF43926);
+	TEST_CHECK(crc32c_update(0, check, len) == 0xE3069283);
+	TEST_CHECK(crc32_bitwise(CRC32_POLY_IEEE, 0, check, len) == 0xCBF43926);
+	TEST_CHECK(crc32_bitwise(CRC32_POLY_C, 0, check, len) == 0xE3069283);
+	TEST_CHECK(crc32_slice4(CRC32_POLY_IEEE, 0, check, len) == 0xCBF43926);
+	TEST_CHECK(crc32_slice4(CRC32_POLY_C, 0, check, len) == 0xE3069283);
+	TEST_CHECK(crc32_slice8(CRC32_POLY_IEEE, 0, check, len) == 0xCBF43926);
+	TEST_CHECK(crc32_slice8(CRC32_POLY_C, 0, check, len) == 0xE3069283);
+	/* Running checksum in 2 blocks */
+	TEST_CHECK(crc32_update(crc32_update(0, check, 4), &check[4], len - 4) == 0xCBF43926);
+	TEST_CHECK(crc32c_update(crc32c_update(0, check, 5), &check[5], len - 5) == 0xE3069283);
+}
+
+/*******************************************************************************
+ * @fn     test_unaligned
+ *
+ * @brief  All versions agree with bitwise reference for each start offset
+ *         and length (head/tail bytes of slicing-by-4/by-8)
+ *
+ * @param  poly: CRC32_POLY_IEEE or CRC32_POLY_C
+ *
+ * @return None
+ */
+static void test_unaligned(e_crc32_poly poly)
+{
+	uint32_t offset;
+	uint32_t len;
+	uint32_t ref;
+	uint32_t upd;
+	const uint8_t* p;
+
+	for(offset = 0; offset < TEST_MAX_OFFSET; offset++)
+	{
+		for(len = 0; len <= 64; len++)
+		{
+			p = &test_buf[offset];
+			ref = crc32_bitwise(poly, 0, p, len);
+			upd = (poly == CRC32_POLY_IEEE) ? crc32_update(0, p, len) : crc32c_update(0, p, len);
+			TEST_CHECK(crc32_slice4(poly, 0, p, len) == ref);
+			TEST_CHECK(crc32_slice8(poly, 0, p, len) == ref);
+			TEST_CHECK(upd == ref);
+		}
+		/* Long buffer continued from an unaligned split */
+		p = &test_buf[offset];
+		ref = crc32_bitwise(poly, 0, p, TEST_BUF_SIZE);
+		TEST_CHECK(crc32_slice4(poly, crc32_slice4(poly, 0, p, 13), &p[13], TEST_BUF_SIZE - 13) == ref);
+		TEST_CHECK(crc32_slice8(poly, crc32_slice8(poly, 0, p, 13), &p[13], TEST_BUF_SIZE - 13) == ref);
+	}
+}
+
+int main(void)
+{
+	uint32_t i;
+
+	for(i = 0; i < sizeof(test_buf); i++)
+		test_buf[i] = (uint8_t)((i * 0x9E3779B9) >> 24);
+	test_check_values();
+	test_unaligned(CRC32_POLY_IEEE);
+	test_unaligned(CRC32_POLY_C);
+	printf("%s\n", test_nb_fail ? "FAILED" : "OK");
+	return test_nb_fail ? 1 : 0;
+}
@@ -0,0 +1,163 @@
+/********************************** (C) COPYRIGHT *******************************
+* File Name          : test_fwupd.c
+* Author             : bvernoux
+* Version            : V1.0
+* Date               : 2026/10/19
+* Description        : Host test of firmware update pipeline (fwupd.c) with
+*                      simulated flash (fwupd_flash.c FWUPD_FLASH_SIM)
+* Copyright (c) 2026 Benjamin VERNOUX
+* SPDX-License-Identifier: Apache-2.0
+*******************************************************************************/
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "crc32.h"
+#include "fwupd.h"
+
+#define TEST_IMAGE_SIZE (100001) /* Last chunk not a multiple of 4 bytes */
+#define TEST_RUNNING_VAL (0x5A) /* Running image content */
+
+static uint32_t test_image[(TEST_IMAGE_SIZE + 3) / 4];
+static uint32_t test_buf[(TEST_IMAGE_SIZE + 3) / 4];
+static int test_nb_fail;
+
+#define TEST_CHECK(cond) \
+	do { if(!(cond)) { printf("FAIL %s:%d %s\n", __FILE__, __LINE__, #cond); test_nb_fail++; } } while(0)
+
+/*******************************************************************************
+ * @fn     test_running_image
+ *
+ * @brief  Program a running image filled with TEST_RUNNING_VAL
+ *
+ * @return None
+ */
+static void test_running_image(void)
+{
+	uint32_t offset;
+
+	memset(test_buf, TEST_RUNNING_VAL, sizeof(test_buf));
+	for(offset = 0; offset < fwupd_flash.max_size; offset += fwupd_flash.sector_size)
+		fwupd_flash.erase(fwupd_flash.base + offset, fwupd_flash.sector_size);
+	fwupd_flash.write(fwupd_flash.base, (const uint8_t*)test_buf, TEST_IMAGE_SIZE);
+}
+
+/*******************************************************************************
+ * @fn     test_running_image_unchanged
+ *
+ * @return 1 if running image is still filled with TEST_RUNNING_VAL else 0
+ */
+static int test_running_image_unchanged(void)
+{
+	const uint8_t* p = (const uint8_t*)test_buf;
+	uint32_t i;
+
+	fwupd_flash.read(fwupd_flash.base, (uint8_t*)test_buf, TEST_IMAGE_SIZE);
+	for(i = 0; i < TEST_IMAGE_SIZE; i++)
+	{
+		if(p[i] != TEST_RUNNING_VAL)
+			return 0;
+	}
+	return 1;
+}
+
+/*******************************************************************************
+ * @fn     test_send
+ *
+ * @brief  Send test_image in chunks of chunk_len bytes
+ *
+ * @return Last fwupd_write() return value
+ */
+static int test_send(uint32_t chunk_len)
+{
+	const uint8_t* data = (const uint8_t*)test_image;
+	uint32_t offset;
+	int ret = 0;
+
+	for(offset = 0; offset < TEST_IMAGE_SIZE; offset += chunk_len)
+	{
+		uint32_t n = TEST_IMAGE_SIZE - offset;
+		if(n > chunk_len)
+			n = chunk_len;
+		ret = fwupd_write(&data[offset], n);
+		if(ret != 0)
+			break;
+	}
+	return ret;
+}
+
+static void test_update_ok(void)
+{
+	fwupd_status_t status;
+	uint32_t crc = crc32_update(0, (const uint8_t*)test_image, TEST_IMAGE_SIZE);
+
+	test_running_image();
+	TEST_CHECK(fwupd_start(&fwupd_flash, TEST_IMAGE_SIZE, crc) == 0);
+	TEST_CHECK(fwupd_busy() == 1);
+	TEST_CHECK(test_send(FWUPD_CHUNK_SIZE) == 0);
+	fwupd_status_get(&status);
+	TEST_CHECK(status.state == FWUPD_STATE_DONE);
+	TEST_CHECK(status.programmed == TEST_IMAGE_SIZE);
+	TEST_CHECK(status.crc_flash == crc);
+	TEST_CHECK(fwupd_busy() == 0);
+	fwupd_flash.read(fwupd_flash.base, (uint8_t*)test_buf, TEST_IMAGE_SIZE);
+	TEST_CHECK(memcmp(test_buf, test_image, TEST_IMAGE_SIZE) == 0);
+	printf("update %d bytes: erase %uus write %uus verify %uus (simulated)\n",
+		   TEST_IMAGE_SIZE, status.erase_us, status.write_us, status.verify_us);
+}
+
+static void test_update_bad_crc(void)
+{
+	fwupd_status_t status;
+	uint32_t crc = crc32_update(0, (const uint8_t*)test_image, TEST_IMAGE_SIZE);
+
+	test_running_image();
+	TEST_CHECK(fwupd_start(&fwupd_flash, TEST_IMAGE_SIZE, crc ^ 1) == 0);
+	TEST_CHECK(test_send(FWUPD_CHUNK_SIZE) != 0);
+	fwupd_status_get(&status);
+	TEST_CHECK(status.state == FWUPD_STATE_ERROR);
+	TEST_CHECK(status.error == FWUPD_ERR_CRC);
+	TEST_CHECK(test_running_image_unchanged());
+}
+
+static void test_update_unaligned_chunk(void)
+{
+	fwupd_status_t status;
+	uint32_t crc = crc32_update(0, (const uint8_t*)test_image, TEST_IMAGE_SIZE);
+
+	test_running_image();
+	TEST_CHECK(fwupd_start(&fwupd_flash, TEST_IMAGE_SIZE, crc) == 0);
+	TEST_CHECK(test_send(FWUPD_CHUNK_SIZE - 2) != 0);
+	fwupd_status_get(&status);
+	TEST_CHECK(status.state == FWUPD_STATE_ERROR);
+	TEST_CHECK(status.error == FWUPD_ERR_LEN);
+	TEST_CHECK(status.programmed == 0);
+	TEST_CHECK(test_running_image_unchanged());
+}
+
+static void test_update_size(void)
+{
+	fwupd_status_t status;
+
+	TEST_CHECK(fwupd_start(&fwupd_flash, 0, 0) != 0);
+	TEST_CHECK(fwupd_start(&fwupd_flash, fwupd_flash.max_size + 1, 0) != 0);
+	fwupd_status_get(&status);
+	TEST_CHECK(status.error == FWUPD_ERR_SIZE);
+	TEST_CHECK(fwupd_start(&fwupd_flash, fwupd_flash.max_size, 0) == 0);
+	fwupd_abort();
+	TEST_CHECK(fwupd_busy() == 0);
+}
+
+int main(void)
+{
+	uint32_t i;
+
+	for(i = 0; i < (sizeof(test_image) / 4); i++)
+		test_image[i] = (i * 0x9E3779B9) ^ 0xA5A5A5A5;
+	test_update_ok();
+	test_update_bad_crc();
+	test_update_unaligned_chunk();
+	test_update_size();
+	printf("%s\n", test_nb_fail ? "FAILED" : "OK");
+	return test_nb_fail ? 1 : 0;
+}